@@ -137,7 +137,7 @@ void A2600System::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDeleg
 	console.initializeVideo();
 	console.initializeAudio();
 	log.info("is PAL:{}", videoSystem() == VideoSystem::PAL ? "yes" : "no");
-	Serializer state;
+	auto state = Serializer::sizeCounter();
 	osystem.state().saveState(state);
 	saveStateSize = state.size();
 }
@@ -228,8 +228,7 @@ void A2600System::reset(EmuApp &, ResetMode mode)
 
 void A2600System::readState(EmuApp &app, std::span<uint8_t> buff)
 {
-	Serializer state;
-	state.putByteArray(buff.data(), buff.size());
+	Serializer state{buff};
 	if(!osystem.state().loadState(state))
 		throw std::runtime_error("Invalid state data");
 	updateSwitchValues();
@@ -237,12 +236,11 @@ void A2600System::readState(EmuApp &app, std::span<uint8_t> buff)
 
 size_t A2600System::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
-	Serializer state;
-	osystem.state().saveState(state);
+	Serializer state{buff};
+	if(!osystem.state().saveState(state))
+		throw std::runtime_error("Error writing state data");
 	assert(state.size() == saveStateSize);
-	assert(state.size() <= buff.size());
-	state.getByteArray(buff.data(), buff.size());
-	return saveStateSize;
+	return state.size();
 }
 
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
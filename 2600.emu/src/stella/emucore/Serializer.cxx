@@ -73,9 +73,60 @@ Serializer::Serializer()
   }
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Serializer::Serializer(std::span<uInt8> buffer)
+  : myBuffer{buffer},
+    myUseBuffer{true}
+{
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Serializer Serializer::sizeCounter()
+{
+  return Serializer{std::span<uInt8>{}};
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::read(void* data, size_t size) const
+{
+  if(!myUseBuffer)
+  {
+    myStream->read(static_cast<char*>(data), size);
+    return;
+  }
+  if(size > myBuffer.size() || myPos > myBuffer.size() - size)
+    throw runtime_error("Serializer: read past end of buffer");
+  std::memcpy(data, &myBuffer[myPos], size);
+  myPos += size;
+  myEnd = std::max(myEnd, myPos);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Serializer::write(const void* data, size_t size)
+{
+  if(!myUseBuffer)
+  {
+    myStream->write(static_cast<const char*>(data), size);
+    return;
+  }
+  if(myBuffer.data())
+  {
+    if(size > myBuffer.size() || myPos > myBuffer.size() - size)
+      throw runtime_error("Serializer: write past end of buffer");
+    std::memcpy(&myBuffer[myPos], data, size);
+  }
+  myPos += size;
+  myEnd = std::max(myEnd, myPos);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::setPosition(size_t pos)
 {
+  if(myUseBuffer)
+  {
+    myPos = pos;
+    return;
+  }
   myStream->clear();
   myStream->seekg(pos);
   myStream->seekp(pos);
@@ -84,6 +135,11 @@ void Serializer::setPosition(size_t pos)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::rewind()
 {
+  if(myUseBuffer)
+  {
+    myPos = 0;
+    return;
+  }
   myStream->clear();
   myStream->seekg(ios_base::beg);
   myStream->seekp(ios_base::beg);
@@ -92,6 +148,9 @@ void Serializer::rewind()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 size_t Serializer::size()
 {
+  if(myUseBuffer)
+    return myEnd;
+
   const std::streampos oldPos = myStream->tellp();
 
   myStream->seekp(0, std::ios::end);
@@ -105,7 +164,7 @@ size_t Serializer::size()
 uInt8 Serializer::getByte() const
 {
   char buf;
-  myStream->read(&buf, 1);
+  read(&buf, 1);
 
   return buf;
 }
@@ -113,14 +172,14 @@ uInt8 Serializer::getByte() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::getByteArray(uInt8* array, size_t size) const
 {
-  myStream->read(reinterpret_cast<char*>(array), size);
+  read(array, size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt16 Serializer::getShort() const
 {
   uInt16 val = 0;
-  myStream->read(reinterpret_cast<char*>(&val), sizeof(uInt16));
+  read(&val, sizeof(uInt16));
 
   return val;
 }
@@ -128,14 +187,14 @@ uInt16 Serializer::getShort() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::getShortArray(uInt16* array, size_t size) const
 {
-  myStream->read(reinterpret_cast<char*>(array), sizeof(uInt16)*size);
+  read(array, sizeof(uInt16)*size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt32 Serializer::getInt() const
 {
   uInt32 val = 0;
-  myStream->read(reinterpret_cast<char*>(&val), sizeof(uInt32));
+  read(&val, sizeof(uInt32));
 
   return val;
 }
@@ -143,14 +202,14 @@ uInt32 Serializer::getInt() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::getIntArray(uInt32* array, size_t size) const
 {
-  myStream->read(reinterpret_cast<char*>(array), sizeof(uInt32)*size);
+  read(array, sizeof(uInt32)*size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 uInt64 Serializer::getLong() const
 {
   uInt64 val = 0;
-  myStream->read(reinterpret_cast<char*>(&val), sizeof(uInt64));
+  read(&val, sizeof(uInt64));
 
   return val;
 }
@@ -159,7 +218,7 @@ uInt64 Serializer::getLong() const
 double Serializer::getDouble() const
 {
   double val = 0.0;
-  myStream->read(reinterpret_cast<char*>(&val), sizeof(double));
+  read(&val, sizeof(double));
 
   return val;
 }
@@ -170,7 +229,7 @@ string Serializer::getString() const
   const int len = getInt();
   string str;
   str.resize(len);
-  myStream->read(&str[0], len);
+  read(str.data(), len);
 
   return str;
 }
@@ -184,49 +243,49 @@ bool Serializer::getBool() const
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putByte(uInt8 value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), 1);
+  write(&value, 1);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putByteArray(const uInt8* array, size_t size)
 {
-  myStream->write(reinterpret_cast<const char*>(array), size);
+  write(array, size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putShort(uInt16 value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), sizeof(uInt16));
+  write(&value, sizeof(uInt16));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putShortArray(const uInt16* array, size_t size)
 {
-  myStream->write(reinterpret_cast<const char*>(array), sizeof(uInt16)*size);
+  write(array, sizeof(uInt16)*size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putInt(uInt32 value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), sizeof(uInt32));
+  write(&value, sizeof(uInt32));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putIntArray(const uInt32* array, size_t size)
 {
-  myStream->write(reinterpret_cast<const char*>(array), sizeof(uInt32)*size);
+  write(array, sizeof(uInt32)*size);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putLong(uInt64 value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), sizeof(uInt64));
+  write(&value, sizeof(uInt64));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Serializer::putDouble(double value)
 {
-  myStream->write(reinterpret_cast<char*>(&value), sizeof(double));
+  write(&value, sizeof(double));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -234,7 +293,7 @@ void Serializer::putString(const string& str)
 {
   const uInt32 len = static_cast<uInt32>(str.length());
   putInt(len);
-  myStream->write(str.data(), len);
+  write(str.data(), len);
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
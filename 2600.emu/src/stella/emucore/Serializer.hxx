@@ -19,11 +19,13 @@
 #define SERIALIZER_HXX
 
 #include "bspf.hxx"
+#include <span>
 
 /**
   This class implements a Serializer device, whereby data is serialized and
   read from/written to a binary stream in a system-independent way.  The
-  stream can be either an actual file, or an in-memory structure.
+  stream can be either an actual file, an in-memory structure, or a
+  caller-provided fixed size buffer.
 
   Bytes are written as characters, shorts as 2 characters (16-bits),
   integers as 4 characters (32-bits), long integers as 8 bytes (64-bits),
@@ -52,12 +54,26 @@ class Serializer
     explicit Serializer(const string& filename, Mode m = Mode::ReadWrite);
     Serializer();
 
+    /**
+      Creates a new Serializer device that reads from and writes to the
+      given buffer directly, without any intermediate copies.  Accessing
+      data past the end of the buffer throws a runtime_error.
+    */
+    explicit Serializer(std::span<uInt8> buffer);
+
+    /**
+      Creates a new Serializer device that discards all written data and
+      only tracks its size, for finding the exact size of a state before
+      allocating a buffer for it.  Reading from it isn't allowed.
+    */
+    static Serializer sizeCounter();
+
   public:
     /**
       Answers whether the serializer is currently initialized for reading
       and writing.
     */
-    explicit operator bool() const { return myStream != nullptr; }
+    explicit operator bool() const { return myStream != nullptr || myUseBuffer; }
 
     /**
       Sets the read/write location to the given offset in the stream.
@@ -70,7 +86,8 @@ class Serializer
     void rewind();
 
     /**
-      Returns the current total size of the stream.
+      Returns the current total size of the stream.  For buffer and size
+      counting devices, this is the furthest position accessed so far.
     */
     size_t size();
 
@@ -220,10 +237,21 @@ class Serializer
     */
     void putBool(bool b);
 
+  private:
+    void read(void* data, size_t size) const;
+    void write(const void* data, size_t size);
+
   private:
     // The stream to send the serialized data to.
     unique_ptr<iostream> myStream;
 
+    // Used instead of the stream when set, with no data stored when the
+    // buffer is empty (size counting mode)
+    std::span<uInt8> myBuffer;
+    mutable size_t myPos{0};
+    mutable size_t myEnd{0};
+    bool myUseBuffer{false};
+
     static constexpr uInt8 TruePattern = 0xfe, FalsePattern = 0x01;
 };
 
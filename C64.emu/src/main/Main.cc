@@ -73,6 +73,7 @@ bool EmuSystem::hasResetModes = true;
 bool EmuSystem::handlesGenericIO = false;
 bool EmuSystem::hasRectangularPixels = true;
 bool EmuSystem::stateSizeChangesAtRuntime = true;
+bool EmuSystem::canRunAhead = false;
 bool EmuApp::needsGlobalInstance = true;
 
 C64App::C64App(ApplicationInitParams initParams, ApplicationContext &ctx):
@@ -1,10 +1,13 @@
 include $(IMAGINE_PATH)/make/imagineStaticLibBase.mk
 
 SRC += \
+AudioResampler.cc \
 AutosaveManager.cc \
 ConfigFile.cc \
+CPUVideoFilter.cc \
 EmuApp.cc \
 EmuAudio.cc \
+EmuBenchmark.cc \
 EmuInput.cc \
 EmuOptions.cc \
 EmuSystem.cc \
@@ -12,13 +15,17 @@ EmuSystemTask.cc \
 EmuTiming.cc \
 EmuVideo.cc \
 EmuVideoLayer.cc \
+FrameCapture.cc \
 InputDeviceConfig.cc \
 InputDeviceData.cc \
+InputMovie.cc \
 KeyConfig.cc \
 OutputTimingManager.cc \
 pathUtils.cc \
 RecentContent.cc \
 RewindManager.cc \
+RunAheadManager.cc \
+StateCodec.cc \
 ToggleInput.cc \
 TurboInput.cc \
 VideoImageEffect.cc \
@@ -78,6 +85,18 @@ CFLAGS_WARN += -Werror
 include $(IMAGINE_PATH)/make/package/imagine.mk
 include $(IMAGINE_PATH)/make/package/stdc++.mk
 
+# zstd state compression links the system libzstd, other targets only write gzip states
+ifeq ($(ENV), linux)
+ ifneq ($(SUBENV), pandora)
+  stateCodecZstd ?= 1
+ endif
+endif
+
+ifeq ($(stateCodecZstd), 1)
+ CPPFLAGS += -DCONFIG_PACKAGE_ZSTD
+ include $(IMAGINE_PATH)/make/package/zstd.mk
+endif
+
 include $(IMAGINE_PATH)/make/imagineStaticLibTarget.mk
 
 install : main
@@ -0,0 +1,58 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/audio/Format.hh>
+#include <imagine/util/memory/DynArray.hh>
+#include <array>
+#include <cmath>
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+// Streaming cubic (Catmull-Rom) resampler for interleaved i16 or f32 frames with up to 2 channels.
+// Position state and the last input frames are carried between calls so consecutive
+// writes resample as one continuous stream.
+
+class AudioResampler
+{
+public:
+	static constexpr int historyFrames = 3;
+
+	// Resamples all frames in src, advancing step input frames per output frame,
+	// and returns the number of frames written to dest, which must have space for maxOutputFrames()
+	size_t resample(void *dest, const void *src, size_t srcFrames, double step, Audio::Format);
+	// Updates the history from frames that were output without resampling
+	void skip(const void *src, size_t srcFrames, Audio::Format);
+	void reset();
+
+	static constexpr size_t maxOutputFrames(size_t srcFrames, double step)
+	{
+		return std::ceil(srcFrames / step) + 1;
+	}
+
+protected:
+	DynArray<float> work;
+	std::array<float, historyFrames * 2> history{};
+	double pos{historyFrames};
+	int channels{};
+
+	void prepare(Audio::Format);
+};
+
+}
@@ -16,13 +16,18 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <emuframework/config.hh>
+#include <emuframework/StateCodec.hh>
 #include <imagine/base/PausableTimer.hh>
 #include <imagine/fs/FSDefs.hh>
 #include <imagine/io/FileIO.hh>
 #include <imagine/util/enum.hh>
+#include <imagine/util/memory/DynArray.hh>
 #include <string>
 #include <string_view>
 #include <functional>
+#include <thread>
+#include <atomic>
+#include <semaphore>
 
 namespace EmuEx
 {
@@ -45,21 +50,23 @@ constexpr std::string_view defaultAutosaveFilename = "auto-00";
 constexpr std::string_view noAutosaveName = "\a";
 constexpr Minutes maxAutosaveSaveFreq{720};
 
+// Autosave states are captured uncompressed, either on the emulation thread after
+// the next emulated frame for timer saves, or directly while emulation is paused.
+// A worker thread then compresses the state and writes it to a temporary file that
+// is synced and renamed over the previous autosave, so an interrupted write
+// never replaces the last good state.
+
 class AutosaveManager
 {
 public:
 	AutosaveManager(EmuApp &);
+	~AutosaveManager();
 	bool save(AutosaveActionSource src = AutosaveActionSource::Auto);
 	bool load(AutosaveActionSource src, LoadAutosaveMode m);
 	bool load(LoadAutosaveMode m) { return load(AutosaveActionSource::Auto, m); }
 	bool load(AutosaveActionSource src = AutosaveActionSource::Auto) { return load(src, LoadAutosaveMode::Normal); }
 	bool setSlot(std::string_view name);
-	void resetSlot(std::string_view name = "")
-	{
-		autoSaveSlot = name;
-		saveTimer.cancel();
-		stateIO = {};
-	}
+	void resetSlot(std::string_view name = "");
 	bool renameSlot(std::string_view name, std::string_view newName);
 	bool deleteSlot(std::string_view name);
 	std::string_view slotName() const { return autoSaveSlot; }
@@ -78,14 +85,38 @@ public:
 	void writeConfig(FileIO &) const;
 	ApplicationContext appContext() const;
 	auto& system(this auto&& self) { return self.app.system(); }
+	void waitForSave();
+
+	// called from the emulation thread after each emulated frame
+	void notifyFrameRun(EmuSystem &sys)
+	{
+		if(captureRequested.load(std::memory_order_acquire)) [[unlikely]]
+			captureState(sys);
+	}
 
 private:
 	EmuApp &app;
 	std::string autoSaveSlot;
-	FileIO stateIO;
+	DynArray<uint8_t> stateBuff;
+	DynArray<uint8_t> compBuff; // write thread's compressor output
+	size_t capturedSize{};
+	FS::PathString capturedPath;
+	StateCodecConfig capturedCodec;
+	std::thread writeThread;
+	std::binary_semaphore writeSem{0};
+	std::atomic_bool writePending{};
+	std::atomic_bool captureRequested{};
+	bool quitWriteThread{};
 
 	bool saveState();
-	bool loadState();
+	bool loadState(FileIO &);
+	void requestStateCapture();
+	void captureState(EmuSystem &);
+	void startWrite();
+	void writeStateFile();
+	void onStateWritten(bool success);
+	void startWriteThread();
+	void stopWriteThread();
 
 public:
 	PausableTimer<Minutes> saveTimer;
@@ -0,0 +1,78 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+// Post-processes a system's frame on the CPU before EmuVideo submits it, for effects like composite video
+// filters that need neighboring pixels and change the output size. Set with EmuVideo::setCPUFilter().
+class CPUVideoFilter
+{
+public:
+	virtual ~CPUVideoFilter() = default;
+	virtual WSize outputSize(WSize inputSize) const = 0;
+	// Filters input rows [startY, endY) into the same rows of dest, called concurrently for disjoint bands.
+	// Input and output share one of the EmuVideo render formats.
+	virtual void filterRows(MutablePixmapView dest, PixmapView src, int startY, int endY) const = 0;
+};
+
+// Splits a frame into horizontal bands and runs them in parallel, the calling thread handles the first band
+class VideoFilterThreadPool
+{
+public:
+	using BandDelegate = DelegateFuncS<sizeof(void*) * 4, void(int startY, int endY)>;
+	static constexpr int maxThreads = 4;
+
+	VideoFilterThreadPool() = default;
+	VideoFilterThreadPool(VideoFilterThreadPool &&) = delete;
+	~VideoFilterThreadPool() { stop(); }
+	void start(int threads);
+	void stop();
+	int threads() const { return int(workers.size()) + 1; }
+	void run(int height, BandDelegate);
+	void addThreadIds(std::vector<ThreadId> &) const;
+	static int defaultThreads();
+
+private:
+	struct Worker
+	{
+		std::thread thread;
+		ThreadId id{};
+	};
+
+	std::vector<Worker> workers;
+	BandDelegate bandDel;
+	int height{};
+	std::atomic_uint32_t generation{};
+	std::atomic_int pendingBands{};
+	bool quit{};
+
+	void runWorker(int band, uint32_t seenGeneration);
+	std::pair<int, int> bandRows(int band) const;
+};
+
+}
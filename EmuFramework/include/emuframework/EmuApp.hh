@@ -23,14 +23,18 @@
 #include <emuframework/EmuVideoLayer.hh>
 #include <emuframework/EmuInput.hh>
 #include <emuframework/EmuOptions.hh>
+#include <emuframework/FrameCapture.hh>
+#include <emuframework/InputMovie.hh>
 #include <emuframework/AutosaveManager.hh>
 #include <emuframework/OutputTimingManager.hh>
 #include <emuframework/RecentContent.hh>
 #include <emuframework/RewindManager.hh>
+#include <emuframework/RunAheadManager.hh>
 #include <imagine/input/inputDefs.hh>
 #include <imagine/gui/ViewManager.hh>
 #include <imagine/gui/ToastView.hh>
 #include <imagine/fs/FSDefs.hh>
+#include <imagine/fs/DirectoryIndex.hh>
 #include <imagine/base/ApplicationContext.hh>
 #include <imagine/base/Application.hh>
 #include <imagine/base/VibrationManager.hh>
@@ -184,13 +188,21 @@ public:
 	void setupStaticBackupMemoryFile(FileIO &, std::string_view ext, size_t staticSize, uint8_t initValue = 0) const;
 	void readState(std::span<uint8_t> buff);
 	size_t writeState(std::span<uint8_t> buff, SaveStateFlags = {});
-	DynArray<uint8_t> saveState();
 	bool saveState(CStringView path);
 	bool saveStateWithSlot(int slot);
 	bool loadState(CStringView path);
 	bool loadStateWithSlot(int slot);
 	bool shouldOverwriteExistingState() const;
+	StateCodecConfig stateCodecConfig() const;
+	bool startInputMovieRecording();
+	bool playInputMovie(CStringView path);
+	void stopInputMovie();
+	FS::PathString inputMoviePath() const { return contentSaveFilePath(".emumovie"); }
+	bool startFrameCapture();
+	void stopFrameCapture();
 	FS::PathString inContentSearchPath(std::string_view name) const;
+	FS::DirectoryIndex &directoryIndex();
+	void saveDirectoryIndex();
 	FS::PathString validSearchPath(const FS::PathString &) const;
 	static void updateLegacySavePath(IG::ApplicationContext, CStringView path);
 	auto screenshotDirectory() const { return system().userPath(userScreenshotPath); }
@@ -231,7 +243,7 @@ public:
 	void renderSystemFramebuffer(EmuVideo &);
 	void renderSystemFramebuffer() { renderSystemFramebuffer(video); }
 	bool writeScreenshot(IG::PixmapView, CStringView path);
-	FS::PathString makeNextScreenshotFilename();
+	FS::PathString makeNextScreenshotFilename(std::string_view ext = ".png");
 	bool mogaManagerIsActive() const { return bool(mogaManagerPtr); }
 	void setMogaManagerActive(bool on, bool notify);
 	void closeBluetoothConnections();
@@ -244,6 +256,7 @@ public:
 	void setIntendedFrameRate(Window &, FrameTimeConfig);
 	static std::u16string_view mainViewName();
 	void runBenchmarkOneShot(EmuVideo &);
+	void runHeadlessBenchmark(CStringView path);
 	void onSelectFileFromPicker(IG::IO, CStringView path, std::string_view displayName,
 		const Input::Event &, EmuSystemCreateParams, ViewAttachParams);
 	void handleOpenFileCommand(CStringView path);
@@ -340,7 +353,10 @@ public:
 	AutosaveManager autosaveManager{*this};
 	InputManager inputManager;
 	OutputTimingManager outputTimingManager;
-	RewindManager rewindManager{*this};
+	RewindManager rewindManager;
+	RunAheadManager runAheadManager;
+	InputMovie inputMovie{*this};
+	FrameCapture frameCapture{*this};
 	ConditionalMember<enableFrameTimeStats, FrameTimeStats> frameTimeStats;
 	[[no_unique_address]] IG::VibrationManager vibrationManager;
 protected:
@@ -355,6 +371,9 @@ protected:
 	Gfx::DrawableConfig windowDrawableConf;
 	ConditionalMember<Config::TRANSLUCENT_SYSTEM_UI, bool> layoutBehindSystemUI{};
 	bool enableBlankFrameInsertion{};
+	HeadlessBenchmarkParams headlessBenchmark;
+	FS::DirectoryIndex directoryIndex_;
+	bool directoryIndexLoaded{};
 public:
 	BluetoothAdapter bluetoothAdapter;
 	RecentContent recentContent;
@@ -397,6 +416,12 @@ public:
 	Property<bool, CFGKEY_IDLE_DISPLAY_POWER_SAVE> idleDisplayPowerSave;
 	Property<bool, CFGKEY_SHOW_HIDDEN_FILES> showHiddenFilesInPicker;
 	Property<bool, CFGKEY_CONFIRM_OVERWRITE_STATE, PropertyDesc<bool>{.defaultValue = true}> confirmOverwriteState;
+	Property<StateCodecType, CFGKEY_STATE_CODEC,
+		PropertyDesc<StateCodecType>{.defaultValue = StateCodecType::Gzip, .isValid = enumIsValidUpToLast}> stateCodec;
+	Property<StateCompressionLevel, CFGKEY_STATE_COMPRESSION_LEVEL,
+		PropertyDesc<StateCompressionLevel>{.defaultValue = StateCompressionLevel::Default, .isValid = enumIsValidUpToLast}> stateCompressionLevel;
+	Property<int8_t, CFGKEY_CAPTURE_FRAME_INTERVAL,
+		PropertyDesc<int8_t>{.defaultValue = 1, .isValid = isValidWithMinMax<1, FrameCapture::maxFrameInterval>}> captureFrameInterval;
 	Property<bool, CFGKEY_SYSTEM_ACTIONS_IS_DEFAULT_MENU, PropertyDesc<bool>{.defaultValue = true}> systemActionsIsDefaultMenu;
 	ConditionalProperty<Config::windowFocus, bool, CFGKEY_PAUSE_UNFOCUSED, PropertyDesc<bool>{
 		.defaultValue = true}> pauseUnfocused;
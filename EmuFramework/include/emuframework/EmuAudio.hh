@@ -15,6 +15,7 @@
 	You should have received a copy of the GNU General Public License
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
+#include <emuframework/AudioResampler.hh>
 #include <imagine/audio/OutputStream.hh>
 #include <imagine/audio/Manager.hh>
 #include <imagine/time/Time.hh>
@@ -34,6 +35,8 @@ namespace EmuEx
 
 using namespace IG;
 
+class FrameCapture;
+
 struct AudioFlags
 {
 	uint8_t
@@ -81,11 +84,14 @@ public:
 	explicit operator bool() const { return bool(rBuff.capacity()); }
 	void writeConfig(FileIO &) const;
 	bool readConfig(MapIO &, unsigned key);
+	void setSequenceCapture(FrameCapture *capture) { sequenceCapture = capture; }
 
 	IG::Audio::Manager manager;
 protected:
 	IG::Audio::OutputStream audioStream;
 	RingBuffer<uint8_t, RingBufferConf{.mirrored = true}> rBuff;
+	AudioResampler resampler;
+	FrameCapture *sequenceCapture{};
 	SteadyClockTimePoint lastUnderrunTime{};
 	double speedMultiplier{1.};
 	size_t targetBufferFillBytes{};
@@ -101,6 +107,7 @@ protected:
 	bool addSoundBuffersOnUnderrun{};
 public:
 	bool addSoundBuffersOnUnderrunSetting{};
+	bool dynamicRateControl{true};
 	int8_t defaultSoundBuffers{3};
 	int8_t soundBuffers{defaultSoundBuffers};
 
@@ -111,6 +118,7 @@ public:
 	void resizeAudioBuffer(size_t targetBufferFillBytes);
 	void updateVolume();
 	void updateAddBuffersOnUnderrun();
+	double rateControlRatio() const;
 };
 
 }
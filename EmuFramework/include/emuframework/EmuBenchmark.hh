@@ -0,0 +1,64 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/base/BaseApplication.hh>
+#include <imagine/time/Time.hh>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+// Parameters for running a benchmark without a window, GL context, or audio device, set from the command line:
+// --benchmark[=frames] [--benchmark-output=path] [--benchmark-movie=path] <content path>
+// With an input movie, the benchmark replays it from its start state and runs for the movie's length by default
+// The app still connects to the display server and opens its GL display at startup, so machines without one
+// need a virtual display, for example: xvfb-run ./app --benchmark game.rom
+struct HeadlessBenchmarkParams
+{
+	static constexpr int defaultFrames = 180;
+
+	int frames{};
+	const char *outputPath{}; // write results to stdout if null
+	const char *moviePath{};
+
+	explicit operator bool() const { return frames > 0 || moviePath; }
+	static HeadlessBenchmarkParams parse(CommandArgs);
+	static bool isOption(std::string_view arg) { return arg.starts_with("--benchmark"); }
+};
+
+class BenchmarkResult
+{
+public:
+	std::vector<SteadyClockTime> frameTimes;
+	SteadyClockTime totalTime{};
+	SteadyClockTime videoTime{}; // time spent in EmuVideo converting and submitting frames
+	size_t peakRSSBytes{};
+
+	int frames() const { return frameTimes.size(); }
+	double fps() const;
+	SteadyClockTime emulationTime() const { return totalTime - videoTime; }
+	SteadyClockTime frameTimePercentile(double percent) const;
+	SteadyClockTime maxFrameTime() const;
+	std::string toJSON(std::string_view systemName, std::string_view contentName) const;
+	static size_t currentPeakRSS();
+};
+
+}
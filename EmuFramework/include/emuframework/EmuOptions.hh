@@ -83,7 +83,10 @@ enum { CFGKEY_SOUND = 0, CFGKEY_TOUCH_CONTROL_DISPLAY = 1,
 	CFGKEY_INPUT_KEY_CONFIGS_V2 = 114, CFGKEY_VCONTROLLER_HIGHLIGHT_PUSHED_BUTTONS = 115,
 	CFGKEY_RECENT_CONTENT_V2 = 116, CFGKEY_MAX_RECENT_CONTENT = 117,
 	CFGKEY_REWIND_STATES = 118, CFGKEY_REWIND_TIMER_SECS = 119,
-	CFGKEY_FRAME_CLOCK = 120,
+	CFGKEY_FRAME_CLOCK = 120, CFGKEY_REWIND_MEMORY_MIB = 121,
+	CFGKEY_REWIND_FRAME_INTERVAL = 122, CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL = 123,
+	CFGKEY_STATE_CODEC = 124, CFGKEY_STATE_COMPRESSION_LEVEL = 125,
+	CFGKEY_RUN_AHEAD_FRAMES = 126, CFGKEY_CAPTURE_FRAME_INTERVAL = 127,
 	// 256+ is reserved
 };
 
@@ -26,6 +26,8 @@
 #include <emuframework/EmuTiming.hh>
 #include <emuframework/VController.hh>
 #include <emuframework/EmuInput.hh>
+#include <emuframework/EmuBenchmark.hh>
+#include <emuframework/StateCodec.hh>
 #include <string>
 #include <string_view>
 
@@ -55,6 +57,7 @@ class EmuSystemTaskContext;
 class EmuAudio;
 class EmuVideo;
 class EmuApp;
+class InputMovie;
 struct EmuFrameTimeInfo;
 class VControllerKeyboard;
 
@@ -140,6 +143,9 @@ constexpr const char *optionUserPathContentToken = ":CONTENT:";
 struct SaveStateFlags
 {
 	uint8_t uncompressed:1{};
+	// state is only read back by this process while the same content is running (rewind, run-ahead),
+	// so a system may use a faster format that isn't compatible with state files
+	uint8_t inSession:1{};
 };
 
 class EmuSystem
@@ -198,6 +204,7 @@ public:
 	static F2Size validFrameRateRange;
 	static bool hasRectangularPixels;
 	static bool stateSizeChangesAtRuntime;
+	static bool canRunAhead;
 
 	EmuSystem(IG::ApplicationContext ctx): appCtx{ctx} {}
 
@@ -242,18 +249,25 @@ public:
 	bool resetSessionOptions(EmuApp &);
 	void savePathChanged();
 	bool shouldFastForward() const;
+	// rewind and run-ahead are only set up when this returns true as the system is created
+	bool allowsInSessionStates() const;
 	FS::FileString contentDisplayNameForPath(CStringView path) const;
 	IG::Rotation contentRotation() const;
 	void addThreadGroupIds(std::vector<ThreadId> &) const;
+	// streams the state through a StateCompressor using outBuff for output chunks, returns the total size or 0 on error,
+	// the default implementation first writes an uncompressed copy to the scratch buffer
+	size_t writeCompressedState(std::span<uint8_t> outBuff, StateCodecConfig, StateCompressor::OutputDelegate onOutput);
 
 	ApplicationContext appContext() const { return appCtx; }
 	bool isActive() const { return state == State::ACTIVE; }
 	bool isStarted() const { return state == State::ACTIVE || state == State::PAUSED; }
 	bool isPaused() const { return state == State::PAUSED; }
 	void loadState(EmuApp &, CStringView uri);
-	void saveState(CStringView uri);
-	DynArray<uint8_t> saveState();
-	DynArray<uint8_t> uncompressGzipState(std::span<uint8_t> buff, size_t expectedSize = 0);
+	void saveState(CStringView uri, StateCodecConfig codec = {});
+	DynArray<uint8_t> uncompressState(std::span<uint8_t> buff, size_t expectedSize = 0);
+	std::span<uint8_t> uncompressStateToScratchBuffer(std::span<uint8_t> buff, size_t expectedSize = 0);
+	std::span<uint8_t> stateScratchBuffer(size_t size);
+	void freeStateBuffers();
 	bool stateExists(int slot) const;
 	static std::string_view stateSlotName(int slot);
 	std::string_view stateSlotName() { return stateSlotName(stateSlot()); }
@@ -279,6 +293,7 @@ public:
 	std::string contentDisplayName() const;
 	void setContentDisplayName(std::string_view name);
 	FS::FileString contentDisplayNameForPathDefaultImpl(CStringView path) const;
+	size_t writeCompressedStateDefaultImpl(std::span<uint8_t> outBuff, StateCodecConfig, StateCompressor::OutputDelegate);
 	void setInitialLoadPath(CStringView path);
 	FS::PathString fallbackSaveDirectory(bool create = false);
 	const auto &contentSaveDirectory() const { return contentSaveDirectory_; }
@@ -360,7 +375,7 @@ public:
 	static double audioMixRate(int outputRate, double inputFrameRate, FrameTime outputFrameTime);
 	double audioMixRate(int outputRate, FrameTime outputFrameTime) const { return audioMixRate(outputRate, frameRate(), outputFrameTime); }
 	void configFrameTime(int outputRate, FrameTime outputFrameTime);
-	SteadyClockTime benchmark(EmuVideo &video);
+	BenchmarkResult benchmark(EmuVideo &video, int frames = HeadlessBenchmarkParams::defaultFrames, InputMovie *movie = {});
 	bool hasContent() const;
 	void resetFrameTime();
 	void pause(EmuApp &);
@@ -390,6 +405,8 @@ protected:
 	std::string contentDisplayName_; // more descriptive content name set by system
 	FS::PathString contentSaveDirectory_;
 	FS::PathString userSaveDirectory_;
+	DynArray<uint8_t> stateScratch; // intermediate uncompressed state when writing compressed states
+	DynArray<uint8_t> stateSaveBuff; // compressed output chunks of saveState(uri)
 
 	void setupContentUriPaths(CStringView uri, std::string_view displayName);
 	void setupContentFilePaths(CStringView filePath, std::string_view displayName);
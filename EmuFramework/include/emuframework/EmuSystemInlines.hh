@@ -141,6 +141,13 @@ bool EmuSystem::shouldFastForward() const
 	return {};
 }
 
+bool EmuSystem::allowsInSessionStates() const
+{
+	if(&MainSystem::allowsInSessionStates != &EmuSystem::allowsInSessionStates)
+		return static_cast<const MainSystem*>(this)->allowsInSessionStates();
+	return true;
+}
+
 void EmuSystem::writeConfig(ConfigType type, FileIO &io)
 {
 	static_cast<MainSystem*>(this)->writeConfig(type, io);
@@ -218,6 +225,13 @@ size_t EmuSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 		return static_cast<MainSystem*>(this)->writeState(buff, flags);
 }
 
+size_t EmuSystem::writeCompressedState(std::span<uint8_t> outBuff, StateCodecConfig codec, StateCompressor::OutputDelegate onOutput)
+{
+	if(&MainSystem::writeCompressedState != &EmuSystem::writeCompressedState)
+		return static_cast<MainSystem*>(this)->writeCompressedState(outBuff, codec, onOutput);
+	return writeCompressedStateDefaultImpl(outBuff, codec, onOutput);
+}
+
 void EmuSystem::clearInputBuffers(EmuInputView &view)
 {
 	static_cast<MainSystem*>(this)->clearInputBuffers(view);
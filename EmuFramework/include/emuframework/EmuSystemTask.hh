@@ -65,7 +65,6 @@ public:
 	void notifyFramePresented();
 	void sendVideoFormatChangedReply(EmuVideo &);
 	void sendFrameFinishedReply(EmuVideo &);
-	void sendScreenshotReply(bool success);
 	auto threadId() const { return threadId_; }
 
 private:
@@ -18,8 +18,10 @@
 #include <emuframework/EmuAppHelper.hh>
 #include <emuframework/EmuSystemTask.hh>
 #include <emuframework/EmuSystemTaskContext.hh>
+#include <emuframework/CPUVideoFilter.hh>
 #include <imagine/gfx/PixmapBufferTexture.hh>
 #include <imagine/gfx/SyncFence.hh>
+#include <imagine/pixmap/MemPixmap.hh>
 
 namespace EmuEx
 {
@@ -27,6 +29,7 @@ namespace EmuEx
 using namespace IG;
 class EmuVideo;
 class EmuSystem;
+class FrameCapture;
 
 class [[nodiscard]] EmuVideoImage
 {
@@ -52,6 +55,10 @@ public:
 	constexpr EmuVideo() = default;
 	void setRendererTask(Gfx::RendererTask &);
 	bool hasRendererTask() const;
+	void setHeadless(EmuSystem &, IG::PixelFormat);
+	bool isHeadless() const { return headless; }
+	void setTrackWorkTime(bool on) { trackWorkTime = on; workTime = {}; }
+	SteadyClockTime takeWorkTime() { return std::exchange(workTime, {}); }
 	bool setFormat(IG::PixmapDesc desc, EmuSystemTaskContext task = {});
 	void dispatchFormatChanged() { onFormatChanged(*this); }
 	void resetImage(IG::PixelFormat newFmt = {});
@@ -81,10 +88,21 @@ public:
 	IG::PixelFormat internalRenderPixelFormat() const;
 	static Gfx::TextureSamplerConfig samplerConfigForLinearFilter(bool useLinearFilter);
 	static MutablePixmapView takeInterlacedFields(MutablePixmapView, bool isOddField);
+	void setCPUFilter(CPUVideoFilter *, int threads = VideoFilterThreadPool::defaultThreads());
+	CPUVideoFilter *cpuFilter() const { return cpuFilter_; }
+	void setSequenceCapture(FrameCapture *capture) { sequenceCapture = capture; }
+	void addThreadGroupIds(std::vector<ThreadId> &ids) const { filterThreads.addThreadIds(ids); }
 
 protected:
 	Gfx::RendererTask *rTask{};
 	Gfx::PixmapBufferTexture vidImg;
+	IG::MemPixmap headlessImg; // CPU-side frame buffer used instead of vidImg when headless
+	IG::MemPixmap filterSrcImg; // frame written by the system before cpuFilter_ runs
+	CPUVideoFilter *cpuFilter_{};
+	FrameCapture *sequenceCapture{};
+	VideoFilterThreadPool filterThreads;
+	SteadyClockTimePoint workStartTime{};
+	SteadyClockTime workTime{};
 public:
 	FrameFinishedDelegate onFrameFinished;
 	FormatChangedDelegate onFormatChanged;
@@ -94,9 +112,23 @@ protected:
 	bool screenshotNextFrame{};
 	Gfx::ColorSpace colSpace{Gfx::ColorSpace::LINEAR};
 	bool useLinearFilter{true};
+	bool headless{};
+	bool trackWorkTime{};
 
-	void doScreenshot(EmuSystemTaskContext, IG::PixmapView pix);
+	void captureFrame(IG::PixmapView pix);
 	void postFrameFinished(EmuSystemTaskContext);
+	void submitFrame(EmuSystemTaskContext, Gfx::LockedTextureBuffer texBuff);
+	void finishFilteredFrame(EmuSystemTaskContext, IG::PixmapView src);
+	void markWorkStart()
+	{
+		if(trackWorkTime && !hasTime(workStartTime))
+			workStartTime = SteadyClock::now();
+	}
+	void markWorkEnd()
+	{
+		if(hasTime(workStartTime))
+			workTime += SteadyClock::now() - std::exchange(workStartTime, {});
+	}
 	Gfx::TextureSamplerConfig samplerConfig() const { return samplerConfigForLinearFilter(useLinearFilter); }
 
 public:
@@ -0,0 +1,113 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/pixmap/MemPixmap.hh>
+#include <imagine/audio/Format.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/fs/FSDefs.hh>
+#include <imagine/util/string/CStringView.hh>
+#include <array>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+class EmuApp;
+
+// Screenshots and frame sequence captures are encoded on a worker thread. The emulation thread copies
+// each frame, along with the audio written since the previous one, into one of a fixed pool of slots
+// and continues. The worker writes PNG screenshots, or YUV4MPEG2 video and WAV audio files for sequences.
+// If every slot is still waiting on the worker, the emulation thread blocks until one frees up,
+// so captured data is never dropped. Frames emulated without video output repeat the previous
+// frame so the video keeps the frame rate in its header and stays in sync with the audio.
+
+class FrameCapture
+{
+public:
+	static constexpr int slots = 4;
+	static constexpr int maxFrameInterval = 4;
+
+	FrameCapture(EmuApp &app): app{app} {}
+	~FrameCapture();
+	void queueScreenshot(PixmapView, FS::PathString path);
+	void startSequence(CStringView videoPath, CStringView audioPath, int frameInterval, double frameRate, Audio::Format);
+	void stopSequence();
+	bool isCapturingSequence() const { return capturingSequence; }
+
+	// called from the emulation thread while a sequence is active
+	void captureFrame(PixmapView);
+	void skipFrames(int frames);
+	void captureAudio(const void *samples, size_t frames);
+
+private:
+	enum class JobType : uint8_t
+	{
+		Screenshot, SequenceData, EndSequence, Quit
+	};
+
+	struct Job
+	{
+		MemPixmap frame;
+		std::vector<uint8_t> audio;
+		FS::PathString path;
+		JobType type{};
+		int repeatFrames{};
+		bool hasFrame{};
+	};
+
+	EmuApp &app;
+	std::array<Job, slots> jobs;
+	std::thread workerThread;
+	std::counting_semaphore<slots> freeSlots{slots};
+	std::counting_semaphore<slots> queuedJobs{0};
+	int writeSlot{};
+	int readSlot{};
+	// emulation thread sequence state
+	std::vector<uint8_t> pendingAudio;
+	Audio::Format audioFormat;
+	int frameInterval{1};
+	int framesUntilCapture{};
+	int capturedFrames{};
+	bool capturingSequence{};
+	// worker thread sequence state
+	FileIO videoFile;
+	FileIO audioFile;
+	PixmapDesc videoDesc;
+	MemPixmap rgbFrame;
+	std::vector<uint8_t> yuvFrame;
+	size_t audioBytesWritten{};
+	double videoFrameRate{};
+	int writtenFrames{};
+	int leadingRepeatFrames{};
+
+	Job &acquireSlot(JobType);
+	void submitSlot();
+	void waitForIdle();
+	void startWorker();
+	void stopWorker();
+	void runJob(Job &);
+	void writeVideoFrame(PixmapView);
+	void repeatVideoFrame(int times);
+	void writeAudio(std::span<const uint8_t>);
+	void finishSequence();
+};
+
+}
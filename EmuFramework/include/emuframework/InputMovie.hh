@@ -0,0 +1,103 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/EmuSystem.hh>
+#include <emuframework/EmuBenchmark.hh>
+#include <imagine/util/memory/DynArray.hh>
+#include <imagine/util/string/CStringView.hh>
+#include <imagine/time/Time.hh>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+class EmuApp;
+
+// Input movies hold the system key actions applied before each emulated frame, along with the state
+// the recording started from, so a session can be replayed frame-accurately for testing & benchmarking.
+// While a movie is active, key actions from the main thread are queued and applied on the emulation
+// thread at the start of the next frame, so recording and playback see the same frame boundaries.
+// Pointer input isn't captured and loading a state ends the movie.
+//
+// File format, with all integers as LEB128 varints:
+// "EXMV", format version byte, system short name (size + bytes), start state (size + bytes),
+// then events of (frame delta << 1 | end flag), followed by the key code, key flags,
+// action, and meta state unless the end flag is set, which marks the last frame
+
+class InputMovie
+{
+public:
+	enum class Mode : uint8_t
+	{
+		Off, Recording, Playing
+	};
+
+	InputMovie(EmuApp &app): app{app} {}
+	Mode mode() const { return mode_.load(std::memory_order_acquire); }
+	bool isActive() const { return mode() != Mode::Off; }
+	void startRecording();
+	void saveRecording(CStringView uri);
+	void startPlayback(CStringView uri);
+	void stop();
+	uint32_t frames() const { return movieFrames; }
+	BenchmarkResult playbackStats() const;
+
+	// called from the main or emulation thread, returns true if the movie consumed the action
+	bool interceptInputAction(InputAction);
+
+	// called from the emulation thread before & after each emulated frame
+	void notifyFrameStart()
+	{
+		if(mode() != Mode::Off) [[unlikely]]
+			startFrame();
+	}
+
+	void notifyFrameEnd()
+	{
+		if(mode() == Mode::Playing && hasTime(frameStartTime)) [[unlikely]]
+			frameTimes.emplace_back(SteadyClock::now() - frameStartTime);
+	}
+
+private:
+	EmuApp &app;
+	DynArray<uint8_t> startState;
+	std::vector<uint8_t> events;
+	std::vector<InputAction> pendingActions;
+	std::vector<InputAction> frameActions;
+	std::vector<SteadyClockTime> frameTimes;
+	std::mutex pendingMutex;
+	size_t eventPos{};
+	uint32_t frame{};
+	uint32_t lastEventFrame{};
+	uint32_t nextEventFrame{};
+	uint32_t movieFrames{};
+	SteadyClockTimePoint frameStartTime{};
+	std::atomic<Mode> mode_{Mode::Off};
+	bool nextEventIsEnd{};
+
+	void startFrame();
+	void recordFrameActions();
+	void playFrameActions();
+	void readNextEventFrame();
+	void finishPlayback();
+};
+
+}
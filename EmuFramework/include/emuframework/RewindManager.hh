@@ -16,8 +16,11 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <emuframework/config.hh>
-#include <imagine/base/PausableTimer.hh>
-#include <imagine/util/memory/FlexArray.hh>
+#include <imagine/util/memory/DynArray.hh>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <semaphore>
 
 namespace IG
 {
@@ -31,24 +34,41 @@ namespace EmuEx
 using namespace IG;
 
 class EmuApp;
+class EmuSystem;
+
+// Rewind history is kept in a fixed size ring buffer sized by a memory budget.
+// Each entry is XOR'd against the last keyframe state and run-length packed,
+// so only the bytes that changed since that keyframe take up space.
+// States are captured every frameInterval emulated frames on the emulation thread
+// and packed into the history on a separate worker thread.
 
 class RewindManager
 {
 public:
-	RewindManager(EmuApp &);
+	static constexpr size_t keyframeInterval = 30;
+	static constexpr int defaultFrameInterval = 60;
+	static constexpr int maxRewindFrameInterval = 3600;
+
+	RewindManager() = default;
+	~RewindManager();
 	void clear();
 	bool reset();
 	void rewindState(EmuApp &);
-	void startTimer();
-	void pauseTimer();
-	void resetTimer();
 	bool readConfig(MapIO &, unsigned key);
 	void writeConfig(FileIO &) const;
 
-	void updateMaxStates(size_t max)
+	// called from the emulation thread after each emulated frame
+	void notifyFrameRun(EmuSystem &sys)
+	{
+		if(!history.size() || ++framesSinceSave < frameInterval)
+			return;
+		saveState(sys);
+	}
+
+	bool updateMaxMemoryMiB(size_t mib)
 	{
-		maxStates = max;
-		reset();
+		maxMemoryMiB = mib;
+		return reset();
 	}
 
 	bool reset(size_t stateSize_)
@@ -60,19 +80,41 @@ public:
 private:
 	struct StateEntry
 	{
+		size_t offset{};
 		size_t size{};
-		uint8_t data[];
+		size_t stateSize{};
+		bool isKeyframe{};
 	};
 
-	FlexArray<StateEntry> stateEntries;
-	size_t stateIdx{};
+	DynArray<uint8_t> history;
+	std::deque<StateEntry> entries;
+	DynArray<uint8_t> stateBuff;
+	DynArray<uint8_t> keyframeBuff;
+	DynArray<uint8_t> packBuff;
+	size_t writeOffset{};
+	size_t deltasSinceKeyframe{};
+	size_t capturedSize{};
+	int framesSinceSave{};
+	std::thread packThread;
+	std::binary_semaphore packSem{0};
+	std::atomic_bool packPending{};
+	bool quitPackThread{};
 public:
 	size_t stateSize{};
-	size_t maxStates{};
-	PausableTimer<Seconds> saveTimer;
+	size_t maxMemoryMiB{};
+	int frameInterval{defaultFrameInterval};
 
 private:
-	void saveState(EmuApp &);
+	void saveState(EmuSystem &);
+	void packState();
+	void waitForPackedState();
+	void startPackThread();
+	void stopPackThread();
+	bool addEntry(size_t packedSize, size_t stateSize, bool isKeyframe);
+	void evictOldestKeyframeGroup();
+	void unpackEntry(const StateEntry &, uint8_t *dest) const;
+	void restoreLastKeyframe();
+	void deallocate();
 };
 
 }
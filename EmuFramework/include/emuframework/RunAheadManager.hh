@@ -0,0 +1,75 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/config.hh>
+#include <imagine/util/memory/DynArray.hh>
+
+namespace IG
+{
+class MapIO;
+class FileIO;
+}
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+class EmuApp;
+class EmuSystem;
+class EmuVideo;
+class EmuSystemTaskContext;
+
+// Hides the game's own input lag by presenting a frame from the future.
+// After the real frames run with audio, the state is captured uncompressed into a
+// pre-allocated buffer, the next frames run with audio & video suppressed except for
+// the last one whose video is presented, then the captured state is restored.
+
+class RunAheadManager
+{
+public:
+	static constexpr int maxFrames = 4;
+
+	RunAheadManager() = default;
+	void clear();
+	bool reset();
+	bool readConfig(MapIO &, unsigned key);
+	void writeConfig(FileIO &) const;
+	bool isActive() const { return frames && stateBuff.size(); }
+	// called from the emulation thread after the real frames have run
+	void runAhead(EmuApp &, EmuSystemTaskContext, EmuVideo &);
+
+	bool updateFrames(int frames_)
+	{
+		frames = frames_;
+		return reset();
+	}
+
+	bool reset(size_t stateSize_)
+	{
+		stateSize = stateSize_;
+		return reset();
+	}
+
+private:
+	DynArray<uint8_t> stateBuff;
+public:
+	size_t stateSize{};
+	int frames{};
+};
+
+}
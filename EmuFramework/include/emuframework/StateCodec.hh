@@ -0,0 +1,113 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/enum.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <span>
+
+struct z_stream_s;
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace EmuEx
+{
+
+using namespace IG;
+
+WISE_ENUM_CLASS((StateCodecType, uint8_t),
+	Gzip,
+	Zstd);
+
+WISE_ENUM_CLASS((StateCompressionLevel, uint8_t),
+	Default,
+	Fast,
+	Best);
+
+struct StateCodecConfig
+{
+	StateCodecType type{StateCodecType::Gzip};
+	StateCompressionLevel level{StateCompressionLevel::Default};
+	uint8_t threads{}; // worker threads for codecs that support them, 0 or 1 compresses on the calling thread
+};
+
+// Compressed states are self-describing, the codec is detected from the magic bytes at the start of the data
+// so states written with any codec, including older gzip-only states, can be read regardless of the current setting
+std::optional<StateCodecType> detectStateCodec(std::span<const uint8_t>);
+bool stateCodecIsAvailable(StateCodecType);
+size_t compressStateBound(size_t size, StateCodecType);
+size_t compressState(std::span<uint8_t> dest, std::span<const uint8_t> src, StateCodecConfig);
+size_t uncompressedStateSize(std::span<const uint8_t>, StateCodecType);
+size_t uncompressState(std::span<uint8_t> dest, std::span<const uint8_t> src, StateCodecType);
+
+// Compresses a state incrementally into a fixed size buffer, so a core can stream its state
+// into the codec without first writing it to an uncompressed buffer
+class StateCompressor
+{
+public:
+	// receives the contents of dest each time it fills up and when finished, returns false on error
+	using OutputDelegate = DelegateFunc<bool(std::span<const uint8_t>)>;
+
+	// srcSize is the total uncompressed size, stored in the header by codecs that support it.
+	// Without an output delegate all compressed data must fit in dest,
+	// otherwise it's reused as a chunk buffer and can be any size.
+	StateCompressor(std::span<uint8_t> dest, size_t srcSize, StateCodecConfig, OutputDelegate = {});
+	StateCompressor(StateCompressor &&) = delete;
+	~StateCompressor();
+	bool write(std::span<const uint8_t>);
+	size_t finish(); // returns the total compressed size, or 0 on error
+	size_t uncompressedSize() const { return inSize; }
+
+private:
+	std::span<uint8_t> dest;
+	OutputDelegate onOutput;
+	size_t outSize{}; // zstd output pending in dest
+	size_t flushedSize{};
+	size_t inSize{};
+	z_stream_s *zStream{};
+	ZSTD_CCtx_s *zstdCtx{};
+	bool failed{};
+
+	size_t pendingOutputSize() const;
+	bool flushOutput();
+};
+
+// Uncompresses a state incrementally, reads past the end of the data or of corrupt data return short counts
+class StateUncompressor
+{
+public:
+	StateUncompressor(std::span<const uint8_t> src, StateCodecType);
+	StateUncompressor(StateUncompressor &&) = delete;
+	~StateUncompressor();
+	size_t read(std::span<uint8_t>);
+	bool restart();
+	size_t size() const { return uncompSize; } // from the header, 0 if unknown
+	bool hasError() const { return failed; }
+
+private:
+	std::span<const uint8_t> src;
+	size_t inPos{};
+	size_t uncompSize{};
+	z_stream_s *zStream{};
+	ZSTD_DCtx_s *zstdCtx{};
+	bool ended{};
+	bool failed{};
+};
+
+}
@@ -32,7 +32,7 @@ public:
 	void onShow() override;
 	void loadStandardItems();
 
-	static constexpr int STANDARD_ITEMS = 10;
+	static constexpr int STANDARD_ITEMS = 13;
 	static constexpr int MAX_SYSTEM_ITEMS = 6;
 
 protected:
@@ -42,8 +42,11 @@ protected:
 	TextMenuItem autosaveNow;
 	TextMenuItem revertAutosave;
 	TextMenuItem stateSlot;
+	TextMenuItem recordInputMovie;
+	TextMenuItem playInputMovie;
 	ConditionalMember<Config::envIsAndroid, TextMenuItem> addLauncherIcon;
 	TextMenuItem screenshot;
+	TextMenuItem frameCapture;
 	TextMenuItem resetSessionOptions;
 	TextMenuItem close;
 	StaticArrayList<MenuItem*, STANDARD_ITEMS + MAX_SYSTEM_ITEMS> item;
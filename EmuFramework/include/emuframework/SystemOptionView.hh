@@ -16,6 +16,8 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <emuframework/EmuAppHelper.hh>
+#include <emuframework/FrameCapture.hh>
+#include <emuframework/RunAheadManager.hh>
 #include <imagine/gui/TableView.hh>
 #include <imagine/gui/MenuItem.hh>
 #include <imagine/util/container/ArrayList.hh>
@@ -38,13 +40,21 @@ protected:
 	MultiChoiceMenuItem autosaveLaunch;
 	BoolMenuItem autosaveContent;
 	BoolMenuItem confirmOverwriteState;
+	TextMenuItem stateCodecItem[2];
+	MultiChoiceMenuItem stateCodec;
+	TextMenuItem stateCompressionLevelItem[3];
+	MultiChoiceMenuItem stateCompressionLevel;
 	TextMenuItem fastModeSpeedItem[6];
 	MultiChoiceMenuItem fastModeSpeed;
 	TextMenuItem slowModeSpeedItem[3];
 	MultiChoiceMenuItem slowModeSpeed;
-	TextMenuItem rewindStatesItem[4];
-	MultiChoiceMenuItem rewindStates;
-	DualTextMenuItem rewindTimeInterval;
+	TextMenuItem rewindMemoryItem[5];
+	MultiChoiceMenuItem rewindMemory;
+	DualTextMenuItem rewindFrameInterval;
+	TextMenuItem runAheadItem[RunAheadManager::maxFrames + 1];
+	MultiChoiceMenuItem runAhead;
+	TextMenuItem captureFrameIntervalItem[FrameCapture::maxFrameInterval];
+	MultiChoiceMenuItem captureFrameInterval;
 	ConditionalMember<Config::envIsAndroid, BoolMenuItem> performanceMode;
 	ConditionalMember<Config::envIsAndroid && Config::DEBUG_BUILD, BoolMenuItem> noopThread;
 	ConditionalMember<Config::cpuAffinity, TextMenuItem> cpuAffinity;
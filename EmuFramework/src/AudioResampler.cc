@@ -0,0 +1,231 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/AudioResampler.hh>
+#include <imagine/util/algorithm.h>
+#include <imagine/util/utility.h>
+#include <algorithm>
+#include <cstring>
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace EmuEx
+{
+
+// Catmull-Rom weights for the 4 input frames around fractional position t
+static void cubicWeights(float t, float &w0, float &w1, float &w2, float &w3)
+{
+	float t2 = t * t;
+	float t3 = t2 * t;
+	w0 = .5f * (2.f * t2 - t3 - t);
+	w1 = .5f * (3.f * t3 - 5.f * t2 + 2.f);
+	w2 = .5f * (4.f * t2 - 3.f * t3 + t);
+	w3 = .5f * (t3 - t2);
+}
+
+template<int channels>
+static size_t resampleScalar(float *__restrict__ out, const float *__restrict__ in, size_t lastIdx, double &pos, double step)
+{
+	size_t frames{};
+	for(size_t idx = pos; idx <= lastIdx; idx = pos)
+	{
+		float w0, w1, w2, w3;
+		cubicWeights(float(pos - idx), w0, w1, w2, w3);
+		auto p = &in[(idx - 1) * channels];
+		for(auto c : iotaCount(channels))
+		{
+			*out++ = w0 * p[c] + w1 * p[channels + c] + w2 * p[channels * 2 + c] + w3 * p[channels * 3 + c];
+		}
+		pos += step;
+		frames++;
+	}
+	return frames;
+}
+
+#if defined __SSE2__ || defined __ARM_NEON
+
+#if defined __SSE2__
+using float4 = __m128;
+static float4 load4(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+static float4 load2x2(const float *a, const float *b)
+{
+	return _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)a), (const __m64*)b);
+}
+static void store4(float *dest, float4 v) { _mm_storeu_ps(dest, v); }
+#else
+using float4 = float32x4_t;
+static float4 load4(float a, float b, float c, float d)
+{
+	alignas(16) const float v[]{a, b, c, d};
+	return vld1q_f32(v);
+}
+static float4 load2x2(const float *a, const float *b) { return vcombine_f32(vld1_f32(a), vld1_f32(b)); }
+static void store4(float *dest, float4 v) { vst1q_f32(dest, v); }
+#endif
+
+// 2 stereo frames per iteration
+static size_t resampleStereo(float *__restrict__ out, const float *__restrict__ in, size_t lastIdx, double &pos, double step)
+{
+	size_t frames{};
+	while(true)
+	{
+		const double pos1 = pos + step;
+		const size_t idx0 = pos, idx1 = pos1;
+		if(idx1 > lastIdx)
+			break;
+		float a[4], b[4];
+		cubicWeights(pos - idx0, a[0], a[1], a[2], a[3]);
+		cubicWeights(pos1 - idx1, b[0], b[1], b[2], b[3]);
+		auto p0 = &in[(idx0 - 1) * 2];
+		auto p1 = &in[(idx1 - 1) * 2];
+		float4 sum = load4(a[0], a[0], b[0], b[0]) * load2x2(p0, p1);
+		for(int k = 1; k < 4; k++)
+		{
+			sum += load4(a[k], a[k], b[k], b[k]) * load2x2(p0 + k * 2, p1 + k * 2);
+		}
+		store4(out, sum);
+		out += 4;
+		pos = pos1 + step;
+		frames += 2;
+	}
+	return frames + resampleScalar<2>(out, in, lastIdx, pos, step);
+}
+
+// 4 mono frames per iteration
+static size_t resampleMono(float *__restrict__ out, const float *__restrict__ in, size_t lastIdx, double &pos, double step)
+{
+	size_t frames{};
+	while(true)
+	{
+		const double p[]{pos, pos + step, pos + step * 2., pos + step * 3.};
+		const size_t idx[]{size_t(p[0]), size_t(p[1]), size_t(p[2]), size_t(p[3])};
+		if(idx[3] > lastIdx)
+			break;
+		float w[4][4];
+		for(int i = 0; i < 4; i++)
+		{
+			cubicWeights(p[i] - idx[i], w[0][i], w[1][i], w[2][i], w[3][i]);
+		}
+		float4 sum{};
+		for(int k = 0; k < 4; k++)
+		{
+			sum += load4(w[k][0], w[k][1], w[k][2], w[k][3]) *
+				load4(in[idx[0] + k - 1], in[idx[1] + k - 1], in[idx[2] + k - 1], in[idx[3] + k - 1]);
+		}
+		store4(out, sum);
+		out += 4;
+		pos = p[3] + step;
+		frames += 4;
+	}
+	return frames + resampleScalar<1>(out, in, lastIdx, pos, step);
+}
+
+#else
+
+static size_t resampleStereo(float *out, const float *in, size_t lastIdx, double &pos, double step)
+{
+	return resampleScalar<2>(out, in, lastIdx, pos, step);
+}
+
+static size_t resampleMono(float *out, const float *in, size_t lastIdx, double &pos, double step)
+{
+	return resampleScalar<1>(out, in, lastIdx, pos, step);
+}
+
+#endif
+
+static void toFloatSamples(float *__restrict__ dest, const void *__restrict__ src, size_t samples, Audio::SampleFormat format)
+{
+	if(format.isFloat())
+	{
+		std::memcpy(dest, src, samples * sizeof(float));
+	}
+	else
+	{
+		auto srcI16 = static_cast<const int16_t*>(src);
+		for(auto i : iotaCount(samples))
+		{
+			dest[i] = srcI16[i] * (1.f / 32768.f);
+		}
+	}
+}
+
+static void fromFloatSamples(int16_t *__restrict__ dest, const float *__restrict__ src, size_t samples)
+{
+	for(auto i : iotaCount(samples))
+	{
+		dest[i] = std::clamp(src[i] * 32768.f, -32768.f, 32767.f);
+	}
+}
+
+void AudioResampler::prepare(Audio::Format format)
+{
+	assumeExpr(format.channels == 1 || format.channels == 2);
+	assumeExpr(format.sample.isFloat() || format.sample.bytes() == 2);
+	if(format.channels != channels)
+	{
+		channels = format.channels;
+		reset();
+	}
+}
+
+size_t AudioResampler::resample(void *dest, const void *src, size_t srcFrames, double step, Audio::Format format)
+{
+	prepare(format);
+	const bool isFloat = format.sample.isFloat();
+	const size_t inFrames = historyFrames + srcFrames;
+	const size_t outSamples = isFloat ? 0 : maxOutputFrames(srcFrames, step) * channels;
+	if(work.size() < inFrames * channels + outSamples)
+		work.resetForOverwrite(inFrames * channels + outSamples);
+	auto in = work.data();
+	std::copy_n(history.data(), historyFrames * channels, in);
+	toFloatSamples(in + historyFrames * channels, src, srcFrames * channels, format.sample);
+	auto out = isFloat ? static_cast<float*>(dest) : in + inFrames * channels;
+	const size_t lastIdx = inFrames - 3;
+	auto frames = channels == 2 ? resampleStereo(out, in, lastIdx, pos, step) : resampleMono(out, in, lastIdx, pos, step);
+	pos -= srcFrames;
+	std::copy_n(in + srcFrames * channels, historyFrames * channels, history.data());
+	if(!isFloat)
+		fromFloatSamples(static_cast<int16_t*>(dest), out, frames * channels);
+	return frames;
+}
+
+void AudioResampler::skip(const void *src, size_t srcFrames, Audio::Format format)
+{
+	prepare(format);
+	if(srcFrames < historyFrames)
+	{
+		auto keptSamples = (historyFrames - srcFrames) * channels;
+		std::copy_n(history.data() + srcFrames * channels, keptSamples, history.data());
+		toFloatSamples(history.data() + keptSamples, src, srcFrames * channels, format.sample);
+	}
+	else
+	{
+		auto skippedBytes = format.framesToBytes(srcFrames - historyFrames);
+		toFloatSamples(history.data(), static_cast<const uint8_t*>(src) + skippedBytes, historyFrames * channels, format.sample);
+	}
+	pos = historyFrames;
+}
+
+void AudioResampler::reset()
+{
+	history = {};
+	pos = historyFrames;
+}
+
+}
@@ -27,6 +27,7 @@ namespace EmuEx
 
 constexpr SystemLogger log{"AutosaveMgr"};
 constexpr Minutes defaultSaveFreq{0};
+constexpr size_t compressedChunkSize = 256 * 1024;
 
 AutosaveManager::AutosaveManager(EmuApp &app_):
 	app{app_},
@@ -37,12 +38,22 @@ AutosaveManager::AutosaveManager(EmuApp &app_):
 		[this]()
 		{
 			log.debug("running autosave timer");
-			save();
+			if(autoSaveSlot != noAutosaveName)
+			{
+				system().flushBackupMemory(app);
+				if(!saveOnlyBackupMemory)
+					requestStateCapture();
+			}
 			saveTimer.update();
 			return true;
 		}
 	} {}
 
+AutosaveManager::~AutosaveManager()
+{
+	stopWriteThread();
+}
+
 bool AutosaveManager::save(AutosaveActionSource src)
 {
 	if(autoSaveSlot == noAutosaveName)
@@ -54,6 +65,14 @@ bool AutosaveManager::save(AutosaveActionSource src)
 	return saveState();
 }
 
+void AutosaveManager::resetSlot(std::string_view name)
+{
+	captureRequested.store(false, std::memory_order_relaxed);
+	waitForSave();
+	autoSaveSlot = name;
+	saveTimer.cancel();
+}
+
 bool AutosaveManager::load(AutosaveActionSource src, LoadAutosaveMode mode)
 {
 	if(autoSaveSlot == noAutosaveName)
@@ -63,16 +82,17 @@ bool AutosaveManager::load(AutosaveActionSource src, LoadAutosaveMode mode)
 		system().loadBackupMemory(app);
 		if(saveOnlyBackupMemory && src == AutosaveActionSource::Auto)
 			return true;
-		if(!stateIO)
-			stateIO = appContext().openFileUri(statePath(), OpenFlags::createFile());
-		if(stateIO.getExpected<uint8_t>(0)) // check if state contains data
+		waitForSave();
+		restoreReplacedFileUri(appContext(), statePath());
+		auto stateIO = appContext().openFileUri(statePath(), {.read = true, .test = true, .accessHint = IOAccessHint::All});
+		if(stateIO && stateIO.size()) // check if state contains data
 		{
 			if(mode == LoadAutosaveMode::NoState)
 			{
 				log.info("skipped loading autosave state");
 				return true;
 			}
-			return loadState();
+			return loadState(stateIO);
 		}
 		else
 		{
@@ -93,22 +113,156 @@ bool AutosaveManager::load(AutosaveActionSource src, LoadAutosaveMode mode)
 bool AutosaveManager::saveState()
 {
 	log.info("saving autosave state");
-	stateIO.truncate(0);
-	auto state = app.saveState();
-	if(stateIO.write(state.span(), 0).bytes != ssize_t(state.size()))
+	app.syncEmulationThread();
+	waitForSave();
+	captureRequested.store(false, std::memory_order_relaxed);
+	try
+	{
+		capturedPath = statePath();
+		capturedCodec = app.stateCodecConfig();
+		auto size = system().stateSize();
+		if(stateBuff.size() < size)
+			stateBuff.resetForOverwrite(size);
+		capturedSize = system().writeState({stateBuff.data(), size}, {.uncompressed = true});
+	}
+	catch(std::exception &err)
 	{
-		app.postErrorMessage(4, "Error writing autosave state");
+		app.postErrorMessage(4, std::format("Error saving autosave state:\n{}", err.what()));
 		return false;
 	}
+	if(!writeThread.joinable())
+		startWriteThread();
+	startWrite();
 	return true;
 }
 
-bool AutosaveManager::loadState()
+void AutosaveManager::requestStateCapture()
+{
+	if(writePending.load(std::memory_order_acquire) || captureRequested.load(std::memory_order_relaxed))
+		return;
+	if(!writeThread.joinable())
+		startWriteThread();
+	capturedPath = statePath();
+	capturedCodec = app.stateCodecConfig();
+	captureRequested.store(true, std::memory_order_release);
+}
+
+void AutosaveManager::captureState(EmuSystem &sys)
+{
+	if(writePending.load(std::memory_order_acquire))
+	{
+		// previous state is still being written, try again next frame
+		return;
+	}
+	log.debug("capturing autosave state");
+	auto size = sys.stateSize();
+	if(stateBuff.size() < size)
+		stateBuff.resetForOverwrite(size);
+	capturedSize = sys.writeState({stateBuff.data(), size}, {.uncompressed = true});
+	captureRequested.store(false, std::memory_order_relaxed);
+	startWrite();
+}
+
+void AutosaveManager::startWrite()
+{
+	writePending.store(true, std::memory_order_relaxed);
+	writeSem.release();
+}
+
+void AutosaveManager::writeStateFile()
+{
+	bool success = [&]
+	{
+		try
+		{
+			if(!compBuff.size())
+				compBuff.resetForOverwrite(compressedChunkSize);
+			// the previous autosave is kept until the new one is completely written
+			return replaceFileUri(appContext(), capturedPath, [&](FileIO &file)
+			{
+				StateCompressor comp{compBuff, capturedSize, capturedCodec,
+					[&](std::span<const uint8_t> data){ return file.write(data).bytes == ssize_t(data.size()); }};
+				comp.write(std::span{stateBuff.data(), capturedSize});
+				return comp.finish() != 0;
+			});
+		}
+		catch(std::exception &err)
+		{
+			log.error("error writing {}:{}", capturedPath, err.what());
+			return false;
+		}
+	}();
+	app.runOnMainThread([this, success](ApplicationContext)
+	{
+		onStateWritten(success);
+	});
+}
+
+void AutosaveManager::onStateWritten(bool success)
+{
+	if(!success)
+	{
+		if(system().hasContent() && !hasWriteAccessToDir(system().contentSaveDirectory()))
+			app.postErrorMessage(8, "Save folder inaccessible, please set it in Options➔File Paths➔Saves");
+		else
+			app.postErrorMessage(4, "Error writing autosave state");
+		return;
+	}
+	log.info("wrote autosave state");
+}
+
+void AutosaveManager::startWriteThread()
+{
+	quitWriteThread = false;
+	writeThread = std::thread
+	{
+		[this]()
+		{
+			log.info("starting write thread");
+			while(true)
+			{
+				writeSem.acquire();
+				if(quitWriteThread)
+					break;
+				writeStateFile();
+				writePending.store(false, std::memory_order_release);
+				writePending.notify_all();
+			}
+			log.info("exiting write thread");
+		}
+	};
+}
+
+void AutosaveManager::stopWriteThread()
+{
+	if(!writeThread.joinable())
+		return;
+	waitForSave();
+	quitWriteThread = true;
+	writeSem.release();
+	writeThread.join();
+}
+
+void AutosaveManager::waitForSave()
+{
+	writePending.wait(true, std::memory_order_acquire);
+}
+
+bool AutosaveManager::loadState(FileIO &stateIO)
 {
 	log.info("loading autosave state");
 	try
 	{
-		app.readState(stateIO.buffer(IOBufferMode::Direct));
+		auto buff = stateIO.buffer(IOBufferMode::Direct);
+		std::span<uint8_t> state = buff;
+		DynArray<uint8_t> uncompArr;
+		if(detectStateCodec(state))
+		{
+			// written by the autosave worker, systems without their own state compression won't expect it
+			uncompArr = system().uncompressState(state);
+			state = uncompArr;
+		}
+		app.readState(state);
 		return true;
 	}
 	catch(std::exception &err)
@@ -0,0 +1,112 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/CPUVideoFilter.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <utility>
+
+namespace EmuEx
+{
+
+constexpr SystemLogger log{"CPUVideoFilter"};
+
+int VideoFilterThreadPool::defaultThreads()
+{
+	return std::clamp(int(std::thread::hardware_concurrency()) - 1, 1, maxThreads);
+}
+
+void VideoFilterThreadPool::start(int threads)
+{
+	threads = std::clamp(threads, 1, maxThreads);
+	if(this->threads() == threads)
+		return;
+	stop();
+	log.info("starting {} filter threads", threads - 1);
+	quit = false;
+	workers.resize(threads - 1);
+	auto startGeneration = generation.load(std::memory_order_relaxed);
+	for(int i = 0; auto &w : workers)
+	{
+		int band = ++i;
+		w.thread = IG::makeThreadSync([this, &w, band, startGeneration](auto &sem)
+		{
+			w.id = IG::thisThreadId();
+			sem.release();
+			runWorker(band, startGeneration);
+		});
+	}
+}
+
+void VideoFilterThreadPool::stop()
+{
+	if(workers.empty())
+		return;
+	quit = true;
+	generation.fetch_add(1, std::memory_order_release);
+	generation.notify_all();
+	for(auto &w : workers)
+		w.thread.join();
+	workers.clear();
+}
+
+std::pair<int, int> VideoFilterThreadPool::bandRows(int band) const
+{
+	auto bands = threads();
+	return {height * band / bands, height * (band + 1) / bands};
+}
+
+void VideoFilterThreadPool::run(int height_, BandDelegate del)
+{
+	height = height_;
+	if(workers.empty())
+	{
+		del(0, height);
+		return;
+	}
+	bandDel = del;
+	pendingBands.store(int(workers.size()), std::memory_order_relaxed);
+	generation.fetch_add(1, std::memory_order_release);
+	generation.notify_all();
+	auto [startY, endY] = bandRows(0);
+	del(startY, endY);
+	while(auto pending = pendingBands.load(std::memory_order_acquire))
+	{
+		pendingBands.wait(pending, std::memory_order_acquire);
+	}
+}
+
+void VideoFilterThreadPool::runWorker(int band, uint32_t seenGeneration)
+{
+	while(true)
+	{
+		generation.wait(seenGeneration, std::memory_order_acquire);
+		seenGeneration = generation.load(std::memory_order_acquire);
+		if(quit)
+			return;
+		auto [startY, endY] = bandRows(band);
+		bandDel(startY, endY);
+		if(pendingBands.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			pendingBands.notify_one();
+	}
+}
+
+void VideoFilterThreadPool::addThreadIds(std::vector<ThreadId> &ids) const
+{
+	for(const auto &w : workers)
+		ids.emplace_back(w.id);
+}
+
+}
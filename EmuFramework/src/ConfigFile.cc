@@ -55,6 +55,9 @@ void EmuApp::saveConfigFile(FileIO &io)
 	writeOptionValueIfNotDefault(io, frameTimeSource);
 	writeOptionValueIfNotDefault(io, idleDisplayPowerSave);
 	writeOptionValueIfNotDefault(io, confirmOverwriteState);
+	writeOptionValueIfNotDefault(io, stateCodec);
+	writeOptionValueIfNotDefault(io, stateCompressionLevel);
+	writeOptionValueIfNotDefault(io, captureFrameInterval);
 	writeOptionValueIfNotDefault(io, systemActionsIsDefaultMenu);
 	writeOptionValueIfNotDefault(io, pauseUnfocused);
 	writeOptionValueIfNotDefault(io, emuOrientation);
@@ -91,6 +94,7 @@ void EmuApp::saveConfigFile(FileIO &io)
 	inputManager.vController.writeConfig(io);
 	autosaveManager.writeConfig(io);
 	rewindManager.writeConfig(io);
+	runAheadManager.writeConfig(io);
 	audio.writeConfig(io);
 	videoLayer.writeConfig(io);
 	if(overrideScreenFrameRate)
@@ -158,6 +162,8 @@ EmuApp::ConfigParams EmuApp::loadConfigFile(IG::ApplicationContext ctx)
 						return true;
 					if(rewindManager.readConfig(io, key))
 						return true;
+					if(runAheadManager.readConfig(io, key))
+						return true;
 					if(audio.readConfig(io, key))
 						return true;
 					if(recentContent.readConfig(io, key, system()))
@@ -193,6 +199,9 @@ EmuApp::ConfigParams EmuApp::loadConfigFile(IG::ApplicationContext ctx)
 				case CFGKEY_LAYOUT_BEHIND_SYSTEM_UI:
 					return ctx.hasTranslucentSysUI() ? readOptionValue(io, layoutBehindSystemUI) : false;
 				case CFGKEY_CONFIRM_OVERWRITE_STATE: return readOptionValue(io, confirmOverwriteState);
+				case CFGKEY_STATE_CODEC: return readOptionValue(io, stateCodec);
+				case CFGKEY_STATE_COMPRESSION_LEVEL: return readOptionValue(io, stateCompressionLevel);
+				case CFGKEY_CAPTURE_FRAME_INTERVAL: return readOptionValue(io, captureFrameInterval);
 				case CFGKEY_FAST_MODE_SPEED: return readOptionValue(io, fastModeSpeed);
 				case CFGKEY_SLOW_MODE_SPEED: return readOptionValue(io, slowModeSpeed);
 				case CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE: return readOptionValue(io, notifyOnInputDeviceChange);
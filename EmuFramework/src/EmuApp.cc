@@ -52,6 +52,7 @@
 #include <imagine/bluetooth/BluetoothInputDevice.hh>
 #include <imagine/input/android/MogaManager.hh>
 #include <cmath>
+#include <cstdio>
 
 namespace EmuEx
 {
@@ -100,16 +101,18 @@ EmuApp::EmuApp(ApplicationInitParams initParams, ApplicationContext &ctx):
 	pixmapWriter{ctx},
 	perfHintManager{ctx.performanceHintManager()},
 	layoutBehindSystemUI{ctx.hasTranslucentSysUI()},
-	bluetoothAdapter{ctx}
+	bluetoothAdapter{ctx},
+	headlessBenchmark{HeadlessBenchmarkParams::parse(initParams.commandArgs())}
 {
-	if(ctx.registerInstance(initParams))
+	if(!headlessBenchmark && ctx.registerInstance(initParams))
 	{
 		ctx.exit();
 		return;
 	}
 	if(needsGlobalInstance)
 		gAppPtr = this;
-	ctx.setAcceptIPC(true);
+	if(!headlessBenchmark)
+		ctx.setAcceptIPC(true);
 	onEvent = [this](ApplicationContext ctx, const ApplicationEvent& appEvent)
 	{
 		appEvent.visit(overloaded
@@ -209,6 +212,7 @@ static void suspendEmulation(EmuApp &app)
 	if(!app.system().hasContent())
 		return;
 	app.autosaveManager.save();
+	app.autosaveManager.waitForSave();
 	app.system().flushBackupMemory(app);
 }
 
@@ -216,9 +220,12 @@ void EmuApp::closeSystem()
 {
 	showUI();
 	emuSystemTask.stop();
+	stopInputMovie();
+	stopFrameCapture();
 	system().closeRuntimeSystem(*this);
 	autosaveManager.resetSlot();
 	rewindManager.clear();
+	runAheadManager.clear();
 	viewController().onSystemClosed();
 }
 
@@ -265,13 +272,14 @@ void EmuApp::showExitAlert(ViewAttachParams attach, const Input::Event &e)
 
 static const char *parseCommandArgs(IG::CommandArgs arg)
 {
-	if(arg.c < 2)
+	for(auto launchPath : std::span{arg.v, size_t(arg.c)}.subspan(std::min(arg.c, 1)))
 	{
-		return nullptr;
+		if(HeadlessBenchmarkParams::isOption(launchPath))
+			continue;
+		log.info("starting content from command line:{}", launchPath);
+		return launchPath;
 	}
-	auto launchPath = arg.v[1];
-	log.info("starting content from command line:{}", launchPath);
-	return launchPath;
+	return nullptr;
 }
 
 bool EmuApp::setWindowDrawableConfig(Gfx::DrawableConfig conf)
@@ -399,6 +407,19 @@ void EmuApp::mainInitCommon(IG::ApplicationInitParams initParams, IG::Applicatio
 	loadSystemOptions();
 	updateLegacySavePathOnStoragePath(ctx, system());
 	system().setInitialLoadPath(parseCommandArgs(initParams.commandArgs()));
+	if(headlessBenchmark)
+	{
+		// skip creating the window, GL context, and audio output stream
+		ctx.addOnResume(
+			[this](IG::ApplicationContext, bool)
+			{
+				auto launchPath = system().contentLocation();
+				system().setInitialLoadPath("");
+				runHeadlessBenchmark(launchPath);
+				return false;
+			});
+		return;
+	}
 	audio.manager.setMusicVolumeControlHint();
 	if(!renderer.supportsColorSpace())
 		windowDrawableConf.colorSpace = {};
@@ -428,6 +449,7 @@ void EmuApp::mainInitCommon(IG::ApplicationInitParams initParams, IG::Applicatio
 			audio.manager.endSession();
 			saveConfigFile(ctx);
 			saveSystemOptions();
+			saveDirectoryIndex();
 			if(!backgrounded || (backgrounded && !keepBluetoothActive))
 				closeBluetoothConnections();
 			onEvent(ctx, FreeCachesEvent{false});
@@ -809,12 +831,83 @@ void EmuApp::handleOpenFileCommand(CStringView path)
 void EmuApp::runBenchmarkOneShot(EmuVideo &video)
 {
 	log.info("starting benchmark");
-	auto time = system().benchmark(video);
+	auto result = system().benchmark(video);
 	autosaveManager.resetSlot(noAutosaveName);
 	closeSystem();
-	auto timeSecs = duration_cast<FloatSeconds>(time);
-	log.info("done in:{}", timeSecs);
-	postMessage(2, 0, std::format("{:.2f} fps", 180. / timeSecs.count()));
+	log.info("done in:{}", duration_cast<FloatSeconds>(result.totalTime));
+	postMessage(2, 0, std::format("{:.2f} fps", result.fps()));
+}
+
+void EmuApp::runHeadlessBenchmark(CStringView path)
+{
+	auto ctx = appContext();
+	if(path.empty())
+	{
+		std::fputs("No content path given for benchmark\n", stderr);
+		ctx.exit(1);
+		return;
+	}
+	auto fmt = renderPixelFormat.value();
+	if(!fmt || (!EmuSystem::canRenderRGBA8888 && fmt != IG::PixelFmtRGB565))
+		fmt = EmuSystem::canRenderRGBA8888 ? IG::PixelFmtRGBA8888 : IG::PixelFmtRGB565;
+	video.onFormatChanged = [](EmuVideo &){};
+	video.setHeadless(system(), fmt);
+	try
+	{
+		log.info("loading benchmark content:{}", path);
+		autosaveManager.resetSlot(noAutosaveName);
+		system().createWithMedia({}, path, ctx.fileUriDisplayName(path), {},
+			[](int, int, const char*){ return true; });
+	}
+	catch(std::exception &err)
+	{
+		std::fputs(std::format("Error loading content: {}\n", err.what()).c_str(), stderr);
+		ctx.exit(1);
+		return;
+	}
+	int frames = headlessBenchmark.frames;
+	InputMovie *moviePtr{};
+	if(headlessBenchmark.moviePath)
+	{
+		try
+		{
+			inputMovie.startPlayback(headlessBenchmark.moviePath);
+		}
+		catch(std::exception &err)
+		{
+			std::fputs(std::format("Error loading input movie: {}\n", err.what()).c_str(), stderr);
+			ctx.exit(1);
+			return;
+		}
+		moviePtr = &inputMovie;
+		if(!frames)
+			frames = inputMovie.frames();
+	}
+	log.info("starting headless benchmark with {} frames", frames);
+	auto result = system().benchmark(video, frames, moviePtr);
+	auto json = result.toJSON(system().shortSystemName(), system().contentDisplayName());
+	log.info("done in:{}", duration_cast<FloatSeconds>(result.totalTime));
+	if(headlessBenchmark.outputPath)
+	{
+		try
+		{
+			FileIO file{headlessBenchmark.outputPath, OpenFlags::newFile()};
+			file.write(json.data(), json.size());
+		}
+		catch(std::exception &err)
+		{
+			std::fputs(std::format("Error writing benchmark output: {}\n", err.what()).c_str(), stderr);
+			ctx.exit(1);
+			return;
+		}
+	}
+	else
+	{
+		std::fputs(json.c_str(), stdout);
+		std::fflush(stdout);
+	}
+	// exit directly so no content, session, or config files are written
+	ctx.exit(0);
 }
 
 void EmuApp::showEmulation()
@@ -921,10 +1014,16 @@ void EmuApp::reloadSystem(EmuSystemCreateParams params)
 void EmuApp::onSystemCreated()
 {
 	updateVideoContentRotation();
-	if(!rewindManager.reset(system().stateSize()))
+	// a zero state size keeps both managers unallocated until the next system is created
+	auto sessionStateSize = system().allowsInSessionStates() ? system().stateSize() : 0;
+	if(!rewindManager.reset(sessionStateSize))
 	{
 		postErrorMessage(4, "Not enough memory for rewind states");
 	}
+	if(!runAheadManager.reset(sessionStateSize))
+	{
+		postErrorMessage(4, "Not enough memory for run-ahead state");
+	}
 	viewController().onSystemCreated();
 }
 
@@ -1039,6 +1138,7 @@ void EmuApp::setupStaticBackupMemoryFile(FileIO &io, std::string_view ext, size_
 void EmuApp::readState(std::span<uint8_t> buff)
 {
 	syncEmulationThread();
+	stopInputMovie();
 	system().readState(*this, buff);
 	system().clearInputBuffers(viewController().inputView);
 	autosaveManager.resetTimer();
@@ -1050,13 +1150,33 @@ size_t EmuApp::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 	return system().writeState(buff, flags);
 }
 
-DynArray<uint8_t> EmuApp::saveState()
+bool EmuApp::saveState(CStringView path)
 {
+	if(!system().hasContent())
+	{
+		postErrorMessage("System not running");
+		return false;
+	}
 	syncEmulationThread();
-	return system().saveState();
+	log.info("saving state {}", path);
+	try
+	{
+		system().saveState(path, stateCodecConfig());
+		return true;
+	}
+	catch(std::exception &err)
+	{
+		postErrorMessage(4, std::format("Can't save state:\n{}", err.what()));
+		return false;
+	}
 }
 
-bool EmuApp::saveState(CStringView path)
+StateCodecConfig EmuApp::stateCodecConfig() const
+{
+	return {.type = stateCodecIsAvailable(stateCodec) ? stateCodec.value() : StateCodecType::Gzip, .level = stateCompressionLevel, .threads = uint8_t(std::min(appContext().cpuCount(), 4))};
+}
+
+bool EmuApp::startInputMovieRecording()
 {
 	if(!system().hasContent())
 	{
@@ -1064,19 +1184,113 @@ bool EmuApp::saveState(CStringView path)
 		return false;
 	}
 	syncEmulationThread();
-	log.info("saving state {}", path);
+	stopInputMovie();
 	try
 	{
-		system().saveState(path);
+		inputMovie.startRecording();
+		system().clearInputBuffers(viewController().inputView);
 		return true;
 	}
 	catch(std::exception &err)
 	{
-		postErrorMessage(4, std::format("Can't save state:\n{}", err.what()));
+		postErrorMessage(4, std::format("Can't start recording:\n{}", err.what()));
 		return false;
 	}
 }
 
+bool EmuApp::playInputMovie(CStringView path)
+{
+	if(!system().hasContent())
+	{
+		postErrorMessage("System not running");
+		return false;
+	}
+	syncEmulationThread();
+	stopInputMovie();
+	log.info("playing input movie {}", path);
+	try
+	{
+		inputMovie.startPlayback(path);
+		system().clearInputBuffers(viewController().inputView);
+		autosaveManager.resetTimer();
+		return true;
+	}
+	catch(std::exception &err)
+	{
+		postErrorMessage(4, std::format("Can't play input movie:\n{}", err.what()));
+		return false;
+	}
+}
+
+void EmuApp::stopInputMovie()
+{
+	switch(inputMovie.mode())
+	{
+		case InputMovie::Mode::Off: return;
+		case InputMovie::Mode::Recording:
+		{
+			syncEmulationThread();
+			try
+			{
+				inputMovie.saveRecording(inputMoviePath());
+				postMessage(std::format("Saved {} frame input movie", inputMovie.frames()));
+			}
+			catch(std::exception &err)
+			{
+				postErrorMessage(4, std::format("Can't save input movie:\n{}", err.what()));
+			}
+			return;
+		}
+		case InputMovie::Mode::Playing:
+			syncEmulationThread();
+			inputMovie.stop();
+			postMessage("Stopped input movie");
+			return;
+	}
+}
+
+bool EmuApp::startFrameCapture()
+{
+	if(!system().hasContent())
+	{
+		postErrorMessage("System not running");
+		return false;
+	}
+	syncEmulationThread();
+	stopFrameCapture();
+	auto videoPath = makeNextScreenshotFilename(".y4m");
+	FS::PathString audioPath;
+	if(audio)
+	{
+		audioPath = videoPath;
+		audioPath.replace(audioPath.size() - 4, 4, ".wav");
+	}
+	log.info("starting frame capture to {}", videoPath);
+	try
+	{
+		frameCapture.startSequence(videoPath, audioPath, captureFrameInterval, system().frameRate(), audio.format());
+	}
+	catch(std::exception &err)
+	{
+		postErrorMessage(4, std::format("Can't start frame capture:\n{}", err.what()));
+		return false;
+	}
+	video.setSequenceCapture(&frameCapture);
+	if(audio)
+		audio.setSequenceCapture(&frameCapture);
+	return true;
+}
+
+void EmuApp::stopFrameCapture()
+{
+	if(!frameCapture.isCapturingSequence())
+		return;
+	syncEmulationThread();
+	video.setSequenceCapture({});
+	audio.setSequenceCapture({});
+	frameCapture.stopSequence();
+}
+
 bool EmuApp::saveStateWithSlot(int slot)
 {
 	return saveState(system().statePath(slot));
@@ -1091,6 +1305,7 @@ bool EmuApp::loadState(CStringView path)
 	}
 	log.info("loading state {}", path);
 	syncEmulationThread();
+	stopInputMovie();
 	try
 	{
 		system().loadState(*this, path);
@@ -1118,6 +1333,28 @@ FS::PathString EmuApp::inContentSearchPath(std::string_view name) const
 	return FS::uriString(contentSearchPath, name);
 }
 
+static FS::PathString directoryIndexPath(ApplicationContext ctx)
+{
+	return FS::pathString(ctx.cachePath(), "directoryIndex.bin");
+}
+
+FS::DirectoryIndex &EmuApp::directoryIndex()
+{
+	if(!directoryIndexLoaded)
+	{
+		directoryIndex_.load(directoryIndexPath(appContext()));
+		directoryIndexLoaded = true;
+	}
+	return directoryIndex_;
+}
+
+void EmuApp::saveDirectoryIndex()
+{
+	if(!directoryIndex_.isModified())
+		return;
+	directoryIndex_.save(directoryIndexPath(appContext()));
+}
+
 FS::PathString EmuApp::validSearchPath(const FS::PathString &path) const
 {
 	auto ctx = appContext();
@@ -1308,8 +1545,23 @@ FrameTimeConfig EmuApp::configFrameTime()
 
 void EmuApp::runFrames(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio *audio, int frames)
 {
+	if(frameCapture.isCapturingSequence()) [[unlikely]]
+		frameCapture.skipFrames(video ? frames - 1 : frames);
+	if(video && runAheadManager.isActive())
+	{
+		// all real frames run without video, the presented frame comes from the run-ahead frames
+		skipFrames(taskCtx, frames, audio);
+		runAheadManager.runAhead(*this, taskCtx, *video);
+		autosaveManager.notifyFrameRun(system());
+		system().updateBackupMemoryCounter();
+		return;
+	}
 	skipFrames(taskCtx, frames - 1, audio);
+	inputMovie.notifyFrameStart();
 	system().runFrame(taskCtx, video, audio);
+	inputMovie.notifyFrameEnd();
+	rewindManager.notifyFrameRun(system());
+	autosaveManager.notifyFrameRun(system());
 	system().updateBackupMemoryCounter();
 }
 
@@ -1318,7 +1570,10 @@ void EmuApp::skipFrames(EmuSystemTaskContext taskCtx, int frames, EmuAudio *audi
 	assert(system().hasContent());
 	for(auto i : iotaCount(frames))
 	{
+		inputMovie.notifyFrameStart();
 		system().runFrame(taskCtx, nullptr, audio);
+		inputMovie.notifyFrameEnd();
+		rewindManager.notifyFrameRun(system());
 	}
 }
 
@@ -1346,14 +1601,14 @@ bool EmuApp::writeScreenshot(IG::PixmapView pix, CStringView path)
 	return pixmapWriter.writeToFile(pix, path);
 }
 
-FS::PathString EmuApp::makeNextScreenshotFilename()
+FS::PathString EmuApp::makeNextScreenshotFilename(std::string_view ext)
 {
 	static constexpr std::string_view subDirName = "screenshots";
 	auto &sys = system();
 	auto userPath = sys.userPath(userScreenshotPath);
 	sys.createContentLocalDirectory(userPath, subDirName);
 	return sys.contentLocalDirectory(userPath, subDirName,
-		appContext().formatDateAndTimeAsFilename(WallClock::now()).append(".png"));
+		appContext().formatDateAndTimeAsFilename(WallClock::now()).append(ext));
 }
 
 void EmuApp::setMogaManagerActive(bool on, bool notify)
@@ -1602,6 +1857,7 @@ void EmuApp::applyCPUAffinity(bool active)
 		return;
 	auto frameThreadGroup = std::vector{emuSystemTask.threadId(), renderer.task().threadId()};
 	system().addThreadGroupIds(frameThreadGroup);
+	video.addThreadGroupIds(frameThreadGroup);
 	for(auto [idx, id] : enumerate(frameThreadGroup))
 	{
 		if(!id)
@@ -16,6 +16,7 @@
 #include <emuframework/EmuOptions.hh>
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuSystem.hh>
+#include <emuframework/FrameCapture.hh>
 #include <emuframework/Option.hh>
 #include <imagine/audio/Manager.hh>
 #include <imagine/util/algorithm.h>
@@ -97,45 +98,8 @@ bool EmuAudio::shouldStartAudioWrites(size_t bytesToWrite) const
 	return rBuff.size() + bytesToWrite >= targetBufferFillBytes;
 }
 
-template<typename T>
-static void simpleResample(T * __restrict__ dest, size_t destFrames, const T * __restrict__ src, size_t srcFrames)
-{
-	if(!destFrames)
-		return;
-	float ratio = (float)srcFrames/(float)destFrames;
-	for(auto i : iotaCount(destFrames))
-	{
-		size_t srcPos = std::floor((float)i * ratio);
-		if(srcPos >= srcFrames) [[unlikely]]
-		{
-			log.info("resample pos {} too high", srcPos);
-			srcPos = srcFrames-1;
-		}
-		dest[i] = src[srcPos];
-	}
-}
-
-static void simpleResample(void *dest, size_t destFrames, const void *src, size_t srcFrames, IG::Audio::Format format)
-{
-	if(format.channels == 1)
-	{
-		if(format.sample.isFloat())
-			simpleResample((uint32_t*)dest, destFrames, (uint32_t*)src, srcFrames);
-		else
-			simpleResample((uint16_t*)dest, destFrames, (uint16_t*)src, srcFrames);
-	}
-	else
-	{
-		if(format.channels != 2)
-		{
-			bug_unreachable("channels == %d", format.channels);
-		}
-		if(format.sample.isFloat())
-			simpleResample((uint64_t*)dest, destFrames, (uint64_t*)src, srcFrames);
-		else
-			simpleResample((uint32_t*)dest, destFrames, (uint32_t*)src, srcFrames);
-	}
-}
+// maximum amount the resampling ratio is adjusted to keep the buffer at its target fill level
+constexpr double maxRateControlDelta = .005;
 
 void EmuAudio::resizeAudioBuffer(size_t targetBufferFillBytes)
 {
@@ -247,6 +211,7 @@ void EmuAudio::stop()
 	if(audioStream)
 		audioStream.close();
 	rBuff.clear();
+	resampler.reset();
 }
 
 void EmuAudio::close()
@@ -265,6 +230,7 @@ void EmuAudio::flush()
 	if(audioStream)
 		audioStream.flush();
 	rBuff.clear();
+	resampler.reset();
 }
 
 void EmuAudio::writeFrames(const void *samples, size_t framesToWrite)
@@ -272,6 +238,8 @@ void EmuAudio::writeFrames(const void *samples, size_t framesToWrite)
 	if(!framesToWrite) [[unlikely]]
 		return;
 	assumeExpr(rBuff.capacity());
+	if(sequenceCapture) [[unlikely]]
+		sequenceCapture->captureAudio(samples, framesToWrite);
 	auto inputFormat = format();
 	switch(audioWriteState)
 	{
@@ -290,36 +258,36 @@ void EmuAudio::writeFrames(const void *samples, size_t framesToWrite)
 		default:
 		break;
 	}
-	const size_t sampleFrames = framesToWrite;
-	if(speedMultiplier != 1.) [[unlikely]]
-	{
-		framesToWrite = std::ceil((double)framesToWrite / speedMultiplier);
-		framesToWrite = std::max(framesToWrite, 1zu);
-	}
-	auto bytes = inputFormat.framesToBytes(framesToWrite);
+	double step = speedMultiplier;
+	if(dynamicRateControl && audioWriteState == AudioWriteState::ACTIVE)
+		step *= rateControlRatio();
+	size_t bytes{};
 	{
-		auto span = rBuff.beginWrite(bytes);
-		if(bytes <= span.size())
+		auto span = rBuff.beginWrite(inputFormat.framesToBytes(AudioResampler::maxOutputFrames(framesToWrite, step)));
+		auto freeFrames = inputFormat.bytesToFrames(span.size());
+		if(step == 1. && framesToWrite <= freeFrames)
 		{
-			if(sampleFrames != framesToWrite)
-			{
-				simpleResample(span.data(), framesToWrite, samples, sampleFrames, inputFormat);
-			}
-			else
-			{
-				copy_n(static_cast<const uint8_t*>(samples), bytes, span.data());
-			}
+			bytes = inputFormat.framesToBytes(framesToWrite);
+			copy_n(static_cast<const uint8_t*>(samples), bytes, span.data());
+			resampler.skip(samples, framesToWrite, inputFormat);
 		}
-		else // not enough space for write
+		else
 		{
-			log.info("overrun, only {} out of {} bytes free", span.size(), bytes);
-			#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-			audioStats.overruns++;
-			#endif
-			auto freeFrames = inputFormat.bytesToFrames(span.size());
-			simpleResample(span.data(), freeFrames, samples, sampleFrames, inputFormat);
+			if(AudioResampler::maxOutputFrames(framesToWrite, step) > freeFrames) [[unlikely]] // not enough space for write
+			{
+				log.info("overrun, only {} out of {} bytes free", span.size(),
+					inputFormat.framesToBytes(AudioResampler::maxOutputFrames(framesToWrite, step)));
+				#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
+				audioStats.overruns++;
+				#endif
+				if(freeFrames < 2)
+					return;
+				// squeeze the frames into the remaining space
+				step = std::max(step, double(framesToWrite) / (freeFrames - 1));
+			}
+			bytes = inputFormat.framesToBytes(resampler.resample(span.data(), samples, framesToWrite, step, inputFormat));
 		}
-		rBuff.endWrite(span);
+		rBuff.endWrite({span.first(bytes), span.idxs});
 	}
 	if(audioWriteState == AudioWriteState::BUFFER && shouldStartAudioWrites(bytes))
 	{
@@ -334,6 +302,13 @@ void EmuAudio::writeFrames(const void *samples, size_t framesToWrite)
 	}
 }
 
+double EmuAudio::rateControlRatio() const
+{
+	// consume input faster when the buffer is above its target fill level, slower when below
+	auto fillDelta = (double(rBuff.size()) - targetBufferFillBytes) / targetBufferFillBytes;
+	return 1. + maxRateControlDelta * std::clamp(fillDelta, -1., 1.);
+}
+
 void EmuAudio::setRate(int newRate)
 {
 	assert(newRate <= defaultRate);
@@ -456,6 +431,7 @@ void EmuAudio::writeConfig(FileIO &io) const
 	writeOptionValueIfNotDefault(io, CFGKEY_SOUND_VOLUME, maxVolume(), 100);
 	writeOptionValueIfNotDefault(io, CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN, addSoundBuffersOnUnderrunSetting, false);
 	writeOptionValueIfNotDefault(io, CFGKEY_AUDIO_API, audioAPI, Audio::Api::DEFAULT);
+	writeOptionValueIfNotDefault(io, CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL, dynamicRateControl, true);
 }
 
 bool EmuAudio::readConfig(MapIO &io, unsigned key)
@@ -468,6 +444,7 @@ bool EmuAudio::readConfig(MapIO &io, unsigned key)
 		case CFGKEY_SOUND_VOLUME: return readOptionValue<int8_t>(io, [&](auto v){ setMaxVolume(v); }, isValidVolumeSetting);
 		case CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN: return readOptionValue(io, addSoundBuffersOnUnderrunSetting);
 		case CFGKEY_AUDIO_API: return readOptionValue(io, audioAPI);
+		case CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL: return readOptionValue(io, dynamicRateControl);
 	}
 	return false;
 }
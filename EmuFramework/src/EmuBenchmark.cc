@@ -0,0 +1,138 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/EmuBenchmark.hh>
+#include <imagine/config/defs.hh>
+#include <imagine/util/format.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <charconv>
+#include <sys/resource.h>
+
+namespace EmuEx
+{
+
+constexpr SystemLogger log{"Benchmark"};
+
+HeadlessBenchmarkParams HeadlessBenchmarkParams::parse(CommandArgs args)
+{
+	HeadlessBenchmarkParams params;
+	bool useDefaultFrames{};
+	for(int i = 1; i < args.c; i++)
+	{
+		std::string_view arg{args.v[i]};
+		if(arg == "--benchmark")
+		{
+			useDefaultFrames = true;
+		}
+		else if(arg.starts_with("--benchmark="))
+		{
+			auto numStr = arg.substr(arg.find('=') + 1);
+			int frames{};
+			if(std::from_chars(numStr.data(), numStr.data() + numStr.size(), frames).ec != std::errc{} || frames <= 0)
+			{
+				log.warn("invalid benchmark frame count:{}, using default", numStr);
+				frames = defaultFrames;
+			}
+			params.frames = frames;
+		}
+		else if(arg.starts_with("--benchmark-output="))
+		{
+			params.outputPath = args.v[i] + arg.find('=') + 1;
+		}
+		else if(arg.starts_with("--benchmark-movie="))
+		{
+			params.moviePath = args.v[i] + arg.find('=') + 1;
+		}
+	}
+	if(useDefaultFrames && !params.frames && !params.moviePath)
+		params.frames = defaultFrames;
+	return params;
+}
+
+double BenchmarkResult::fps() const
+{
+	auto secs = std::chrono::duration_cast<FloatSeconds>(totalTime).count();
+	return secs > 0. ? frames() / secs : 0.;
+}
+
+SteadyClockTime BenchmarkResult::frameTimePercentile(double percent) const
+{
+	if(frameTimes.empty())
+		return {};
+	auto sorted = frameTimes;
+	auto idx = std::min(size_t(percent / 100. * sorted.size()), sorted.size() - 1);
+	std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+	return sorted[idx];
+}
+
+SteadyClockTime BenchmarkResult::maxFrameTime() const
+{
+	if(frameTimes.empty())
+		return {};
+	return std::ranges::max(frameTimes);
+}
+
+static double toMs(SteadyClockTime t)
+{
+	return std::chrono::duration<double, std::milli>(t).count();
+}
+
+static std::string jsonEscaped(std::string_view str)
+{
+	std::string out;
+	out.reserve(str.size());
+	for(char c : str)
+	{
+		switch(c)
+		{
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if((unsigned char)c < 0x20)
+					out += std::format("\\u{:04x}", c);
+				else
+					out += c;
+		}
+	}
+	return out;
+}
+
+std::string BenchmarkResult::toJSON(std::string_view systemName, std::string_view contentName) const
+{
+	return std::format(
+		"{{\"system\":\"{}\",\"content\":\"{}\",\"frames\":{},\"fps\":{:.3f},"
+		"\"frameTimeMs\":{{\"avg\":{:.4f},\"p50\":{:.4f},\"p99\":{:.4f},\"max\":{:.4f}}},"
+		"\"totalMs\":{:.3f},\"emulationMs\":{:.3f},\"videoMs\":{:.3f},\"peakRSSBytes\":{}}}\n",
+		jsonEscaped(systemName), jsonEscaped(contentName), frames(), fps(),
+		frames() ? toMs(totalTime) / frames() : 0., toMs(frameTimePercentile(50)),
+		toMs(frameTimePercentile(99)), toMs(maxFrameTime()),
+		toMs(totalTime), toMs(emulationTime()), toMs(videoTime), peakRSSBytes);
+}
+
+size_t BenchmarkResult::currentPeakRSS()
+{
+	rusage usage{};
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+	if constexpr(Config::envIsMacOSX || Config::envIsIOS)
+		return usage.ru_maxrss; // already in bytes
+	else
+		return size_t(usage.ru_maxrss) * 1024;
+}
+
+}
@@ -191,10 +191,10 @@ bool InputManager::handleAppActionKeyInput(EmuApp& app, InputAction action, cons
 		{
 			if(!isPushed)
 				break;
-			if(app.rewindManager.maxStates)
+			if(app.rewindManager.maxMemoryMiB)
 				app.rewindManager.rewindState(app);
 			else
-				app.postMessage(3, false, "Please set rewind states in Options➔System");
+				app.postMessage(3, false, "Please set rewind memory in Options➔System");
 			break;
 		}
 		case softReset:
@@ -241,7 +241,9 @@ void InputManager::handleSystemKeyInput(EmuApp& app, KeyInfo keyInfo, Input::Act
 		app.defaultVController().updateSystemKeys(keyInfo, act == Input::Action::PUSHED);
 		for(auto code : keyInfo.codes)
 		{
-			app.system().handleInputAction(&app, {code, keyInfo.flags, act, metaState});
+			InputAction action{code, keyInfo.flags, act, metaState};
+			if(!app.inputMovie.interceptInputAction(action))
+				app.system().handleInputAction(&app, action);
 		}
 	}
 }
@@ -19,16 +19,17 @@
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuVideo.hh>
 #include <emuframework/EmuViewController.hh>
+#include <emuframework/StateCodec.hh>
 #include <imagine/base/ApplicationContext.hh>
 #include <imagine/fs/ArchiveFS.hh>
 #include <imagine/fs/FSUtils.hh>
 #include <imagine/io/IO.hh>
+#include <imagine/io/FileIO.hh>
 #include <imagine/input/DragTracker.hh>
 #include <imagine/util/utility.h>
 #include <imagine/util/math.hh>
 #include <imagine/util/ScopeGuard.hh>
 #include <imagine/util/string.h>
-#include <imagine/util/zlib.hh>
 #include <imagine/util/format.hh>
 #include <imagine/logger/logger.h>
 #include <algorithm>
@@ -39,6 +40,7 @@ namespace EmuEx
 {
 
 constexpr SystemLogger log{"EmuSystem"};
+constexpr size_t stateOutputChunkSize = 256 * 1024;
 
 [[gnu::weak]] bool EmuSystem::inputHasKeyboard = false;
 [[gnu::weak]] bool EmuSystem::hasBundledGames = false;
@@ -54,6 +56,7 @@ constexpr SystemLogger log{"EmuSystem"};
 [[gnu::weak]] F2Size EmuSystem::validFrameRateRange{minFrameRate, 80.};
 [[gnu::weak]] bool EmuSystem::hasRectangularPixels = false;
 [[gnu::weak]] bool EmuSystem::stateSizeChangesAtRuntime = false;
+[[gnu::weak]] bool EmuSystem::canRunAhead = true;
 
 bool EmuSystem::stateExists(int slot) const
 {
@@ -74,31 +77,66 @@ bool EmuApp::shouldOverwriteExistingState() const
 
 void EmuSystem::loadState(EmuApp &app, CStringView uri)
 {
+	restoreReplacedFileUri(appContext(), uri);
 	auto file = appContext().openFileUri(uri, {.accessHint = IOAccessHint::All});
-	readState(app, file.buffer(IOBufferMode::Release));
+	auto buff = file.buffer(IOBufferMode::Release);
+	if(detectStateCodec(buff))
+	{
+		readState(app, uncompressState(buff));
+		return;
+	}
+	readState(app, buff);
+}
+
+static std::span<uint8_t> reserveBuffer(DynArray<uint8_t> &arr, size_t size)
+{
+	if(arr.size() < size)
+		arr.resetForOverwrite(size);
+	return {arr.data(), size};
+}
+
+void EmuSystem::saveState(CStringView uri, StateCodecConfig codec)
+{
+	// the existing state is kept until the new one is completely written
+	bool success = replaceFileUri(appContext(), uri, [&](FileIO &file)
+	{
+		return writeCompressedState(reserveBuffer(stateSaveBuff, stateOutputChunkSize), codec,
+			[&](std::span<const uint8_t> data){ return file.write(data).bytes == ssize_t(data.size()); }) != 0;
+	});
+	if(!success)
+		throw std::runtime_error("Error writing state");
 }
 
-void EmuSystem::saveState(CStringView uri)
+size_t EmuSystem::writeCompressedStateDefaultImpl(std::span<uint8_t> outBuff, StateCodecConfig codec,
+	StateCompressor::OutputDelegate onOutput)
 {
-	auto file = appContext().openFileUri(uri, OpenFlags::newFile());
-	file.write(saveState().span());
+	auto stateBuff = stateScratchBuffer(stateSize());
+	auto uncompSize = writeState(stateBuff, {.uncompressed = true});
+	StateCompressor comp{outBuff, uncompSize, codec, onOutput};
+	comp.write(stateBuff.first(uncompSize));
+	return comp.finish();
 }
 
-DynArray<uint8_t> EmuSystem::saveState()
+std::span<uint8_t> EmuSystem::stateScratchBuffer(size_t size)
 {
-	auto stateArr = dynArrayForOverwrite<uint8_t>(stateSize());
-	stateArr.trim(writeState(stateArr));
-	return stateArr;
+	return reserveBuffer(stateScratch, size);
 }
 
-DynArray<uint8_t> EmuSystem::uncompressGzipState(std::span<uint8_t> buff, size_t expectedSize)
+void EmuSystem::freeStateBuffers()
 {
-	assert(hasGzipHeader(buff));
-	auto uncompSize = gzipUncompressedSize(buff);
+	stateScratch = {};
+	stateSaveBuff = {};
+}
+
+static auto uncompressStateWith(std::span<uint8_t> buff, size_t expectedSize, auto &&allocUncompressed)
+{
+	auto codec = detectStateCodec(buff);
+	assert(codec);
+	auto uncompSize = uncompressedStateSize(buff, *codec);
 	if(expectedSize && expectedSize != uncompSize)
 		throw std::runtime_error("Invalid state size from header");
-	auto uncompArr = dynArrayForOverwrite<uint8_t>(uncompSize);
-	auto size = uncompressGzip(uncompArr, buff);
+	auto uncompArr = allocUncompressed(uncompSize);
+	auto size = EmuEx::uncompressState(uncompArr, buff, *codec);
 	if(!size)
 		throw std::runtime_error("Error uncompressing state");
 	if(expectedSize && size != expectedSize)
@@ -106,6 +144,16 @@ DynArray<uint8_t> EmuSystem::uncompressGzipState(std::span<uint8_t> buff, size_t
 	return uncompArr;
 }
 
+DynArray<uint8_t> EmuSystem::uncompressState(std::span<uint8_t> buff, size_t expectedSize)
+{
+	return uncompressStateWith(buff, expectedSize, [](size_t size){ return dynArrayForOverwrite<uint8_t>(size); });
+}
+
+std::span<uint8_t> EmuSystem::uncompressStateToScratchBuffer(std::span<uint8_t> buff, size_t expectedSize)
+{
+	return uncompressStateWith(buff, expectedSize, [&](size_t size){ return stateScratchBuffer(size); });
+}
+
 void EmuSystem::setupContentUriPaths(CStringView uri, std::string_view displayName)
 {
 	contentFileName_ = displayName;
@@ -273,8 +321,10 @@ void EmuSystem::closeRuntimeSystem(EmuApp &app)
 		log.info("closing game:{}", contentName_);
 		flushBackupMemory(app);
 		closeSystem();
+		freeStateBuffers();
 		app.autosaveManager.cancelTimer();
 		app.rewindManager.clear();
+		app.runAheadManager.clear();
 		state = State::OFF;
 	}
 	clearGamePaths();
@@ -296,7 +346,6 @@ void EmuSystem::pause(EmuApp &app)
 		state = State::PAUSED;
 	app.audio.stop();
 	app.autosaveManager.pauseTimer();
-	app.rewindManager.pauseTimer();
 	onStop();
 }
 
@@ -310,23 +359,37 @@ void EmuSystem::start(EmuApp &app)
 	onStart();
 	app.startAudio();
 	app.autosaveManager.startTimer();
-	if(stateSizeChangesAtRuntime && app.rewindManager.maxStates)
+	if(stateSizeChangesAtRuntime && (app.rewindManager.maxMemoryMiB || app.runAheadManager.frames) && allowsInSessionStates())
 	{
 		auto newStateSize = stateSize();
-		if(newStateSize != app.rewindManager.stateSize)
+		if(app.rewindManager.maxMemoryMiB && newStateSize != app.rewindManager.stateSize)
 			app.rewindManager.reset(newStateSize);
+		if(app.runAheadManager.frames && newStateSize != app.runAheadManager.stateSize)
+			app.runAheadManager.reset(newStateSize);
 	}
-	app.rewindManager.startTimer();
 }
 
-SteadyClockTime EmuSystem::benchmark(EmuVideo &video)
+BenchmarkResult EmuSystem::benchmark(EmuVideo &video, int frames, InputMovie *movie)
 {
+	BenchmarkResult result;
+	result.frameTimes.reserve(frames);
+	video.setTrackWorkTime(true);
 	auto before = SteadyClock::now();
-	for(auto i : iotaCount(180))
+	auto frameStart = before;
+	for(auto i : iotaCount(frames))
 	{
+		if(movie)
+			movie->notifyFrameStart();
 		runFrame({}, &video, nullptr);
+		auto frameEnd = SteadyClock::now();
+		result.frameTimes.push_back(frameEnd - frameStart);
+		frameStart = frameEnd;
 	}
-	return SteadyClock::now() - before;
+	result.totalTime = frameStart - before;
+	result.videoTime = video.takeWorkTime();
+	video.setTrackWorkTime(false);
+	result.peakRSSBytes = BenchmarkResult::currentPeakRSS();
+	return result;
 }
 
 void EmuSystem::configFrameTime(int outputRate, FrameTime outputFrameTime)
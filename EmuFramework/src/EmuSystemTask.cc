@@ -156,12 +156,4 @@ void EmuSystemTask::sendFrameFinishedReply(EmuVideo &video)
 	video.dispatchFrameFinished();
 }
 
-void EmuSystemTask::sendScreenshotReply(bool success)
-{
-	app.runOnMainThread([&app = app, success](ApplicationContext ctx)
-	{
-		app.printScreenshotResult(success);
-	});
-}
-
 }
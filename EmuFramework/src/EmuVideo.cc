@@ -25,6 +25,13 @@ namespace EmuEx
 
 constexpr SystemLogger log{"EmuVideo"};
 
+static bool isValidRenderFormat(IG::PixelFormat fmt)
+{
+	return fmt == IG::PixelFmtRGBA8888 ||
+		fmt == IG::PixelFmtBGRA8888 ||
+		fmt == IG::PixelFmtRGB565;
+}
+
 void EmuVideo::resetImage(IG::PixelFormat newFmt)
 {
 	if(!vidImg)
@@ -39,6 +46,22 @@ void EmuVideo::resetImage(IG::PixelFormat newFmt)
 
 IG::PixmapDesc EmuVideo::deleteImage()
 {
+	if(filterSrcImg)
+	{
+		auto desc = filterSrcImg.desc();
+		filterSrcImg = {};
+		if(headless)
+			headlessImg = {};
+		else
+			vidImg = {};
+		return desc;
+	}
+	if(headless)
+	{
+		auto desc = headlessImg.desc();
+		headlessImg = {};
+		return desc;
+	}
 	auto desc = vidImg.pixmapDesc();
 	vidImg = {};
 	return desc;
@@ -54,11 +77,18 @@ bool EmuVideo::hasRendererTask() const
 	return rTask;
 }
 
-static bool isValidRenderFormat(IG::PixelFormat fmt)
+void EmuVideo::setHeadless(EmuSystem &sys, IG::PixelFormat fmt)
 {
-	return fmt == IG::PixelFmtRGBA8888 ||
-		fmt == IG::PixelFmtBGRA8888 ||
-		fmt == IG::PixelFmtRGB565;
+	assert(!rTask);
+	assert(isValidRenderFormat(fmt));
+	headless = true;
+	renderFmt = fmt;
+	log.info("using headless video with render pixel format:{}", fmt.name());
+	auto oldPixDesc = deleteImage();
+	if(!sys.onVideoRenderFormatChange(*this, fmt) && oldPixDesc.w())
+	{
+		setFormat({oldPixDesc.size, fmt});
+	}
 }
 
 bool EmuVideo::setFormat(IG::PixmapDesc desc, EmuSystemTaskContext taskCtx)
@@ -67,7 +97,16 @@ bool EmuVideo::setFormat(IG::PixmapDesc desc, EmuSystemTaskContext taskCtx)
 	{
 		return false; // no change to size/format
 	}
-	if(!vidImg)
+	if(cpuFilter_)
+	{
+		filterSrcImg = {desc};
+		desc = {cpuFilter_->outputSize(desc.size), desc.format};
+	}
+	if(headless)
+	{
+		headlessImg = {desc};
+	}
+	else if(!vidImg)
 	{
 		Gfx::TextureConfig conf{desc, samplerConfig()};
 		conf.colorSpace = colSpace;
@@ -92,29 +131,38 @@ bool EmuVideo::setFormat(IG::PixmapDesc desc, EmuSystemTaskContext taskCtx)
 
 EmuVideoImage EmuVideo::startFrame(EmuSystemTaskContext taskCtx)
 {
+	markWorkStart();
+	if(cpuFilter_)
+		return {taskCtx, *this, Gfx::LockedTextureBuffer{nullptr, filterSrcImg.view(), {}, 0, false}};
+	if(headless)
+		return {taskCtx, *this, Gfx::LockedTextureBuffer{nullptr, headlessImg.view(), {}, 0, false}};
 	auto lockedTex = vidImg.lock();
 	return {taskCtx, *this, lockedTex};
 }
 
 void EmuVideo::startFrame(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
 {
+	markWorkStart();
 	finishFrame(taskCtx, pix);
 }
 
 EmuVideoImage EmuVideo::startFrameWithFormat(EmuSystemTaskContext taskCtx, IG::PixmapDesc desc)
 {
+	markWorkStart();
 	setFormat(desc, taskCtx);
 	return startFrame(taskCtx);
 }
 
 void EmuVideo::startFrameWithFormat(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
 {
+	markWorkStart();
 	setFormat(pix.desc(), taskCtx);
 	startFrame(taskCtx, pix);
 }
 
 void EmuVideo::startFrameWithAltFormat(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
 {
+	markWorkStart();
 	auto destFmt = renderPixelFormat();
 	auto srcFmt = pix.format();
 	assumeExpr(isValidRenderFormat(srcFmt));
@@ -147,28 +195,103 @@ void EmuVideo::postFrameFinished(EmuSystemTaskContext taskCtx)
 
 void EmuVideo::finishFrame(EmuSystemTaskContext taskCtx, Gfx::LockedTextureBuffer texBuff)
 {
-	if(screenshotNextFrame) [[unlikely]]
+	if(cpuFilter_)
+	{
+		finishFilteredFrame(taskCtx, texBuff.pixmap());
+		return;
+	}
+	submitFrame(taskCtx, texBuff);
+}
+
+void EmuVideo::submitFrame(EmuSystemTaskContext taskCtx, Gfx::LockedTextureBuffer texBuff)
+{
+	if(screenshotNextFrame || sequenceCapture) [[unlikely]]
+	{
+		captureFrame(texBuff.pixmap());
+	}
+	if(headless)
 	{
-		doScreenshot(taskCtx, texBuff.pixmap());
+		markWorkEnd();
+		return;
 	}
 	app().record(FrameTimeStatEvent::aboutToSubmitFrame);
 	vidImg.unlock(texBuff);
+	markWorkEnd();
 	postFrameFinished(taskCtx);
 }
 
 void EmuVideo::finishFrame(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
 {
-	if(screenshotNextFrame) [[unlikely]]
+	if(cpuFilter_)
 	{
-		doScreenshot(taskCtx, pix);
+		if(pix.desc() != filterSrcImg.desc()) [[unlikely]]
+		{
+			log.error("frame format doesn't match filter input, skipping frame");
+			markWorkEnd();
+			postFrameFinished(taskCtx);
+			return;
+		}
+		finishFilteredFrame(taskCtx, pix);
+		return;
+	}
+	if(screenshotNextFrame || sequenceCapture) [[unlikely]]
+	{
+		captureFrame(pix);
+	}
+	if(headless)
+	{
+		headlessImg.view().write(pix);
+		markWorkEnd();
+		return;
 	}
 	app().record(FrameTimeStatEvent::aboutToSubmitFrame);
 	vidImg.write(pix, {.async = true});
+	markWorkEnd();
 	postFrameFinished(taskCtx);
 }
 
+void EmuVideo::finishFilteredFrame(EmuSystemTaskContext taskCtx, IG::PixmapView src)
+{
+	auto texBuff = headless ? Gfx::LockedTextureBuffer{nullptr, headlessImg.view(), {}, 0, false} : vidImg.lock();
+	auto dest = texBuff.pixmap();
+	filterThreads.run(src.h(), [&](int startY, int endY){ cpuFilter_->filterRows(dest, src, startY, endY); });
+	submitFrame(taskCtx, texBuff);
+}
+
+void EmuVideo::setCPUFilter(CPUVideoFilter *filter, int threads)
+{
+	if(filter == cpuFilter_)
+		return;
+	IG::PixmapDesc desc{};
+	if(filterSrcImg || (headless ? bool(headlessImg) : bool(vidImg)))
+		desc = deleteImage();
+	cpuFilter_ = filter;
+	if(filter)
+	{
+		log.info("enabled CPU video filter");
+		filterThreads.start(threads);
+	}
+	else
+	{
+		log.info("disabled CPU video filter");
+		filterThreads.stop();
+	}
+	if(desc.w())
+	{
+		setFormat(desc);
+		if(!headless)
+			app().renderSystemFramebuffer(*this);
+	}
+}
+
 void EmuVideo::clear()
 {
+	if(headless)
+	{
+		if(headlessImg)
+			headlessImg.view().clear();
+		return;
+	}
 	if(!vidImg)
 		return;
 	vidImg.clear();
@@ -179,18 +302,15 @@ void EmuVideo::takeGameScreenshot()
 	screenshotNextFrame = true;
 }
 
-void EmuVideo::doScreenshot(EmuSystemTaskContext taskCtx, IG::PixmapView pix)
+void EmuVideo::captureFrame(IG::PixmapView pix)
 {
-	screenshotNextFrame = false;
-	auto success = app().writeScreenshot(pix, app().makeNextScreenshotFilename());
-	if(taskCtx)
-	{
-		taskCtx.task().sendScreenshotReply(success);
-	}
-	else
+	if(screenshotNextFrame)
 	{
-		app().printScreenshotResult(success);
+		screenshotNextFrame = false;
+		app().frameCapture.queueScreenshot(pix, app().makeNextScreenshotFilename());
 	}
+	if(sequenceCapture)
+		sequenceCapture->captureFrame(pix);
 }
 
 bool EmuVideo::isExternalTexture() const
@@ -237,6 +357,8 @@ void EmuVideoImage::endFrame()
 
 WSize EmuVideo::size() const
 {
+	if(headless)
+		return headlessImg ? headlessImg.desc().size : WSize{1, 1};
 	if(!vidImg)
 		return {1, 1};
 	else
@@ -245,6 +367,10 @@ WSize EmuVideo::size() const
 
 bool EmuVideo::formatIsEqual(IG::PixmapDesc desc) const
 {
+	if(cpuFilter_)
+		return filterSrcImg && desc == filterSrcImg.desc() && (headless ? bool(headlessImg) : bool(vidImg));
+	if(headless)
+		return headlessImg && desc == headlessImg.desc();
 	return vidImg && desc == vidImg.pixmapDesc();
 }
 
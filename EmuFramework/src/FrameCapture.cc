@@ -0,0 +1,340 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/FrameCapture.hh>
+#include <emuframework/EmuApp.hh>
+#include <imagine/util/format.hh>
+#include <imagine/util/ranges.hh>
+#include <imagine/logger/logger.h>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace EmuEx
+{
+
+constexpr SystemLogger log{"FrameCapture"};
+constexpr size_t wavHeaderSize = 44;
+
+static void writeWavHeader(FileIO &file, Audio::Format fmt, uint32_t dataBytes)
+{
+	std::array<uint8_t, wavHeaderSize> header;
+	auto put16 = [&](size_t offset, uint16_t val) { std::memcpy(&header[offset], &val, sizeof(val)); };
+	auto put32 = [&](size_t offset, uint32_t val) { std::memcpy(&header[offset], &val, sizeof(val)); };
+	std::memcpy(&header[0], "RIFF", 4);
+	put32(4, dataBytes + wavHeaderSize - 8);
+	std::memcpy(&header[8], "WAVEfmt ", 8);
+	put32(16, 16);
+	put16(20, fmt.sample.isFloat() ? 3 : 1);
+	put16(22, fmt.channels);
+	put32(24, fmt.rate);
+	put32(28, fmt.rate * fmt.bytesPerFrame());
+	put16(32, fmt.bytesPerFrame());
+	put16(34, fmt.sample.bits());
+	std::memcpy(&header[36], "data", 4);
+	put32(40, dataBytes);
+	file.write(header.data(), header.size(), 0);
+}
+
+static void copyFrame(MemPixmap &dest, PixmapView src)
+{
+	if(dest.desc() != src.desc())
+		dest = MemPixmap{src.desc()};
+	dest.view().write(src);
+}
+
+FrameCapture::~FrameCapture()
+{
+	stopWorker();
+}
+
+void FrameCapture::startWorker()
+{
+	workerThread = std::thread
+	{
+		[this]()
+		{
+			log.info("starting capture thread");
+			while(true)
+			{
+				queuedJobs.acquire();
+				auto &job = jobs[readSlot];
+				readSlot = (readSlot + 1) % slots;
+				bool quit = job.type == JobType::Quit;
+				if(!quit)
+					runJob(job);
+				freeSlots.release();
+				if(quit)
+					break;
+			}
+			log.info("exiting capture thread");
+		}
+	};
+}
+
+void FrameCapture::stopWorker()
+{
+	if(!workerThread.joinable())
+		return;
+	acquireSlot(JobType::Quit);
+	submitSlot();
+	workerThread.join();
+}
+
+FrameCapture::Job &FrameCapture::acquireSlot(JobType type)
+{
+	if(!workerThread.joinable())
+		startWorker();
+	freeSlots.acquire();
+	auto &job = jobs[writeSlot];
+	job.type = type;
+	job.repeatFrames = 0;
+	job.hasFrame = false;
+	return job;
+}
+
+void FrameCapture::submitSlot()
+{
+	writeSlot = (writeSlot + 1) % slots;
+	queuedJobs.release();
+}
+
+void FrameCapture::waitForIdle()
+{
+	if(!workerThread.joinable())
+		return;
+	for([[maybe_unused]] auto i : iotaCount(slots))
+		freeSlots.acquire();
+	freeSlots.release(slots);
+}
+
+void FrameCapture::queueScreenshot(PixmapView pix, FS::PathString path)
+{
+	auto &job = acquireSlot(JobType::Screenshot);
+	copyFrame(job.frame, pix);
+	job.path = std::move(path);
+	submitSlot();
+}
+
+void FrameCapture::startSequence(CStringView videoPath, CStringView audioPath, int frameInterval_,
+	double frameRate, Audio::Format audioFormat_)
+{
+	stopSequence();
+	waitForIdle();
+	auto ctx = app.appContext();
+	videoFile = ctx.openFileUri(videoPath, OpenFlags::newFile());
+	if(audioPath.size() && audioFormat_)
+	{
+		audioFile = ctx.openFileUri(audioPath, OpenFlags::newFile());
+		writeWavHeader(audioFile, audioFormat_, 0);
+	}
+	videoDesc = {};
+	videoFrameRate = frameRate;
+	writtenFrames = leadingRepeatFrames = 0;
+	audioBytesWritten = 0;
+	audioFormat = audioFormat_;
+	frameInterval = frameInterval_;
+	framesUntilCapture = capturedFrames = 0;
+	pendingAudio.clear();
+	capturingSequence = true;
+	log.info("started sequence capture:{} every {} frame(s)", videoPath, frameInterval);
+}
+
+void FrameCapture::stopSequence()
+{
+	if(!capturingSequence)
+		return;
+	capturingSequence = false;
+	if(pendingAudio.size())
+	{
+		auto &job = acquireSlot(JobType::SequenceData);
+		std::swap(job.audio, pendingAudio);
+		pendingAudio.clear();
+		submitSlot();
+	}
+	acquireSlot(JobType::EndSequence);
+	submitSlot();
+}
+
+void FrameCapture::captureFrame(PixmapView pix)
+{
+	if(framesUntilCapture--)
+		return;
+	framesUntilCapture = frameInterval - 1;
+	auto &job = acquireSlot(JobType::SequenceData);
+	copyFrame(job.frame, pix);
+	job.hasFrame = true;
+	job.audio.clear();
+	std::swap(job.audio, pendingAudio);
+	submitSlot();
+	capturedFrames++;
+}
+
+void FrameCapture::skipFrames(int frames)
+{
+	int repeats{};
+	for([[maybe_unused]] auto i : iotaCount(frames))
+	{
+		if(framesUntilCapture--)
+			continue;
+		framesUntilCapture = frameInterval - 1;
+		repeats++;
+	}
+	if(!repeats)
+		return;
+	auto &job = acquireSlot(JobType::SequenceData);
+	job.repeatFrames = repeats;
+	job.audio.clear();
+	std::swap(job.audio, pendingAudio);
+	submitSlot();
+	capturedFrames += repeats;
+}
+
+void FrameCapture::captureAudio(const void *samples, size_t frames)
+{
+	auto bytes = audioFormat.framesToBytes(frames);
+	auto src = static_cast<const uint8_t*>(samples);
+	pendingAudio.insert(pendingAudio.end(), src, src + bytes);
+	if(pendingAudio.size() > size_t(audioFormat.timeToBytes(Seconds{1}))) [[unlikely]]
+	{
+		// no frames are being captured, don't let the audio grow unbounded
+		auto &job = acquireSlot(JobType::SequenceData);
+		job.audio.clear();
+		std::swap(job.audio, pendingAudio);
+		submitSlot();
+	}
+}
+
+void FrameCapture::runJob(Job &job)
+{
+	switch(job.type)
+	{
+		case JobType::Screenshot:
+		{
+			auto success = app.writeScreenshot(job.frame.view(), job.path);
+			app.runOnMainThread([&app = app, success](ApplicationContext)
+			{
+				app.printScreenshotResult(success);
+			});
+			return;
+		}
+		case JobType::SequenceData:
+			if(job.repeatFrames)
+				repeatVideoFrame(job.repeatFrames);
+			if(job.hasFrame)
+				writeVideoFrame(job.frame.view());
+			if(job.audio.size())
+				writeAudio(job.audio);
+			return;
+		case JobType::EndSequence:
+			finishSequence();
+			return;
+		case JobType::Quit:
+			return;
+	}
+}
+
+void FrameCapture::writeVideoFrame(PixmapView pix)
+{
+	if(!videoFile)
+		return;
+	if(!videoDesc.w())
+	{
+		videoDesc = pix.desc();
+		auto header = std::format("YUV4MPEG2 W{} H{} F{}:1000 Ip A1:1 C444\n",
+			pix.w(), pix.h(), std::lround(videoFrameRate * 1000. / frameInterval));
+		videoFile.write(header.data(), header.size());
+		rgbFrame = MemPixmap{{pix.size(), PixelFmtRGB888}};
+		yuvFrame.resize(pix.w() * pix.h() * 3);
+	}
+	else if(pix.desc() != videoDesc)
+	{
+		log.warn("repeating previous frame in place of size:{}x{} that doesn't match video size:{}x{}",
+			pix.w(), pix.h(), videoDesc.w(), videoDesc.h());
+		repeatVideoFrame(1);
+		return;
+	}
+	auto rgb = rgbFrame.view();
+	rgb.writeConverted(pix);
+	// BT.601 limited range, all three planes at full resolution
+	const int w = rgb.w(), h = rgb.h();
+	auto yPlane = yuvFrame.data();
+	auto uPlane = yPlane + w * h;
+	auto vPlane = uPlane + w * h;
+	for(auto y : iotaCount(h))
+	{
+		auto row = static_cast<const uint8_t*>(rgb.data({0, y}));
+		for(auto x : iotaCount(w))
+		{
+			int r = row[x * 3], g = row[x * 3 + 1], b = row[x * 3 + 2];
+			auto i = y * w + x;
+			yPlane[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+			uPlane[i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+			vPlane[i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+		}
+	}
+	videoFile.write("FRAME\n", 6);
+	videoFile.write(yuvFrame.data(), yuvFrame.size());
+	writtenFrames++;
+	if(leadingRepeatFrames)
+	{
+		// fill in frames skipped before the first one was captured
+		repeatVideoFrame(std::exchange(leadingRepeatFrames, 0));
+	}
+}
+
+void FrameCapture::repeatVideoFrame(int times)
+{
+	if(!videoFile)
+		return;
+	if(!videoDesc.w())
+	{
+		leadingRepeatFrames += times;
+		return;
+	}
+	for([[maybe_unused]] auto i : iotaCount(times))
+	{
+		videoFile.write("FRAME\n", 6);
+		videoFile.write(yuvFrame.data(), yuvFrame.size());
+	}
+	writtenFrames += times;
+}
+
+void FrameCapture::writeAudio(std::span<const uint8_t> samples)
+{
+	if(!audioFile)
+		return;
+	audioFile.write(samples.data(), samples.size(), wavHeaderSize + audioBytesWritten);
+	audioBytesWritten += samples.size();
+}
+
+void FrameCapture::finishSequence()
+{
+	if(audioFile)
+	{
+		writeWavHeader(audioFile, audioFormat, audioBytesWritten);
+		audioFile = {};
+	}
+	videoFile = {};
+	rgbFrame = {};
+	yuvFrame = {};
+	log.info("finished sequence capture with {} frames", writtenFrames);
+	app.runOnMainThread([&app = app, frames = writtenFrames](ApplicationContext)
+	{
+		app.postMessage(std::format("Wrote {} captured frames", frames));
+	});
+}
+
+}
@@ -0,0 +1,307 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/InputMovie.hh>
+#include <emuframework/EmuApp.hh>
+#include <emuframework/StateCodec.hh>
+#include <imagine/io/IO.hh>
+#include <imagine/util/format.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+
+namespace EmuEx
+{
+
+constexpr SystemLogger log{"InputMovie"};
+constexpr std::string_view movieMagic{"EXMV"};
+constexpr uint8_t movieVersion = 1;
+
+static void writeVarint(std::vector<uint8_t> &out, uint64_t val)
+{
+	while(val >= 0x80)
+	{
+		out.push_back(uint8_t(val) | 0x80);
+		val >>= 7;
+	}
+	out.push_back(uint8_t(val));
+}
+
+static void writeBytes(std::vector<uint8_t> &out, std::span<const uint8_t> bytes)
+{
+	writeVarint(out, bytes.size());
+	out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+// bounds checked reader for movie data, throws on truncated or malformed input
+class MovieReader
+{
+public:
+	MovieReader(std::span<const uint8_t> data, size_t pos = 0): data{data}, pos{pos} {}
+
+	uint8_t readByte()
+	{
+		if(pos == data.size())
+			throw std::runtime_error("Truncated movie data");
+		return data[pos++];
+	}
+
+	uint64_t readVarint()
+	{
+		uint64_t val{};
+		for(unsigned shift = 0; shift < 64; shift += 7)
+		{
+			auto byte = readByte();
+			val |= uint64_t(byte & 0x7F) << shift;
+			if(!(byte & 0x80))
+				return val;
+		}
+		throw std::runtime_error("Invalid movie data");
+	}
+
+	std::span<const uint8_t> readBytes()
+	{
+		auto size = readVarint();
+		if(size > data.size() - pos)
+			throw std::runtime_error("Truncated movie data");
+		auto bytes = data.subspan(pos, size);
+		pos += size;
+		return bytes;
+	}
+
+	InputAction readAction()
+	{
+		InputAction action;
+		action.code = readVarint();
+		action.flags = std::bit_cast<KeyFlags>(readByte());
+		action.state = Input::Action(readByte());
+		action.metaState = readVarint();
+		return action;
+	}
+
+	bool atEnd() const { return pos == data.size(); }
+	size_t position() const { return pos; }
+
+private:
+	std::span<const uint8_t> data;
+	size_t pos{};
+};
+
+void InputMovie::startRecording()
+{
+	auto &sys = app.system();
+	auto state = dynArrayForOverwrite<uint8_t>(sys.stateSize());
+	auto stateSize = sys.writeState(state, {.uncompressed = true});
+	auto codec = app.stateCodecConfig();
+	startState = dynArrayForOverwrite<uint8_t>(compressStateBound(stateSize, codec.type));
+	auto compSize = compressState(startState, {state.data(), stateSize}, codec);
+	if(!compSize)
+		throw std::runtime_error("Error compressing start state");
+	startState.trim(compSize);
+	events.clear();
+	pendingActions.clear();
+	frame = lastEventFrame = movieFrames = 0;
+	log.info("started recording with start state of size:{}", compSize);
+	mode_.store(Mode::Recording, std::memory_order_release);
+}
+
+void InputMovie::saveRecording(CStringView uri)
+{
+	if(mode() != Mode::Recording)
+		return;
+	std::vector<uint8_t> data;
+	data.reserve(movieMagic.size() + startState.size() + events.size() + 64);
+	data.insert(data.end(), movieMagic.begin(), movieMagic.end());
+	data.push_back(movieVersion);
+	std::string_view sysName{app.system().shortSystemName()};
+	writeBytes(data, {(const uint8_t*)sysName.data(), sysName.size()});
+	writeBytes(data, startState);
+	data.insert(data.end(), events.begin(), events.end());
+	writeVarint(data, uint64_t(frame - lastEventFrame) << 1 | 1);
+	movieFrames = frame;
+	stop();
+	log.info("saving {} frame recording to:{}", movieFrames, uri);
+	auto file = app.appContext().openFileUri(uri, OpenFlags::newFile());
+	file.write(std::span<const uint8_t>{data});
+}
+
+void InputMovie::startPlayback(CStringView uri)
+{
+	stop();
+	auto &sys = app.system();
+	auto file = app.appContext().openFileUri(uri, {.accessHint = IOAccessHint::All});
+	auto buff = file.buffer(IOBufferMode::Release);
+	std::span<const uint8_t> data{buff.data(), buff.size()};
+	if(!std::ranges::equal(data.first(std::min(data.size(), movieMagic.size())), movieMagic))
+		throw std::runtime_error("Not an input movie file");
+	MovieReader in{data, movieMagic.size()};
+	if(auto version = in.readByte(); version != movieVersion)
+		throw std::runtime_error(std::format("Unsupported movie version:{}", version));
+	auto sysName = in.readBytes();
+	if(!std::ranges::equal(sysName, std::string_view{sys.shortSystemName()}))
+		throw std::runtime_error(std::format("Movie was recorded with another system ({})",
+			std::string_view{(const char*)sysName.data(), sysName.size()}));
+	auto stateData = in.readBytes();
+	events.assign(data.begin() + in.position(), data.end());
+	// validate all events up front so playback on the emulation thread can't fail
+	MovieReader eventsIn{events};
+	uint64_t frames{};
+	while(true)
+	{
+		auto tag = eventsIn.readVarint();
+		frames += tag >> 1;
+		if(frames > UINT32_MAX)
+			throw std::runtime_error("Invalid movie data");
+		if(tag & 1)
+			break;
+		eventsIn.readAction();
+	}
+	if(!eventsIn.atEnd())
+		throw std::runtime_error("Invalid movie data");
+	movieFrames = frames;
+	startState = dynArrayForOverwrite<uint8_t>(stateData.size());
+	std::ranges::copy(stateData, startState.begin());
+	if(detectStateCodec(startState))
+		sys.readState(app, sys.uncompressState(startState));
+	else
+		sys.readState(app, startState);
+	eventPos = 0;
+	frame = lastEventFrame = 0;
+	frameTimes.clear();
+	frameTimes.reserve(movieFrames);
+	frameStartTime = {};
+	readNextEventFrame();
+	log.info("started playback of {} frames", movieFrames);
+	mode_.store(Mode::Playing, std::memory_order_release);
+}
+
+void InputMovie::stop()
+{
+	if(mode() == Mode::Off)
+		return;
+	mode_.store(Mode::Off, std::memory_order_release);
+	// actions still waiting for the next frame go straight to the system so no key is left held
+	std::scoped_lock lock{pendingMutex};
+	for(auto action : pendingActions)
+		app.system().handleInputAction(&app, action);
+	pendingActions.clear();
+}
+
+BenchmarkResult InputMovie::playbackStats() const
+{
+	BenchmarkResult result;
+	result.frameTimes = frameTimes;
+	result.totalTime = std::reduce(frameTimes.begin(), frameTimes.end(), SteadyClockTime{});
+	result.peakRSSBytes = BenchmarkResult::currentPeakRSS();
+	return result;
+}
+
+bool InputMovie::interceptInputAction(InputAction action)
+{
+	switch(mode())
+	{
+		case Mode::Off: return false;
+		case Mode::Recording:
+		{
+			std::scoped_lock lock{pendingMutex};
+			pendingActions.emplace_back(action);
+			return true;
+		}
+		case Mode::Playing:
+			return true; // live input would desync playback
+	}
+	return false;
+}
+
+void InputMovie::startFrame()
+{
+	if(mode() == Mode::Recording)
+		recordFrameActions();
+	else
+		playFrameActions();
+	frame++;
+}
+
+void InputMovie::recordFrameActions()
+{
+	{
+		std::scoped_lock lock{pendingMutex};
+		std::swap(pendingActions, frameActions);
+	}
+	for(auto action : frameActions)
+	{
+		app.system().handleInputAction(&app, action);
+		writeVarint(events, uint64_t(frame - lastEventFrame) << 1);
+		writeVarint(events, action.code);
+		events.push_back(std::bit_cast<uint8_t>(action.flags));
+		events.push_back(uint8_t(action.state));
+		writeVarint(events, action.metaState);
+		lastEventFrame = frame;
+	}
+	frameActions.clear();
+}
+
+void InputMovie::readNextEventFrame()
+{
+	MovieReader in{events, eventPos};
+	auto tag = in.readVarint();
+	nextEventFrame = lastEventFrame + (tag >> 1);
+	lastEventFrame = nextEventFrame;
+	nextEventIsEnd = tag & 1;
+	eventPos = in.position();
+}
+
+void InputMovie::playFrameActions()
+{
+	while(!nextEventIsEnd && nextEventFrame == frame)
+	{
+		MovieReader in{events, eventPos};
+		app.system().handleInputAction(&app, in.readAction());
+		eventPos = in.position();
+		readNextEventFrame();
+	}
+	if(nextEventIsEnd && frame >= nextEventFrame)
+	{
+		finishPlayback();
+		return;
+	}
+	frameStartTime = SteadyClock::now();
+}
+
+static double toMs(SteadyClockTime t)
+{
+	return std::chrono::duration<double, std::milli>(t).count();
+}
+
+void InputMovie::finishPlayback()
+{
+	mode_.store(Mode::Off, std::memory_order_release);
+	log.info("finished playback after {} frames", frame);
+	if(frameTimes.empty())
+		return;
+	app.runOnMainThread([this](ApplicationContext)
+	{
+		auto stats = playbackStats();
+		auto &sys = app.system();
+		log.info("playback stats:{}", stats.toJSON(sys.shortSystemName(), sys.contentDisplayName()));
+		app.postMessage(4, false, std::format("Movie finished, {} frames\navg:{:.2f}ms p99:{:.2f}ms max:{:.2f}ms",
+			stats.frames(), toMs(stats.totalTime) / stats.frames(), toMs(stats.frameTimePercentile(99)),
+			toMs(stats.maxFrameTime())));
+	});
+}
+
+}
@@ -17,33 +17,151 @@
 #include <emuframework/EmuApp.hh>
 #include <emuframework/Option.hh>
 #include <emuframework/EmuOptions.hh>
+#include <imagine/util/algorithm.h>
 #include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstring>
 
 namespace EmuEx
 {
 
 constexpr SystemLogger log{"RewindMgr"};
-constexpr Seconds defaultSaveFreq{1};
+constexpr size_t maxRewindMemoryMiB = 4096;
 
-RewindManager::RewindManager(EmuApp &app):
-	saveTimer
+// Packed format is a series of (match length, literal length, literal bytes) runs,
+// where matched bytes equal the reference state and literal bytes are XOR'd with it.
+// Literal runs only end on a match of at least minMatchRun bytes to keep runs from fragmenting.
+constexpr size_t minMatchRun = 16;
+
+static constexpr size_t packedSizeBound(size_t size) { return size + size / 8 + 32; }
+
+static uint8_t *writeVarint(uint8_t *out, size_t val)
+{
+	while(val >= 0x80)
+	{
+		*out++ = uint8_t(val) | 0x80;
+		val >>= 7;
+	}
+	*out++ = uint8_t(val);
+	return out;
+}
+
+static const uint8_t *readVarint(const uint8_t *in, size_t &val)
+{
+	val = 0;
+	for(unsigned shift = 0;; shift += 7)
+	{
+		auto byte = *in++;
+		val |= size_t(byte & 0x7F) << shift;
+		if(!(byte & 0x80))
+			return in;
+	}
+}
+
+// pack state as a delta against ref, or against all zeros if ref is null
+static size_t packDelta(std::span<const uint8_t> state, const uint8_t *ref, uint8_t *out)
+{
+	auto refByte = [&](size_t i) -> uint8_t { return ref ? ref[i] : 0; };
+	auto wordMatches = [&](size_t i)
+	{
+		uint64_t stateWord, refWord{};
+		std::memcpy(&stateWord, &state[i], sizeof(stateWord));
+		if(ref)
+			std::memcpy(&refWord, &ref[i], sizeof(refWord));
+		return stateWord == refWord;
+	};
+	const auto size = state.size();
+	const auto outStart = out;
+	size_t i = 0;
+	while(i < size)
+	{
+		auto matchStart = i;
+		while(i + 8 <= size && wordMatches(i))
+			i += 8;
+		while(i < size && state[i] == refByte(i))
+			i++;
+		auto literalStart = i;
+		auto literalEnd = i;
+		size_t matches = 0;
+		for(; i < size; i++)
+		{
+			if(state[i] == refByte(i))
+			{
+				if(++matches == minMatchRun)
+					break;
+			}
+			else
+			{
+				matches = 0;
+				literalEnd = i + 1;
+			}
+		}
+		i = literalEnd;
+		out = writeVarint(out, literalStart - matchStart);
+		out = writeVarint(out, literalEnd - literalStart);
+		if(ref)
+		{
+			for(auto l = literalStart; l < literalEnd; l++)
+				*out++ = state[l] ^ ref[l];
+		}
+		else
+		{
+			out = std::copy(&state[literalStart], &state[literalEnd], out);
+		}
+	}
+	return out - outStart;
+}
+
+static void unpackDelta(const uint8_t *in, const uint8_t *ref, std::span<uint8_t> state)
+{
+	const auto size = state.size();
+	size_t i = 0;
+	while(i < size)
 	{
-		defaultSaveFreq,
-		"RewindManager::saveStateTimer",
-		[this, &app]()
+		size_t matchSize, literalSize;
+		in = readVarint(in, matchSize);
+		in = readVarint(in, literalSize);
+		assumeExpr(i + matchSize + literalSize <= size);
+		if(ref)
+			std::memcpy(&state[i], &ref[i], matchSize);
+		else
+			std::memset(&state[i], 0, matchSize);
+		i += matchSize;
+		if(ref)
+		{
+			for(size_t l = 0; l < literalSize; l++)
+				state[i + l] = in[l] ^ ref[i + l];
+		}
+		else
 		{
-			//log.debug("running rewind save state timer");
-			saveState(app);
-			saveTimer.update();
-			return true;
+			std::memcpy(&state[i], in, literalSize);
 		}
-	} {}
+		in += literalSize;
+		i += literalSize;
+	}
+}
+
+RewindManager::~RewindManager()
+{
+	stopPackThread();
+}
+
+void RewindManager::deallocate()
+{
+	history = {};
+	stateBuff = {};
+	keyframeBuff = {};
+	packBuff = {};
+}
 
 void RewindManager::clear()
 {
-	saveTimer.cancel();
-	stateEntries = {};
-	stateIdx = 0;
+	stopPackThread();
+	deallocate();
+	entries = {};
+	writeOffset = 0;
+	deltasSinceKeyframe = 0;
+	framesSinceSave = 0;
 	stateSize = 0;
 }
 
@@ -51,55 +169,174 @@ bool RewindManager::reset()
 {
 	if(!stateSize)
 		return true;
-	try
+	stopPackThread();
+	entries = {};
+	writeOffset = 0;
+	deltasSinceKeyframe = 0;
+	framesSinceSave = 0;
+	if(!maxMemoryMiB)
 	{
-		if(maxStates)
-			log.info("allocating {} states of size:{}", maxStates, stateSize);
-		stateEntries.reset(maxStates, stateSize);
-		stateIdx = 0;
+		deallocate();
 		return true;
 	}
+	try
+	{
+		log.info("allocating {}MiB of rewind history for states of size:{}", maxMemoryMiB, stateSize);
+		history.resetForOverwrite(maxMemoryMiB * 1024 * 1024);
+		stateBuff.resetForOverwrite(stateSize);
+		keyframeBuff.reset(stateSize);
+		packBuff.resetForOverwrite(packedSizeBound(stateSize));
+	}
 	catch(...)
 	{
+		deallocate();
 		return false;
 	}
+	startPackThread();
+	return true;
 }
 
-void RewindManager::saveState(EmuApp &app)
+void RewindManager::startPackThread()
 {
-	assumeExpr(maxStates);
-	assumeExpr(stateIdx < maxStates);
-	//log.debug("saving rewind state index:{}", stateIdx);
-	auto &entry = stateEntries[stateIdx];
-	stateIdx = stateIdx + 1 == maxStates ? 0 : stateIdx + 1;
-	entry.size = app.writeState({entry.data, stateSize}, {.uncompressed = true});
+	quitPackThread = false;
+	packThread = std::thread
+	{
+		[this]()
+		{
+			log.info("starting pack thread");
+			while(true)
+			{
+				packSem.acquire();
+				if(quitPackThread)
+					break;
+				packState();
+				packPending.store(false, std::memory_order_release);
+				packPending.notify_all();
+			}
+			log.info("exiting pack thread");
+		}
+	};
 }
 
-void RewindManager::rewindState(EmuApp &app)
+void RewindManager::stopPackThread()
 {
-	if(!maxStates)
+	if(!packThread.joinable())
 		return;
-	assumeExpr(stateIdx < maxStates);
-	auto prevIdx = stateIdx ? stateIdx - 1 : maxStates - 1;
-	auto &entry = stateEntries[prevIdx];
-	if(!entry.size)
+	waitForPackedState();
+	quitPackThread = true;
+	packSem.release();
+	packThread.join();
+}
+
+void RewindManager::waitForPackedState()
+{
+	packPending.wait(true, std::memory_order_acquire);
+}
+
+void RewindManager::saveState(EmuSystem &sys)
+{
+	if(packPending.load(std::memory_order_acquire))
+	{
+		// previous state is still being packed, try again next frame
 		return;
-	log.info("rewinding to state index:{}", prevIdx);
-	app.readState({entry.data, std::exchange(entry.size, 0)});
-	stateIdx = prevIdx;
-	saveTimer.reset();
+	}
+	//log.debug("capturing rewind state");
+	capturedSize = sys.writeState(stateBuff, {.uncompressed = true, .inSession = true});
+	framesSinceSave = 0;
+	packPending.store(true, std::memory_order_relaxed);
+	packSem.release();
 }
 
-void RewindManager::startTimer()
+void RewindManager::packState()
 {
-	if(!stateEntries.size())
+	std::span<const uint8_t> state{stateBuff.data(), capturedSize};
+	if(entries.size() && deltasSinceKeyframe < keyframeInterval)
+	{
+		if(addEntry(packDelta(state, keyframeBuff.data(), packBuff.data()), state.size(), false))
+		{
+			deltasSinceKeyframe++;
+			return;
+		}
+		// keyframe was evicted to make space, fall through and start a new one
+	}
+	//log.debug("packing rewind keyframe");
+	if(!addEntry(packDelta(state, nullptr, packBuff.data()), state.size(), true))
+	{
+		log.warn("rewind memory too small to hold state of size:{}", state.size());
 		return;
-	saveTimer.start();
+	}
+	std::copy_n(state.data(), state.size(), keyframeBuff.data());
+	std::fill(keyframeBuff.begin() + state.size(), keyframeBuff.end(), 0);
+	deltasSinceKeyframe = 0;
 }
 
-void RewindManager::pauseTimer()
+bool RewindManager::addEntry(size_t packedSize, size_t stateSize, bool isKeyframe)
 {
-	saveTimer.pause();
+	if(packedSize > history.size()) [[unlikely]]
+		return false;
+	if(writeOffset + packedSize > history.size())
+	{
+		// entries past the write offset are the oldest ones, drop them before wrapping around
+		while(entries.size() && entries.front().offset >= writeOffset)
+			evictOldestKeyframeGroup();
+		writeOffset = 0;
+	}
+	auto overlapsWrite = [&](const StateEntry &e)
+	{
+		return e.offset < writeOffset + packedSize && writeOffset < e.offset + e.size;
+	};
+	while(entries.size() && overlapsWrite(entries.front()))
+		evictOldestKeyframeGroup();
+	if(!isKeyframe && entries.empty())
+		return false;
+	std::copy_n(packBuff.data(), packedSize, &history[writeOffset]);
+	entries.emplace_back(writeOffset, packedSize, stateSize, isKeyframe);
+	writeOffset += packedSize;
+	return true;
+}
+
+void RewindManager::evictOldestKeyframeGroup()
+{
+	entries.pop_front();
+	while(entries.size() && !entries.front().isKeyframe)
+		entries.pop_front();
+}
+
+void RewindManager::unpackEntry(const StateEntry &e, uint8_t *dest) const
+{
+	unpackDelta(&history[e.offset], e.isKeyframe ? nullptr : keyframeBuff.data(), {dest, e.stateSize});
+}
+
+void RewindManager::restoreLastKeyframe()
+{
+	auto it = std::ranges::find_if(entries.rbegin(), entries.rend(), [](auto &e){ return e.isKeyframe; });
+	if(it == entries.rend())
+	{
+		deltasSinceKeyframe = 0;
+		return;
+	}
+	unpackEntry(*it, keyframeBuff.data());
+	std::fill(keyframeBuff.begin() + it->stateSize, keyframeBuff.end(), 0);
+	deltasSinceKeyframe = std::distance(entries.rbegin(), it);
+}
+
+void RewindManager::rewindState(EmuApp &app)
+{
+	app.syncEmulationThread();
+	waitForPackedState();
+	if(entries.empty())
+		return;
+	auto entry = entries.back();
+	log.info("rewinding to state:{} ({})", entries.size() - 1, entry.isKeyframe ? "keyframe" : "delta");
+	unpackEntry(entry, stateBuff.data());
+	entries.pop_back();
+	writeOffset = entry.offset;
+	if(entry.isKeyframe)
+		restoreLastKeyframe();
+	else
+		deltasSinceKeyframe--;
+	app.readState({stateBuff.data(), entry.stateSize});
+	framesSinceSave = 0;
 }
 
 bool RewindManager::readConfig(MapIO &io, unsigned key)
@@ -107,19 +344,29 @@ bool RewindManager::readConfig(MapIO &io, unsigned key)
 	switch(key)
 	{
 		default: return false;
-		case CFGKEY_REWIND_STATES: return readOptionValue<uint32_t>(io, [&](auto m){ maxStates = m; });
+		case CFGKEY_REWIND_MEMORY_MIB: return readOptionValue<uint16_t>(io, [&](auto m)
+		{
+			if(m <= maxRewindMemoryMiB)
+				maxMemoryMiB = m;
+		});
+		case CFGKEY_REWIND_FRAME_INTERVAL: return readOptionValue<int16_t>(io, [&](auto f)
+		{
+			if(f >= 1 && f <= maxRewindFrameInterval)
+				frameInterval = f;
+		});
 		case CFGKEY_REWIND_TIMER_SECS: return readOptionValue<int16_t>(io, [&](auto s)
 		{
-			if(s > 0)
-				saveTimer.frequency = Seconds{s};
+			// convert from the old timer based setting
+			if(s > 0 && s * 60 <= maxRewindFrameInterval)
+				frameInterval = s * 60;
 		});
 	}
 }
 
 void RewindManager::writeConfig(FileIO &io) const
 {
-	writeOptionValueIfNotDefault(io, CFGKEY_REWIND_STATES, uint32_t(maxStates), 0u);
-	writeOptionValueIfNotDefault(io, CFGKEY_REWIND_TIMER_SECS, int16_t(saveTimer.frequency.count()), defaultSaveFreq.count());
+	writeOptionValueIfNotDefault(io, CFGKEY_REWIND_MEMORY_MIB, uint16_t(maxMemoryMiB), uint16_t(0));
+	writeOptionValueIfNotDefault(io, CFGKEY_REWIND_FRAME_INTERVAL, int16_t(frameInterval), int16_t(defaultFrameInterval));
 }
 
 
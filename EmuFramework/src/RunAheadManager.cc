@@ -0,0 +1,86 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/RunAheadManager.hh>
+#include <emuframework/EmuApp.hh>
+#include <emuframework/EmuSystemTaskContext.hh>
+#include <emuframework/Option.hh>
+#include <emuframework/EmuOptions.hh>
+#include <imagine/logger/logger.h>
+
+namespace EmuEx
+{
+
+constexpr SystemLogger log{"RunAhead"};
+
+void RunAheadManager::clear()
+{
+	stateBuff = {};
+	stateSize = 0;
+}
+
+bool RunAheadManager::reset()
+{
+	if(!stateSize)
+		return true;
+	if(!frames || !EmuSystem::canRunAhead)
+	{
+		stateBuff = {};
+		return true;
+	}
+	try
+	{
+		log.info("running {} frame(s) ahead with states of size:{}", frames, stateSize);
+		stateBuff.resetForOverwrite(stateSize);
+	}
+	catch(...)
+	{
+		stateBuff = {};
+		return false;
+	}
+	return true;
+}
+
+void RunAheadManager::runAhead(EmuApp &app, EmuSystemTaskContext taskCtx, EmuVideo &video)
+{
+	auto &sys = app.system();
+	auto size = sys.writeState(stateBuff, {.uncompressed = true, .inSession = true});
+	for(auto i : iotaCount(frames - 1))
+	{
+		sys.runFrame(taskCtx, nullptr, nullptr);
+	}
+	sys.runFrame(taskCtx, &video, nullptr);
+	sys.readState(app, {stateBuff.data(), size});
+}
+
+bool RunAheadManager::readConfig(MapIO &io, unsigned key)
+{
+	switch(key)
+	{
+		default: return false;
+		case CFGKEY_RUN_AHEAD_FRAMES: return readOptionValue<int8_t>(io, [&](auto f)
+		{
+			if(f >= 0 && f <= maxFrames)
+				frames = f;
+		});
+	}
+}
+
+void RunAheadManager::writeConfig(FileIO &io) const
+{
+	writeOptionValueIfNotDefault(io, CFGKEY_RUN_AHEAD_FRAMES, int8_t(frames), int8_t(0));
+}
+
+}
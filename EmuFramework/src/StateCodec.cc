@@ -0,0 +1,459 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/StateCodec.hh>
+#include <imagine/util/zlib.hh>
+#include <imagine/logger/logger.h>
+#ifdef CONFIG_PACKAGE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace EmuEx
+{
+
+constexpr SystemLogger log{"StateCodec"};
+constexpr size_t gzipWrapperExtraBytes = 12; // gzip header & trailer size over the zlib ones in compressBound()
+#ifdef CONFIG_PACKAGE_ZSTD
+constexpr size_t zstdMinMultithreadSize = 1024 * 1024; // smaller states fit in a single zstd job
+#endif
+
+static bool hasZstdHeader(std::span<const uint8_t> buff)
+{
+	return buff.size() > 4 && buff[0] == 0x28 && buff[1] == 0xB5 && buff[2] == 0x2F && buff[3] == 0xFD;
+}
+
+static int gzipLevel(StateCompressionLevel level)
+{
+	switch(level)
+	{
+		case StateCompressionLevel::Fast: return Z_BEST_SPEED;
+		case StateCompressionLevel::Best: return Z_BEST_COMPRESSION;
+		default: return Z_DEFAULT_COMPRESSION;
+	}
+}
+
+#ifdef CONFIG_PACKAGE_ZSTD
+static int zstdLevel(StateCompressionLevel level)
+{
+	switch(level)
+	{
+		case StateCompressionLevel::Fast: return 1;
+		case StateCompressionLevel::Best: return 19;
+		default: return ZSTD_CLEVEL_DEFAULT;
+	}
+}
+#endif
+
+std::optional<StateCodecType> detectStateCodec(std::span<const uint8_t> buff)
+{
+	if(hasGzipHeader(buff))
+		return StateCodecType::Gzip;
+	if(hasZstdHeader(buff))
+		return StateCodecType::Zstd;
+	return {};
+}
+
+bool stateCodecIsAvailable(StateCodecType type)
+{
+	#ifndef CONFIG_PACKAGE_ZSTD
+	if(type == StateCodecType::Zstd)
+		return false;
+	#endif
+	return true;
+}
+
+// states are written with gzip when the selected codec isn't in this build
+static StateCodecType availableStateCodec(StateCodecType type)
+{
+	return stateCodecIsAvailable(type) ? type : StateCodecType::Gzip;
+}
+
+size_t compressStateBound(size_t size, StateCodecType type)
+{
+	switch(availableStateCodec(type))
+	{
+		case StateCodecType::Gzip: return compressBound(size) + gzipWrapperExtraBytes;
+		#ifdef CONFIG_PACKAGE_ZSTD
+		case StateCodecType::Zstd: return ZSTD_compressBound(size);
+		#endif
+		default: return 0;
+	}
+}
+
+#ifdef CONFIG_PACKAGE_ZSTD
+static void setZstdParameters(ZSTD_CCtx *ctx, size_t srcSize, StateCodecConfig conf)
+{
+	ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, zstdLevel(conf.level));
+	ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
+	if(conf.threads > 1 && srcSize >= zstdMinMultithreadSize)
+	{
+		// fails if libzstd was built without multithread support, compression then runs on this thread
+		if(ZSTD_isError(ZSTD_CCtx_setParameter(ctx, ZSTD_c_nbWorkers, conf.threads)))
+			log.debug("multithreaded compression unsupported");
+	}
+}
+
+static size_t compressZstd(std::span<uint8_t> dest, std::span<const uint8_t> src, StateCodecConfig conf)
+{
+	auto ctx = ZSTD_createCCtx();
+	if(!ctx) [[unlikely]]
+		return 0;
+	setZstdParameters(ctx, src.size(), conf);
+	auto size = ZSTD_compress2(ctx, dest.data(), dest.size(), src.data(), src.size());
+	ZSTD_freeCCtx(ctx);
+	if(ZSTD_isError(size))
+	{
+		log.error("error compressing state:{}", ZSTD_getErrorName(size));
+		return 0;
+	}
+	return size;
+}
+#endif
+
+size_t compressState(std::span<uint8_t> dest, std::span<const uint8_t> src, StateCodecConfig conf)
+{
+	switch(availableStateCodec(conf.type))
+	{
+		case StateCodecType::Gzip: return compressGzip(dest, src, gzipLevel(conf.level));
+		#ifdef CONFIG_PACKAGE_ZSTD
+		case StateCodecType::Zstd: return compressZstd(dest, src, conf);
+		#endif
+		default: return 0;
+	}
+}
+
+size_t uncompressedStateSize(std::span<const uint8_t> buff, StateCodecType type)
+{
+	switch(type)
+	{
+		case StateCodecType::Gzip: return gzipUncompressedSize(buff);
+		case StateCodecType::Zstd:
+		{
+			#ifdef CONFIG_PACKAGE_ZSTD
+			auto size = ZSTD_getFrameContentSize(buff.data(), buff.size());
+			if(size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR)
+				return 0;
+			return size;
+			#else
+			log.error("zstd compressed states aren't supported in this build");
+			return 0;
+			#endif
+		}
+	}
+	return 0;
+}
+
+size_t uncompressState(std::span<uint8_t> dest, std::span<const uint8_t> src, StateCodecType type)
+{
+	switch(type)
+	{
+		case StateCodecType::Gzip: return uncompressGzip(dest, src);
+		case StateCodecType::Zstd:
+		{
+			#ifdef CONFIG_PACKAGE_ZSTD
+			auto size = ZSTD_decompress(dest.data(), dest.size(), src.data(), src.size());
+			if(ZSTD_isError(size))
+			{
+				log.error("error uncompressing state:{}", ZSTD_getErrorName(size));
+				return 0;
+			}
+			return size;
+			#else
+			log.error("zstd compressed states aren't supported in this build");
+			return 0;
+			#endif
+		}
+	}
+	return 0;
+}
+
+StateCompressor::StateCompressor(std::span<uint8_t> dest, size_t srcSize, StateCodecConfig conf, OutputDelegate onOutput):
+	dest{dest}, onOutput{onOutput}
+{
+	switch(availableStateCodec(conf.type))
+	{
+		case StateCodecType::Gzip:
+			zStream = new z_stream{};
+			zStream->next_out = dest.data();
+			zStream->avail_out = dest.size();
+			if(deflateInit2(zStream, gzipLevel(conf.level), Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				failed = true;
+			return;
+		#ifdef CONFIG_PACKAGE_ZSTD
+		case StateCodecType::Zstd:
+			zstdCtx = ZSTD_createCCtx();
+			if(!zstdCtx) [[unlikely]]
+			{
+				failed = true;
+				return;
+			}
+			setZstdParameters(zstdCtx, srcSize, conf);
+			ZSTD_CCtx_setPledgedSrcSize(zstdCtx, srcSize);
+			return;
+		#endif
+		default: break;
+	}
+	failed = true;
+}
+
+StateCompressor::~StateCompressor()
+{
+	if(zStream)
+	{
+		deflateEnd(zStream);
+		delete zStream;
+	}
+	#ifdef CONFIG_PACKAGE_ZSTD
+	ZSTD_freeCCtx(zstdCtx);
+	#endif
+}
+
+size_t StateCompressor::pendingOutputSize() const
+{
+	return zStream ? dest.size() - zStream->avail_out : outSize;
+}
+
+bool StateCompressor::flushOutput()
+{
+	auto size = pendingOutputSize();
+	if(!onOutput || !onOutput(dest.first(size)))
+		return false;
+	flushedSize += size;
+	outSize = 0;
+	if(zStream)
+	{
+		zStream->next_out = dest.data();
+		zStream->avail_out = dest.size();
+	}
+	return true;
+}
+
+bool StateCompressor::write(std::span<const uint8_t> src)
+{
+	if(failed)
+		return false;
+	inSize += src.size();
+	if(zStream)
+	{
+		zStream->next_in = const_cast<z_const Bytef*>(src.data());
+		zStream->avail_in = src.size();
+		while(zStream->avail_in)
+		{
+			if((!zStream->avail_out && !flushOutput()) || deflate(zStream, Z_NO_FLUSH) != Z_OK)
+			{
+				log.error("error compressing state, {} bytes in", inSize);
+				failed = true;
+				return false;
+			}
+		}
+		return true;
+	}
+	#ifdef CONFIG_PACKAGE_ZSTD
+	ZSTD_inBuffer in{src.data(), src.size(), 0};
+	while(in.pos < in.size)
+	{
+		if(outSize == dest.size() && !flushOutput())
+		{
+			log.error("error compressing state:output full");
+			failed = true;
+			return false;
+		}
+		ZSTD_outBuffer out{dest.data(), dest.size(), outSize};
+		auto lastInPos = in.pos, lastOutPos = out.pos;
+		auto res = ZSTD_compressStream2(zstdCtx, &out, &in, ZSTD_e_continue);
+		outSize = out.pos;
+		if(ZSTD_isError(res) || (in.pos == lastInPos && out.pos == lastOutPos))
+		{
+			log.error("error compressing state:{}", ZSTD_isError(res) ? ZSTD_getErrorName(res) : "no progress");
+			failed = true;
+			return false;
+		}
+	}
+	#endif
+	return true;
+}
+
+size_t StateCompressor::finish()
+{
+	if(failed)
+		return 0;
+	if(zStream)
+	{
+		zStream->avail_in = 0;
+		int res = Z_BUF_ERROR;
+		do
+		{
+			if(!zStream->avail_out && !flushOutput())
+				break;
+			res = deflate(zStream, Z_FINISH);
+		} while(res == Z_OK);
+		if(res != Z_STREAM_END)
+		{
+			log.error("error finishing compressed state");
+			failed = true;
+			return 0;
+		}
+	}
+	#ifdef CONFIG_PACKAGE_ZSTD
+	else
+	{
+		ZSTD_inBuffer in{nullptr, 0, 0};
+		size_t remaining;
+		do
+		{
+			if(outSize == dest.size() && !flushOutput())
+			{
+				log.error("error finishing compressed state:output full");
+				failed = true;
+				return 0;
+			}
+			ZSTD_outBuffer out{dest.data(), dest.size(), outSize};
+			auto lastOutPos = out.pos;
+			remaining = ZSTD_compressStream2(zstdCtx, &out, &in, ZSTD_e_end);
+			outSize = out.pos;
+			if(ZSTD_isError(remaining) || (remaining && out.pos == lastOutPos))
+			{
+				log.error("error finishing compressed state:{}", ZSTD_isError(remaining) ? ZSTD_getErrorName(remaining) : "no progress");
+				failed = true;
+				return 0;
+			}
+		} while(remaining);
+	}
+	#endif
+	if(onOutput && !flushOutput())
+	{
+		log.error("error writing compressed state");
+		failed = true;
+		return 0;
+	}
+	return flushedSize + pendingOutputSize();
+}
+
+StateUncompressor::StateUncompressor(std::span<const uint8_t> src, StateCodecType type):
+	src{src},
+	uncompSize{uncompressedStateSize(src, type)}
+{
+	switch(type)
+	{
+		case StateCodecType::Gzip:
+			zStream = new z_stream{};
+			zStream->next_in = const_cast<z_const Bytef*>(src.data());
+			zStream->avail_in = src.size();
+			if(inflateInit2(zStream, MAX_WBITS + 16) != Z_OK)
+				failed = true;
+			return;
+		case StateCodecType::Zstd:
+			#ifdef CONFIG_PACKAGE_ZSTD
+			zstdCtx = ZSTD_createDCtx();
+			if(!zstdCtx) [[unlikely]]
+				failed = true;
+			return;
+			#else
+			break;
+			#endif
+	}
+	failed = true;
+}
+
+StateUncompressor::~StateUncompressor()
+{
+	if(zStream)
+	{
+		inflateEnd(zStream);
+		delete zStream;
+	}
+	#ifdef CONFIG_PACKAGE_ZSTD
+	ZSTD_freeDCtx(zstdCtx);
+	#endif
+}
+
+size_t StateUncompressor::read(std::span<uint8_t> dest)
+{
+	if(failed || ended || dest.empty())
+		return 0;
+	if(zStream)
+	{
+		zStream->next_out = dest.data();
+		zStream->avail_out = dest.size();
+		while(zStream->avail_out)
+		{
+			auto res = inflate(zStream, Z_NO_FLUSH);
+			if(res == Z_STREAM_END)
+			{
+				ended = true;
+				break;
+			}
+			if(res != Z_OK)
+			{
+				log.error("error uncompressing state:{}", zStream->msg ? zStream->msg : "truncated data");
+				failed = true;
+				break;
+			}
+		}
+		return dest.size() - zStream->avail_out;
+	}
+	#ifdef CONFIG_PACKAGE_ZSTD
+	ZSTD_outBuffer out{dest.data(), dest.size(), 0};
+	while(out.pos < out.size)
+	{
+		ZSTD_inBuffer in{src.data(), src.size(), inPos};
+		auto lastOutPos = out.pos;
+		auto res = ZSTD_decompressStream(zstdCtx, &out, &in);
+		bool madeProgress = in.pos != inPos || out.pos != lastOutPos;
+		inPos = in.pos;
+		if(ZSTD_isError(res) || (res && !madeProgress))
+		{
+			log.error("error uncompressing state:{}", ZSTD_isError(res) ? ZSTD_getErrorName(res) : "truncated data");
+			failed = true;
+			break;
+		}
+		if(!res)
+		{
+			ended = true;
+			break;
+		}
+	}
+	return out.pos;
+	#else
+	return 0;
+	#endif
+}
+
+bool StateUncompressor::restart()
+{
+	if(zStream)
+	{
+		if(inflateReset(zStream) != Z_OK)
+			return false;
+		zStream->next_in = const_cast<z_const Bytef*>(src.data());
+		zStream->avail_in = src.size();
+	}
+	#ifdef CONFIG_PACKAGE_ZSTD
+	else if(zstdCtx)
+	{
+		if(ZSTD_isError(ZSTD_DCtx_reset(zstdCtx, ZSTD_reset_session_only)))
+			return false;
+		inPos = 0;
+	}
+	#endif
+	else
+	{
+		return false;
+	}
+	ended = failed = false;
+	return true;
+}
+
+}
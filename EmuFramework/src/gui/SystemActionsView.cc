@@ -49,6 +49,16 @@ static std::string saveAutosaveName(EmuApp &app)
 		duration_cast<Seconds>(autosaveManager.saveTimer.nextFireTime()));
 }
 
+static std::string_view recordInputMovieName(EmuApp &app)
+{
+	return app.inputMovie.isActive() ? "Stop Input Movie" : "Record Input Movie";
+}
+
+static std::string_view frameCaptureName(EmuApp &app)
+{
+	return app.frameCapture.isCapturingSequence() ? "Stop Frame Capture" : "Start Frame Capture";
+}
+
 SystemActionsView::SystemActionsView(ViewAttachParams attach, bool customMenu):
 	TableView{"System Actions", attach, item},
 	cheats
@@ -127,6 +137,40 @@ SystemActionsView::SystemActionsView(ViewAttachParams attach, bool customMenu):
 			pushAndShow(makeView<StateSlotView>(), e);
 		}
 	},
+	recordInputMovie
+	{
+		recordInputMovieName(app()), attach,
+		[this]
+		{
+			if(!system().hasContent())
+				return;
+			if(app().inputMovie.isActive())
+			{
+				app().stopInputMovie();
+				recordInputMovie.compile(recordInputMovieName(app()));
+				return;
+			}
+			if(app().startInputMovieRecording())
+				app().showEmulation();
+		}
+	},
+	playInputMovie
+	{
+		"Play Input Movie", attach,
+		[this]
+		{
+			if(!system().hasContent())
+				return;
+			auto path = app().inputMoviePath();
+			if(!appContext().fileUriExists(path))
+			{
+				app().postMessage("No input movie recorded");
+				return;
+			}
+			if(app().playInputMovie(path))
+				app().showEmulation();
+		}
+	},
 	addLauncherIcon
 	{
 		"Add Content Shortcut To Launcher", attach,
@@ -172,6 +216,23 @@ SystemActionsView::SystemActionsView(ViewAttachParams attach, bool customMenu):
 				}), e);
 		}
 	},
+	frameCapture
+	{
+		frameCaptureName(app()), attach,
+		[this]
+		{
+			if(!system().hasContent())
+				return;
+			if(app().frameCapture.isCapturingSequence())
+			{
+				app().stopFrameCapture();
+				frameCapture.compile(frameCaptureName(app()));
+				return;
+			}
+			if(app().startFrameCapture())
+				app().showEmulation();
+		}
+	},
 	resetSessionOptions
 	{
 		"Reset Saved Options", attach,
@@ -217,6 +278,8 @@ void SystemActionsView::onShow()
 	autosaveNow.compile(saveAutosaveName(app()));
 	autosaveNow.setActive(app().autosaveManager.slotName() != noAutosaveName);
 	revertAutosave.setActive(app().autosaveManager.slotName() != noAutosaveName);
+	recordInputMovie.compile(recordInputMovieName(app()));
+	frameCapture.compile(frameCaptureName(app()));
 	resetSessionOptions.setActive(app().hasSavedSessionOptions());
 }
 
@@ -231,9 +294,12 @@ void SystemActionsView::loadStandardItems()
 	item.emplace_back(&revertAutosave);
 	item.emplace_back(&autosaveNow);
 	item.emplace_back(&stateSlot);
+	item.emplace_back(&recordInputMovie);
+	item.emplace_back(&playInputMovie);
 	if(used(addLauncherIcon))
 		item.emplace_back(&addLauncherIcon);
 	item.emplace_back(&screenshot);
+	item.emplace_back(&frameCapture);
 	item.emplace_back(&resetSessionOptions);
 	item.emplace_back(&close);
 }
@@ -99,6 +99,35 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 			app().confirmOverwriteState = item.flipBoolValue(*this);
 		}
 	},
+	stateCodecItem
+	{
+		{"Gzip",      attach, {.id = StateCodecType::Gzip}},
+		{"Zstandard", attach, {.id = StateCodecType::Zstd}},
+	},
+	stateCodec
+	{
+		"Save State Compression", attach,
+		MenuId{app().stateCodec.value()},
+		stateCodecItem,
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().stateCodec = StateCodecType(item.id.val); }
+		},
+	},
+	stateCompressionLevelItem
+	{
+		{"Default",       attach, {.id = StateCompressionLevel::Default}},
+		{"Fastest",       attach, {.id = StateCompressionLevel::Fast}},
+		{"Smallest Size", attach, {.id = StateCompressionLevel::Best}},
+	},
+	stateCompressionLevel
+	{
+		"Save State Compression Level", attach,
+		MenuId{app().stateCompressionLevel.value()},
+		stateCompressionLevelItem,
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().stateCompressionLevel = StateCompressionLevel(item.id.val); }
+		},
+	},
 	fastModeSpeedItem
 	{
 		{"1.5x",  attach, {.id = 150}},
@@ -177,19 +206,21 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 			.defaultItemOnSelect = [this](TextMenuItem &item) { app().setAltSpeed(AltSpeedMode::slow, item.id); }
 		},
 	},
-	rewindStatesItem
+	rewindMemoryItem
 	{
-		{"0",  attach, {.id = 0}},
-		{"30", attach, {.id = 30}},
-		{"60", attach, {.id = 60}},
+		{"Off", attach, {.id = 0}},
+		{"64MiB", attach, {.id = 64}},
+		{"128MiB", attach, {.id = 128}},
+		{"256MiB", attach, {.id = 256}},
 		{"Custom Value", attach, [this](const Input::Event &e)
 			{
-				pushAndShowNewCollectValueRangeInputView<int, 0, 50000>(attachParams(), e,
-					"Input 0 to 50000", std::to_string(app().rewindManager.maxStates),
+				pushAndShowNewCollectValueRangeInputView<int, 0, 4096>(attachParams(), e,
+					"Input 0 to 4096", std::to_string(app().rewindManager.maxMemoryMiB),
 					[this](CollectTextInputView &, auto val)
 					{
-						app().rewindManager.updateMaxStates(val);
-						rewindStates.setSelected(val, *this);
+						if(!app().rewindManager.updateMaxMemoryMiB(val))
+							app().postErrorMessage(4, "Not enough memory for rewind states");
+						rewindMemory.setSelected(val, *this);
 						dismissPrevious();
 						return true;
 					});
@@ -197,35 +228,78 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 			}, {.id = defaultMenuId}
 		},
 	},
-	rewindStates
+	rewindMemory
 	{
-		"Rewind States", attach,
-		MenuId{app().rewindManager.maxStates},
-		rewindStatesItem,
+		"Rewind Memory", attach,
+		MenuId{app().rewindManager.maxMemoryMiB},
+		rewindMemoryItem,
 		{
 			.onSetDisplayString = [this](auto idx, Gfx::Text &t)
 			{
-				t.resetString(std::format("{}", app().rewindManager.maxStates));
+				if(!app().rewindManager.maxMemoryMiB)
+					return false;
+				t.resetString(std::format("{}MiB", app().rewindManager.maxMemoryMiB));
 				return true;
 			},
-			.defaultItemOnSelect = [this](TextMenuItem &item) { app().rewindManager.updateMaxStates(item.id); }
+			.defaultItemOnSelect = [this](TextMenuItem &item)
+			{
+				if(!app().rewindManager.updateMaxMemoryMiB(item.id))
+					app().postErrorMessage(4, "Not enough memory for rewind states");
+			}
 		},
 	},
-	rewindTimeInterval
+	rewindFrameInterval
 	{
-		"Rewind State Interval (Seconds)", std::to_string(app().rewindManager.saveTimer.frequency.count()), attach,
+		"Rewind State Interval (Frames)", std::to_string(app().rewindManager.frameInterval), attach,
 		[this](const Input::Event &e)
 		{
-			pushAndShowNewCollectValueRangeInputView<int, 1, 60>(attachParams(), e,
-				"Input 1 to 60", std::to_string(app().rewindManager.saveTimer.frequency.count()),
+			pushAndShowNewCollectValueRangeInputView<int, 1, RewindManager::maxRewindFrameInterval>(attachParams(), e,
+				"Input 1 to 3600", std::to_string(app().rewindManager.frameInterval),
 				[this](CollectTextInputView &, auto val)
 				{
-					app().rewindManager.saveTimer.frequency = Seconds{val};
-					rewindTimeInterval.set2ndName(std::to_string(val));
+					app().rewindManager.frameInterval = val;
+					rewindFrameInterval.set2ndName(std::to_string(val));
 					return true;
 				});
 		}
 	},
+	runAheadItem
+	{
+		{"Off", attach, {.id = 0}},
+		{"1",   attach, {.id = 1}},
+		{"2",   attach, {.id = 2}},
+		{"3",   attach, {.id = 3}},
+		{"4",   attach, {.id = 4}},
+	},
+	runAhead
+	{
+		"Run-Ahead Frames", attach,
+		MenuId{app().runAheadManager.frames},
+		runAheadItem,
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item)
+			{
+				if(!app().runAheadManager.updateFrames(item.id))
+					app().postErrorMessage(4, "Not enough memory for run-ahead state");
+			}
+		},
+	},
+	captureFrameIntervalItem
+	{
+		{"Every Frame",     attach, {.id = 1}},
+		{"Every 2nd Frame", attach, {.id = 2}},
+		{"Every 3rd Frame", attach, {.id = 3}},
+		{"Every 4th Frame", attach, {.id = 4}},
+	},
+	captureFrameInterval
+	{
+		"Frame Capture Interval", attach,
+		MenuId{app().captureFrameInterval.value()},
+		captureFrameIntervalItem,
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item) { app().captureFrameInterval = item.id; }
+		},
+	},
 	performanceMode
 	{
 		"Performance Mode", attach,
@@ -266,10 +340,16 @@ void SystemOptionView::loadStockItems()
 	item.emplace_back(&autosaveTimer);
 	item.emplace_back(&autosaveContent);
 	item.emplace_back(&confirmOverwriteState);
+	if(stateCodecIsAvailable(StateCodecType::Zstd))
+		item.emplace_back(&stateCodec);
+	item.emplace_back(&stateCompressionLevel);
 	item.emplace_back(&fastModeSpeed);
 	item.emplace_back(&slowModeSpeed);
-	item.emplace_back(&rewindStates);
-	item.emplace_back(&rewindTimeInterval);
+	item.emplace_back(&rewindMemory);
+	item.emplace_back(&rewindFrameInterval);
+	if(EmuSystem::canRunAhead)
+		item.emplace_back(&runAhead);
+	item.emplace_back(&captureFrameInterval);
 	if(used(performanceMode) && appContext().hasSustainedPerformanceMode())
 		item.emplace_back(&performanceMode);
 	if(used(noopThread))
@@ -19,6 +19,7 @@
 #include <imagine/io/FileIO.hh>
 #include <imagine/util/ScopeGuard.hh>
 #include <imagine/util/format.hh>
+#include <imagine/util/string/uri.hh>
 #include <imagine/logger/logger.h>
 #include <vector>
 
@@ -107,4 +108,74 @@ bool hasWriteAccessToDir(CStringView path)
 	}
 }
 
+static FS::PathString replacementUri(CStringView uri)
+{
+	FS::PathString tmpUri{uri};
+	tmpUri.append(".tmp");
+	return tmpUri;
+}
+
+// Writes the new file next to the existing one and only replaces it once writeFile() succeeds.
+// Document providers can't rename over an existing file, so for URIs the old file is removed just
+// before the rename and restoreReplacedFileUri() picks up the new one if that gets interrupted.
+bool replaceFileUri(ApplicationContext ctx, CStringView uri, DelegateFunc<bool(FileIO &)> writeFile)
+{
+	auto writeNewFile = [&](CStringView writeUri)
+	{
+		auto file = ctx.openFileUri(writeUri, OpenFlags::newFile());
+		try
+		{
+			if(writeFile(file))
+			{
+				file.sync();
+				return true;
+			}
+		}
+		catch(...)
+		{
+			file = {};
+			ctx.removeFileUri(writeUri);
+			throw;
+		}
+		file = {};
+		ctx.removeFileUri(writeUri);
+		return false;
+	};
+	if(isUri(uri) && ctx.androidSDK() < 24)
+	{
+		// document URIs can't be renamed on this OS version, so the file is written in place
+		return writeNewFile(uri);
+	}
+	auto tmpUri = replacementUri(uri);
+	if(!writeNewFile(tmpUri))
+		return false;
+	if(isUri(uri) && ctx.fileUriExists(uri) && !ctx.removeFileUri(uri))
+	{
+		ctx.removeFileUri(tmpUri);
+		return false;
+	}
+	if(!ctx.renameFileUri(tmpUri, uri))
+	{
+		log.error("error renaming {} to {}", tmpUri, uri);
+		// the old file is already gone from a URI, so keep the new one for restoreReplacedFileUri()
+		if(!isUri(uri))
+			ctx.removeFileUri(tmpUri);
+		return false;
+	}
+	return true;
+}
+
+void restoreReplacedFileUri(ApplicationContext ctx, CStringView uri)
+{
+	// file paths are renamed over the old file, so only URIs can be left without one
+	if(!isUri(uri) || ctx.fileUriExists(uri))
+		return;
+	auto tmpUri = replacementUri(uri);
+	if(ctx.fileUriExists(tmpUri))
+	{
+		log.info("restoring interrupted write of:{}", uri);
+		ctx.renameFileUri(tmpUri, uri);
+	}
+}
+
 }
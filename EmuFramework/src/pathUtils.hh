@@ -15,10 +15,12 @@
 
 #include <vector>
 #include <imagine/util/string/CStringView.hh>
+#include <imagine/util/DelegateFunc.hh>
 
 namespace IG
 {
 class ApplicationContext;
+class FileIO;
 }
 
 namespace IG::FS
@@ -37,5 +39,7 @@ std::vector<FS::PathString> subDirectoryStrings(ApplicationContext, CStringView
 void flattenSubDirectories(ApplicationContext, const std::vector<FS::PathString> &subDirs, CStringView outPath);
 void updateLegacySavePathOnStoragePath(IG::ApplicationContext, EmuSystem &);
 bool hasWriteAccessToDir(CStringView path);
+bool replaceFileUri(ApplicationContext, CStringView uri, DelegateFunc<bool(FileIO &)> writeFile);
+void restoreReplacedFileUri(ApplicationContext, CStringView uri);
 
 }
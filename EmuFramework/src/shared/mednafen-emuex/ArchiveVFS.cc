@@ -18,13 +18,29 @@
 #include <imagine/fs/ArchiveFS.hh>
 #include <imagine/fs/FS.hh>
 #include <imagine/io/MapIO.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/base/ApplicationContext.hh>
 #include <imagine/util/format.hh>
 #include <imagine/logger/logger.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace EmuEx
+{
+IG::ApplicationContext gAppContext();
+}
 
 namespace Mednafen
 {
 
 constexpr IG::SystemLogger log{"ArchiveVFS"};
+constexpr std::string_view diskCacheDirName{"archivedDiscs"};
+constexpr std::string_view diskCacheMarkerName{".complete"}; // holds the directory's total size, written last
+constexpr size_t extractBufferSize = 1024 * 1024;
+
+uint64 ArchiveVFS::DiskCacheMaxBytes = uint64(4) * 1024 * 1024 * 1024;
 
 ArchiveVFS::ArchiveVFS(IG::ArchiveIO arch):
 	VirtualFS('/', "/"),
@@ -66,6 +82,148 @@ void ArchiveVFS::seekFile(const std::string& path)
 	}
 }
 
+static void removeDirectory(IG::CStringView path)
+{
+	for(auto &e : IG::FS::directory_iterator{path})
+	{
+		IG::FS::remove(e.path());
+	}
+	IG::FS::remove(path);
+}
+
+static void writeDiskCacheMarker(IG::CStringView dirPath, uint64 size)
+{
+	// rewriting the marker also updates its modification time for LRU eviction
+	IG::FileIO markerFile{IG::FS::pathString(dirPath, diskCacheMarkerName), IG::OpenFlags::newFile()};
+	markerFile.put(size);
+}
+
+static void evictDiskCache(IG::CStringView cachePath, uint64 neededBytes)
+{
+	struct CacheDir
+	{
+		IG::FS::PathString path;
+		IG::FS::file_time_type lastUse;
+		uint64 size;
+	};
+	std::vector<CacheDir> dirs;
+	uint64 totalSize{};
+	for(auto &e : IG::FS::directory_iterator{cachePath})
+	{
+		if(e.type() != IG::FS::file_type::directory)
+			continue;
+		auto markerPath = IG::FS::pathString(e.path(), diskCacheMarkerName);
+		if(!IG::FS::exists(markerPath))
+		{
+			log.info("removing incomplete cache directory:{}", e.path());
+			removeDirectory(e.path());
+			continue;
+		}
+		auto size = IG::FileIO{markerPath, {.read = true}}.get<uint64>();
+		dirs.push_back({e.path(), IG::FS::status(markerPath).lastWriteTime(), size});
+		totalSize += size;
+	}
+	std::ranges::sort(dirs, [](auto &a, auto &b){ return a.lastUse < b.lastUse; });
+	for(auto &dir : dirs)
+	{
+		if(totalSize + neededBytes <= ArchiveVFS::DiskCacheMaxBytes)
+			break;
+		log.info("evicting cache directory:{} ({} bytes)", dir.path, dir.size);
+		removeDirectory(dir.path);
+		totalSize -= std::min(dir.size, totalSize);
+	}
+}
+
+std::string ArchiveVFS::extractToDiskCache()
+{
+	auto cacheBasePath = EmuEx::gAppContext().cachePath();
+	if(cacheBasePath.empty())
+		return {};
+	// identify the archive contents by the name, size, and CRC of every file using FNV-1a
+	uint64 key = 0xcbf29ce484222325;
+	auto hashBytes = [&](const void *data, size_t size)
+	{
+		for(auto b : std::span{static_cast<const uint8*>(data), size})
+		{
+			key = (key ^ b) * 0x100000001b3;
+		}
+	};
+	uint64 totalSize{};
+	std::vector<std::string> names;
+	arch.rewind();
+	arch.forAllEntries([&](auto &)
+	{
+		if(arch.type() == IG::FS::file_type::directory)
+			return;
+		auto name = IG::FS::basename(arch.name());
+		auto size = uint64(arch.size());
+		auto crc = arch.crc32();
+		hashBytes(name.data(), name.size());
+		hashBytes(&size, sizeof(size));
+		hashBytes(&crc, sizeof(crc));
+		totalSize += size;
+		names.emplace_back(name);
+	});
+	if(!totalSize || totalSize > DiskCacheMaxBytes)
+		return {};
+	// files are extracted into a single directory by name, so entries in different
+	// sub-directories with the same name (like one per disc) would overwrite each other
+	std::ranges::sort(names);
+	if(auto it = std::ranges::adjacent_find(names); it != names.end())
+	{
+		log.info("not caching archive with multiple files named:{}", *it);
+		return {};
+	}
+	auto cachePath = IG::FS::createDirectorySegments(cacheBasePath, diskCacheDirName);
+	auto dirName = std::format("{:016x}", key);
+	auto dirPath = IG::FS::pathString(cachePath, dirName);
+	try
+	{
+		if(IG::FS::exists(IG::FS::pathString(dirPath, diskCacheMarkerName)))
+		{
+			log.info("using cached archive contents in:{}", dirPath);
+			writeDiskCacheMarker(dirPath, totalSize);
+			return std::string{dirPath};
+		}
+		evictDiskCache(cachePath, totalSize);
+		auto tempPath = IG::FS::pathString(cachePath, dirName + ".tmp");
+		if(IG::FS::exists(tempPath))
+			removeDirectory(tempPath);
+		IG::FS::create_directory(tempPath);
+		log.info("extracting {} bytes to:{}", totalSize, tempPath);
+		auto buff = std::make_unique<uint8[]>(extractBufferSize);
+		arch.rewind();
+		arch.forAllEntries([&](auto &)
+		{
+			if(arch.type() == IG::FS::file_type::directory)
+				return;
+			IG::FileIO file{IG::FS::pathString(tempPath, IG::FS::basename(arch.name())), IG::OpenFlags::newFile()};
+			while(true)
+			{
+				auto bytesRead = arch.read(buff.get(), extractBufferSize);
+				if(bytesRead == -1)
+					throw MDFN_Error(0, "Error reading archive file:\n%s", arch.name().data());
+				if(!bytesRead)
+					break;
+				if(file.write(buff.get(), bytesRead) != bytesRead)
+					throw MDFN_Error(0, "Error writing cache file for:\n%s", arch.name().data());
+			}
+		});
+		writeDiskCacheMarker(tempPath, totalSize);
+		if(!IG::FS::rename(tempPath, dirPath))
+			throw MDFN_Error(0, "Error renaming cache directory");
+		return std::string{dirPath};
+	}
+	catch(std::exception &err)
+	{
+		log.error("can't cache archive contents:{}", err.what());
+		auto tempPath = IG::FS::pathString(cachePath, dirName + ".tmp");
+		if(IG::FS::exists(tempPath))
+			removeDirectory(tempPath);
+		return {};
+	}
+}
+
 int ArchiveVFS::mkdir(const std::string& path, const bool throw_on_exist, const bool throw_on_noent) { return -1; }
 bool ArchiveVFS::unlink(const std::string &path, const bool throw_on_noent, const CanaryType canary) { return false; }
 void ArchiveVFS::rename(const std::string &oldpath, const std::string &newpath, const CanaryType canary) {}
@@ -36,6 +36,14 @@ public:
 	void readdirentries(const std::string& path, std::function<bool(const std::string&)> callb) final;
 	std::string get_human_path(const std::string& path) final;
 
+	// Extracts the archive's files once into a cache directory named after their names, sizes, and CRCs so
+	// disc images can be streamed from disk with NVFS instead of decompressed into memory on every launch.
+	// The least recently used directories are removed when the cache grows past DiskCacheMaxBytes.
+	// Returns the directory path, or an empty string if the archive can't be cached.
+	std::string extractToDiskCache();
+
+	static uint64 DiskCacheMaxBytes;
+
 private:
 	IG::ArchiveIO arch;
 
@@ -169,4 +169,22 @@ int CDAccess_CHD::Read_Sector(uint8 *buf, int32 lba, uint32 size)
 	return readSector(*this, buf, lba, size);
 }
 
+void CDAccess_CHD::HintReadSector(int32 lba, int32 count)
+{
+	for(int32 track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+	{
+		CHDFILE_TRACK_INFO *ct = &Tracks[track];
+
+		if(lba >= (ct->LBA - ct->pregap_dv) && lba < (ct->LBA + ct->sectors))
+		{
+			// start decompressing on the read-ahead thread, the following hunks are queued as they're read
+			auto hunknum = HunkForLBA(lba, ct);
+			std::lock_guard cacheLock{cache_mutex};
+			if(!FindCachedHunk(hunknum))
+				RequestReadAhead(hunknum);
+			return;
+		}
+	}
+}
+
 }
@@ -30,6 +30,7 @@
 #include <mednafen/cdrom/CDInterface.h>
 #include <main/MainSystem.hh>
 #include <string_view>
+#include <algorithm>
 
 namespace Mednafen
 {
@@ -166,10 +167,42 @@ inline void runFrame(EmuSystem &sys, Mednafen::MDFNGI &mdfnGameInfo, EmuSystemTa
 
 // Save states
 
+// Write-only stream that tracks the position and size of written data without storing it,
+// used to size a state without serializing it into memory
+class SizeCountStream final : public Mednafen::Stream
+{
+public:
+	uint64 attributes() override { return ATTRIBUTE_WRITEABLE | ATTRIBUTE_SEEKABLE | ATTRIBUTE_INMEM_FAST; }
+	uint64 read(void *, uint64, bool) override { throw std::runtime_error("SizeCountStream can't be read"); }
+	void write(const void *, uint64 count) override
+	{
+		pos += count;
+		size_ = std::max(size_, pos);
+	}
+	void truncate(uint64 length) override { size_ = length; }
+	void seek(int64 offset, int whence) override
+	{
+		switch(whence)
+		{
+			case SEEK_SET: pos = offset; break;
+			case SEEK_CUR: pos += offset; break;
+			case SEEK_END: pos = size_ + offset; break;
+		}
+	}
+	uint64 tell() override { return pos; }
+	uint64 size() override { return size_; }
+	void flush() override {}
+	void close() override {}
+
+private:
+	uint64 pos{};
+	uint64 size_{};
+};
+
 inline size_t stateSizeMDFN()
 {
 	using namespace Mednafen;
-	MemoryStream s;
+	SizeCountStream s;
 	MDFNSS_SaveSM(&s);
 	return s.size();
 }
@@ -198,7 +231,7 @@ inline void readStateMDFN(EmuApp &app, std::span<uint8_t> buff)
 	}
 }
 
-inline size_t writeStateMDFN(std::span<uint8_t> buff, SaveStateFlags flags)
+inline size_t writeStateMDFN(EmuSystem &sys, std::span<uint8_t> buff, SaveStateFlags flags)
 {
 	using namespace Mednafen;
 	if(flags.uncompressed)
@@ -209,9 +242,11 @@ inline size_t writeStateMDFN(std::span<uint8_t> buff, SaveStateFlags flags)
 	}
 	else
 	{
-		MemoryStream s;
+		// buff is sized from stateSize() so it also bounds the uncompressed data
+		auto stateBuff = sys.stateScratchBuffer(buff.size());
+		FileStream s{stateBuff};
 		MDFNSS_SaveSM(&s);
-		return compressGzip(buff, {s.map(), size_t(s.size())}, MDFN_GetSettingI("filesys.state_comp_level"));
+		return compressGzip(buff, stateBuff.first(s.tell()), MDFN_GetSettingI("filesys.state_comp_level"));
 	}
 }
 
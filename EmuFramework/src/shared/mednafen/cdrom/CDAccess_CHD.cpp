@@ -23,6 +23,7 @@
 #include <mednafen/general.h>
 
 #include <stdio.h>
+#include <algorithm>
 
 #include "CDAccess_CHD.h"
 
@@ -57,6 +58,9 @@ static const int32_t DI_Size_Table[8] =
         2352  // CD-I RAW
 };
 
+unsigned CDAccess_CHD::HunkCacheSize = 32;
+unsigned CDAccess_CHD::ReadAheadHunks = 4;
+
 CDAccess_CHD::CDAccess_CHD(VirtualFS* vfs, const std::string &path, bool image_memcache) : NumTracks(0), total_sectors(0)
 {
   Load(vfs, path, image_memcache);
@@ -83,10 +87,14 @@ void CDAccess_CHD::Load(VirtualFS* vfs, const std::string &path, bool image_memc
 
   /* allocate storage for sector reads */
   const chd_header *head = chd_get_header(chd);
-  hunkmem = (uint8_t *)malloc(head->hunkbytes);
-  oldhunk = -1;
+  hunkbytes = head->hunkbytes;
+  totalhunks = head->totalhunks;
+  hunk_cache.resize(std::max(HunkCacheSize, 1u));
+  for (auto &entry : hunk_cache)
+    entry.data.reset(new uint8_t[hunkbytes]);
+  miss_hunkmem.reset(new uint8_t[hunkbytes]);
 
-  MDFN_printf("chd_load '%s' hunkbytes=%d\n", path.c_str(), head->hunkbytes);
+  MDFN_printf("chd_load '%s' hunkbytes=%d cached hunks=%d\n", path.c_str(), head->hunkbytes, (int)hunk_cache.size());
 
   int plba = -150;
   int numsectors = 0;
@@ -209,87 +217,192 @@ void CDAccess_CHD::Load(VirtualFS* vfs, const std::string &path, bool image_memc
       assert(Tracks[x].index[i] >= 0);
     }
   }
+
+  StartReadAhead();
 }
 
 CDAccess_CHD::~CDAccess_CHD()
 {
+  StopReadAhead();
+
   if (chd != NULL)
     chd_close(chd);
+}
+
+void CDAccess_CHD::StartReadAhead(void)
+{
+  if (!ReadAheadHunks)
+    return;
 
-  if (hunkmem)
-    free(hunkmem);
+  read_ahead_hunkmem.reset(new uint8_t[hunkbytes]);
+  read_ahead_quit = false;
+  read_ahead_thread = std::thread([this]() { ReadAheadThreadLoop(); });
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+void CDAccess_CHD::StopReadAhead(void)
 {
-  const chd_header *head = chd_get_header(chd);
-  int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
-
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  if (!read_ahead_thread.joinable())
+    return;
+
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-    	MDFN_printf("chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+    read_ahead_quit = true;
   }
+  read_ahead_cond.notify_one();
+  read_ahead_thread.join();
+}
+
+//
+// Decompresses the hunks queued by RequestReadAhead() so sequential reads are served from the cache
+//
+void CDAccess_CHD::ReadAheadThreadLoop(void)
+{
+  std::unique_lock<std::mutex> cache_lock(cache_mutex);
+
+  while (1)
+  {
+    read_ahead_cond.wait(cache_lock, [this]() { return read_ahead_quit || read_ahead_next < read_ahead_end; });
 
-  memcpy(buf, hunkmem + hunkofs * (2352 + 96), 2352);
+    if (read_ahead_quit)
+      return;
 
-  return err;
+    const int32_t hunknum = read_ahead_next++;
+
+    if (FindCachedHunk(hunknum))
+      continue;
+
+    cache_lock.unlock();
+    {
+      std::lock_guard<std::mutex> chd_lock(chd_mutex);
+      cache_lock.lock();
+      // the reading thread may have decompressed it while waiting for chd_mutex
+      const bool cached = FindCachedHunk(hunknum);
+      cache_lock.unlock();
+
+      if (!cached)
+      {
+        const chd_error err = chd_read(chd, hunknum, read_ahead_hunkmem.get());
+
+        cache_lock.lock();
+        if (err == CHDERR_NONE)
+          InsertCachedHunk(hunknum, read_ahead_hunkmem);
+        else
+          read_ahead_end = read_ahead_next; // leave the error for the reading thread to report
+        cache_lock.unlock();
+      }
+    }
+    cache_lock.lock();
+  }
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+CDAccess_CHD::HunkCacheEntry* CDAccess_CHD::FindCachedHunk(int32_t hunknum)
 {
-  const chd_header *head = chd_get_header(chd);
-  int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
-
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  for (auto &entry : hunk_cache)
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-    	MDFN_printf("chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    if (entry.hunknum == hunknum)
+      return &entry;
   }
 
-  memcpy(buf + 16, hunkmem + hunkofs * (2352 + 96), 2048);
+  return NULL;
+}
+
+void CDAccess_CHD::InsertCachedHunk(int32_t hunknum, std::unique_ptr<uint8_t[]>& data)
+{
+  HunkCacheEntry* lru = &hunk_cache[0];
 
-  return err;
+  for (auto &entry : hunk_cache)
+  {
+    if (entry.lastUse < lru->lastUse)
+      lru = &entry;
+  }
+
+  // swap buffers so the caller's one can be reused for the next decompression
+  lru->data.swap(data);
+  lru->hunknum = hunknum;
+  lru->lastUse = ++hunk_use_counter;
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+void CDAccess_CHD::RequestReadAhead(int32_t hunknum)
 {
-  const chd_header *head = chd_get_header(chd);
-  int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
-
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  if (!read_ahead_thread.joinable() || hunknum >= (int32_t)totalhunks)
+    return;
+
+  read_ahead_next = hunknum;
+  read_ahead_end = std::min<int32_t>(hunknum + ReadAheadHunks, totalhunks);
+  read_ahead_cond.notify_one();
+}
+
+int32_t CDAccess_CHD::HunkForLBA(int32_t lba, const CHDFILE_TRACK_INFO* track) const
+{
+  const int32_t cad = lba - track->LBA + track->fileOffset;
+  const int32_t sph = hunkbytes / (2352 + 96);
+
+  return cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk(uint8_t *buf, uint32_t size, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  const int32_t cad = lba - track->LBA + track->fileOffset;
+  const int32_t sph = hunkbytes / (2352 + 96);
+  const int32_t hunknum = cad / sph;
+  const int32_t hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
+
   {
-    err = chd_read(chd, hunknum, hunkmem);
+    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+
+    if (HunkCacheEntry* entry = FindCachedHunk(hunknum))
+    {
+      entry->lastUse = ++hunk_use_counter;
+      memcpy(buf, entry->data.get() + hunkofs * (2352 + 96), size);
+      RequestReadAhead(hunknum + 1);
+      return true;
+    }
+  }
+
+  //
+  // Cache miss, decompress on this thread
+  //
+  std::lock_guard<std::mutex> chd_lock(chd_mutex);
+  std::lock_guard<std::mutex> cache_lock(cache_mutex);
+
+  // the read-ahead thread may have finished this hunk while waiting for chd_mutex
+  HunkCacheEntry* entry = FindCachedHunk(hunknum);
+
+  if (!entry)
+  {
+    const chd_error err = chd_read(chd, hunknum, miss_hunkmem.get());
+
     if (err != CHDERR_NONE)
-    	MDFN_printf("chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    {
+      MDFN_printf("chd_read_sector failed lba=%d error=%d\n", lba, err);
+      memset(buf, 0, size);
+      return false;
+    }
+
+    InsertCachedHunk(hunknum, miss_hunkmem);
+    entry = FindCachedHunk(hunknum);
   }
 
-  memcpy(buf + 16, hunkmem + hunkofs * (2352 + 96), 2336);
+  entry->lastUse = ++hunk_use_counter;
+  memcpy(buf, entry->data.get() + hunkofs * (2352 + 96), size);
+  RequestReadAhead(hunknum + 1);
+
+  return true;
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk(buf, 2352, lba, track);
+}
 
-  return err;
+bool CDAccess_CHD::Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk(buf + 16, 2048, lba, track);
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  return Read_CHD_Hunk(buf + 16, 2336, lba, track);
 }
 
 int CDAccess_CHD::Read_Raw_Sector(uint8 *buf, int32 lba)
@@ -25,6 +25,12 @@
 #include "CDAccess.h"
 #include <libchdr/chd.h>
 
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 namespace Mednafen
 {
 
@@ -66,10 +72,15 @@ class CDAccess_CHD final : public CDAccess
 
  void Read_TOC(CDUtility::TOC *toc) final;
 
- void HintReadSector(int32 lba, int32 count) final {};
+ void HintReadSector(int32 lba, int32 count) final;
 
  int Read_Sector(uint8 *buf, int32 lba, uint32 size) final;
 
+ // Number of decompressed hunks kept in the LRU cache and how many hunks past the last one read are
+ // decompressed ahead of time on a separate thread (0 disables it), applied to images opened afterwards
+ static unsigned HunkCacheSize;
+ static unsigned ReadAheadHunks;
+
  private:
 
  void Load(VirtualFS* vfs, const std::string& path, bool image_memcache);
@@ -78,9 +89,27 @@ class CDAccess_CHD final : public CDAccess
   // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
   int32_t MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const;
 
+  struct HunkCacheEntry
+  {
+   int32_t hunknum = -1;
+   uint32_t lastUse = 0;
+   std::unique_ptr<uint8_t[]> data;
+  };
+
+  bool Read_CHD_Hunk(uint8_t *buf, uint32_t size, int32_t lba, CHDFILE_TRACK_INFO* track);
   bool Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
   bool Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
   bool Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
+  int32_t HunkForLBA(int32_t lba, const CHDFILE_TRACK_INFO* track) const;
+
+  // The following require cache_mutex to be held
+  HunkCacheEntry* FindCachedHunk(int32_t hunknum);
+  void InsertCachedHunk(int32_t hunknum, std::unique_ptr<uint8_t[]>& data);
+  void RequestReadAhead(int32_t hunknum);
+
+  void StartReadAhead(void);
+  void StopReadAhead(void);
+  void ReadAheadThreadLoop(void);
 
   int32_t NumTracks;
   int32_t FirstTrack;
@@ -97,10 +126,24 @@ class CDAccess_CHD final : public CDAccess
   int num_tracks;
 
   chd_file *chd;
-  /* hunk data cache */
-  uint8_t *hunkmem;
-  /* last hunknum read */
-  int oldhunk;
+  uint32_t hunkbytes;
+  uint32_t totalhunks;
+
+  /* decompressed hunk LRU cache, shared with the read-ahead thread */
+  std::vector<HunkCacheEntry> hunk_cache;
+  uint32_t hunk_use_counter = 0;
+  /* output buffer for hunks decompressed on the reading thread after a cache miss */
+  std::unique_ptr<uint8_t[]> miss_hunkmem;
+
+  /* lock order is chd_mutex, then cache_mutex */
+  std::mutex chd_mutex; // serializes chd_read()
+  std::mutex cache_mutex;
+  std::condition_variable read_ahead_cond;
+  std::thread read_ahead_thread;
+  std::unique_ptr<uint8_t[]> read_ahead_hunkmem;
+  int32_t read_ahead_next = 0;
+  int32_t read_ahead_end = 0;
+  bool read_ahead_quit = false;
 };
 
 }
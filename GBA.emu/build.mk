@@ -42,6 +42,9 @@ main/input.cc \
 main/EmuMenuViews.cc \
 main/VbamApi.cc \
 main/Cheats.cc \
+main/GBALineRenderer.cc \
+main/GBAIdleLoop.cc \
+main/GBAJit.cc \
 $(addprefix $(vbamPath)/,$(vbamSrc))
 
 include $(EMUFRAMEWORK_PATH)/package/emuframework.mk
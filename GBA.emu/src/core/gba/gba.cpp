@@ -702,15 +702,19 @@ void CPUUpdateRenderBuffers(GBASys &gba, bool force)
 {
   if (!(layerEnable & 0x0100) || force) {
     CLEAR_ARRAY(g_line0);
+    gba.lcd.pendingLineClears |= 1;
   }
   if (!(layerEnable & 0x0200) || force) {
   	CLEAR_ARRAY(g_line1);
+    gba.lcd.pendingLineClears |= 2;
   }
   if (!(layerEnable & 0x0400) || force) {
   	CLEAR_ARRAY(g_line2);
+    gba.lcd.pendingLineClears |= 4;
   }
   if (!(layerEnable & 0x0800) || force) {
   	CLEAR_ARRAY(g_line3);
+    gba.lcd.pendingLineClears |= 8;
   }
 }
 
@@ -758,6 +762,7 @@ bool CPUReadState(GBASys &gba, const uint8_t* data)
 {
 	  auto &cpu = gba.cpu;
 	  auto &g_ioMem = cpu.gba->mem.ioMem.b;
+	  gba.lineRenderer.flush(gba.lcd);
     // Don't really care about version.
     int version = utilReadIntMem(data);
     if (version != SAVE_GAME_VERSION)
@@ -832,6 +837,7 @@ bool CPUReadState(GBASys &gba, const uint8_t* data)
     }
 
     CPUUpdateRegister(gba.cpu, 0x204, CPUReadHalfWordQuick(gba.cpu, 0x4000204));
+    gba.jit.revalidate(gba.cpu);
 
     return true;
 }
@@ -3422,6 +3428,9 @@ void CPUReset(GBASys &gba)
 {
 	auto &cpu = gba.cpu;
 	auto &g_ioMem = cpu.gba->mem.ioMem;
+	gba.lineRenderer.flush(gba.lcd);
+	cpu.idleLoop.reset();
+	gba.jit.flush();
   switch (CheckEReaderRegion()) {
   case 1: //US
       EReaderWriteMemory(0x8009134, 0x46C0DFE0);
@@ -3727,6 +3736,7 @@ void CPULoop(GBASys &gba, EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo *
   int timerOverflow = 0;
   // variable used by the CPU core
   cpuTotalTicks = 0;
+  cpu.idleLoop.epoch++;
 
 #ifndef NO_LINK
 // shuffle2: what's the purpose?
@@ -3743,7 +3753,7 @@ void CPULoop(GBASys &gba, EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo *
     if (!holdState && !SWITicks) {
       if (armState) {
       	armOpcodeCount++;
-        if (!armExecute(cpu))
+        if (!(gba.jit.isActive() ? gba.jit.execute(cpu) : armExecute(cpu)))
         {
 #ifdef VBAM_ENABLE_DEBUGGER
           return;
@@ -3753,7 +3763,7 @@ void CPULoop(GBASys &gba, EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo *
         	return;
       } else {
       	thumbOpcodeCount++;
-        if (!thumbExecute(cpu))
+        if (!(gba.jit.isActive() ? gba.jit.execute(cpu) : thumbExecute(cpu)))
         {
 #ifdef VBAM_ENABLE_DEBUGGER
           return;
@@ -3783,6 +3793,7 @@ void CPULoop(GBASys &gba, EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo *
 
       clockTicks = cpuNextEvent;
       cpuTotalTicks = 0;
+      cpu.idleLoop.onEvent(clockTicks);
 
     updateLoop:
 
@@ -4053,13 +4064,17 @@ void CPULoop(GBASys &gba, EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo *
             	else
             	{
             	}*/
-              (*gba.lcd.renderLine)(gba.lcd.lineMix, gba.lcd, ioMem);
+              if (gba.lineRenderer.isActive())
+                gba.lineRenderer.renderLine(gba.lcd, ioMem);
+              else
+                (*gba.lcd.renderLine)(gba.lcd.lineMix, gba.lcd, ioMem);
             }
             if (VCOUNT == 159)
             {
             	cpuBreakLoop = true;
               if (video)
               {
+            	  gba.lineRenderer.waitForFrame();
             	  systemDrawScreen(taskCtx, *video);
             	  video = nullptr;
               }
@@ -310,11 +310,22 @@ uint8_t v3_deadtable2[256] = {
 
 #define CHEAT_IS_HEX(a) (((a) >= 'A' && (a) <= 'F') || ((a) >= '0' && (a) <= '9'))
 
+// patches are reapplied every frame, only drop recompiled code when the value changes
 #define CHEAT_PATCH_ROM_16BIT(a, v) \
-  WRITE16LE(((uint16_t*)&g_rom[(a)&0x1ffffff]), v);
+  do { \
+    if (READ16LE(((uint16_t*)&g_rom[(a)&0x1ffffff])) != (uint16_t)(v)) { \
+      WRITE16LE(((uint16_t*)&g_rom[(a)&0x1ffffff]), v); \
+      cpu.gba->jit.invalidate(0x08000000 | ((a)&0x1ffffff), 2); \
+    } \
+  } while (0);
 
 #define CHEAT_PATCH_ROM_32BIT(a, v) \
-  WRITE32LE(((uint32_t*)&g_rom[(a)&0x1ffffff]), v);
+  do { \
+    if (READ32LE(((uint32_t*)&g_rom[(a)&0x1ffffff])) != (uint32_t)(v)) { \
+      WRITE32LE(((uint32_t*)&g_rom[(a)&0x1ffffff]), v); \
+      cpu.gba->jit.invalidate(0x08000000 | ((a)&0x1ffffff), 4); \
+    } \
+  } while (0);
 
 static bool isMultilineWithData(int i)
 {
@@ -2602,6 +2602,8 @@ static INSN_REGPARM void armA00(ARM7TDMI &cpu, uint32_t opcode, int &clockTicks)
     ARM_PREFETCH;
     clockTicks = (codeTicksAccessSeq32(armNextPC) * 2) + codeTicksAccess32(armNextPC) + 3;
     busPrefetchCount = 0;
+    if (offset < 0 && cpu.skipIdleLoops)
+        cpu.checkIdleLoop(armNextPC - offset - 8);
 }
 
 // BL <offset>
@@ -2846,11 +2848,51 @@ static void tester(void) {
 }
 #endif
 
-int armExecute(ARM7TDMI &cpu)
+[[gnu::always_inline]] static inline bool armConditionPassed(ARM7TDMI &cpu, int cond)
+{
+    switch (cond) {
+      case 0x00: // EQ
+        return Z_FLAG;
+      case 0x01: // NE
+        return !Z_FLAG;
+      case 0x02: // CS
+        return C_FLAG;
+      case 0x03: // CC
+        return !C_FLAG;
+      case 0x04: // MI
+        return N_FLAG;
+      case 0x05: // PL
+        return !N_FLAG;
+      case 0x06: // VS
+        return V_FLAG;
+      case 0x07: // VC
+        return !V_FLAG;
+      case 0x08: // HI
+        return C_FLAG && !Z_FLAG;
+      case 0x09: // LS
+        return !C_FLAG || Z_FLAG;
+      case 0x0A: // GE
+        return N_FLAG == V_FLAG;
+      case 0x0B: // LT
+        return N_FLAG != V_FLAG;
+      case 0x0C: // GT
+        return !Z_FLAG && (N_FLAG == V_FLAG);
+      case 0x0D: // LE
+        return Z_FLAG || (N_FLAG != V_FLAG);
+      case 0x0E: // AL
+        return true;
+      case 0x0F:
+      	return false;
+      default:
+        // ???
+      	bug_unreachable("invalid condition:0x%X", cond);
+        return false;
+    }
+}
+
+[[gnu::always_inline]] static inline bool armExecuteStep(ARM7TDMI &cpu)
 {
-	int &cpuNextEvent = cpu.cpuNextEvent;
 	int &cpuTotalTicks = cpu.cpuTotalTicks;
-    do {
 		if (coreOptions.cheatsEnabled) {
 			cpuMasterCodeCheck(cpu);
 		}
@@ -2884,69 +2926,15 @@ int armExecute(ARM7TDMI &cpu)
             if (debuggerBreakOnExecution(memAddr, armState)) {
                 // Revert tickcount?
                 debugger = true;
-                return 0;
+                return false;
             }
         }
 #endif
 
         int cond = opcode >> 28;
         bool cond_res = true;
-        if (UNLIKELY(cond != 0x0E)) {  // most opcodes are AL (always)
-            switch (cond) {
-              case 0x00: // EQ
-                cond_res = Z_FLAG;
-                break;
-              case 0x01: // NE
-                cond_res = !Z_FLAG;
-                break;
-              case 0x02: // CS
-                cond_res = C_FLAG;
-                break;
-              case 0x03: // CC
-                cond_res = !C_FLAG;
-                break;
-              case 0x04: // MI
-                cond_res = N_FLAG;
-                break;
-              case 0x05: // PL
-                cond_res = !N_FLAG;
-                break;
-              case 0x06: // VS
-                cond_res = V_FLAG;
-                break;
-              case 0x07: // VC
-                cond_res = !V_FLAG;
-                break;
-              case 0x08: // HI
-                cond_res = C_FLAG && !Z_FLAG;
-                break;
-              case 0x09: // LS
-                cond_res = !C_FLAG || Z_FLAG;
-                break;
-              case 0x0A: // GE
-                cond_res = N_FLAG == V_FLAG;
-                break;
-              case 0x0B: // LT
-                cond_res = N_FLAG != V_FLAG;
-                break;
-              case 0x0C: // GT
-                cond_res = !Z_FLAG && (N_FLAG == V_FLAG);
-                break;
-              case 0x0D: // LE
-                cond_res = Z_FLAG || (N_FLAG != V_FLAG);
-                break;
-              /*case 0x0E: // AL (impossible, checked above)
-                cond_res = true;
-                break;*/
-              case 0x0F:
-              	cond_res = false;
-              	break;
-              default:
-                // ???
-              	bug_unreachable("invalid condition:0x%X", cond);
-                break;
-            }
-        }
+        if (UNLIKELY(cond != 0x0E))  // most opcodes are AL (always)
+            cond_res = armConditionPassed(cpu, cond);
 
         if (cond_res)
         	(*armInsnTable[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0x0F)])(cpu, opcode, clockTicks);
@@ -2995,8 +2983,39 @@ int armExecute(ARM7TDMI &cpu)
         if (clockTicks == 0)
             clockTicks = 1 + codeTicksAccessSeq32(oldArmNextPC);
         cpuTotalTicks += clockTicks;
+        cpu.idleLoop.insns++;
+        return true;
+}
 
+int armExecute(ARM7TDMI &cpu)
+{
+	int &cpuNextEvent = cpu.cpuNextEvent;
+	int &cpuTotalTicks = cpu.cpuTotalTicks;
+    do {
+        if (!armExecuteStep(cpu))
+            return 0;
     } while (cpuTotalTicks < cpuNextEvent &&
     		(!CONFIG_TRIGGER_ARM_STATE_EVENT && armState) && !cpu.SWITicks);
     return 1;
 }
+
+// Single steps and helpers for GBAJit, blocks call the same handlers as armExecute()
+void armExecuteInsn(ARM7TDMI &cpu)
+{
+    armExecuteStep(cpu);
+}
+
+uintptr_t armInsnHandler(uint32_t opcode)
+{
+    return reinterpret_cast<uintptr_t>(armInsnTable[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0x0F)]);
+}
+
+int armInsnConditionPassed(ARM7TDMI &cpu, uint32_t cond)
+{
+    return armConditionPassed(cpu, cond);
+}
+
+int armInsnSeqTicks(ARM7TDMI &cpu, uint32_t pc)
+{
+    return 1 + codeTicksAccessSeq32(pc);
+}
@@ -1805,6 +1805,8 @@ static INSN_REGPARM int thumbC8(ARM7TDMI &cpu, uint32_t opcode, uint32_t oldArmN
         clockTicks += codeTicksAccessSeq16(armNextPC)              \
             + codeTicksAccess16(armNextPC) + 2;                    \
         busPrefetchCount = 0;                                           \
+        if ((int32_t)offset < 0 && cpu.skipIdleLoops)                   \
+            cpu.checkIdleLoop(oldArmNextPC);                            \
     }                                                                   \
 		return clockTicks;
 
@@ -1917,6 +1919,8 @@ static INSN_REGPARM int thumbE0(ARM7TDMI &cpu, uint32_t opcode, uint32_t oldArmN
   THUMB_PREFETCH;
   int clockTicks = codeTicksAccessSeq16(armNextPC) * 2 + codeTicksAccess16(armNextPC) + 3;
   busPrefetchCount = 0;
+  if (offset < 0 && cpu.skipIdleLoops)
+    cpu.checkIdleLoop(oldArmNextPC);
   return clockTicks;
 }
 
@@ -2094,11 +2098,9 @@ constexpr insnfunc_t thumbInsnTable[1024] = {
 
 // Wrapper routine (execution loop) ///////////////////////////////////////
 
-int thumbExecute(ARM7TDMI &cpu)
+[[gnu::always_inline]] static inline bool thumbExecuteStep(ARM7TDMI &cpu)
 {
-	int &cpuNextEvent = cpu.cpuNextEvent;
 	int &cpuTotalTicks = cpu.cpuTotalTicks;
-  do {
 	  if (coreOptions.cheatsEnabled) {
 		  cpuMasterCodeCheck(cpu);
 	  }
@@ -2129,7 +2131,7 @@ int thumbExecute(ARM7TDMI &cpu)
             if (debuggerBreakOnExecution(memAddr, armState)) {
                 // Revert tickcount?
                 debugger = true;
-                return 0;
+                return false;
             }
         }
 #endif
@@ -2178,8 +2180,34 @@ int thumbExecute(ARM7TDMI &cpu)
     if (clockTicks == 0)
         clockTicks = codeTicksAccessSeq16(oldArmNextPC) + 1;
     cpuTotalTicks += clockTicks;
+    cpu.idleLoop.insns++;
+    return true;
+}
 
+int thumbExecute(ARM7TDMI &cpu)
+{
+	int &cpuNextEvent = cpu.cpuNextEvent;
+	int &cpuTotalTicks = cpu.cpuTotalTicks;
+  do {
+    if (!thumbExecuteStep(cpu))
+      return 0;
   } while (cpuTotalTicks < cpuNextEvent &&
   		(!CONFIG_TRIGGER_ARM_STATE_EVENT && !armState) && !cpu.SWITicks);
   return 1;
 }
+
+// Single steps and helpers for GBAJit, blocks call the same handlers as thumbExecute()
+void thumbExecuteInsn(ARM7TDMI &cpu)
+{
+  thumbExecuteStep(cpu);
+}
+
+uintptr_t thumbInsnHandler(uint32_t opcode)
+{
+  return reinterpret_cast<uintptr_t>(thumbInsnTable[opcode >> 6]);
+}
+
+int thumbInsnSeqTicks(ARM7TDMI &cpu, uint32_t pc)
+{
+  return codeTicksAccessSeq16(pc) + 1;
+}
@@ -509,7 +509,10 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, uint32_t address, uint32_t valu
             cheatsWriteMemory(address & 0x203FFFC, value);
         else
 #endif
+        {
             WRITE32LE(((uint32_t*)&g_workRAM[address & 0x3FFFC]), value);
+            cpu.gba->jit.invalidateWorkRAM(address);
+        }
         break;
     case 0x03:
 #ifdef VBAM_ENABLE_DEBUGGER
@@ -517,7 +520,10 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, uint32_t address, uint32_t valu
             cheatsWriteMemory(address & 0x3007FFC, value);
         else
 #endif
+        {
             WRITE32LE(((uint32_t*)&g_internalRAM[address & 0x7ffC]), value);
+            cpu.gba->jit.invalidateInternalRAM(address);
+        }
         break;
     case 0x04:
         if (address < 0x4000400) {
@@ -532,7 +538,10 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, uint32_t address, uint32_t valu
             cheatsWriteMemory(address & 0x70003FC, value);
         else
 #endif
+        {
             WRITE32LE(((uint32_t*)&g_paletteRAM[address & 0x3FC]), value);
+            cpu.gba->lcd.paletteDirty = true;
+        }
         break;
     case 0x06:
         address = (address & 0x1fffc);
@@ -547,7 +556,10 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, uint32_t address, uint32_t valu
         else
 #endif
 
+        {
             WRITE32LE(((uint32_t*)&g_vram[address]), value);
+            cpu.gba->lcd.markVramDirty(address);
+        }
         break;
     case 0x07:
 #ifdef VBAM_ENABLE_DEBUGGER
@@ -555,7 +567,10 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, uint32_t address, uint32_t valu
             cheatsWriteMemory(address & 0x70003FC, value);
         else
 #endif
+        {
             WRITE32LE(((uint32_t*)&g_oam[address & 0x3fc]), value);
+            cpu.gba->lcd.oamDirty = true;
+        }
         break;
     case 0x0D:
         if (cpuEEPROMEnabled) {
@@ -614,7 +629,10 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, uint32_t address, uint16_t va
             cheatsWriteHalfWord(address & 0x203FFFE, value);
         else
 #endif
+        {
             WRITE16LE(((uint16_t*)&g_workRAM[address & 0x3FFFE]), value);
+            cpu.gba->jit.invalidateWorkRAM(address);
+        }
         break;
     case 3:
 #ifdef VBAM_ENABLE_DEBUGGER
@@ -622,7 +640,10 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, uint32_t address, uint16_t va
             cheatsWriteHalfWord(address & 0x3007ffe, value);
         else
 #endif
+        {
             WRITE16LE(((uint16_t*)&g_internalRAM[address & 0x7ffe]), value);
+            cpu.gba->jit.invalidateInternalRAM(address);
+        }
         break;
     case 4:
         if (address < 0x4000400)
@@ -636,7 +657,10 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, uint32_t address, uint16_t va
             cheatsWriteHalfWord(address & 0x70003fe, value);
         else
 #endif
+        {
             WRITE16LE(((uint16_t*)&g_paletteRAM[address & 0x3fe]), value);
+            cpu.gba->lcd.paletteDirty = true;
+        }
         break;
     case 6:
         address = (address & 0x1fffe);
@@ -649,7 +673,10 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, uint32_t address, uint16_t va
             cheatsWriteHalfWord(address + 0x06000000, value);
         else
 #endif
+        {
             WRITE16LE(((uint16_t*)&g_vram[address]), value);
+            cpu.gba->lcd.markVramDirty(address);
+        }
         break;
     case 7:
 #ifdef VBAM_ENABLE_DEBUGGER
@@ -657,7 +684,10 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, uint32_t address, uint16_t va
             cheatsWriteHalfWord(address & 0x70003fe, value);
         else
 #endif
+        {
             WRITE16LE(((uint16_t*)&g_oam[address & 0x3fe]), value);
+            cpu.gba->lcd.oamDirty = true;
+        }
         break;
     case 8:
     case 9:
@@ -713,7 +743,10 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, uint32_t address, uint8_t b)
             cheatsWriteByte(address & 0x203FFFF, b);
         else
 #endif
+        {
             g_workRAM[address & 0x3FFFF] = b;
+            cpu.gba->jit.invalidateWorkRAM(address);
+        }
         break;
     case 3:
 #ifdef VBAM_ENABLE_DEBUGGER
@@ -721,7 +754,10 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, uint32_t address, uint8_t b)
             cheatsWriteByte(address & 0x3007fff, b);
         else
 #endif
+        {
             g_internalRAM[address & 0x7fff] = b;
+            cpu.gba->jit.invalidateInternalRAM(address);
+        }
         break;
     case 4:
         if (address < 0x4000400) {
@@ -792,6 +828,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, uint32_t address, uint8_t b)
     case 5:
         // no need to switch
         *((uint16_t*)&g_paletteRAM[address & 0x3FE]) = (b << 8) | b;
+        cpu.gba->lcd.paletteDirty = true;
         break;
     case 6:
         address = (address & 0x1fffe);
@@ -808,7 +845,10 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, uint32_t address, uint8_t b)
                 cheatsWriteByte(address + 0x06000000, b);
             else
 #endif
+            {
                 *((uint16_t*)&g_vram[address]) = (b << 8) | b;
+                cpu.gba->lcd.markVramDirty(address);
+            }
         }
         break;
     case 7:
@@ -861,10 +861,12 @@ void BIOS_RegisterRamReset(ARM7TDMI &cpu, uint32_t flags)
     if (flags & 0x01) {
       // clear work RAM
     	memset(g_workRAM, 0, SIZE_WRAM);
+    	cpu.gba->jit.invalidate(0x02000000, SIZE_WRAM);
     }
     if (flags & 0x02) {
       // clear internal RAM
     	memset(g_internalRAM, 0, 0x7e00); // don't clear 0x7e00-0x7fff
+    	cpu.gba->jit.invalidate(0x03000000, 0x7e00);
     }
     cpu.gba->lcd.registerRamReset(flags);
     /*if (flags & 0x04) {
@@ -1064,6 +1066,7 @@ void BIOS_SoftReset(ARM7TDMI &cpu)
 
   cpu.softReset(g_internalRAM[0x7ffa]);
   memset(&g_internalRAM[0x7e00], 0, 0x200);
+  cpu.gba->jit.invalidate(0x03007e00, 0x200);
 
   /*armState = true;
   armMode = 0x1F;
@@ -151,6 +151,18 @@ class ConsoleOptionView : public TableView, public MainAppHelper
 		}
 	};
 
+	BoolMenuItem skipIdleLoops
+	{
+		"Skip Idle Loops", attachParams(),
+		system().skipIdleLoops,
+		[this](BoolMenuItem &item)
+		{
+			system().sessionOptionSet();
+			system().skipIdleLoops = item.flipBoolValue(*this);
+			system().applySkipIdleLoops();
+		}
+	};
+
 	#ifdef IG_CONFIG_SENSORS
 	TextMenuItem hardwareSensorItem[5]
 	{
@@ -184,11 +196,12 @@ class ConsoleOptionView : public TableView, public MainAppHelper
 	};
 	#endif
 
-	std::array<MenuItem*, Config::SENSORS ? 4 : 3> menuItem
+	std::array<MenuItem*, Config::SENSORS ? 5 : 4> menuItem
 	{
 		&bios,
 		&rtc
 		, &saveType
+		, &skipIdleLoops
 		#ifdef IG_CONFIG_SENSORS
 		, &hardwareSensor
 		#endif
@@ -406,6 +419,42 @@ class CustomSystemOptionView : public SystemOptionView, public MainAppHelper
 		}
 	};
 
+	BoolMenuItem threadedRendering
+	{
+		"Threaded Rendering", attachParams(),
+		system().threadedRendering,
+		[this](BoolMenuItem &item)
+		{
+			system().threadedRendering = item.flipBoolValue(*this);
+			if(system().hasContent())
+				system().applyThreadedRendering();
+		}
+	};
+
+	BoolMenuItem cpuRecompiler
+	{
+		"CPU Recompiler", attachParams(),
+		system().cpuRecompiler,
+		[this](BoolMenuItem &item)
+		{
+			system().cpuRecompiler = item.flipBoolValue(*this);
+			if(system().hasContent())
+				system().applyCpuRecompiler();
+		}
+	};
+
+	BoolMenuItem compareCpuRecompiler
+	{
+		"Compare Recompiler With Interpreter", attachParams(),
+		system().compareCpuRecompiler,
+		[this](BoolMenuItem &item)
+		{
+			system().compareCpuRecompiler = item.flipBoolValue(*this);
+			if(system().hasContent())
+				system().applyCpuRecompiler();
+		}
+	};
+
 	#ifdef IG_CONFIG_SENSORS
 	TextMenuItem lightSensorScaleItem[5]
 	{
@@ -453,6 +502,12 @@ public:
 	{
 		loadStockItems();
 		item.emplace_back(&bios);
+		item.emplace_back(&threadedRendering);
+		if constexpr(GBAJit::isSupported)
+		{
+			item.emplace_back(&cpuRecompiler);
+			item.emplace_back(&compareCpuRecompiler);
+		}
 		#ifdef IG_CONFIG_SENSORS
 		item.emplace_back(&lightSensorScale);
 		#endif
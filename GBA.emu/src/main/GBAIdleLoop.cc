@@ -0,0 +1,375 @@
+/*  This file is part of GBA.emu.
+
+	GBA.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	GBA.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with GBA.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include "GBASys.hh"
+#include <bit>
+#include <optional>
+
+// Register values the loop body can compute without reading memory that's being polled,
+// load addresses must be built only from these
+struct KnownRegs
+{
+	std::array<uint32_t, 16> val{};
+	uint16_t mask{};
+
+	bool isKnown(int r) const { return mask & (1 << r); }
+	void set(int r, uint32_t v) { val[r] = v; mask |= 1 << r; }
+	void setUnknown(int r) { mask &= ~(1 << r); }
+};
+
+// Memory whose contents only change by CPU stores, DMA, or scheduled events, so reading it
+// again without any of those in between returns the same value
+static bool isIdleReadAddr(uint32_t addr, uint32_t size)
+{
+	auto end = addr + size;
+	switch(addr >> 24)
+	{
+		case 2: case 3: case 5: case 6: case 7:
+			return true;
+		case 4:
+		{
+			// DISPCNT/DISPSTAT/VCOUNT, KEYINPUT, and IE/IF/WAITCNT/IME, but not the timer counters
+			// since reading them computes their value from the current tick count
+			auto offset = addr & 0xFFFFFF;
+			auto endOffset = end - (addr & 0xFF000000);
+			return endOffset <= 0x8 || (offset >= 0x130 && endOffset <= 0x132) ||
+				(offset >= 0x200 && endOffset <= 0x20A);
+		}
+		case 8: case 9: case 0xA: case 0xB: case 0xC:
+		{
+			// GPIO port used for the RTC
+			auto romAddr = addr & 0x1FFFFFF;
+			return romAddr + size <= 0xC4 || romAddr >= 0xCA;
+		}
+	}
+	return false;
+}
+
+static bool isIdleCodeAddr(uint32_t addr)
+{
+	auto region = addr >> 24;
+	return region == 2 || region == 3 || (region >= 8 && region <= 0xC);
+}
+
+// Returns true if the loop from target to the branch at branchAddr has no stores, register writes
+// to PC, mode changes, or reads from memory with side effects
+static bool isIdleThumbLoop(ARM7TDMI &cpu, uint32_t target, uint32_t branchAddr)
+{
+	KnownRegs regs;
+	for(int i = 0; i < 15; i++)
+		regs.set(i, cpu.reg[i].I);
+	auto load = [&](uint32_t addr, uint32_t size, int rd)
+	{
+		regs.setUnknown(rd);
+		return isIdleReadAddr(addr, size);
+	};
+	for(uint32_t addr = target; addr != branchAddr; addr += 2)
+	{
+		uint32_t pc = addr + 4;
+		uint32_t op = CPUReadHalfWordQuick(cpu, addr);
+		switch(op >> 11)
+		{
+			case 0x00: case 0x01: case 0x02: // LSL/LSR/ASR imm
+			{
+				int rd = op & 7, rs = (op >> 3) & 7;
+				unsigned imm = (op >> 6) & 0x1F;
+				auto type = op >> 11;
+				if(!regs.isKnown(rs) || type == 2)
+				{
+					regs.setUnknown(rd);
+					break;
+				}
+				auto v = regs.val[rs];
+				regs.set(rd, type == 0 ? v << imm : (imm ? v >> imm : 0));
+				break;
+			}
+			case 0x03: // ADD/SUB reg or imm3
+			{
+				int rd = op & 7, rs = (op >> 3) & 7, rn = (op >> 6) & 7;
+				bool isImm = op & 0x400, isSub = op & 0x200;
+				if(!regs.isKnown(rs) || (!isImm && !regs.isKnown(rn)))
+				{
+					regs.setUnknown(rd);
+					break;
+				}
+				uint32_t operand = isImm ? rn : regs.val[rn];
+				regs.set(rd, isSub ? regs.val[rs] - operand : regs.val[rs] + operand);
+				break;
+			}
+			case 0x04: // MOV imm8
+				regs.set((op >> 8) & 7, op & 0xFF);
+				break;
+			case 0x05: // CMP imm8
+				break;
+			case 0x06: case 0x07: // ADD/SUB imm8
+			{
+				int rd = (op >> 8) & 7;
+				if(regs.isKnown(rd))
+					regs.set(rd, (op >> 11) == 6 ? regs.val[rd] + (op & 0xFF) : regs.val[rd] - (op & 0xFF));
+				break;
+			}
+			case 0x08:
+			{
+				if(!(op & 0x400)) // ALU ops
+				{
+					auto aluOp = (op >> 6) & 0xF;
+					if(aluOp != 0x8 && aluOp != 0xA && aluOp != 0xB) // all but TST/CMP/CMN write Rd
+						regs.setUnknown(op & 7);
+					break;
+				}
+				// hi register ops
+				int rd = (op & 7) | ((op >> 4) & 8), rs = (op >> 3) & 0xF;
+				switch((op >> 8) & 3)
+				{
+					case 0: // ADD
+						if(rd == 15)
+							return false;
+						if(regs.isKnown(rd) && (rs == 15 || regs.isKnown(rs)))
+							regs.set(rd, regs.val[rd] + (rs == 15 ? pc : regs.val[rs]));
+						else
+							regs.setUnknown(rd);
+						break;
+					case 1: // CMP
+						break;
+					case 2: // MOV
+						if(rd == 15)
+							return false;
+						if(rs == 15 || regs.isKnown(rs))
+							regs.set(rd, rs == 15 ? pc : regs.val[rs]);
+						else
+							regs.setUnknown(rd);
+						break;
+					case 3: // BX
+						return false;
+				}
+				break;
+			}
+			case 0x09: // LDR PC-relative, the literal itself is treated as a constant
+			{
+				int rd = (op >> 8) & 7;
+				uint32_t litAddr = (pc & ~2) + ((op & 0xFF) << 2);
+				if(!isIdleReadAddr(litAddr, 4))
+					return false;
+				regs.set(rd, CPUReadMemoryQuick(cpu, litAddr));
+				break;
+			}
+			case 0x0A: case 0x0B: // load/store with register offset
+			{
+				int rd = op & 7, rb = (op >> 3) & 7, ro = (op >> 6) & 7;
+				static constexpr uint8_t loadSize[8]{0, 0, 0, 1, 4, 2, 1, 2};
+				auto size = loadSize[(op >> 9) & 7];
+				if(!size || !regs.isKnown(rb) || !regs.isKnown(ro))
+					return false;
+				if(!load(regs.val[rb] + regs.val[ro], size, rd))
+					return false;
+				break;
+			}
+			case 0x0D: case 0x0F: case 0x11: // LDR/LDRB/LDRH imm5
+			{
+				int rd = op & 7, rb = (op >> 3) & 7;
+				uint32_t size = (op >> 11) == 0x0D ? 4 : (op >> 11) == 0x0F ? 1 : 2;
+				if(!regs.isKnown(rb))
+					return false;
+				if(!load(regs.val[rb] + ((op >> 6) & 0x1F) * size, size, rd))
+					return false;
+				break;
+			}
+			case 0x13: // LDR SP-relative
+				if(!regs.isKnown(13) || !load(regs.val[13] + ((op & 0xFF) << 2), 4, (op >> 8) & 7))
+					return false;
+				break;
+			case 0x14: // ADD Rd, PC
+				regs.set((op >> 8) & 7, (pc & ~2) + ((op & 0xFF) << 2));
+				break;
+			case 0x15: // ADD Rd, SP
+				if(regs.isKnown(13))
+					regs.set((op >> 8) & 7, regs.val[13] + ((op & 0xFF) << 2));
+				else
+					regs.setUnknown((op >> 8) & 7);
+				break;
+			case 0x1A: case 0x1B: // conditional branch, only allowed out of the loop
+			{
+				auto cond = (op >> 8) & 0xF;
+				if(cond >= 0xE)
+					return false;
+				uint32_t dest = pc + ((uint32_t)((int8_t)(op & 0xFF)) << 1);
+				if(dest <= branchAddr)
+					return false;
+				break;
+			}
+			default: // stores, PUSH/POP, LDM/STM, SWI, unconditional branches, BL
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool isIdleArmLoop(ARM7TDMI &cpu, uint32_t target, uint32_t branchAddr)
+{
+	KnownRegs regs;
+	for(int i = 0; i < 15; i++)
+		regs.set(i, cpu.reg[i].I);
+	for(uint32_t addr = target; addr != branchAddr; addr += 4)
+	{
+		uint32_t pc = addr + 8;
+		uint32_t op = CPUReadMemoryQuick(cpu, addr);
+		auto cond = op >> 28;
+		if(cond == 0xF)
+			return false;
+		bool always = cond == 0xE;
+		int rd = (op >> 12) & 0xF, rn = (op >> 16) & 0xF;
+		auto baseValue = [&]() -> std::optional<uint32_t>
+		{
+			if(rn == 15)
+				return pc;
+			if(!regs.isKnown(rn))
+				return {};
+			return regs.val[rn];
+		};
+		switch((op >> 25) & 7)
+		{
+			case 0: case 1:
+			{
+				if((op & 0x0E000090) == 0x00000090) // multiply, swap, and halfword transfer space
+				{
+					bool isHalfwordLoad = (op & 0x60) && (op & (1 << 20)) && (op & (1 << 24)) &&
+						!(op & (1 << 21)) && (op & (1 << 22));
+					if(!isHalfwordLoad || rd == 15)
+						return false;
+					auto base = baseValue();
+					if(!base)
+						return false;
+					uint32_t offset = ((op >> 4) & 0xF0) | (op & 0xF);
+					uint32_t size = ((op >> 5) & 3) == 2 ? 1 : 2;
+					if(!isIdleReadAddr((op & (1 << 23)) ? *base + offset : *base - offset, size))
+						return false;
+					regs.setUnknown(rd);
+					break;
+				}
+				auto aluOp = (op >> 21) & 0xF;
+				bool setsFlags = op & (1 << 20);
+				bool isTest = aluOp >= 0x8 && aluOp <= 0xB;
+				if(isTest && !setsFlags) // MRS/MSR/BX
+					return false;
+				if(isTest)
+					break;
+				if(rd == 15)
+					return false;
+				bool isImm = op & (1 << 25);
+				uint32_t imm = std::rotr(op & 0xFF, ((op >> 8) & 0xF) * 2);
+				if(always && isImm && aluOp == 0xD) // MOV
+					regs.set(rd, imm);
+				else if(always && isImm && (aluOp == 0x4 || aluOp == 0x2) && (rn == 15 || regs.isKnown(rn))) // ADD/SUB
+				{
+					auto base = rn == 15 ? pc : regs.val[rn];
+					regs.set(rd, aluOp == 0x4 ? base + imm : base - imm);
+				}
+				else if(always && !isImm && aluOp == 0xD && !(op & 0xFF0) && regs.isKnown(op & 0xF)) // MOV Rd, Rm
+					regs.set(rd, regs.val[op & 0xF]);
+				else
+					regs.setUnknown(rd);
+				break;
+			}
+			case 2: // LDR/STR with immediate offset
+			{
+				bool isPreIndexedLoad = (op & (1 << 24)) && !(op & (1 << 21)) && (op & (1 << 20));
+				if(!isPreIndexedLoad || rd == 15)
+					return false;
+				auto base = baseValue();
+				if(!base)
+					return false;
+				uint32_t offset = op & 0xFFF;
+				uint32_t size = (op & (1 << 22)) ? 1 : 4;
+				uint32_t loadAddr = (op & (1 << 23)) ? *base + offset : *base - offset;
+				if(!isIdleReadAddr(loadAddr, size))
+					return false;
+				if(always && rn == 15 && size == 4) // literal
+					regs.set(rd, CPUReadMemoryQuick(cpu, loadAddr));
+				else
+					regs.setUnknown(rd);
+				break;
+			}
+			case 5: // B, only allowed out of the loop
+			{
+				if(op & (1 << 24)) // BL
+					return false;
+				uint32_t dest = pc + ((int32_t)((op & 0x00FFFFFF) << 8) >> 6);
+				if(dest <= branchAddr)
+					return false;
+				break;
+			}
+			default: // register offset transfers, LDM/STM, coprocessor, SWI
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool isIdleLoop(ARM7TDMI &cpu, uint32_t target, uint32_t branchAddr)
+{
+	auto insnSize = cpu.armState ? 4 : 2;
+	if(target > branchAddr || (branchAddr - target) / insnSize >= GBAIdleLoopDetector::maxBodyInsns ||
+		!isIdleCodeAddr(target) || (target >> 24) != (branchAddr >> 24))
+		return false;
+	return cpu.armState ? isIdleArmLoop(cpu, target, branchAddr) : isIdleThumbLoop(cpu, target, branchAddr);
+}
+
+void ARM7TDMI::checkIdleLoop(uint32_t branchAddr)
+{
+	auto &idle = idleLoop;
+	uint32_t key = armState ? branchAddr : branchAddr | 1;
+	uint32_t target = armNextPC;
+	if(key != idle.branch)
+	{
+		auto &verdict = idle.verdictFor(key);
+		if(verdict.branch != key)
+			verdict = {key, isIdleLoop(*this, target, branchAddr)};
+		if(!verdict.isIdle)
+			return;
+		idle.branch = key;
+		idle.stateEpoch = idle.epoch - 1;
+	}
+	uint32_t bodyInsns = (branchAddr - target) / (armState ? 4 : 2) + 1;
+	int ticks = cpuTotalTicks - idle.stateTicks;
+	auto state = idleLoopState();
+	if(idle.stateEpoch != idle.epoch || idle.insns - idle.stateInsns != bodyInsns || ticks <= 0)
+	{
+		// an event or code outside the loop ran since the last iteration
+		idle.state = state;
+		idle.stateEpoch = idle.epoch;
+		idle.stateInsns = idle.insns;
+		idle.stateTicks = cpuTotalTicks;
+		return;
+	}
+	if(state != idle.state)
+	{
+		// body modifies its own registers, like a delay counter, so iterations never repeat
+		idle.verdictFor(key).isIdle = false;
+		idle.branch = 0;
+		return;
+	}
+	idle.stateInsns = idle.insns;
+	int iterations = (cpuNextEvent - 1 - cpuTotalTicks) / ticks;
+	// the cached verdict may be from a visit with different base registers or from code in RAM
+	// that's since been rewritten, so check it still holds
+	if(iterations > 0 && isIdleLoop(*this, target, branchAddr))
+	{
+		int skippedTicks = iterations * ticks;
+		cpuTotalTicks += skippedTicks;
+		idle.stats.skips++;
+		idle.stats.skippedTicks += skippedTicks;
+	}
+	idle.stateTicks = cpuTotalTicks;
+}
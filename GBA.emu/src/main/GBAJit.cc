@@ -0,0 +1,349 @@
+/*  This file is part of GBA.emu.
+
+	GBA.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	GBA.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with GBA.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include "GBASys.hh"
+#include "GBAJitEmitter.hh"
+#include <core/gba/gbaCpu.h>
+#include <imagine/vmem/memory.hh>
+#include <imagine/logger/logger.h>
+#include <sys/mman.h>
+#include <bit>
+
+// not named log, that would conflict with VBA-M's global log()
+constexpr IG::SystemLogger jitLog{"GBAJit"};
+
+#if defined __x86_64__
+using GBAJitEmitter = GBAJitX86_64Emitter;
+#else
+using GBAJitEmitter = GBAJitArm64Emitter;
+#endif
+
+using BlockFunc = void(*)(ARM7TDMI *, const bool *exitBlock);
+
+constexpr size_t codeBuffSize = 32 * 1024 * 1024;
+constexpr size_t maxBlockCodeSize = 0x4000; // worst case for GBAJit::maxBlockInsns ARM instructions with either emitter
+constexpr size_t recentBlocksSize = 0x1000;
+
+static_assert(!GBAJit::isSupported || ARM7TDMI::USE_SWITICKS, "blocks read SWITicks as an int");
+
+// index into GBAJit's page tables, or -1 if code isn't translated from this address
+static int32_t codePage(uint32_t addr)
+{
+	switch(addr >> 24)
+	{
+		case 0:
+			return addr < 0x4000 ? GBAJit::biosPage + (addr >> GBAJit::pageShift) : -1;
+		case 2:
+			return GBAJit::workRAMPage + ((addr & 0x3FFFF) >> GBAJit::pageShift);
+		case 3:
+			return GBAJit::internalRAMPage + ((addr & 0x7FFF) >> GBAJit::pageShift);
+		case 8: case 9: case 0xA: case 0xC:
+			return GBAJit::romPage + ((addr & 0x1FFFFFF) >> GBAJit::pageShift);
+	}
+	return -1;
+}
+
+// true if all of [addr, endAddr) can be translated and stays in one memory region
+static bool isCodeRange(uint32_t addr, uint32_t endAddr)
+{
+	return codePage(addr) != -1 && ((endAddr - 1) >> 24) == (addr >> 24) &&
+		((addr >> 24) != 0 || endAddr <= 0x4000);
+}
+
+static bool endsThumbBlock(uint32_t opcode)
+{
+	return (opcode & 0xF000) == 0xD000 || // conditional branch & SWI
+		(opcode & 0xF800) == 0xE000 || // B
+		(opcode & 0xF800) == 0xF800 || // BL suffix
+		(opcode & 0xFF00) == 0x4700 || // BX
+		(opcode & 0xFF00) == 0xBD00 || // POP with PC
+		(opcode & 0xFC87) == 0x4487; // hi register op with PC as destination
+}
+
+static bool endsArmBlock(uint32_t opcode)
+{
+	auto type = (opcode >> 25) & 7;
+	return type == 5 || // B & BL
+		((opcode >> 24) & 0xF) == 0xF || // SWI
+		(opcode & 0x0FFFFFF0) == 0x012FFF10 || // BX
+		(type == 4 && (opcode & (1 << 20)) && (opcode & (1 << 15))) || // LDM with PC
+		(type < 4 && ((opcode >> 12) & 0xF) == 15); // anything else writing PC, including undefined forms
+}
+
+static uint32_t readOpcode(ARM7TDMI &cpu, uint32_t addr, bool thumb)
+{
+	return thumb ? CPUReadHalfWordQuick(cpu, addr) : CPUReadMemoryQuick(cpu, addr);
+}
+
+static uint32_t hashCode(ARM7TDMI &cpu, uint32_t addr, uint32_t endAddr, bool thumb)
+{
+	uint32_t hash = 2166136261u;
+	for(auto step = thumb ? 2 : 4; addr < endAddr; addr += step)
+	{
+		hash = (hash ^ readOpcode(cpu, addr, thumb)) * 16777619u;
+	}
+	return hash;
+}
+
+GBAJitLayout GBAJit::makeLayout(ARM7TDMI &cpu)
+{
+	auto offset = [&](const auto &member) { return int32_t((const uint8_t*)&member - (const uint8_t*)&cpu); };
+	return
+	{
+		.prefetch = offset(cpu.cpuPrefetch),
+		.busPrefetch = offset(cpu.busPrefetch),
+		.busPrefetchCount = offset(cpu.busPrefetchCount),
+		.armNextPC = offset(cpu.armNextPC),
+		.reg15 = offset(cpu.reg[15].I),
+		.totalTicks = offset(cpu.cpuTotalTicks),
+		.nextEvent = offset(cpu.cpuNextEvent),
+		.idleLoopInsns = offset(cpu.idleLoop.insns),
+		.armState = offset(cpu.armState),
+		.swiTicks = offset(cpu.SWITicks),
+		.thumbSeqTicks = std::bit_cast<uintptr_t>(&thumbInsnSeqTicks),
+		.armSeqTicks = std::bit_cast<uintptr_t>(&armInsnSeqTicks),
+		.armCondition = std::bit_cast<uintptr_t>(&armInsnConditionPassed),
+	};
+}
+
+static bool isValidLayout(const GBAJitLayout &l)
+{
+	// AArch64 load/store immediates are scaled by the access size and limited to 12 bits
+	auto isValidWord = [](int32_t offset) { return offset >= 0 && offset < 0x4000 && !(offset % 4); };
+	auto isValidByte = [](int32_t offset) { return offset >= 0 && offset < 0x1000; };
+	return isValidWord(l.prefetch) && isValidWord(l.prefetch + 4) && isValidWord(l.busPrefetchCount) &&
+		isValidWord(l.armNextPC) && isValidWord(l.reg15) && isValidWord(l.totalTicks) &&
+		isValidWord(l.nextEvent) && isValidWord(l.idleLoopInsns) && isValidWord(l.swiTicks) &&
+		isValidByte(l.busPrefetch) && isValidByte(l.armState);
+}
+
+bool GBAJit::setEnabled(bool on)
+{
+	if(on == isEnabled())
+		return true;
+	if(!on)
+	{
+		flush();
+		IG::vFree(codeBuff);
+		codeBuff = {};
+		recentBlocks.reset();
+		jitLog.info("disabled");
+		return true;
+	}
+	if constexpr(!isSupported)
+	{
+		return false;
+	}
+	ARM7TDMI layoutCpu{nullptr};
+	if(!isValidLayout(makeLayout(layoutCpu)))
+	{
+		jitLog.error("ARM7TDMI members are out of range of generated code");
+		return false;
+	}
+	auto buff = IG::vAlloc(codeBuffSize);
+	if(!buff.data())
+		return false;
+	if(mprotect(buff.data(), buff.size(), PROT_READ | PROT_WRITE | PROT_EXEC) != 0)
+	{
+		jitLog.error("error making code buffer executable");
+		IG::vFree(buff);
+		return false;
+	}
+	codeBuff = buff;
+	recentBlocks = std::make_unique<Block*[]>(recentBlocksSize);
+	stats_ = {};
+	jitLog.info("enabled with {}MB code buffer", codeBuffSize / (1024 * 1024));
+	return true;
+}
+
+int GBAJit::execute(ARM7TDMI &cpu)
+{
+	const bool thumb = !cpu.armState;
+	const uint32_t step = thumb ? 2 : 4;
+	// blocks don't run the cheat master code hook the interpreter checks before every instruction
+	const bool useInterpreter = coreOptions.cheatsEnabled && mastercode;
+	do
+	{
+		auto addr = cpu.armNextPC;
+		auto block = useInterpreter ? nullptr : findBlock(cpu, addr, thumb);
+		if(!block || cpu.reg[15].I != addr + step ||
+			cpu.cpuPrefetch[0] != block->prefetch[0] || cpu.cpuPrefetch[1] != block->prefetch[1])
+		{
+			// the pipeline holds opcodes from before a write or state change, keep the interpreter's behavior
+			if(thumb)
+				thumbExecuteInsn(cpu);
+			else
+				armExecuteInsn(cpu);
+			stats_.interpretedInsns++;
+			continue;
+		}
+		exitBlock = false;
+		stats_.blockRuns++;
+		std::bit_cast<BlockFunc>(codeBuff.data() + block->codeOffset)(&cpu, &exitBlock);
+	} while(cpu.cpuTotalTicks < cpu.cpuNextEvent && cpu.armState != thumb && !cpu.SWITicks);
+	return 1;
+}
+
+GBAJit::Block *GBAJit::findBlock(ARM7TDMI &cpu, uint32_t addr, bool thumb)
+{
+	auto key = addr | thumb;
+	auto &recent = recentBlocks[(key >> 1) % recentBlocksSize];
+	if(recent && recent->key == key)
+		return recent;
+	if(auto it = blocks.find(key); it != blocks.end())
+		return recent = &it->second;
+	if(auto block = translate(cpu, addr, thumb))
+		return recent = block;
+	return nullptr;
+}
+
+GBAJit::Block *GBAJit::translate(ARM7TDMI &cpu, uint32_t addr, bool thumb)
+{
+	const uint32_t step = thumb ? 2 : 4;
+	if(addr % step || !isCodeRange(addr, addr + step * 3))
+		return nullptr;
+	if(codeBuff.size() - codeSize < maxBlockCodeSize)
+	{
+		jitLog.info("code buffer full");
+		flush();
+	}
+	auto layout = makeLayout(cpu);
+	auto code = codeBuff.subspan(codeSize, maxBlockCodeSize);
+	GBAJitEmitter emitter{code, layout};
+	auto pc = addr;
+	for(uint32_t i = 0;; i++, pc += step)
+	{
+		auto opcode = readOpcode(cpu, pc, thumb);
+		GBAJitInsn insn
+		{
+			.addr = pc,
+			.opcode = opcode,
+			.prefetch = {readOpcode(cpu, pc + step, thumb), readOpcode(cpu, pc + step * 2, thumb)},
+			.handler = thumb ? thumbInsnHandler(opcode) : armInsnHandler(opcode),
+		};
+		bool isLast = i + 1 == maxBlockInsns || (thumb ? endsThumbBlock(opcode) : endsArmBlock(opcode)) ||
+			!isCodeRange(addr, pc + step * 4);
+		if(thumb)
+			emitter.thumbInsn(insn, isLast);
+		else
+			emitter.armInsn(insn, isLast);
+		if(isLast)
+			break;
+	}
+	auto size = emitter.finish();
+	if(!size)
+	{
+		jitLog.error("block at:{:X} doesn't fit in {} bytes", addr, maxBlockCodeSize);
+		return nullptr;
+	}
+	__builtin___clear_cache((char*)code.data(), (char*)code.data() + size);
+	auto key = addr | thumb;
+	auto endAddr = pc + step * 3;
+	auto &block = blocks[key];
+	block =
+	{
+		.key = key,
+		.codeOffset = uint32_t(codeSize),
+		.endAddr = endAddr,
+		.hash = hashCode(cpu, addr, endAddr, thumb),
+		.prefetch = {readOpcode(cpu, addr, thumb), readOpcode(cpu, addr + step, thumb)},
+	};
+	codeSize += (size + 15) & ~size_t(15);
+	for(auto page : {codePage(addr), codePage(endAddr - 1)})
+	{
+		auto &keys = pageBlocks[page];
+		if(keys.empty() || keys.back() != key)
+			keys.emplace_back(key);
+		if(uint32_t(page) < romPage)
+			pageHasCode[page] = 1;
+	}
+	stats_.translatedBlocks++;
+	return &block;
+}
+
+void GBAJit::dropBlock(uint32_t key)
+{
+	auto it = blocks.find(key);
+	if(it == blocks.end())
+		return;
+	auto &recent = recentBlocks[(key >> 1) % recentBlocksSize];
+	if(recent == &it->second)
+		recent = nullptr;
+	blocks.erase(it);
+	stats_.droppedBlocks++;
+}
+
+void GBAJit::dropPage(uint32_t page)
+{
+	if(auto it = pageBlocks.find(page); it != pageBlocks.end())
+	{
+		for(auto key : it->second)
+		{
+			dropBlock(key);
+		}
+		pageBlocks.erase(it);
+	}
+	if(page < romPage)
+		pageHasCode[page] = 0;
+	// the running block may have been translated from the written memory
+	exitBlock = true;
+}
+
+void GBAJit::invalidate(uint32_t addr, uint32_t size)
+{
+	if(!isEnabled() || !size)
+		return;
+	for(auto pageAddr = addr & ~((1u << pageShift) - 1); pageAddr < addr + size; pageAddr += 1 << pageShift)
+	{
+		auto page = codePage(pageAddr);
+		if(page != -1 && pageBlocks.contains(page))
+			dropPage(page);
+	}
+}
+
+void GBAJit::flush()
+{
+	if(!isEnabled())
+		return;
+	blocks.clear();
+	pageBlocks.clear();
+	pageHasCode.fill(0);
+	std::fill_n(recentBlocks.get(), recentBlocksSize, nullptr);
+	codeSize = 0;
+	exitBlock = true;
+	stats_.flushes++;
+}
+
+void GBAJit::revalidate(ARM7TDMI &cpu)
+{
+	if(!isEnabled())
+		return;
+	// BIOS and ROM aren't part of states, only RAM blocks can be out of date
+	std::vector<uint32_t> changedKeys;
+	for(const auto &[key, block] : blocks)
+	{
+		auto region = key >> 24;
+		if(region != 2 && region != 3)
+			continue;
+		bool thumb = key & 1;
+		auto addr = key & ~1u;
+		if(hashCode(cpu, addr, block.endAddr, thumb) != block.hash)
+			changedKeys.emplace_back(key);
+	}
+	for(auto key : changedKeys)
+	{
+		dropBlock(key);
+	}
+}
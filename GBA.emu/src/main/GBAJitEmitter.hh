@@ -0,0 +1,429 @@
+#pragma once
+
+/*  This file is part of GBA.emu.
+
+	GBA.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	GBA.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with GBA.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+// Offsets of the ARM7TDMI members translated code accesses and the helpers it calls, offsets
+// must be aligned to the access size and fit AArch64's scaled 12-bit load/store immediates
+struct GBAJitLayout
+{
+	int32_t prefetch{}; // both cpuPrefetch words
+	int32_t busPrefetch{};
+	int32_t busPrefetchCount{};
+	int32_t armNextPC{};
+	int32_t reg15{};
+	int32_t totalTicks{};
+	int32_t nextEvent{};
+	int32_t idleLoopInsns{};
+	int32_t armState{};
+	int32_t swiTicks{};
+	uintptr_t thumbSeqTicks{}; // int(ARM7TDMI &, uint32_t pc)
+	uintptr_t armSeqTicks{}; // int(ARM7TDMI &, uint32_t pc)
+	uintptr_t armCondition{}; // int(ARM7TDMI &, uint32_t cond)
+};
+
+struct GBAJitInsn
+{
+	uint32_t addr{};
+	uint32_t opcode{};
+	uint32_t prefetch[2]{}; // the next two opcodes, loaded into the pipeline while this one executes
+	uintptr_t handler{};
+};
+
+// Blocks are called as void(ARM7TDMI *, const bool *exitBlock). Each instruction does the same steps
+// as one iteration of the thumbExecute()/armExecute() loop with the fetched values as constants, then
+// returns if the PC isn't the next instruction or the loop would end for any other reason.
+class GBAJitX86_64Emitter
+{
+public:
+	GBAJitX86_64Emitter(std::span<uint8_t> buff, const GBAJitLayout &layout):
+		buff{buff}, layout{layout}
+	{
+		emit({0x53}); // push rbx
+		emit({0x41, 0x54}); // push r12
+		emit({0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8, keeps the stack aligned and holds ARM clockTicks
+		emit({0x48, 0x89, 0xFB}); // mov rbx, rdi
+		emit({0x49, 0x89, 0xF4}); // mov r12, rsi
+	}
+
+	void thumbInsn(const GBAJitInsn &insn, bool isLast)
+	{
+		storeImm64(layout.prefetch, insn.prefetch[0] | (uint64_t(insn.prefetch[1]) << 32));
+		storeImm8(layout.busPrefetch, 0);
+		storeImm32(layout.armNextPC, insn.addr + 2);
+		storeImm32(layout.reg15, insn.addr + 4);
+		movRdiRbx();
+		movEsi(insn.opcode);
+		emit({0xBA}); emit32(insn.addr); // mov edx, imm32
+		call(insn.handler);
+		addSeqTicksIfZero(layout.thumbSeqTicks, insn.addr);
+		if(!isLast)
+			exitChecks(insn.addr + 4, 0x85);
+	}
+
+	void armInsn(const GBAJitInsn &insn, bool isLast)
+	{
+		if((insn.addr & 0x0803FFFF) == 0x08020000)
+			storeImm32(layout.busPrefetchCount, 0x100);
+		storeImm64(layout.prefetch, insn.prefetch[0] | (uint64_t(insn.prefetch[1]) << 32));
+		storeImm8(layout.busPrefetch, 0);
+		// if(busPrefetchCount & 0xFFFFFE00) busPrefetchCount = 0x100 | (busPrefetchCount & 0xFF)
+		emit({0x8B, 0x83}); emit32(layout.busPrefetchCount); // mov eax, [rbx + busPrefetchCount]
+		emit({0xA9}); emit32(0xFFFFFE00); // test eax, imm32
+		emit({0x74, 16}); // jz over the next 3 instructions
+		emit({0x25}); emit32(0xFF); // and eax, 0xFF
+		emit({0x0D}); emit32(0x100); // or eax, 0x100
+		emit({0x89, 0x83}); emit32(layout.busPrefetchCount); // mov [rbx + busPrefetchCount], eax
+		storeImm32(layout.armNextPC, insn.addr + 4);
+		storeImm32(layout.reg15, insn.addr + 8);
+		emit({0xC7, 0x04, 0x24}); emit32(0); // mov dword [rsp], 0
+		auto cond = insn.opcode >> 28;
+		if(cond != 0xF) // NV never executes
+		{
+			size_t condJumpPos{};
+			if(cond != 0xE)
+			{
+				movRdiRbx();
+				movEsi(cond);
+				call(layout.armCondition);
+				emit({0x85, 0xC0}); // test eax, eax
+				emit({0x0F, 0x84}); // jz rel32
+				condJumpPos = pos;
+				emit32(0);
+			}
+			movRdiRbx();
+			movEsi(insn.opcode);
+			emit({0x48, 0x8D, 0x14, 0x24}); // lea rdx, [rsp]
+			call(insn.handler);
+			if(condJumpPos)
+				patch32(condJumpPos, pos - (condJumpPos + 4));
+		}
+		emit({0x8B, 0x04, 0x24}); // mov eax, [rsp]
+		addSeqTicksIfZero(layout.armSeqTicks, insn.addr);
+		if(!isLast)
+			exitChecks(insn.addr + 8, 0x84);
+	}
+
+	// Writes the shared exit path, returns the block size or 0 if it didn't fit
+	size_t finish()
+	{
+		auto exitPos = pos;
+		emit({0x48, 0x83, 0xC4, 0x08}); // add rsp, 8
+		emit({0x41, 0x5C}); // pop r12
+		emit({0x5B}); // pop rbx
+		emit({0xC3}); // ret
+		if(overflow)
+			return 0;
+		for(auto fixupPos : exitFixups)
+			patch32(fixupPos, exitPos - (fixupPos + 4));
+		return pos;
+	}
+
+private:
+	std::span<uint8_t> buff;
+	const GBAJitLayout &layout;
+	std::vector<size_t> exitFixups;
+	size_t pos{};
+	bool overflow{};
+
+	void emit(std::initializer_list<uint8_t> bytes)
+	{
+		if(pos + bytes.size() > buff.size())
+		{
+			overflow = true;
+			return;
+		}
+		std::memcpy(&buff[pos], bytes.begin(), bytes.size());
+		pos += bytes.size();
+	}
+
+	void emit32(uint32_t v) { emit({uint8_t(v), uint8_t(v >> 8), uint8_t(v >> 16), uint8_t(v >> 24)}); }
+	void emit64(uint64_t v) { emit32(v); emit32(v >> 32); }
+
+	void patch32(size_t at, uint32_t v)
+	{
+		if(overflow)
+			return;
+		std::memcpy(&buff[at], &v, 4);
+	}
+
+	void storeImm64(int32_t offset, uint64_t v)
+	{
+		emit({0x48, 0xB8}); emit64(v); // mov rax, imm64
+		emit({0x48, 0x89, 0x83}); emit32(offset); // mov [rbx + offset], rax
+	}
+
+	void storeImm32(int32_t offset, uint32_t v) { emit({0xC7, 0x83}); emit32(offset); emit32(v); }
+	void storeImm8(int32_t offset, uint8_t v) { emit({0xC6, 0x83}); emit32(offset); emit({v}); }
+	void movRdiRbx() { emit({0x48, 0x89, 0xDF}); }
+	void movEsi(uint32_t v) { emit({0xBE}); emit32(v); }
+
+	void call(uintptr_t func)
+	{
+		auto rel = int64_t(func) - int64_t(uintptr_t(buff.data()) + pos + 5);
+		if(rel == int32_t(rel))
+		{
+			emit({0xE8}); emit32(rel); // call rel32
+		}
+		else
+		{
+			emit({0x48, 0xB8}); emit64(func); // mov rax, imm64
+			emit({0xFF, 0xD0}); // call rax
+		}
+	}
+
+	// takes the handler's ticks in eax, adds the sequential code fetch time instead if it's 0
+	void addSeqTicksIfZero(uintptr_t seqTicksFunc, uint32_t addr)
+	{
+		emit({0x85, 0xC0}); // test eax, eax
+		emit({0x75, 0}); // jnz rel8
+		auto skipPos = pos;
+		movRdiRbx();
+		movEsi(addr);
+		call(seqTicksFunc);
+		if(!overflow)
+			buff[skipPos - 1] = pos - skipPos;
+		emit({0x01, 0x83}); emit32(layout.totalTicks); // add [rbx + totalTicks], eax
+		emit({0x83, 0x83}); emit32(layout.idleLoopInsns); emit({1}); // add dword [rbx + idleLoopInsns], 1
+	}
+
+	void exitJump(uint8_t jccOpcode)
+	{
+		emit({0x0F, jccOpcode});
+		exitFixups.emplace_back(pos);
+		emit32(0);
+	}
+
+	// armStateExitJcc is jne for Thumb and je for ARM code
+	void exitChecks(uint32_t nextReg15, uint8_t armStateExitJcc)
+	{
+		emit({0x81, 0xBB}); emit32(layout.reg15); emit32(nextReg15); // cmp dword [rbx + reg15], imm32
+		exitJump(0x85); // jne
+		emit({0x80, 0xBB}); emit32(layout.armState); emit({0}); // cmp byte [rbx + armState], 0
+		exitJump(armStateExitJcc);
+		emit({0x83, 0xBB}); emit32(layout.swiTicks); emit({0}); // cmp dword [rbx + swiTicks], 0
+		exitJump(0x85); // jne
+		emit({0x8B, 0x83}); emit32(layout.totalTicks); // mov eax, [rbx + totalTicks]
+		emit({0x3B, 0x83}); emit32(layout.nextEvent); // cmp eax, [rbx + nextEvent]
+		exitJump(0x8D); // jge
+		emit({0x41, 0x80, 0x3C, 0x24, 0}); // cmp byte [r12], 0
+		exitJump(0x85); // jne
+	}
+};
+
+class GBAJitArm64Emitter
+{
+public:
+	GBAJitArm64Emitter(std::span<uint8_t> buff, const GBAJitLayout &layout):
+		buff{buff}, layout{layout}
+	{
+		emit(0xA9BD7BFD); // stp x29, x30, [sp, #-48]!
+		emit(0x910003FD); // mov x29, sp
+		emit(0xA90153F3); // stp x19, x20, [sp, #16], [sp, #32] holds ARM clockTicks
+		emit(0xAA0003F3); // mov x19, x0
+		emit(0xAA0103F4); // mov x20, x1
+	}
+
+	void thumbInsn(const GBAJitInsn &insn, bool isLast)
+	{
+		storePrefetch(insn);
+		emit(strb(wzr, x19, layout.busPrefetch));
+		storeImm32(layout.armNextPC, insn.addr + 2);
+		storeImm32(layout.reg15, insn.addr + 4);
+		emit(movX0X19);
+		movImm32(1, insn.opcode);
+		movImm32(2, insn.addr);
+		call(insn.handler);
+		addSeqTicksIfZero(layout.thumbSeqTicks, insn.addr);
+		if(!isLast)
+			exitChecks(insn.addr + 4, cbnzW10);
+	}
+
+	void armInsn(const GBAJitInsn &insn, bool isLast)
+	{
+		if((insn.addr & 0x0803FFFF) == 0x08020000)
+			storeImm32(layout.busPrefetchCount, 0x100);
+		storePrefetch(insn);
+		emit(strb(wzr, x19, layout.busPrefetch));
+		// if(busPrefetchCount & 0xFFFFFE00) busPrefetchCount = 0x100 | (busPrefetchCount & 0xFF)
+		emit(ldr(9, x19, layout.busPrefetchCount));
+		emit(0x7217593F); // tst w9, #0xFFFFFE00
+		emit(0x54000000 | (4 << 5) | condEQ); // b.eq over the next 3 instructions
+		emit(0x12001D29); // and w9, w9, #0xFF
+		emit(0x32180129); // orr w9, w9, #0x100
+		emit(str(9, x19, layout.busPrefetchCount));
+		storeImm32(layout.armNextPC, insn.addr + 4);
+		storeImm32(layout.reg15, insn.addr + 8);
+		emit(0xB90023FF); // str wzr, [sp, #32]
+		auto cond = insn.opcode >> 28;
+		if(cond != 0xF) // NV never executes
+		{
+			size_t condJumpPos{};
+			if(cond != 0xE)
+			{
+				emit(movX0X19);
+				movImm32(1, cond);
+				call(layout.armCondition);
+				condJumpPos = pos;
+				emit(0x34000000); // cbz w0, past the handler
+			}
+			emit(movX0X19);
+			movImm32(1, insn.opcode);
+			emit(0x910083E2); // add x2, sp, #32
+			call(insn.handler);
+			if(condJumpPos)
+				patchBranch(condJumpPos, pos);
+		}
+		emit(0xB94023E0); // ldr w0, [sp, #32]
+		addSeqTicksIfZero(layout.armSeqTicks, insn.addr);
+		if(!isLast)
+			exitChecks(insn.addr + 8, cbzW10);
+	}
+
+	// Writes the shared exit path, returns the block size or 0 if it didn't fit
+	size_t finish()
+	{
+		auto exitPos = pos;
+		emit(0xA94153F3); // ldp x19, x20, [sp, #16]
+		emit(0xA8C37BFD); // ldp x29, x30, [sp], #48
+		emit(0xD65F03C0); // ret
+		if(overflow)
+			return 0;
+		for(auto fixupPos : exitFixups)
+			patchBranch(fixupPos, exitPos);
+		return pos;
+	}
+
+private:
+	static constexpr uint32_t x19 = 19, x20 = 20, wzr = 31;
+	static constexpr uint32_t movX0X19 = 0xAA1303E0;
+	static constexpr uint32_t condEQ = 0x0, condNE = 0x1, condGE = 0xA;
+	static constexpr uint32_t cbzW10 = 0x3400000A, cbnzW10 = 0x3500000A;
+
+	std::span<uint8_t> buff;
+	const GBAJitLayout &layout;
+	std::vector<size_t> exitFixups;
+	size_t pos{};
+	bool overflow{};
+
+	void emit(uint32_t insn)
+	{
+		if(pos + 4 > buff.size())
+		{
+			overflow = true;
+			return;
+		}
+		std::memcpy(&buff[pos], &insn, 4);
+		pos += 4;
+	}
+
+	// sets the 19-bit offset of the B.cond/CBZ/CBNZ at branchPos
+	void patchBranch(size_t branchPos, size_t targetPos)
+	{
+		if(overflow)
+			return;
+		uint32_t insn;
+		std::memcpy(&insn, &buff[branchPos], 4);
+		insn |= ((uint32_t(int32_t(targetPos - branchPos) / 4)) & 0x7FFFF) << 5;
+		std::memcpy(&buff[branchPos], &insn, 4);
+	}
+
+	static constexpr uint32_t ldr(uint32_t rt, uint32_t rn, int32_t offset) { return 0xB9400000 | (uint32_t(offset / 4) << 10) | (rn << 5) | rt; }
+	static constexpr uint32_t str(uint32_t rt, uint32_t rn, int32_t offset) { return 0xB9000000 | (uint32_t(offset / 4) << 10) | (rn << 5) | rt; }
+	static constexpr uint32_t ldrb(uint32_t rt, uint32_t rn, int32_t offset) { return 0x39400000 | (uint32_t(offset) << 10) | (rn << 5) | rt; }
+	static constexpr uint32_t strb(uint32_t rt, uint32_t rn, int32_t offset) { return 0x39000000 | (uint32_t(offset) << 10) | (rn << 5) | rt; }
+
+	void movImm32(uint32_t rd, uint32_t v)
+	{
+		emit(0x52800000 | ((v & 0xFFFF) << 5) | rd); // movz wd, #lo
+		if(v >> 16)
+			emit(0x72A00000 | ((v >> 16) << 5) | rd); // movk wd, #hi, lsl #16
+	}
+
+	void movImm64(uint32_t rd, uint64_t v)
+	{
+		emit(0xD2800000 | uint32_t((v & 0xFFFF) << 5) | rd); // movz xd, #v0
+		for(uint32_t hw = 1; hw < 4; hw++)
+		{
+			if(uint32_t part = (v >> (hw * 16)) & 0xFFFF)
+				emit(0xF2800000 | (hw << 21) | (part << 5) | rd); // movk xd, #part, lsl #(hw * 16)
+		}
+	}
+
+	// cpuPrefetch is only 4 byte aligned
+	void storePrefetch(const GBAJitInsn &insn)
+	{
+		storeImm32(layout.prefetch, insn.prefetch[0]);
+		storeImm32(layout.prefetch + 4, insn.prefetch[1]);
+	}
+
+	void storeImm32(int32_t offset, uint32_t v)
+	{
+		movImm32(9, v);
+		emit(str(9, x19, offset));
+	}
+
+	void call(uintptr_t func)
+	{
+		movImm64(16, func);
+		emit(0xD63F0200); // blr x16
+	}
+
+	// takes the handler's ticks in w0, adds the sequential code fetch time instead if it's 0
+	void addSeqTicksIfZero(uintptr_t seqTicksFunc, uint32_t addr)
+	{
+		auto skipPos = pos;
+		emit(0x35000000); // cbnz w0, past the call
+		emit(movX0X19);
+		movImm32(1, addr);
+		call(seqTicksFunc);
+		patchBranch(skipPos, pos);
+		emit(ldr(9, x19, layout.totalTicks));
+		emit(0x0B000129); // add w9, w9, w0
+		emit(str(9, x19, layout.totalTicks));
+		emit(ldr(10, x19, layout.idleLoopInsns));
+		emit(0x1100054A); // add w10, w10, #1
+		emit(str(10, x19, layout.idleLoopInsns));
+	}
+
+	void exitBranch(uint32_t insn)
+	{
+		exitFixups.emplace_back(pos);
+		emit(insn);
+	}
+
+	// w9 holds totalTicks from addSeqTicksIfZero(), armStateExitInsn is cbnz for Thumb and cbz for ARM code
+	void exitChecks(uint32_t nextReg15, uint32_t armStateExitInsn)
+	{
+		emit(ldr(10, x19, layout.reg15));
+		movImm32(11, nextReg15);
+		emit(0x6B0B015F); // cmp w10, w11
+		exitBranch(0x54000000 | condNE);
+		emit(ldrb(10, x19, layout.armState));
+		exitBranch(armStateExitInsn);
+		emit(ldr(10, x19, layout.swiTicks));
+		exitBranch(cbnzW10);
+		emit(ldr(10, x19, layout.nextEvent));
+		emit(0x6B0A013F); // cmp w9, w10
+		exitBranch(0x54000000 | condGE);
+		emit(ldrb(10, x20, 0));
+		exitBranch(cbnzW10);
+	}
+};
@@ -0,0 +1,267 @@
+/*  This file is part of GBA.emu.
+
+	GBA.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	GBA.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with GBA.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include "GBASys.hh"
+#include <imagine/logger/logger.h>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+// not named log, that would conflict with VBA-M's global log()
+constexpr IG::SystemLogger rendererLog{"GBALineRenderer"};
+
+// VRAM, palette, and OAM deltas share one address space in the delta buffer
+constexpr uint32_t paletteDeltaAddr = 0x20000;
+constexpr uint32_t oamDeltaAddr = 0x20400;
+
+struct DeltaHeader
+{
+	uint32_t addr;
+	uint32_t size;
+};
+
+static uint8_t *deltaDest(GBALCD &lcd, uint32_t addr)
+{
+	if(addr < paletteDeltaAddr)
+		return &lcd.vram[addr];
+	if(addr < oamDeltaAddr)
+		return &lcd.paletteRAM[addr - paletteDeltaAddr];
+	return &lcd.oam[addr - oamDeltaAddr];
+}
+
+// same as CPUUpdateRenderBuffers() for the layers set in the mask
+static void clearLines(GBALCD &lcd, uint8_t mask)
+{
+	uint32_t *lines[]{lcd.line0, lcd.line1, lcd.line2, lcd.line3};
+	for(int i = 0; i < 4; i++)
+	{
+		if(mask & (1 << i))
+			std::fill_n(lines[i], 240, 0x80000000);
+	}
+}
+
+GBALineRenderer::~GBALineRenderer()
+{
+	if(!isActive())
+		return;
+	drain();
+	queueLine({});
+	thread.join();
+}
+
+void GBALineRenderer::start()
+{
+	if(isActive())
+		return;
+	lcd = std::make_unique<GBALCD>();
+	lines = std::make_unique<LineJob[]>(maxLines);
+	deltaBuff = std::make_unique<uint8_t[]>(deltaBuffSize);
+	deltaSize = 0;
+	queuedLines = 0;
+	submittedLines = 0;
+	renderedLines = 0;
+	needsUpload = true;
+	thread = IG::makeThreadSync([this](auto &sem)
+	{
+		threadId_ = IG::thisThreadId();
+		sem.release();
+		rendererLog.info("starting render thread");
+		run();
+		rendererLog.info("exiting render thread");
+	});
+}
+
+void GBALineRenderer::stop(GBALCD &emuLcd)
+{
+	if(!isActive())
+		return;
+	flush(emuLcd);
+	queueLine({});
+	thread.join();
+	threadId_ = {};
+	lcd.reset();
+	lines.reset();
+	deltaBuff.reset();
+}
+
+void GBALineRenderer::renderLine(GBALCD &emuLcd, const GBAMem::IoMem &ioMem)
+{
+	if(needsUpload)
+	{
+		// worker is idle after flush(), copy everything at once
+		*lcd = emuLcd;
+		emuLcd.vramDirty = {};
+		emuLcd.paletteDirty = emuLcd.oamDirty = false;
+		emuLcd.pendingLineClears = 0;
+		needsUpload = false;
+	}
+	if(queuedLines - renderedLines.load(std::memory_order_acquire) == maxLines)
+	{
+		auto rendered = queuedLines - maxLines;
+		renderedLines.wait(rendered, std::memory_order_acquire);
+	}
+	auto &job = lines[queuedLines % maxLines];
+	job.deltaStart = queueDeltas(emuLcd);
+	job.deltaEnd = deltaSize;
+	job.renderLine = emuLcd.renderLine;
+	job.lineMix = emuLcd.lineMix;
+	job.layerEnable = emuLcd.layerEnable;
+	job.bg2Changed = emuLcd.gfxBG2Changed;
+	job.bg3Changed = emuLcd.gfxBG3Changed;
+	job.lineClears = emuLcd.pendingLineClears;
+	memcpy(job.lcdRegs.data(), ioMem.b, lcdRegsSize);
+	memcpy(job.gfxInWin0, emuLcd.gfxInWin0, sizeof(job.gfxInWin0));
+	memcpy(job.gfxInWin1, emuLcd.gfxInWin1, sizeof(job.gfxInWin1));
+	queuedLines++;
+	submittedLines.store(queuedLines, std::memory_order_release);
+	submittedLines.notify_one();
+	// the worker's copy now owns these, renderLine would have reset the BG changed flags anyway
+	emuLcd.gfxBG2Changed = emuLcd.gfxBG3Changed = 0;
+	emuLcd.pendingLineClears = 0;
+}
+
+void GBALineRenderer::queueLine(const LineJob &job)
+{
+	lines[queuedLines % maxLines] = job;
+	queuedLines++;
+	submittedLines.store(queuedLines, std::memory_order_release);
+	submittedLines.notify_one();
+}
+
+uint32_t GBALineRenderer::queueDeltas(GBALCD &emuLcd)
+{
+	size_t dirtyBlocks{};
+	for(auto bits : emuLcd.vramDirty)
+		dirtyBlocks += std::popcount(bits);
+	constexpr size_t blockSize = 1 << GBALCD::vramDirtyBlockShift;
+	size_t neededSize = dirtyBlocks * (blockSize + sizeof(DeltaHeader)) +
+		(emuLcd.paletteDirty ? sizeof(emuLcd.paletteRAM) + sizeof(DeltaHeader) : 0) +
+		(emuLcd.oamDirty ? sizeof(emuLcd.oam) + sizeof(DeltaHeader) : 0);
+	if(!neededSize)
+		return deltaSize;
+	if(deltaSize + neededSize > deltaBuffSize)
+		drain();
+	auto startSize = deltaSize;
+	// coalesce runs of dirty blocks into single deltas
+	for(uint32_t wordIdx = 0; wordIdx < emuLcd.vramDirty.size(); wordIdx++)
+	{
+		auto bits = std::exchange(emuLcd.vramDirty[wordIdx], 0);
+		while(bits)
+		{
+			auto first = std::countr_zero(bits);
+			auto count = std::countr_one(bits >> first);
+			auto addr = ((wordIdx * 64) + first) * blockSize;
+			pushDelta(addr, &emuLcd.vram[addr], count * blockSize);
+			bits = count == 64 ? 0 : bits & ~(((1ull << count) - 1) << first);
+		}
+	}
+	if(emuLcd.paletteDirty)
+	{
+		pushDelta(paletteDeltaAddr, emuLcd.paletteRAM, sizeof(emuLcd.paletteRAM));
+		emuLcd.paletteDirty = false;
+	}
+	if(emuLcd.oamDirty)
+	{
+		pushDelta(oamDeltaAddr, emuLcd.oam, sizeof(emuLcd.oam));
+		emuLcd.oamDirty = false;
+	}
+	return startSize;
+}
+
+void GBALineRenderer::pushDelta(uint32_t addr, const uint8_t *data, uint32_t size)
+{
+	DeltaHeader header{addr, size};
+	memcpy(&deltaBuff[deltaSize], &header, sizeof(header));
+	memcpy(&deltaBuff[deltaSize + sizeof(header)], data, size);
+	deltaSize += sizeof(header) + size;
+}
+
+void GBALineRenderer::waitForFrame()
+{
+	if(!isActive())
+		return;
+	drain();
+}
+
+void GBALineRenderer::drain()
+{
+	while(true)
+	{
+		auto rendered = renderedLines.load(std::memory_order_acquire);
+		if(rendered == queuedLines)
+			break;
+		renderedLines.wait(rendered, std::memory_order_acquire);
+	}
+	deltaSize = 0;
+}
+
+void GBALineRenderer::flush(GBALCD &emuLcd)
+{
+	if(!isActive() || needsUpload)
+		return;
+	drain();
+	memcpy(emuLcd.line0, lcd->line0, sizeof(emuLcd.line0));
+	memcpy(emuLcd.line1, lcd->line1, sizeof(emuLcd.line1));
+	memcpy(emuLcd.line2, lcd->line2, sizeof(emuLcd.line2));
+	memcpy(emuLcd.line3, lcd->line3, sizeof(emuLcd.line3));
+	memcpy(emuLcd.lineOBJ, lcd->lineOBJ, sizeof(emuLcd.lineOBJ));
+	memcpy(emuLcd.lineOBJWin, lcd->lineOBJWin, sizeof(emuLcd.lineOBJWin));
+	memcpy(emuLcd.lineOBJpixleft, lcd->lineOBJpixleft, sizeof(emuLcd.lineOBJpixleft));
+	clearLines(emuLcd, emuLcd.pendingLineClears);
+	emuLcd.pendingLineClears = 0;
+	emuLcd.gfxBG2Changed |= lcd->gfxBG2Changed;
+	emuLcd.gfxBG3Changed |= lcd->gfxBG3Changed;
+	emuLcd.gfxBG2X = lcd->gfxBG2X;
+	emuLcd.gfxBG2Y = lcd->gfxBG2Y;
+	emuLcd.gfxBG3X = lcd->gfxBG3X;
+	emuLcd.gfxBG3Y = lcd->gfxBG3Y;
+	emuLcd.gfxLastVCOUNT = lcd->gfxLastVCOUNT;
+	needsUpload = true;
+}
+
+void GBALineRenderer::run()
+{
+	GBAMem::IoMem ioMem{};
+	uint32_t renderedIdx = renderedLines.load(std::memory_order_relaxed);
+	while(true)
+	{
+		submittedLines.wait(renderedIdx, std::memory_order_acquire);
+		auto submittedIdx = submittedLines.load(std::memory_order_acquire);
+		for(; renderedIdx != submittedIdx; renderedIdx++)
+		{
+			auto &job = lines[renderedIdx % maxLines];
+			if(!job.renderLine)
+				return;
+			for(auto offset = job.deltaStart; offset != job.deltaEnd;)
+			{
+				DeltaHeader header;
+				memcpy(&header, &deltaBuff[offset], sizeof(header));
+				offset += sizeof(header);
+				memcpy(deltaDest(*lcd, header.addr), &deltaBuff[offset], header.size);
+				offset += header.size;
+			}
+			clearLines(*lcd, job.lineClears);
+			lcd->layerEnable = job.layerEnable;
+			lcd->gfxBG2Changed |= job.bg2Changed;
+			lcd->gfxBG3Changed |= job.bg3Changed;
+			memcpy(lcd->gfxInWin0, job.gfxInWin0, sizeof(job.gfxInWin0));
+			memcpy(lcd->gfxInWin1, job.gfxInWin1, sizeof(job.gfxInWin1));
+			memcpy(ioMem.b, job.lcdRegs.data(), lcdRegsSize);
+			job.renderLine(job.lineMix, *lcd, ioMem);
+			renderedLines.store(renderedIdx + 1, std::memory_order_release);
+			renderedLines.notify_one();
+		}
+	}
+}
@@ -3,8 +3,17 @@
 #include <core/base/system.h>
 #include <core/base/port.h>
 #include <core/gba/gba.h>
+#include <imagine/thread/Thread.hh>
 #include <imagine/util/used.hh>
 #include <imagine/util/utility.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using MixColorType = uint16_t;
 struct GBALCD;
@@ -282,20 +291,40 @@ struct GBALCD
 	int layerEnableDelay{};
 	int lcdTicks{};
 	uint16_t gfxLastVCOUNT{};
+	// memory changed since the last line was queued to GBALineRenderer
+	static constexpr unsigned vramDirtyBlockShift = 8;
+	std::array<uint64_t, 0x20000 / (64 << vramDirtyBlockShift)> vramDirty{};
+	bool paletteDirty{};
+	bool oamDirty{};
+	uint8_t pendingLineClears{};
+
+	void markVramDirty(uint32_t addr)
+	{
+		vramDirty[addr >> (vramDirtyBlockShift + 6)] |= 1ull << ((addr >> vramDirtyBlockShift) & 63);
+	}
+
+	void markAllDirty()
+	{
+		vramDirty.fill(~0ull);
+		paletteDirty = oamDirty = true;
+	}
 
 	void registerRamReset(uint32_t flags)
 	{
     if(flags & 0x04) {
       // clear palette RAM
       memset(paletteRAM, 0, 0x400);
+      paletteDirty = true;
     }
     if(flags & 0x08) {
       // clear VRAM
       memset(vram, 0, 0x18000);
+      std::fill_n(vramDirty.begin(), 0x18000 / (64 << vramDirtyBlockShift), ~0ull);
     }
     if(flags & 0x10) {
       // clean OAM
       memset(oam, 0, 0x400);
+      oamDirty = true;
     }
 	}
 
@@ -305,6 +334,7 @@ struct GBALCD
 		memset(vram, 0, sizeof(vram));
 		memset(oam, 0, sizeof(oam));
 		memset(pix, 0, sizeof(pix));
+		markAllDirty();
 	}
 
 	void resetAll(bool useBios, bool skipBios, GBAMem::IoMem &ioMem)
@@ -317,6 +347,62 @@ struct GBALCD
 
 const char *dispModeName(GBALCD::RenderLineFunc);
 
+// Renders scanlines on a worker thread from its own copy of GBALCD. Each queued line carries the
+// LCD registers at the time it was queued plus the VRAM, palette, and OAM writes made since the
+// previous line so the output matches calling GBALCD::renderLine directly on the emulation thread.
+class GBALineRenderer
+{
+public:
+	GBALineRenderer() = default;
+	~GBALineRenderer();
+	void start();
+	void stop(GBALCD &);
+	bool isActive() const { return thread.joinable(); }
+	IG::ThreadId threadId() const { return threadId_; }
+	void renderLine(GBALCD &, const GBAMem::IoMem &);
+	void waitForFrame();
+	// Waits for all queued lines & copies the worker-owned state back so GBALCD can be modified directly,
+	// must be called before any change to GBALCD not tracked by its dirty flags
+	void flush(GBALCD &);
+
+private:
+	static constexpr size_t lcdRegsSize = 0x56;
+	static constexpr uint32_t maxLines = 64;
+	static constexpr size_t deltaBuffSize = 0x40000;
+
+	struct LineJob
+	{
+		GBALCD::RenderLineFunc renderLine{};
+		MixColorType *lineMix{};
+		unsigned layerEnable{};
+		uint32_t deltaStart{};
+		uint32_t deltaEnd{};
+		uint8_t bg2Changed{};
+		uint8_t bg3Changed{};
+		uint8_t lineClears{};
+		std::array<uint8_t, lcdRegsSize> lcdRegs;
+		bool gfxInWin0[240];
+		bool gfxInWin1[240];
+	};
+
+	std::thread thread;
+	std::unique_ptr<GBALCD> lcd;
+	std::unique_ptr<LineJob[]> lines;
+	std::unique_ptr<uint8_t[]> deltaBuff;
+	uint32_t deltaSize{};
+	uint32_t queuedLines{};
+	std::atomic<uint32_t> submittedLines{};
+	std::atomic<uint32_t> renderedLines{};
+	IG::ThreadId threadId_{};
+	bool needsUpload{};
+
+	void run();
+	void drain();
+	void queueLine(const LineJob &);
+	uint32_t queueDeltas(GBALCD &);
+	void pushDelta(uint32_t addr, const uint8_t *data, uint32_t size);
+};
+
 struct ARM7TDMI;
 
 static inline uint32_t CPUReadByteQuick(ARM7TDMI &cpu, uint32_t addr);
@@ -353,6 +439,160 @@ constexpr unsigned cpuBitsSet[256] =
 #define VBAM_USE_DELAYED_CPU_FLAGS
 
 struct GBASys;
+struct GBAJitLayout;
+
+// Finds loops that only read memory that can't change before the next scheduled event, like waiting
+// on VCOUNT, DISPSTAT, or an interrupt flag in RAM, and skips the iterations left before that event.
+// A loop is tracked from its taken backward branch, once two consecutive iterations start with the
+// same CPU state the rest are known to repeat identically and their ticks are added in one step.
+struct GBAIdleLoopDetector
+{
+	static constexpr int maxBodyInsns = 16;
+
+	struct Stats
+	{
+		uint64_t skips{};
+		uint64_t skippedTicks{};
+		uint64_t totalTicks{};
+	};
+
+	struct Verdict
+	{
+		uint32_t branch{};
+		bool isIdle{};
+	};
+
+	struct CPUState
+	{
+		std::array<uint32_t, 15> reg{};
+		uint32_t busPrefetchCount{};
+		bool n{}, z{}, c{}, v{};
+		bool busPrefetch{};
+
+		constexpr bool operator==(const CPUState &) const = default;
+	};
+
+	std::array<Verdict, 64> verdicts{}; // recently analyzed loop branches, bit 0 of the address set for Thumb
+	CPUState state;
+	Stats stats;
+	uint32_t branch{}; // branch of the loop being tracked
+	uint32_t epoch{}; // incremented on each event, iterations are only comparable within one
+	uint32_t stateEpoch{};
+	uint32_t insns{}; // instructions executed, used to check exactly one iteration ran between branches
+	uint32_t stateInsns{};
+	int stateTicks{};
+
+	Verdict &verdictFor(uint32_t branch)
+	{
+		return verdicts[(branch ^ (branch >> 6)) % verdicts.size()];
+	}
+
+	void onEvent(int ticks)
+	{
+		epoch++;
+		stats.totalTicks += ticks;
+	}
+
+	void reset()
+	{
+		verdicts = {};
+		branch = 0;
+		stats = {};
+	}
+};
+
+// Translates runs of ARM or Thumb instructions into native code that calls the interpreter's handler
+// for each one with the fetch, pipeline, and tick bookkeeping of armExecute()/thumbExecute() done
+// inline, checking after every instruction for the same loop exit conditions. Blocks are keyed by
+// address and ARM/Thumb state and only entered when the CPU's prefetched opcodes match the ones they
+// were translated with, otherwise the interpreter runs one instruction. Writes to a 256 byte page
+// of BIOS/RAM that blocks were translated from drop them and end the running block.
+class GBAJit
+{
+public:
+	#if (defined __x86_64__ || defined __aarch64__) && !defined __APPLE__ && !defined VBAM_ENABLE_DEBUGGER
+	static constexpr bool isSupported = true;
+	#else
+	static constexpr bool isSupported = false;
+	#endif
+	static constexpr uint32_t pageShift = 8;
+	static constexpr uint32_t biosPage = 0;
+	static constexpr uint32_t workRAMPage = biosPage + (0x4000 >> pageShift);
+	static constexpr uint32_t internalRAMPage = workRAMPage + (0x40000 >> pageShift);
+	static constexpr uint32_t romPage = internalRAMPage + (0x8000 >> pageShift);
+	static constexpr uint32_t maxBlockInsns = 32;
+
+	struct Stats
+	{
+		uint64_t translatedBlocks{};
+		uint64_t droppedBlocks{};
+		uint64_t flushes{};
+		uint64_t blockRuns{};
+		uint64_t interpretedInsns{};
+	};
+
+	GBAJit() = default;
+	GBAJit(const GBAJit &) = delete;
+	GBAJit &operator=(const GBAJit &) = delete;
+	~GBAJit() { setEnabled(false); }
+	bool isEnabled() const { return codeBuff.data(); }
+	bool isActive() const { return isEnabled() && !suspended; }
+	// runs the interpreter while keeping translated blocks, used to compare the two on the same input
+	void setSuspended(bool on) { suspended = on; }
+	// returns false if the host isn't supported or the code buffer can't be allocated
+	bool setEnabled(bool on);
+	// runs until the same conditions armExecute()/thumbExecute() stop at
+	int execute(ARM7TDMI &);
+	void invalidateWorkRAM(uint32_t addr) { invalidatePage(workRAMPage + ((addr & 0x3FFFF) >> pageShift)); }
+	void invalidateInternalRAM(uint32_t addr) { invalidatePage(internalRAMPage + ((addr & 0x7FFF) >> pageShift)); }
+	// for writes outside of CPUWriteMemory() and friends, like BIOS RAM clears and ROM patches
+	void invalidate(uint32_t addr, uint32_t size);
+	void flush();
+	// drops blocks whose source changed after memory was replaced by a state load
+	void revalidate(ARM7TDMI &);
+	const Stats &stats() const { return stats_; }
+
+private:
+	struct Block
+	{
+		uint32_t key{};
+		uint32_t codeOffset{};
+		uint32_t endAddr{}; // includes the opcodes prefetched by the last instruction
+		uint32_t hash{};
+		uint32_t prefetch[2]{}; // pipeline contents on entry
+	};
+
+	std::span<uint8_t> codeBuff;
+	size_t codeSize{};
+	std::unordered_map<uint32_t, Block> blocks; // keyed by address with bit 0 set for Thumb
+	std::unordered_map<uint32_t, std::vector<uint32_t>> pageBlocks;
+	std::unique_ptr<Block*[]> recentBlocks;
+	std::array<uint8_t, romPage> pageHasCode{}; // BIOS & RAM pages with entries in pageBlocks
+	Stats stats_;
+	bool exitBlock{};
+	bool suspended{};
+
+	void invalidatePage(uint32_t page)
+	{
+		if(pageHasCode[page]) [[unlikely]]
+			dropPage(page);
+	}
+
+	static GBAJitLayout makeLayout(ARM7TDMI &);
+	void dropPage(uint32_t page);
+	void dropBlock(uint32_t key);
+	Block *findBlock(ARM7TDMI &, uint32_t addr, bool thumb);
+	Block *translate(ARM7TDMI &, uint32_t addr, bool thumb);
+};
+
+// interpreter entry points used by GBAJit
+void armExecuteInsn(ARM7TDMI &);
+void thumbExecuteInsn(ARM7TDMI &);
+uintptr_t armInsnHandler(uint32_t opcode);
+uintptr_t thumbInsnHandler(uint32_t opcode);
+int armInsnConditionPassed(ARM7TDMI &, uint32_t cond);
+int armInsnSeqTicks(ARM7TDMI &, uint32_t pc);
+int thumbInsnSeqTicks(ARM7TDMI &, uint32_t pc);
 
 struct ARM7TDMI
 {
@@ -378,6 +618,7 @@ struct ARM7TDMI
 	ConditionalMember<USE_IRQTICKS, int> IRQTicks{};
 #ifdef VBAM_USE_CPU_PREFETCH
 private:
+	friend class GBAJit;
 	uint32_t cpuPrefetch[2]{};
 #endif
 public:
@@ -398,6 +639,8 @@ public:
 	bool armState{true};
 	bool armIrqEnable{true};
 	bool holdState{};
+	bool skipIdleLoops{};
+	GBAIdleLoopDetector idleLoop;
 	//uint8_t cpuBitsSet[256];
 	//uint8_t cpuLowestBitSet[256];
 	GBASys *gba;
@@ -635,6 +878,18 @@ public:
 	{
 		return armMode ? armNextPC - 4: armNextPC - 2;
 	}
+
+	// called from taken backward branches with armNextPC already set to the target
+	void checkIdleLoop(uint32_t branchAddr);
+
+	GBAIdleLoopDetector::CPUState idleLoopState() const
+	{
+		GBAIdleLoopDetector::CPUState s{.busPrefetchCount = busPrefetchCount,
+			.n = nFlag(), .z = zFlag(), .c = C_FLAG, .v = V_FLAG, .busPrefetch = busPrefetch};
+		for(int i = 0; i < 15; i++)
+			s.reg[i] = reg[i].I;
+		return s;
+	}
 };
 
 struct GBASys
@@ -647,6 +902,8 @@ struct GBASys
 	GBATimers timers;
 	GBADMA dma;
 	GBAMem mem;
+	GBALineRenderer lineRenderer;
+	GBAJit jit;
 };
 
 extern GBASys gGba;
@@ -33,6 +33,7 @@
 #include <core/base/patch.h>
 #include <core/base/file_util.h>
 #include <sys/mman.h>
+#include <algorithm>
 
 bool patchApplyIPS(FILE* f, uint8_t** rom, int *size);
 bool patchApplyUPS(FILE* f, uint8_t** rom, int *size);
@@ -90,12 +91,8 @@ FS::FileString GbaSystem::stateFilename(int slot, std::string_view name) const
 
 void GbaSystem::readState(EmuApp &app, std::span<uint8_t> buff)
 {
-	DynArray<uint8_t> uncompArr;
-	if(hasGzipHeader(buff))
-	{
-		uncompArr = uncompressGzipState(buff, saveStateSize);
-		buff = uncompArr;
-	}
+	if(detectStateCodec(buff))
+		buff = uncompressStateToScratchBuffer(buff, saveStateSize);
 	if(!CPUReadState(gGba, buff.data()))
 		throw std::runtime_error("Invalid state data");
 }
@@ -110,7 +107,7 @@ size_t GbaSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 	else
 	{
 		assert(saveStateSize);
-		auto stateArr = DynArray<uint8_t>(saveStateSize);
+		auto stateArr = stateScratchBuffer(saveStateSize);
 		CPUWriteState(gGba, stateArr.data());
 		return compressGzip(buff, stateArr, Z_DEFAULT_COMPRESSION);
 	}
@@ -153,6 +150,7 @@ WallClockTimePoint GbaSystem::backupMemoryLastWriteTime(const EmuApp &app) const
 void GbaSystem::closeSystem()
 {
 	assert(hasContent());
+	gGba.lineRenderer.stop(gGba.lcd);
 	CPUCleanUp();
 	saveFileIO = {};
 	coreOptions.saveType = GBA_SAVE_NONE;
@@ -161,6 +159,8 @@ void GbaSystem::closeSystem()
 	sensorListener = {};
 	darknessLevel = darknessLevelDefault;
 	cheatsList.clear();
+	gGba.jit.setEnabled(false);
+	jitCompareBuff.reset();
 }
 
 void GbaSystem::applyGamePatches(uint8_t *rom, int &romSize)
@@ -214,7 +214,10 @@ void GbaSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDelegat
 	}
 	CPUInit(gGba, biosRom);
 	CPUReset(gGba);
-	saveStateSize = CPUWriteState(gGba, DynArray<uint8_t>{maxStateSize}.data());
+	saveStateSize = CPUWriteState(gGba, stateScratchBuffer(maxStateSize).data());
+	applyThreadedRendering();
+	applySkipIdleLoops();
+	applyCpuRecompiler();
 	readCheatFile(*this);
 }
 
@@ -242,12 +245,86 @@ bool GbaSystem::onVideoRenderFormatChange(EmuVideo &video, IG::PixelFormat fmt)
 
 void GbaSystem::renderFramebuffer(EmuVideo &video)
 {
+	gGba.lineRenderer.waitForFrame();
 	systemDrawScreen({}, video);
 }
 
+void GbaSystem::applyThreadedRendering()
+{
+	if(threadedRendering)
+	{
+		log.info("rendering scanlines on worker thread");
+		gGba.lineRenderer.start();
+	}
+	else
+	{
+		gGba.lineRenderer.stop(gGba.lcd);
+	}
+}
+
+void GbaSystem::applySkipIdleLoops()
+{
+	gGba.cpu.skipIdleLoops = skipIdleLoops;
+}
+
+void GbaSystem::applyCpuRecompiler()
+{
+	if(!gGba.jit.setEnabled(cpuRecompiler))
+		log.error("CPU recompiler isn't available, using interpreter");
+	gGba.jit.setSuspended(false);
+	if(gGba.jit.isEnabled() && compareCpuRecompiler)
+	{
+		if(!jitCompareBuff)
+		{
+			log.info("comparing recompiler with interpreter every frame");
+			jitCompareBuff = std::make_unique<uint8_t[]>(saveStateSize * 3);
+			jitComparedFrames = 0;
+		}
+	}
+	else
+	{
+		jitCompareBuff.reset();
+	}
+}
+
+void GbaSystem::addThreadGroupIds(std::vector<ThreadId> &ids) const
+{
+	if(gGba.lineRenderer.isActive())
+		ids.emplace_back(gGba.lineRenderer.threadId());
+}
+
 void GbaSystem::runFrame(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio *audio)
 {
+	if(jitCompareBuff) [[unlikely]]
+		return runJitComparisonFrame(taskCtx, video, audio);
+	CPULoop(gGba, taskCtx, video, audio);
+}
+
+// Runs the frame on the interpreter without output, then again from the same starting state with the
+// recompiler and compares the two resulting states. On the first difference the interpreter's state
+// is kept and the rest of the session runs on the interpreter.
+void GbaSystem::runJitComparisonFrame(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio *audio)
+{
+	std::span startState{jitCompareBuff.get(), saveStateSize};
+	std::span interpreterState{startState.data() + saveStateSize, saveStateSize};
+	std::span jitState{interpreterState.data() + saveStateSize, saveStateSize};
+	CPUWriteState(gGba, startState.data());
+	gGba.jit.setSuspended(true);
+	CPULoop(gGba, taskCtx, nullptr, nullptr);
+	gGba.jit.setSuspended(false);
+	CPUWriteState(gGba, interpreterState.data());
+	CPUReadState(gGba, startState.data());
 	CPULoop(gGba, taskCtx, video, audio);
+	CPUWriteState(gGba, jitState.data());
+	jitComparedFrames++;
+	if(auto [it, jitIt] = std::ranges::mismatch(interpreterState, jitState); it != interpreterState.end())
+	{
+		log.error("recompiler state differs from interpreter at frame:{} offset:0x{:X}, switching to interpreter",
+			jitComparedFrames, it - interpreterState.begin());
+		CPUReadState(gGba, interpreterState.data());
+		gGba.jit.setSuspended(true);
+		jitCompareBuff.reset();
+	}
 }
 
 void GbaSystem::configAudioRate(FrameTime outputFrameTime, int outputRate)
@@ -265,6 +342,17 @@ void GbaSystem::onStart()
 void GbaSystem::onStop()
 {
 	setSensorActive(false);
+	if(auto &stats = gGba.cpu.idleLoop.stats; stats.totalTicks)
+	{
+		log.info("idle loops skipped:{} ({:.1f}% of cycles)", stats.skips,
+			stats.skippedTicks * 100. / stats.totalTicks);
+	}
+	if(gGba.jit.isEnabled())
+	{
+		auto &stats = gGba.jit.stats();
+		log.info("recompiled blocks:{} dropped:{} flushes:{} block runs:{} interpreted instructions:{} frames compared:{}",
+			stats.translatedBlocks, stats.droppedBlocks, stats.flushes, stats.blockRuns, stats.interpretedInsns, jitComparedFrames);
+	}
 }
 
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
@@ -289,12 +377,12 @@ void systemDrawScreen(EmuEx::EmuSystemTaskContext taskCtx, EmuEx::EmuVideo &vide
 	assumeExpr(img.pixmap().size() == framePix.size());
 	if(img.pixmap().format() == IG::PixelFmtRGB565)
 	{
-		img.pixmap().writeTransformed([](uint16_t p){ return systemColorMap.map16[p]; }, framePix);
+		img.pixmap().writeLookup(systemColorMap.map16, framePix);
 	}
 	else
 	{
 		assumeExpr(img.pixmap().format().bytesPerPixel() == 4);
-		img.pixmap().writeTransformed([](uint16_t p){ return systemColorMap.map32[p]; }, framePix);
+		img.pixmap().writeLookup(systemColorMap.map32, framePix);
 	}
 	img.endFrame();
 }
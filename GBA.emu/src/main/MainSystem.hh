@@ -42,7 +42,9 @@ enum
 	CFGKEY_SENSOR_TYPE = 262, CFGKEY_LIGHT_SENSOR_SCALE = 263,
 	CFGKEY_CHEATS_PATH = 264, CFGKEY_PATCHES_PATH = 265,
 	CFGKEY_USE_BIOS = 266, CFGKEY_DEFAULT_USE_BIOS = 267,
-	CFGKEY_BIOS_PATH = 268
+	CFGKEY_BIOS_PATH = 268, CFGKEY_THREADED_RENDERING = 269,
+	CFGKEY_CPU_RECOMPILER = 270, CFGKEY_COMPARE_CPU_RECOMPILER = 271,
+	CFGKEY_SKIP_IDLE_LOOPS = 272
 };
 
 void readCheatFile(class EmuSystem &);
@@ -90,6 +92,13 @@ public:
 	bool saveMemoryIsMappedFile{};
 	Property<AutoTristate, CFGKEY_USE_BIOS> useBios;
 	Property<bool, CFGKEY_DEFAULT_USE_BIOS> defaultUseBios;
+	Property<bool, CFGKEY_THREADED_RENDERING> threadedRendering;
+	Property<bool, CFGKEY_SKIP_IDLE_LOOPS, PropertyDesc<bool>{.defaultValue = true}> skipIdleLoops;
+	Property<bool, CFGKEY_CPU_RECOMPILER> cpuRecompiler;
+	Property<bool, CFGKEY_COMPARE_CPU_RECOMPILER> compareCpuRecompiler;
+	// start, interpreter, and recompiler states of the frame being compared
+	std::unique_ptr<uint8_t[]> jitCompareBuff;
+	uint32_t jitComparedFrames{};
 	ConditionalMember<Config::SENSORS, GbaSensorType> sensorType{};
 	ConditionalMember<Config::SENSORS, GbaSensorType> detectedSensorType{};
 	static constexpr auto gbaFrameTime{fromSeconds<FrameTime>(280896. / 16777216.)}; // ~59.7275Hz
@@ -103,6 +112,9 @@ public:
 	void setSensorActive(bool);
 	void setSensorType(GbaSensorType);
 	void clearSensorValues();
+	void applyThreadedRendering();
+	void applySkipIdleLoops();
+	void applyCpuRecompiler();
 
 	// required API functions
 	void loadContent(IO &, EmuSystemCreateParams, OnLoadProgressDelegate);
@@ -132,9 +144,11 @@ public:
 	void closeSystem();
 	bool onVideoRenderFormatChange(EmuVideo &, IG::PixelFormat);
 	void renderFramebuffer(EmuVideo &);
+	void addThreadGroupIds(std::vector<ThreadId> &) const;
 
 private:
 	void applyGamePatches(uint8_t *rom, int &romSize);
+	void runJitComparisonFrame(EmuSystemTaskContext, EmuVideo *, EmuAudio *);
 	bool shouldUseBios() const
 	{
 		switch(useBios)
@@ -45,6 +45,8 @@ bool GbaSystem::resetSessionOptions(EmuApp &)
 	optionSaveTypeOverride.reset();
 	sensorType = GbaSensorType::Auto;
 	useBios.reset();
+	skipIdleLoops.reset();
+	applySkipIdleLoops();
 	return true;
 }
 
@@ -63,6 +65,9 @@ bool GbaSystem::readConfig(ConfigType type, MapIO &io, unsigned key)
 			case CFGKEY_PATCHES_PATH: return readStringOptionValue(io, patchesDir);
 			case CFGKEY_BIOS_PATH: return readStringOptionValue(io, biosPath);
 			case CFGKEY_DEFAULT_USE_BIOS: return readOptionValue(io, defaultUseBios);
+			case CFGKEY_THREADED_RENDERING: return readOptionValue(io, threadedRendering);
+			case CFGKEY_CPU_RECOMPILER: return readOptionValue(io, cpuRecompiler);
+			case CFGKEY_COMPARE_CPU_RECOMPILER: return readOptionValue(io, compareCpuRecompiler);
 		}
 	}
 	else if(type == ConfigType::SESSION)
@@ -74,6 +79,7 @@ bool GbaSystem::readConfig(ConfigType type, MapIO &io, unsigned key)
 			case CFGKEY_SENSOR_TYPE:
 				return readOptionValue(io, sensorType, [&](auto v){return v <= IG::lastEnum<GbaSensorType>;});
 			case CFGKEY_USE_BIOS: return readOptionValue(io, useBios);
+			case CFGKEY_SKIP_IDLE_LOOPS: return readOptionValue(io, skipIdleLoops);
 		}
 	}
 	return false;
@@ -92,6 +98,9 @@ void GbaSystem::writeConfig(ConfigType type, FileIO &io)
 		writeStringOptionValue(io, CFGKEY_PATCHES_PATH, patchesDir);
 		writeStringOptionValue(io, CFGKEY_BIOS_PATH, biosPath);
 		writeOptionValueIfNotDefault(io, defaultUseBios);
+		writeOptionValueIfNotDefault(io, threadedRendering);
+		writeOptionValueIfNotDefault(io, cpuRecompiler);
+		writeOptionValueIfNotDefault(io, compareCpuRecompiler);
 	}
 	else if(type == ConfigType::SESSION)
 	{
@@ -100,6 +109,7 @@ void GbaSystem::writeConfig(ConfigType type, FileIO &io)
 		if(sensorType != GbaSensorType::Auto)
 			writeOptionValue(io, CFGKEY_SENSOR_TYPE, sensorType);
 		writeOptionValueIfNotDefault(io, useBios);
+		writeOptionValueIfNotDefault(io, skipIdleLoops);
 	}
 }
 
@@ -52,6 +52,9 @@
 #include "system.h"
 #include "susie.h"
 #include "lynxdef.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
 
 //
 // As the Susie sprite engine only ever sees system RAM
@@ -695,8 +698,9 @@ uint32 CSusie::PaintSprites(void)
 								// Initialise our line
 								LineInit(voff);
 								onscreen=false;
+								int line_first=0,line_last=0;
 
-								// Now render an individual destination line
+								// Now decode an individual destination line into mLinePens
 								while((pixel=LineGetPixel())!=LINE_END)
 								{
 									// This is allowed to update every pixel
@@ -709,7 +713,9 @@ uint32 CSusie::PaintSprites(void)
 										// Draw if onscreen but break loop on transition to offscreen
 										if(hoff>=0 && hoff<SCREEN_WIDTH)
 										{
-											ProcessPixel(hoff,pixel);
+											mLinePens[hoff]=pixel;
+											if(!onscreen) line_first=hoff;
+											line_last=hoff;
 											onscreen = true;
 											everonscreen = true;
 										}
@@ -720,6 +726,15 @@ uint32 CSusie::PaintSprites(void)
 										hoff+=hsign;
 									}
 								}
+
+								// The drawn pixels are always one contiguous run
+								if(onscreen)
+								{
+									if(hsign==1)
+										PaintLine(line_first,line_last);
+									else
+										PaintLine(line_last,line_first);
+								}
 							}
 							voff+=vsign;
 
@@ -1188,6 +1203,186 @@ void CSusie::ProcessPixel(uint32 hoff,uint32 pixel)
 	}
 }
 
+//
+// Batched line painting
+//
+// PaintSprites() decodes each destination line into mLinePens, then the line
+// is painted here two pixels (one RAM byte) at a time instead of calling
+// ProcessPixel() per pixel. Pens 1-13 are always drawn and collide for every
+// sprite type, so each type reduces to which of pens 0, 14 and 15 are drawn,
+// which touch the collision buffer, and whether it reads back the collision
+// value or exclusive-ors the screen data. See the table above ProcessPixel().
+//
+
+struct TSpriteTypeRule
+{
+	uint16 drawPens;		// bit n set if pen n is written to the screen
+	uint16 collidePens;		// bit n set if pen n writes the collision buffer
+	bool readCollision;
+	bool xorPixels;
+};
+
+#define ALL_PENS		0xffff
+#define PEN(n)			(1<<(n))
+
+static const TSpriteTypeRule spriteTypeRules[8]=
+{
+	/* background shadow */		{ALL_PENS,							ALL_PENS&~PEN(14),			false,false},
+	/* background noncollide */	{ALL_PENS,							0,							false,false},
+	/* boundary shadow */		{ALL_PENS&~(PEN(0)|PEN(14)|PEN(15)),ALL_PENS&~(PEN(0)|PEN(14)),	true,false},
+	/* boundary */				{ALL_PENS&~(PEN(0)|PEN(15)),		ALL_PENS&~PEN(0),			true,false},
+	/* normal */				{ALL_PENS&~PEN(0),					ALL_PENS&~PEN(0),			true,false},
+	/* noncollide */			{ALL_PENS&~PEN(0),					0,							false,false},
+	/* xor shadow */			{ALL_PENS&~PEN(0),					ALL_PENS&~(PEN(0)|PEN(14)),	true,true},
+	/* shadow */				{ALL_PENS&~PEN(0),					ALL_PENS&~(PEN(0)|PEN(14)),	true,false},
+};
+
+// Nibble mask for a pen, high selects the first (upper nibble) pixel of a byte
+static INLINE uint8 PenMask(uint16 pens,uint32 pixel,bool high)
+{
+	if(!((pens>>pixel)&1)) return 0;
+	return high ? 0xf0 : 0x0f;
+}
+
+#if defined(__GNUC__) && __BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+#define SUSIE_VECTOR_PAINT
+
+// 16 pens, painted as 8 bytes of screen or collision RAM
+typedef uint8 TPenVec __attribute__((vector_size(16)));
+typedef uint16 TPenPairVec __attribute__((vector_size(16)));
+typedef uint8 TByteVec __attribute__((vector_size(8)));
+
+static INLINE TPenVec PenMaskVec(uint16 pens,TPenVec p)
+{
+	if(!pens) return TPenVec{};
+	TPenVec mask=~TPenVec{};
+	if(!(pens&PEN(0))) mask&=(TPenVec)(p!=0);
+	if(!(pens&PEN(14))) mask&=(TPenVec)(p!=14);
+	if(!(pens&PEN(15))) mask&=(TPenVec)(p!=15);
+	return mask&0x0f;
+}
+
+// Packs pen pairs into bytes, the first pen of each pair goes in the upper nibble
+static INLINE TByteVec PackPens(TPenVec p)
+{
+	TPenPairVec pairs=(TPenPairVec)p;
+	return __builtin_convertvector(((pairs&0xff)<<4)|(pairs>>8),TByteVec);
+}
+
+static INLINE uint64 VecBits(TByteVec v)
+{
+	uint64 bits;
+	memcpy(&bits,&v,sizeof(bits));
+	return bits;
+}
+
+static INLINE int MaxNibble(TByteVec v)
+{
+	if(!VecBits(v)) return 0;
+	TByteVec high=v>>4,low=v&0x0f;
+	TByteVec nibbles=high>low ? high : low;
+	int max=0;
+	for(int loop=0;loop<8;loop++) max=std::max(max,(int)nibbles[loop]);
+	return max;
+}
+#endif
+
+void CSusie::PaintLine(int first,int last)
+{
+	const TSpriteTypeRule &rule=spriteTypeRules[mSPRCTL0_Type];
+	const uint16 collidePens=(!mSPRCOLL_Collide && !mSPRSYS_NoCollide) ? rule.collidePens : 0;
+	const uint32 scr_addr=(uint16)(mLineBaseAddress+(first/2));
+	const uint32 col_addr=(uint16)(mLineCollisionAddress+(first/2));
+	const uint32 bytes=(last/2)-(first/2)+1;
+
+	// Keep the pixel by pixel order if the line wraps around the end of RAM
+	// or writes collision data over its own screen data
+	if(scr_addr+bytes>0x10000 || (collidePens && (col_addr+bytes>0x10000 ||
+		(scr_addr<col_addr+bytes && col_addr<scr_addr+bytes))))
+	{
+		for(int hoff=first;hoff<=last;hoff++) ProcessPixel(hoff,mLinePens[hoff]);
+		return;
+	}
+
+	// Pixels that only fill half a byte
+	if(first&1)
+	{
+		ProcessPixel(first,mLinePens[first]);
+		first++;
+	}
+	if(first<=last && !(last&1))
+	{
+		ProcessPixel(last,mLinePens[last]);
+		last--;
+	}
+	if(first>last) return;
+
+	uint8 *scr=mRamPointer+(uint16)(mLineBaseAddress+(first/2));
+	uint8 *col=mRamPointer+(uint16)(mLineCollisionAddress+(first/2));
+	const uint8 *pens=&mLinePens[first];
+	const uint32 pairs=(last-first+1)/2;
+	const uint8 collNumber=mSPRCOLL_Number*0x11;
+	uint32 drawn=0,collided=0;
+	uint32 loop=0;
+
+#ifdef SUSIE_VECTOR_PAINT
+	for(;loop+8<=pairs;loop+=8)
+	{
+		TPenVec p;
+		memcpy(&p,pens+loop*2,sizeof(p));
+		TByteVec data=PackPens(p);
+		TByteVec drawMask=PackPens(PenMaskVec(rule.drawPens,p));
+		TByteVec dest;
+		memcpy(&dest,scr+loop,sizeof(dest));
+		if(rule.xorPixels)
+			dest^=data&drawMask;
+		else
+			dest=(dest&~drawMask)|(data&drawMask);
+		memcpy(scr+loop,&dest,sizeof(dest));
+		drawn+=std::popcount(VecBits(drawMask))/4;
+
+		TByteVec colMask=PackPens(PenMaskVec(collidePens,p));
+		if(VecBits(colMask))
+		{
+			TByteVec coll;
+			memcpy(&coll,col+loop,sizeof(coll));
+			if(rule.readCollision) mCollision=std::max(mCollision,MaxNibble(coll&colMask));
+			coll=(coll&~colMask)|(collNumber&colMask);
+			memcpy(col+loop,&coll,sizeof(coll));
+			collided+=std::popcount(VecBits(colMask))/4;
+		}
+	}
+#endif
+
+	for(;loop<pairs;loop++)
+	{
+		const uint32 high=pens[loop*2],low=pens[loop*2+1];
+		const uint8 data=(high<<4)|low;
+		const uint8 drawMask=PenMask(rule.drawPens,high,true)|PenMask(rule.drawPens,low,false);
+		if(rule.xorPixels)
+			scr[loop]^=data&drawMask;
+		else
+			scr[loop]=(scr[loop]&~drawMask)|(data&drawMask);
+		drawn+=std::popcount(drawMask)/4;
+
+		const uint8 colMask=PenMask(collidePens,high,true)|PenMask(collidePens,low,false);
+		if(colMask)
+		{
+			if(rule.readCollision)
+			{
+				const uint8 coll=col[loop]&colMask;
+				mCollision=std::max({mCollision,coll>>4,coll&0x0f});
+			}
+			col[loop]=(col[loop]&~colMask)|(collNumber&colMask);
+			collided+=std::popcount(colMask)/4;
+		}
+	}
+
+	// Same cycle count as the equivalent ProcessPixel() calls
+	cycles_used+=drawn*(rule.xorPixels ? 3 : 2)*SPR_RDWR_CYC;
+	cycles_used+=collided*(rule.readCollision ? 3 : 2)*SPR_RDWR_CYC;
+}
+
 uint32 CSusie::LineInit(uint32 voff)
 {
 //	TRACE_SUSIE0("LineInit()");
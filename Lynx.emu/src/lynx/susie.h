@@ -338,6 +338,7 @@ class CSusie : public CLynxBase
 		uint32	LineGetBits(uint32 bits);
 
 		void	ProcessPixel(uint32 hoff,uint32 pixel);
+		void	PaintLine(int first,int last);
 		void	WritePixel(uint32 hoff,uint32 pixel);
 		uint32	ReadPixel(uint32 hoff);
 		void	WriteCollision(uint32 hoff,uint32 pixel);
@@ -425,6 +426,7 @@ class CSusie : public CLynxBase
 		uint32		mLineRepeatCount;
 		uint32		mLinePixel;
 		uint32		mLinePacketBitsLeft;
+		uint8		mLinePens[SCREEN_WIDTH];
 
 		int			mCollision;
 
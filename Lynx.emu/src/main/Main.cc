@@ -66,7 +66,7 @@ FS::FileString LynxSystem::stateFilename(int slot, std::string_view name) const
 
 size_t LynxSystem::stateSize() { return stateSizeMDFN(); }
 void LynxSystem::readState(EmuApp &app, std::span<uint8_t> buff) { readStateMDFN(app, buff); }
-size_t LynxSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags) { return writeStateMDFN(buff, flags); }
+size_t LynxSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags) { return writeStateMDFN(*this, buff, flags); }
 
 void LynxSystem::closeSystem()
 {
@@ -107,6 +107,7 @@ main/options.cc \
 main/input.cc \
 main/EmuMenuViews.cc \
 main/Cheats.cc \
+main/MdNtscFilter.cc \
 $(addprefix $(gplusPath)/,$(gplusSrc))
 
 include $(EMUFRAMEWORK_PATH)/package/emuframework.mk
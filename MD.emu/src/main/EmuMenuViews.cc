@@ -15,6 +15,7 @@
 
 #include <emuframework/SystemOptionView.hh>
 #include <emuframework/AudioOptionView.hh>
+#include <emuframework/VideoOptionView.hh>
 #include <emuframework/FilePathOptionView.hh>
 #include <emuframework/DataPathSelectView.hh>
 #include <emuframework/UserPathSelectView.hh>
@@ -221,6 +222,45 @@ public:
 	}
 };
 
+class CustomVideoOptionView : public VideoOptionView, public MainAppHelper
+{
+	using MainAppHelper::app;
+	using MainAppHelper::system;
+
+	TextMenuItem::SelectDelegate setNtscFilterDel()
+	{
+		return [this](TextMenuItem &item)
+		{
+			system().optionNtscFilter = MdNtscMode(item.id.val);
+			system().applyNtscFilter(app().video);
+		};
+	}
+
+	TextMenuItem ntscFilterItem[5]
+	{
+		{"Off",        attachParams(), setNtscFilterDel(), {.id = MdNtscMode::Off}},
+		{"Composite",  attachParams(), setNtscFilterDel(), {.id = MdNtscMode::Composite}},
+		{"S-Video",    attachParams(), setNtscFilterDel(), {.id = MdNtscMode::SVideo}},
+		{"RGB",        attachParams(), setNtscFilterDel(), {.id = MdNtscMode::RGB}},
+		{"Monochrome", attachParams(), setNtscFilterDel(), {.id = MdNtscMode::Monochrome}},
+	};
+
+	MultiChoiceMenuItem ntscFilter
+	{
+		"NTSC Filter", attachParams(),
+		MenuId{system().optionNtscFilter.value()},
+		ntscFilterItem
+	};
+
+public:
+	CustomVideoOptionView(ViewAttachParams attach, EmuVideoLayer &layer): VideoOptionView{attach, layer, true}
+	{
+		loadStockItems();
+		item.emplace_back(&systemSpecificHeading);
+		item.emplace_back(&ntscFilter);
+	}
+};
+
 class CustomAudioOptionView : public AudioOptionView, public MainAppHelper
 {
 	using MainAppHelper::system;
@@ -368,6 +408,7 @@ std::unique_ptr<View> EmuApp::makeCustomView(ViewAttachParams attach, ViewID id)
 {
 	switch(id)
 	{
+		case ViewID::VIDEO_OPTIONS: return std::make_unique<CustomVideoOptionView>(attach, videoLayer);
 		case ViewID::AUDIO_OPTIONS: return std::make_unique<CustomAudioOptionView>(attach, audio);
 		case ViewID::SYSTEM_ACTIONS: return std::make_unique<CustomSystemActionsView>(attach);
 		case ViewID::SYSTEM_OPTIONS: return std::make_unique<CustomSystemOptionView>(attach);
@@ -359,7 +359,10 @@ void MdSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDelegate
 				io = std::move(*archIt);
 			}
 			ArchiveVFS archVFS{ArchiveIO{std::move(io)}};
-			cd = CDAccess_Open(&archVFS, std::string{contentFileName()}, true);
+			if(auto cacheDir = archVFS.extractToDiskCache(); cacheDir.size())
+				cd = CDAccess_Open(&NVFS, pathString(cacheDir, FS::basename(contentFileName())).data(), false);
+			else
+				cd = CDAccess_Open(&archVFS, std::string{contentFileName()}, true);
 		}
 		else
 		{
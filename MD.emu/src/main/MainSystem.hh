@@ -18,6 +18,7 @@
 #include <emuframework/EmuSystem.hh>
 #include <emuframework/EmuOptions.hh>
 #include <emuframework/Option.hh>
+#include "MdNtscFilter.hh"
 #include "genplus-config.h"
 #include "system.h"
 #include "state.h"
@@ -37,6 +38,7 @@ enum
 	CFGKEY_MD_REGION = 284, CFGKEY_VIDEO_SYSTEM = 285,
 	CFGKEY_INPUT_PORT_1 = 286, CFGKEY_INPUT_PORT_2 = 287,
 	CFGKEY_MULTITAP = 288, CFGKEY_CHEATS_PATH = 289,
+	CFGKEY_NTSC_FILTER = 290,
 };
 
 bool hasMDExtension(std::string_view name);
@@ -59,6 +61,8 @@ public:
 	Property<int8_t, CFGKEY_INPUT_PORT_2, PropertyDesc<int8_t>{.defaultValue = -1, .isValid = isValidWithMinMax<-1, 4>}> optionInputPort2;
 	Property<uint8_t, CFGKEY_MD_REGION, PropertyDesc<uint8_t>{.isValid = isValidWithMax<4>}> optionRegion;
 	Property<uint8_t, CFGKEY_VIDEO_SYSTEM, PropertyDesc<uint8_t>{.isValid = isValidWithMax<2>}> optionVideoSystem;
+	Property<MdNtscMode, CFGKEY_NTSC_FILTER, PropertyDesc<MdNtscMode>{.isValid = isValidWithMax<MdNtscMode::Monochrome>}> optionNtscFilter;
+	std::unique_ptr<MdNtscFilter> ntscFilter;
 	#ifndef NO_SCD
 	FS::PathString cdBiosUSAPath{}, cdBiosJpnPath{}, cdBiosEurPath{};
 	#endif
@@ -69,6 +73,7 @@ public:
 	MdSystem(ApplicationContext ctx):
 		EmuSystem{ctx} {}
 	void setupInput(EmuApp &);
+	void applyNtscFilter(EmuVideo &);
 
 	// required API functions
 	void loadContent(IO &, EmuSystemCreateParams, OnLoadProgressDelegate);
@@ -0,0 +1,176 @@
+/*  This file is part of MD.emu.
+
+	MD.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	MD.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with MD.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include "MdNtscFilter.hh"
+#include <imagine/util/ranges.hh>
+#include <imagine/util/utility.h>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+// only the table generator is used, rows are filtered with the vectorized code below
+#define MD_NTSC_NO_BLITTERS
+#include "ntsc/md_ntsc.c"
+
+namespace EmuEx
+{
+
+static_assert(md_ntsc_palette_size == 512 && md_ntsc_entry_size == 32);
+
+// 4 output pixels in md_ntsc's internal RGB format, maps to a SSE2/NEON register
+using RawPixels = uint32_t __attribute__((vector_size(16)));
+constexpr int rawPixelsSize = 4;
+
+constexpr int maxInputWidth = 512;
+// input pixels overlapping an 8 pixel output chunk, from 7 before it to 3 after
+constexpr int chunkKernels = 11;
+
+static const md_ntsc_setup_t &ntscSetup(MdNtscMode mode)
+{
+	switch(mode)
+	{
+		case MdNtscMode::SVideo: return md_ntsc_svideo;
+		case MdNtscMode::RGB: return md_ntsc_rgb;
+		case MdNtscMode::Monochrome: return md_ntsc_monochrome;
+		default: return md_ntsc_composite;
+	}
+}
+
+MdNtscFilter::MdNtscFilter(MdNtscMode mode):
+	table{std::make_unique<PaletteEntry[]>(paletteSize)},
+	mode_{mode}
+{
+	auto ntsc = std::make_unique<md_ntsc_t>();
+	md_ntsc_init(ntsc.get(), &ntscSetup(mode));
+	for(auto i : iotaCount(paletteSize))
+	{
+		for(auto half : iotaCount(2))
+		{
+			// truncating is safe since the clamp & pack steps only use the low 32 bits
+			std::copy_n(&ntsc->table[i][half * 16], 16, &table[i].kernel[half][8]);
+		}
+	}
+}
+
+WSize MdNtscFilter::outputSize(WSize inputSize) const
+{
+	auto w = std::min(inputSize.x, maxInputWidth);
+	return {w / md_ntsc_in_chunk * md_ntsc_out_chunk, inputSize.y};
+}
+
+template<PixelFormatId fmt>
+static unsigned paletteIndex(auto pixel)
+{
+	// index bits are BBBGGGRRR, using the top 3 bits of each component
+	if constexpr(fmt == PixelFormatId::RGB565)
+	{
+		return (pixel << 4 & 0x1C0) | (pixel >> 5 & 0x38) | (pixel >> 13);
+	}
+	else
+	{
+		unsigned r = pixel >> 5 & 7, g = pixel >> 13 & 7, b = pixel >> 21 & 7;
+		if constexpr(fmt == PixelFormatId::BGRA8888)
+			std::swap(r, b);
+		return b << 6 | g << 3 | r;
+	}
+}
+
+static RawPixels loadKernel(const uint32_t *kernel)
+{
+	RawPixels v;
+	memcpy(&v, kernel, sizeof(v));
+	return v;
+}
+
+static RawPixels clampRaw(RawPixels raw)
+{
+	constexpr uint32_t rgbBuilder = (1 << 21) | (1 << 11) | (1 << 1);
+	constexpr uint32_t clampMask = rgbBuilder * 3 / 2;
+	constexpr uint32_t clampAdd = rgbBuilder * 0x101;
+	RawPixels sub = raw >> 9 & clampMask;
+	RawPixels clamp = clampAdd - sub;
+	raw |= clamp;
+	clamp -= sub;
+	return raw & clamp;
+}
+
+template<PixelFormatId fmt>
+static void storePixels(auto *out, RawPixels raw)
+{
+	if constexpr(fmt == PixelFormatId::RGB565)
+	{
+		using Pixels16 = uint16_t __attribute__((vector_size(8)));
+		auto pixels = __builtin_convertvector((raw >> 13 & 0xF800) | (raw >> 8 & 0x07E0) | (raw >> 4 & 0x001F), Pixels16);
+		memcpy(out, &pixels, sizeof(pixels));
+	}
+	else
+	{
+		RawPixels r = raw >> 21 & 0xFF, g = raw >> 11 & 0xFF, b = raw >> 1 & 0xFF;
+		if constexpr(fmt == PixelFormatId::BGRA8888)
+			std::swap(r, b);
+		RawPixels pixels = r | g << 8 | b << 16 | 0xFF000000;
+		memcpy(out, &pixels, sizeof(pixels));
+	}
+}
+
+template<PixelFormatId fmt>
+void MdNtscFilter::filterRowsWithFormat(MutablePixmapView dest, PixmapView src, int startY, int endY) const
+{
+	using Pixel = std::conditional_t<fmt == PixelFormatId::RGB565, uint16_t, uint32_t>;
+	const int chunks = std::min(src.w(), maxInputWidth) / md_ntsc_in_chunk;
+	const int inWidth = chunks * md_ntsc_in_chunk;
+	// Palette entry of each input pixel in filter order, the row starts with 4 black pixels
+	// and ends with 3 like md_ntsc_blit()
+	std::array<const PaletteEntry*, maxInputWidth + 7> entries;
+	std::fill_n(entries.begin(), 4, &table[md_ntsc_black]);
+	std::fill_n(entries.begin() + inWidth + 4, 3, &table[md_ntsc_black]);
+	for(auto y = startY; y < endY; y++)
+	{
+		auto in = (const Pixel*)src.data({0, y});
+		auto out = (Pixel*)dest.data({0, y});
+		for(auto x : iotaCount(inWidth))
+		{
+			entries[x + 4] = &table[paletteIndex<fmt>(in[x])];
+		}
+		for(auto chunk : iotaCount(chunks))
+		{
+			// Input pixel j's kernel starts 2 output pixels after the one before it, and alternates
+			// between the two kernel halves, so its window into the padded kernel is fixed for each j
+			auto chunkEntries = &entries[chunk * md_ntsc_in_chunk];
+			for(auto x = 0; x < md_ntsc_out_chunk; x += rawPixelsSize)
+			{
+				RawPixels raw{};
+				for(auto j : iotaCount(chunkKernels))
+				{
+					raw += loadKernel(&chunkEntries[j]->kernel[(j + 1) & 1][22 - j * 2 + x]);
+				}
+				storePixels<fmt>(&out[chunk * md_ntsc_out_chunk + x], clampRaw(raw));
+			}
+		}
+	}
+}
+
+void MdNtscFilter::filterRows(MutablePixmapView dest, PixmapView src, int startY, int endY) const
+{
+	switch(src.format().id)
+	{
+		case PixelFormatId::RGB565: return filterRowsWithFormat<PixelFormatId::RGB565>(dest, src, startY, endY);
+		case PixelFormatId::RGBA8888: return filterRowsWithFormat<PixelFormatId::RGBA8888>(dest, src, startY, endY);
+		case PixelFormatId::BGRA8888: return filterRowsWithFormat<PixelFormatId::BGRA8888>(dest, src, startY, endY);
+		default: bug_unreachable("invalid pixel format");
+	}
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+/*  This file is part of MD.emu.
+
+	MD.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	MD.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with MD.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/CPUVideoFilter.hh>
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace EmuEx
+{
+
+enum class MdNtscMode : uint8_t
+{
+	Off, Composite, SVideo, RGB, Monochrome
+};
+
+// md_ntsc composite video filter, doubles the horizontal resolution
+class MdNtscFilter final : public CPUVideoFilter
+{
+public:
+	MdNtscFilter(MdNtscMode);
+	MdNtscMode mode() const { return mode_; }
+	WSize outputSize(WSize inputSize) const final;
+	void filterRows(MutablePixmapView dest, PixmapView src, int startY, int endY) const final;
+
+private:
+	static constexpr int paletteSize = 512;
+	static constexpr int lanes = 32;
+	// Each md_ntsc kernel half (16 values, one per output pixel offset) with 8 zeros on both sides,
+	// so any 8 output pixel window can be loaded without bounds checks
+	using PaddedKernel = std::array<uint32_t, lanes>;
+	struct alignas(64) PaletteEntry
+	{
+		PaddedKernel kernel[2];
+	};
+	std::unique_ptr<PaletteEntry[]> table;
+	MdNtscMode mode_;
+
+	template<PixelFormatId>
+	void filterRowsWithFormat(MutablePixmapView dest, PixmapView src, int startY, int endY) const;
+};
+
+}
@@ -44,6 +44,23 @@ void MdSystem::onSessionOptionsLoaded(EmuApp &app)
 	mdInputPortDev[0] = optionInputPort1;
 	mdInputPortDev[1] = optionInputPort2;
 	setupInput(app);
+	applyNtscFilter(app.video);
+}
+
+void MdSystem::applyNtscFilter(EmuVideo &video)
+{
+	if(optionNtscFilter == MdNtscMode::Off)
+	{
+		video.setCPUFilter(nullptr);
+		ntscFilter.reset();
+		return;
+	}
+	if(ntscFilter && ntscFilter->mode() == optionNtscFilter)
+		return;
+	// swap in the new filter before freeing the old one still referenced by the video
+	auto newFilter = std::make_unique<MdNtscFilter>(optionNtscFilter);
+	video.setCPUFilter(newFilter.get());
+	ntscFilter = std::move(newFilter);
 }
 
 bool MdSystem::resetSessionOptions(EmuApp &app)
@@ -72,6 +89,7 @@ bool MdSystem::readConfig(ConfigType type, MapIO &io, unsigned key)
 			case CFGKEY_MD_CD_BIOS_EUR_PATH: return readStringOptionValue(io, cdBiosEurPath);
 			#endif
 			case CFGKEY_CHEATS_PATH: return readStringOptionValue(io, cheatsDir);
+			case CFGKEY_NTSC_FILTER: return readOptionValue(io, optionNtscFilter);
 		}
 	}
 	else if(type == ConfigType::SESSION)
@@ -101,6 +119,7 @@ void MdSystem::writeConfig(ConfigType type, FileIO &io)
 		writeStringOptionValue(io, CFGKEY_MD_CD_BIOS_EUR_PATH, cdBiosEurPath);
 		#endif
 		writeStringOptionValue(io, CFGKEY_CHEATS_PATH, cheatsDir);
+		writeOptionValueIfNotDefault(io, optionNtscFilter);
 	}
 	else if(type == ConfigType::SESSION)
 	{
@@ -40,6 +40,7 @@ RomType currentRomType[2]{};
 static BoardTimer* fdcTimer{};
 static BoardTimer* mixerTimer;
 static constexpr unsigned mixerSyncHz = 120;
+static unsigned mixerSyncs{};
 
 Mixer* boardGetMixer()
 {
@@ -85,6 +86,7 @@ void boardSetFdcActive()
 static void onMixerSync(void* mixer, UInt32 time)
 {
     mixerSync((Mixer*)mixer);
+    mixerSyncs++;
     boardTimerAdd(mixerTimer, boardSystemTime() + boardFrequency() / mixerSyncHz);
 }
 
@@ -239,6 +241,26 @@ void boardTimerRemove(BoardTimer* timer)
     timer->prev = timer;
 }
 
+static void boardTimerCleanup()
+{
+    while (timerList->next != timerList) {
+        boardTimerRemove(timerList->next);
+    }
+
+    timeoutCheckBreak = 1;
+}
+
+void boardLoadStateInPlace()
+{
+    boardTimerCleanup();
+    fdcActive = 0;
+    boardInfo.loadState();
+    // the device states re-add their own timers, the board's are restarted like in boardRewind()
+    boardTimerAdd(mixerTimer, boardSystemTime() + boardFrequency() / mixerSyncHz);
+}
+
+unsigned boardMixerSyncCount() { return mixerSyncs; }
+
 const char* boardGetBaseDirectory()
 {
 	return EmuEx::gSystem().contentSaveDirectoryPtr();
@@ -493,7 +493,11 @@ void MsxSystem::saveBlueMSXState(const char *filename)
 	machineSaveState(machine);
 	boardInfo.saveState();
 	saveStateDestroy();
-	zipEndWrite();
+	if(!zipEndWrite())
+	{
+		log.error("error writing to zip:{}", filename);
+		EmuSystem::throwFileWriteError();
+	}
 }
 
 static FS::FileString saveStateGetFileString(SaveState* state, const char* tagName)
@@ -509,7 +513,32 @@ static FS::FileString saveStateGetFileString(SaveState* state, const char* tagNa
 	return {};
 }
 
-void MsxSystem::loadBlueMSXState(EmuApp &app, const char *filename)
+bool MsxSystem::stateMatchesBoard()
+{
+	if(!machine || !msxIsInit())
+		return false;
+	SaveState* state = saveStateOpenForRead("machine");
+	std::array<char, sizeof(machine->name)> name{};
+	saveStateGetBuffer(state, "name", name.data(), name.size() - 1);
+	auto boardType = saveStateGet(state, "boardType", BOARD_MSX);
+	saveStateClose(state);
+	if(std::string_view{name.data()} != machine->name || boardType != UInt32(machine->board.type))
+		return false;
+	state = saveStateOpenForRead("board");
+	auto destroyState = IG::scopeGuard([&](){ saveStateClose(state); });
+	return saveStateGet(state, "cartType00", 0) == UInt32(currentRomType[0]) &&
+		saveStateGetFileString(state, "cartName00") == cartName[0] &&
+		saveStateGet(state, "cartType01", 0) == UInt32(currentRomType[1]) &&
+		saveStateGetFileString(state, "cartName01") == cartName[1] &&
+		saveStateGetFileString(state, "diskName00") == diskName[0] &&
+		saveStateGetFileString(state, "diskName01") == diskName[1] &&
+		saveStateGetFileString(state, "diskName02") == hdName[0] &&
+		saveStateGetFileString(state, "diskName03") == hdName[1] &&
+		saveStateGetFileString(state, "diskName10") == hdName[2] &&
+		saveStateGetFileString(state, "diskName11") == hdName[3];
+}
+
+void MsxSystem::loadBlueMSXState(EmuApp &app, const char *filename, bool allowInPlace)
 {
 	log.info("loading state:{}", filename);
 	assert(machine);
@@ -528,6 +557,18 @@ void MsxSystem::loadBlueMSXState(EmuApp &app, const char *filename)
 	}
 	free(version);
 
+	if(allowInPlace)
+	{
+		if(stateMatchesBoard())
+		{
+			// same machine and media, so only the device states need loading, like blueMSX's rewind
+			boardLoadStateInPlace();
+			return;
+		}
+		// restart file lookups for the full load
+		saveStateCreateForRead(filename);
+	}
+
 	ejectMedia();
 	machineLoadState(machine);
 
@@ -570,14 +611,18 @@ void MsxSystem::loadBlueMSXState(EmuApp &app, const char *filename)
 void MsxSystem::readState(EmuApp &app, std::span<uint8_t> buff)
 {
 	setZipMemBuffer(buff);
-	loadBlueMSXState(app, ":::B");
+	if(hasRawStateHeader(buff))
+		loadBlueMSXState(app, ":::R", true);
+	else
+		loadBlueMSXState(app, ":::B");
 }
 
 size_t MsxSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 {
 	assert(buff.size() == stateSize());
 	setZipMemBuffer(buff);
-	saveBlueMSXState(":::B");
+	// in-session states skip building a zip archive
+	saveBlueMSXState(flags.inSession ? ":::R" : ":::B");
 	return zipMemBufferSize();
 }
 
@@ -721,7 +766,10 @@ void MsxSystem::runFrame(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio
 	emuSysTask = taskCtx;
 	emuVideo = video;
 	mixerSetWriteCallback(mixer, audio ? soundWrite : nullptr, audio, 0);
+	[[maybe_unused]] auto prevMixerSyncs = boardMixerSyncCount();
 	boardInfo.run(boardInfo.cpuRef);
+	// a frame always spans a mixer sync, audio stops if an in-place state load dropped the mixer timer
+	assert(boardMixerSyncCount() != prevMixerSyncs);
 	((R800*)boardInfo.cpuRef)->terminate = 0;
 	commitUnchangedVideoFrame(); // runs if emuVideo wasn't unset in emulation of this frame
 }
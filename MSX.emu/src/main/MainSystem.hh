@@ -51,9 +51,12 @@ extern IG::FS::FileString hdName[4];
 extern Machine *machine;
 
 bool zipStartWrite(const char *fileName);
-void zipEndWrite();
+bool zipEndWrite();
 void setZipMemBuffer(std::span<uint8_t> buff);
 size_t zipMemBufferSize();
+bool hasRawStateHeader(std::span<const uint8_t> buff);
+void boardLoadStateInPlace();
+unsigned boardMixerSyncCount();
 IG::PixmapView frameBufferPixmap();
 HdType boardGetHdType(int hdIndex);
 
@@ -230,7 +233,8 @@ public:
 private:
 	void insertMedia(EmuApp &app);
 	void saveBlueMSXState(const char *filename);
-	void loadBlueMSXState(EmuApp &app, const char *filename);
+	void loadBlueMSXState(EmuApp &app, const char *filename, bool allowInPlace = false);
+	bool stateMatchesBoard();
 };
 
 using MainSystem = MsxSystem;
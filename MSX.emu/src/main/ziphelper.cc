@@ -24,7 +24,9 @@
 #include <imagine/util/ScopeGuard.hh>
 #include "ziphelper.h"
 #include "MainSystem.hh"
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 
 namespace EmuEx
 {
@@ -40,6 +42,64 @@ static FS::ArchiveIterator cachedZipIt{};
 static FS::PathString cachedZipName{};
 static uint8_t *buffData{};
 static size_t buffSize{};
+static size_t rawWritePos{};
+static bool writingRaw{}, rawWriteOverflow{};
+
+// Raw state container used in place of a zip for in-session states, stored as the magic followed by
+// a record for each file with native endian sizes: name size, name, data size, data
+static constexpr std::string_view rawStateMagic{"BMSXRAW1"};
+
+static bool isRawState(std::string_view zipName) { return zipName == ":::R"; }
+
+bool hasRawStateHeader(std::span<const uint8_t> buff)
+{
+	return buff.size() >= rawStateMagic.size() && std::equal(rawStateMagic.begin(), rawStateMagic.end(), buff.begin());
+}
+
+static bool writeRaw(const void *data, size_t size)
+{
+	if(size > buffSize - rawWritePos)
+		return false;
+	memcpy(buffData + rawWritePos, data, size);
+	rawWritePos += size;
+	return true;
+}
+
+static void *loadFromRawState(const char* fileName, int* size)
+{
+	std::string_view name{fileName};
+	size_t pos = rawStateMagic.size();
+	auto readSize = [&]()
+	{
+		uint32_t val{};
+		if(sizeof(val) > buffSize - pos)
+			return ~uint32_t{};
+		memcpy(&val, buffData + pos, sizeof(val));
+		pos += sizeof(val);
+		return val;
+	};
+	while(pos < buffSize)
+	{
+		auto nameSize = readSize();
+		if(nameSize > buffSize - pos)
+			break;
+		std::string_view entryName{(const char*)buffData + pos, nameSize};
+		pos += nameSize;
+		auto dataSize = readSize();
+		if(dataSize > buffSize - pos)
+			break;
+		if(entryName == name)
+		{
+			void *buff = malloc(dataSize);
+			memcpy(buff, buffData + pos, dataSize);
+			*size = dataSize;
+			return buff;
+		}
+		pos += dataSize;
+	}
+	logErr("file %s not in raw state", fileName);
+	return nullptr;
+}
 
 void setZipMemBuffer(std::span<uint8_t> buff)
 {
@@ -66,6 +126,12 @@ void zipCacheReadOnlyZip(const char* zipName_)
 	else
 	{
 		std::string_view zipName{zipName_};
+		if(isRawState(zipName))
+		{
+			// files are looked up directly in the memory buffer
+			unsetCachedReadZip();
+			return;
+		}
 		cachedZipName = zipName;
 		if(zipName == ":::B")
 		{
@@ -106,6 +172,8 @@ static void *loadFromArchiveIt(FS::ArchiveIterator &it, const char* zipName, con
 
 void* zipLoadFile(const char* zipName, const char* fileName, int* size)
 {
+	if(isRawState(zipName))
+		return loadFromRawState(fileName, size);
 	try
 	{
 		if(cachedZipIt.hasEntry() && cachedZipName == zipName)
@@ -128,7 +196,14 @@ void* zipLoadFile(const char* zipName, const char* fileName, int* size)
 
 bool zipStartWrite(const char *fileName)
 {
-	assert(!writeArch);
+	assert(!writeArch && !writingRaw);
+	if(isRawState(fileName))
+	{
+		writingRaw = true;
+		rawWritePos = 0;
+		rawWriteOverflow = false;
+		return writeRaw(rawStateMagic.data(), rawStateMagic.size());
+	}
 	writeArch = archive_write_new();
 	archive_write_set_format_zip(writeArch);
 	if(std::string_view{fileName} == ":::B")
@@ -158,6 +233,19 @@ bool zipStartWrite(const char *fileName)
 
 int zipSaveFile(const char* zipName, const char* fileName, int append, const void* buffer, int size)
 {
+	if(isRawState(zipName))
+	{
+		uint32_t nameSize = strlen(fileName);
+		uint32_t dataSize = size;
+		if(rawWriteOverflow || !writeRaw(&nameSize, sizeof(nameSize)) || !writeRaw(fileName, nameSize) ||
+			!writeRaw(&dataSize, sizeof(dataSize)) || !writeRaw(buffer, dataSize))
+		{
+			logErr("no space for file %s in raw state", fileName);
+			rawWriteOverflow = true;
+			return 0;
+		}
+		return 1;
+	}
 	assert(writeArch);
 	auto entry = archive_entry_new();
 	auto freeEntry = IG::scopeGuard([&](){ archive_entry_free(entry); });
@@ -178,12 +266,20 @@ int zipSaveFile(const char* zipName, const char* fileName, int append, const voi
 	return 1;
 }
 
-void zipEndWrite()
+bool zipEndWrite()
 {
+	if(writingRaw)
+	{
+		// the buffer size becomes the amount written
+		writingRaw = false;
+		buffSize = rawWritePos;
+		return !rawWriteOverflow;
+	}
 	assert(writeArch);
 	archive_write_close(writeArch);
 	archive_write_free(writeArch);
 	writeArch = {};
+	return true;
 }
 
 FILE *fopenHelper(const char* filename, const char* mode)
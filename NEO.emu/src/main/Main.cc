@@ -164,9 +164,9 @@ void NeoSystem::readState(EmuApp &app, std::span<uint8_t> buff)
 	int *bksw_offset=memory.bksw_offset;
 
 	DynArray<uint8_t> uncompArr;
-	if(hasGzipHeader(buff))
+	if(detectStateCodec(buff))
 	{
-		uncompArr = uncompressGzipState(buff, saveStateSize);
+		uncompArr = uncompressState(buff, saveStateSize);
 		buff = uncompArr;
 	}
 	MapIO buffIO{buff};
@@ -219,7 +219,7 @@ size_t NeoSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 	else
 	{
 		assert(saveStateSize);
-		auto stateArr = DynArray<uint8_t>{saveStateSize};
+		auto stateArr = stateScratchBuffer(saveStateSize);
 		MapIO buffIO{stateArr};
 		openState(buffIO, STWRITE);
 		makeState(buffIO, STWRITE);
@@ -330,7 +330,7 @@ void NeoSystem::loadContent(IO &, EmuSystemCreateParams, OnLoadProgressDelegate
 		FileUtils::writeToUri(ctx, memcardPath, {memory.memcard, 0x800});
 	}
 	static constexpr size_t maxStateSize = 0x60000;
-	saveStateSize = writeState(std::span{std::make_unique<uint8_t[]>(maxStateSize).get(), maxStateSize}, {.uncompressed = true});
+	saveStateSize = writeState(stateScratchBuffer(maxStateSize), {.uncompressed = true});
 }
 
 void NeoSystem::configAudioRate(FrameTime outputFrameTime, int outputRate)
@@ -440,12 +440,12 @@ void NesSystem::renderVideo(EmuSystemTaskContext taskCtx, EmuVideo &video, uint8
 	assumeExpr(pix.size() == ppuPixRegion.size());
 	if(pix.format() == PixelFmtRGB565)
 	{
-		pix.writeTransformed([&](uint8 p){ return nativeCol.col16[p]; }, ppuPixRegion);
+		pix.writeLookup(nativeCol.col16, ppuPixRegion);
 	}
 	else
 	{
 		assumeExpr(pix.format().bytesPerPixel() == 4);
-		pix.writeTransformed([&](uint8 p){ return nativeCol.col32[p]; }, ppuPixRegion);
+		pix.writeLookup(nativeCol.col32, ppuPixRegion);
 	}
 	img.endFrame();
 }
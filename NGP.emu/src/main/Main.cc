@@ -72,7 +72,7 @@ FS::FileString NgpSystem::stateFilename(int slot, std::string_view name) const
 
 size_t NgpSystem::stateSize() { return stateSizeMDFN(); }
 void NgpSystem::readState(EmuApp &app, std::span<uint8_t> buff) { readStateMDFN(app, buff); }
-size_t NgpSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags) { return writeStateMDFN(buff, flags); }
+size_t NgpSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags) { return writeStateMDFN(*this, buff, flags); }
 
 static FS::PathString saveFilename(const EmuApp &app)
 {
@@ -18,6 +18,7 @@ SRC += main/Main.cc \
 main/options.cc \
 main/input.cc \
 main/EmuMenuViews.cc \
+main/CoreComparison.cc \
 $(MDFN_COMMON_SRC) \
 $(MDFN_CDROM_SRC) \
 pce_fast/input.cpp \
@@ -0,0 +1,237 @@
+/*  This file is part of PCE.emu.
+
+	PCE.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	PCE.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with PCE.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include "CoreComparison.hh"
+#include "MainSystem.hh"
+#include <emuframework/EmuAudio.hh>
+#include <pce/huc.h>
+#include <pce_fast/huc.h>
+#include <mednafen-emuex/MDFNUtils.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/util/format.hh>
+#include <imagine/logger/logger.h>
+#include <zlib.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+namespace EmuEx
+{
+
+constexpr SystemLogger log{"CoreCompare"};
+
+struct KnownCore
+{
+	std::string_view md5;
+	EmuCore core;
+};
+
+// Titles checked with CoreComparison, sorted by content MD5. Fast means pce_fast matched pce for a
+// full play session, Accurate means it diverged. Lines from the comparison results file go here as-is.
+constexpr std::array<KnownCore, 0> knownCores
+{
+};
+
+static_assert(std::ranges::is_sorted(knownCores, {}, &KnownCore::md5));
+
+EmuCore knownCompatibleCore(std::string_view md5)
+{
+	auto it = std::ranges::lower_bound(knownCores, md5, {}, &KnownCore::md5);
+	if(it == knownCores.end() || it->md5 != md5)
+		return EmuCore::Auto;
+	return it->core;
+}
+
+// audio output of the two cores goes through different filters and resamplers, so only
+// compare if each one is audible and allow either to start or stop up to a second late
+constexpr int audibleLevel = 64;
+constexpr uint32_t maxAudioMismatchFrames = 60;
+
+// a title is only marked as safe for pce_fast after matching for at least 10 minutes
+constexpr uint32_t minFastResultFrames = 60 * 60 * 10;
+
+static bool isAudible(std::span<const int16> samples)
+{
+	return std::ranges::any_of(samples, [](auto s){ return std::abs(s) >= audibleLevel; });
+}
+
+static std::span<const uint8> coreRAM(bool accurate)
+{
+	return accurate ? MDFN_IEN_PCE::GetBaseRAM() : MDFN_IEN_PCE_FAST::GetBaseRAM();
+}
+
+CoreComparison::CoreComparison(ApplicationContext ctx, const Mednafen::MDFNGI &coreInfo,
+	std::string_view contentName, std::string_view contentMD5):
+	ctx{ctx},
+	coreInfo{coreInfo},
+	pixBuff{std::make_unique<uint32_t[]>(PceSystem::maxFrameBuffWidth * PceSystem::maxFrameBuffHeight)},
+	contentName{contentName},
+	contentMD5{contentMD5} {}
+
+CoreComparison::~CoreComparison()
+{
+	if(!loaded)
+		return;
+	writeResult();
+	useCore([](Mednafen::MDFNGI &info){ info.CloseGame(); });
+}
+
+void CoreComparison::loadBackupMemory()
+{
+	// never saved back so it stays the same as the active core's
+	useCore([&](Mednafen::MDFNGI &)
+	{
+		if(isAccurateCore())
+			MDFN_IEN_PCE::HuC_LoadNV();
+		else
+			MDFN_IEN_PCE_FAST::HuC_LoadNV();
+	});
+}
+
+void CoreComparison::reset()
+{
+	useCore([](Mednafen::MDFNGI &info){ info.DoSimpleCommand(MDFN_MSC_RESET); });
+}
+
+void CoreComparison::setPixelFormat(IG::PixelFormat fmt)
+{
+	pix = {{{coreInfo.fb_width, coreInfo.fb_height}, fmt}, pixBuff.get()};
+	if(isAccurateCore())
+		MDFN_IEN_PCE::vce->SetPixelFormat(toMDFNSurface(pix).format, nullptr, 0);
+	else
+		MDFN_IEN_PCE_FAST::VDC_SetPixelFormat(toMDFNSurface(pix).format, nullptr, 0);
+}
+
+void CoreComparison::setSoundRate(double rate)
+{
+	if(isAccurateCore())
+	{
+		if(MDFN_IEN_PCE::GetSoundRate() != rate)
+			MDFN_IEN_PCE::SetSoundRate(rate);
+	}
+	else
+	{
+		if(MDFN_IEN_PCE_FAST::GetSoundRate() != std::round(rate))
+			MDFN_IEN_PCE_FAST::SetSoundRate(rate);
+	}
+}
+
+CoreComparison::FrameOutput CoreComparison::frameOutput(const Mednafen::EmulateSpecStruct &espec,
+	IG::PixmapView pix, std::span<const uint8> ram)
+{
+	FrameOutput out
+	{
+		.ramCRC = uint32_t(crc32(0, ram.data(), ram.size())),
+		.hasAudio = isAudible({espec.SoundBuf, size_t(espec.SoundBufSize) * 2}),
+	};
+	if(!espec.skip)
+	{
+		// the cores use different frame buffer sizes and start rows, so hash the visible lines by content
+		uLong crc = crc32(0, nullptr, 0);
+		for(auto y : iotaCount(espec.DisplayRect.h))
+		{
+			auto lineY = espec.DisplayRect.y + y;
+			int32 width = espec.LineWidths[lineY];
+			crc = crc32(crc, (const Bytef*)&width, sizeof(width));
+			crc = crc32(crc, (const Bytef*)pix.data({espec.DisplayRect.x, lineY}), pix.format().pixelBytes(width));
+		}
+		out.videoCRC = crc;
+	}
+	return out;
+}
+
+bool CoreComparison::runFrame(PceSystem &sys, EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio *audio)
+{
+	using namespace Mednafen;
+	auto emulate = [&](MDFNGI &info, MutablePixmapView pix, EmuVideo *video, bool skip, int16 *audioBuff, int32 *lineWidths)
+	{
+		EmulateSpecStruct espec{};
+		if(audio)
+		{
+			espec.SoundBuf = audioBuff;
+			espec.SoundBufMaxSize = PceSystem::maxAudioFrames;
+		}
+		espec.taskCtx = taskCtx;
+		espec.sys = &sys;
+		espec.video = video;
+		espec.skip = skip;
+		auto surface = toMDFNSurface(pix);
+		espec.surface = &surface;
+		espec.LineWidths = lineWidths;
+		info.Emulate(&espec);
+		return espec;
+	};
+	int16 audioBuff[PceSystem::maxAudioFrames * 2];
+	int32 lineWidths[PceSystem::maxLineWidths];
+	auto espec = emulate(sys.mdfnGameInfo, sys.mSurfacePix, video, !video, audioBuff, lineWidths);
+	if(audio)
+		audio->writeFrames((uint8_t*)audioBuff, espec.SoundBufSize);
+	auto out = frameOutput(espec, sys.mSurfacePix, coreRAM(!isAccurateCore()));
+	// renders into its own buffer without a video output, only on frames the active core renders
+	int16 otherAudioBuff[PceSystem::maxAudioFrames * 2];
+	int32 otherLineWidths[PceSystem::maxLineWidths];
+	FrameOutput otherOut;
+	useCore([&](MDFNGI &info)
+	{
+		auto otherEspec = emulate(info, pix, nullptr, espec.skip, otherAudioBuff, otherLineWidths);
+		otherOut = frameOutput(otherEspec, pix, coreRAM(isAccurateCore()));
+	});
+	frames++;
+	if(out.ramCRC != otherOut.ramCRC)
+		mismatchType = "RAM";
+	else if(out.videoCRC != otherOut.videoCRC)
+		mismatchType = "video";
+	else if(out.hasAudio == otherOut.hasAudio)
+		audioMismatchFrames = 0;
+	else if(++audioMismatchFrames > maxAudioMismatchFrames)
+		mismatchType = "audio";
+	if(mismatchType.size())
+	{
+		log.info("{} differs from the other core at frame:{}", mismatchType, frames);
+		return false;
+	}
+	return true;
+}
+
+void CoreComparison::writeResult()
+{
+	if(!frames || resultDiscarded)
+		return;
+	if(mismatchType.empty() && frames < minFastResultFrames)
+	{
+		log.info("not writing result, only {} of {} frames compared", frames, minFastResultFrames);
+		return;
+	}
+	auto [core, desc] = mismatchType.size() ?
+		std::pair{EmuCore::Accurate, std::format("{} differs at frame {}", mismatchType, frames)} :
+		std::pair{EmuCore::Fast, std::format("{} frames matched", frames)};
+	auto line = std::format("\t{{\"{}\", EmuCore::{}}}, // {}: {}\n", contentMD5, wise_enum::to_string(core), contentName, desc);
+	log.info("result:{}", line);
+	auto path = FS::pathString(ctx.supportPath(), "pceCoreComparison.txt");
+	try
+	{
+		FileIO file{path, OpenFlags::createFile()};
+		file.seek(0, IOSeekMode::End);
+		file.write(line.data(), line.size());
+	}
+	catch(std::exception &err)
+	{
+		log.error("error writing results to:{}:{}", path, err.what());
+	}
+}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+/*  This file is part of PCE.emu.
+
+	PCE.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	PCE.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with PCE.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/base/ApplicationContext.hh>
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/util/ScopeGuard.hh>
+#include <emuframework/EmuSystem.hh>
+#include <mednafen/mednafen.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace EmuEx
+{
+
+class PceSystem;
+
+// Runs the core that isn't producing output in lock-step with the one that is, on the same input,
+// and compares each frame's video, work RAM, and whether audio is playing. The result for the content
+// is appended to a file in the app's support path in the same format as the built-in table of known
+// titles, so it can be used to decide which titles the Auto core setting can run on pce_fast.
+class CoreComparison
+{
+public:
+	CoreComparison(ApplicationContext, const Mednafen::MDFNGI &coreInfo, std::string_view contentName, std::string_view contentMD5);
+	~CoreComparison();
+	Mednafen::MDFNGI &gameInfo() { return coreInfo; }
+	bool isAccurateCore() const { return coreInfo.fb_width == 1365; }
+	// run with this core's game info set as the active one
+	void useCore(auto &&func)
+	{
+		auto restoreInfo = scopeGuard([prevInfo = std::exchange(Mednafen::MDFNGameInfo, &coreInfo)]()
+		{
+			Mednafen::MDFNGameInfo = prevInfo;
+		});
+		func(coreInfo);
+	}
+	void setLoaded() { loaded = true; }
+	void loadBackupMemory();
+	void reset();
+	void setPixelFormat(IG::PixelFormat);
+	void setSoundRate(double rate);
+	// returns false once the cores have diverged and the comparison is finished
+	bool runFrame(PceSystem &, EmuSystemTaskContext, EmuVideo *, EmuAudio *);
+	// ends the comparison without writing a result, like when a state load puts the cores out of sync
+	void discardResult() { resultDiscarded = true; }
+
+private:
+	struct FrameOutput
+	{
+		uint32_t videoCRC{};
+		uint32_t ramCRC{};
+		bool hasAudio{};
+	};
+
+	ApplicationContext ctx;
+	Mednafen::MDFNGI coreInfo;
+	std::unique_ptr<uint32_t[]> pixBuff;
+	IG::MutablePixmapView pix;
+	std::string contentName;
+	std::string contentMD5;
+	std::string_view mismatchType{};
+	uint32_t frames{};
+	uint32_t audioMismatchFrames{};
+	bool loaded{};
+	bool resultDiscarded{};
+
+	static FrameOutput frameOutput(const Mednafen::EmulateSpecStruct &, IG::PixmapView, std::span<const uint8> ram);
+	void writeResult();
+};
+
+}
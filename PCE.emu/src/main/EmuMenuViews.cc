@@ -344,6 +344,13 @@ class CustomSystemOptionView : public SystemOptionView, public MainAppHelper
 		};
 	}
 
+	BoolMenuItem compareCores
+	{
+		"Compare Cores On Load", attachParams(),
+		system().compareCores,
+		[this](BoolMenuItem &item) { system().compareCores = item.flipBoolValue(*this); }
+	};
+
 	BoolMenuItem saveFilenameType = saveFilenameTypeMenuItem(*this, system());
 
 public:
@@ -351,6 +358,7 @@ public:
 	{
 		loadStockItems();
 		item.emplace_back(&emuCore);
+		item.emplace_back(&compareCores);
 		item.emplace_back(&cdSpeed);
 		item.emplace_back(&saveFilenameType);
 	}
@@ -79,6 +79,8 @@ void PceSystem::loadBackupMemory(EmuApp &)
 		MDFN_IEN_PCE::HuC_LoadNV();
 	else
 		MDFN_IEN_PCE_FAST::HuC_LoadNV();
+	if(coreComparison)
+		coreComparison->loadBackupMemory();
 }
 
 void PceSystem::onFlushBackupMemory(EmuApp &, BackupMemoryDirtyFlags)
@@ -104,17 +106,41 @@ FS::FileString PceSystem::stateFilename(int slot, std::string_view name) const
 
 void PceSystem::closeSystem()
 {
+	coreComparison.reset();
 	mdfnGameInfo.CloseGame();
 	clearCDInterfaces(CDInterfaces);
+	autoCore = EmuCore::Fast;
+}
+
+void PceSystem::endCoreComparison()
+{
+	coreComparison.reset();
+	updateCdSettings();
 }
 
 WSize PceSystem::multiresVideoBaseSize() const { return {512, 0}; }
 
+static std::string huCardMD5(std::span<const uint8_t> rom)
+{
+	// same data HuC_Load() hashes, after any copier header
+	if(rom.size() & 512)
+		rom = rom.subspan(512);
+	Mednafen::md5_context md5;
+	uint8 digest[16];
+	md5.starts();
+	md5.update(rom.data(), rom.size());
+	md5.finish(digest);
+	return Mednafen::md5_context::asciistr(digest, 0);
+}
+
 void PceSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDelegate)
 {
-	mdfnGameInfo = resolvedCore() == EmuCore::Accurate ? EmulatedPCE : EmulatedPCE_Fast;
-	logMsg("using emulator core module:%s", asModuleString(resolvedCore()).data());
-	if(hasCDExtension(contentFileName()))
+	static constexpr size_t maxRomSize = 0x300000;
+	bool isCD = hasCDExtension(contentFileName());
+	auto unloadCD = scopeGuard([&]() { clearCDInterfaces(CDInterfaces); });
+	IOBuffer romBuff;
+	std::string contentMD5;
+	if(isCD)
 	{
 		bool isArchive = std::holds_alternative<ArchiveIO>(io);
 		bool isCHD = endsWithAnyCaseless(contentFileName(), ".chd");
@@ -126,34 +152,70 @@ void PceSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDelegat
 		{
 			throw std::runtime_error("No System Card Set");
 		}
-		auto unloadCD = scopeGuard([&]() { clearCDInterfaces(CDInterfaces); });
 		if(isArchive)
 		{
 			ArchiveVFS archVFS{ArchiveIO{std::move(io)}};
-			CDInterfaces.push_back(CDInterface::Open(&archVFS, std::string{contentFileName()}, true, 0));
+			if(auto cacheDir = archVFS.extractToDiskCache(); cacheDir.size())
+				CDInterfaces.push_back(CDInterface::Open(&NVFS, pathString(cacheDir, FS::basename(contentFileName())).data(), false, 0));
+			else
+				CDInterfaces.push_back(CDInterface::Open(&archVFS, std::string{contentFileName()}, true, 0));
 		}
 		else
 		{
 			CDInterfaces.push_back(CDInterface::Open(&NVFS, std::string{contentLocation()}, false, 0));
 		}
 		writeCDMD5(mdfnGameInfo, CDInterfaces);
-		mdfnGameInfo.LoadCD(&CDInterfaces);
-		if(isUsingAccurateCore())
-			Mednafen::SCSICD_SetDisc(false, CDInterfaces[0]);
-		else
-			MDFN_IEN_PCE_FAST::PCECD_Drive_SetDisc(false, CDInterfaces[0]);
-		unloadCD.cancel();
+		contentMD5 = Mednafen::md5_context::asciistr(mdfnGameInfo.MD5, 0);
 	}
 	else
 	{
-		static constexpr size_t maxRomSize = 0x300000;
-		EmuEx::loadContent(*this, mdfnGameInfo, io, maxRomSize);
+		// buffered so the MD5 is known before picking a core, and so a second core can load it
+		romBuff = io.buffer(IOBufferMode::Release);
+		if(!romBuff)
+			throwFileReadError();
+		contentMD5 = huCardMD5(romBuff.span().first(std::min(romBuff.size(), maxRomSize)));
 	}
-	//logMsg("%d input ports", MDFNGameInfo->InputInfo->InputPorts);
-	for(auto i : iotaCount(5))
+	autoCore = knownCompatibleCore(contentMD5);
+	if(autoCore == EmuCore::Auto)
+		autoCore = EmuCore::Fast;
+	auto loadCore = [&](Mednafen::MDFNGI &gameInfo)
 	{
-		mdfnGameInfo.SetInput(i, "gamepad", (uint8*)&inputBuff[i]);
+		if(isCD)
+		{
+			writeCDMD5(gameInfo, CDInterfaces);
+			gameInfo.LoadCD(&CDInterfaces);
+			if(gameInfo.fb_width == 1365)
+				Mednafen::SCSICD_SetDisc(false, CDInterfaces[0]);
+			else
+				MDFN_IEN_PCE_FAST::PCECD_Drive_SetDisc(false, CDInterfaces[0]);
+		}
+		else
+		{
+			IO romIO{IOBuffer{romBuff.span()}};
+			EmuEx::loadContent(*this, gameInfo, romIO, maxRomSize);
+		}
+		//logMsg("%d input ports", MDFNGameInfo->InputInfo->InputPorts);
+		for(auto i : iotaCount(5))
+		{
+			gameInfo.SetInput(i, "gamepad", (uint8*)&inputBuff[i]);
+		}
+	};
+	auto useAccurateCore = resolvedCore() == EmuCore::Accurate;
+	mdfnGameInfo = useAccurateCore ? EmulatedPCE : EmulatedPCE_Fast;
+	logMsg("using emulator core module:%s", asModuleString(resolvedCore()).data());
+	auto endComparison = scopeGuard([&]() { coreComparison.reset(); });
+	if(compareCores)
+	{
+		// the other core loads first so the active core's memory and cheat setup is what stays registered
+		coreComparison = std::make_unique<CoreComparison>(appContext(), useAccurateCore ? EmulatedPCE_Fast : EmulatedPCE,
+			contentName(), contentMD5);
+		logMsg("comparing with emulator core module:%s", coreComparison->isAccurateCore() ? "pce" : "pce_fast");
+		coreComparison->useCore(loadCore);
+		coreComparison->setLoaded();
 	}
+	loadCore(mdfnGameInfo);
+	endComparison.cancel();
+	unloadCD.cancel();
 	updatePixmap(mSurfacePix.format());
 }
 
@@ -172,6 +234,8 @@ void PceSystem::updatePixmap(IG::PixelFormat fmt)
 		MDFN_IEN_PCE::vce->SetPixelFormat(toMDFNSurface(mSurfacePix).format, nullptr, 0);
 	else
 		MDFN_IEN_PCE_FAST::VDC_SetPixelFormat(toMDFNSurface(mSurfacePix).format, nullptr, 0);
+	if(coreComparison)
+		coreComparison->setPixelFormat(fmt);
 	return;
 }
 
@@ -181,6 +245,8 @@ void PceSystem::configAudioRate(FrameTime outputFrameTime, int outputRate)
 {
 	configuredFor263Lines = isUsing263Lines();
 	auto mixRate = audioMixRate(outputRate, outputFrameTime);
+	if(coreComparison)
+		coreComparison->setSoundRate(mixRate);
 	if(!isUsingAccurateCore())
 		mixRate = std::round(mixRate);
 	auto currMixRate = isUsingAccurateCore() ? MDFN_IEN_PCE::GetSoundRate() : MDFN_IEN_PCE_FAST::GetSoundRate();
@@ -195,9 +261,15 @@ void PceSystem::configAudioRate(FrameTime outputFrameTime, int outputRate)
 
 void PceSystem::runFrame(EmuSystemTaskContext taskCtx, EmuVideo *video, EmuAudio *audio)
 {
-	static constexpr size_t maxAudioFrames = 48000 / minFrameRate;
-	static constexpr size_t maxLineWidths = 264;
-	EmuEx::runFrame(*this, mdfnGameInfo, taskCtx, video, mSurfacePix, audio, maxAudioFrames, maxLineWidths);
+	if(coreComparison) [[unlikely]]
+	{
+		if(!coreComparison->runFrame(*this, taskCtx, video, audio))
+			endCoreComparison();
+	}
+	else
+	{
+		EmuEx::runFrame(*this, mdfnGameInfo, taskCtx, video, mSurfacePix, audio, maxAudioFrames, maxLineWidths);
+	}
 	if(configuredFor263Lines != isUsing263Lines()) [[unlikely]]
 	{
 		onFrameTimeChanged();
@@ -208,11 +280,24 @@ void PceSystem::reset(EmuApp &, ResetMode mode)
 {
 	assert(hasContent());
 	mdfnGameInfo.DoSimpleCommand(MDFN_MSC_RESET);
+	if(coreComparison)
+		coreComparison->reset();
 }
 
 size_t PceSystem::stateSize() { return stateSizeMDFN(); }
-void PceSystem::readState(EmuApp &app, std::span<uint8_t> buff) { readStateMDFN(app, buff); }
-size_t PceSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags) { return writeStateMDFN(buff, flags); }
+
+void PceSystem::readState(EmuApp &app, std::span<uint8_t> buff)
+{
+	if(coreComparison)
+	{
+		logMsg("ending core comparison without a result since state load puts the cores out of sync");
+		coreComparison->discardResult();
+		endCoreComparison();
+	}
+	readStateMDFN(app, buff);
+}
+
+size_t PceSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags) { return writeStateMDFN(*this, buff, flags); }
 
 double PceSystem::videoAspectRatioScale() const
 {
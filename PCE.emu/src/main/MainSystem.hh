@@ -22,6 +22,7 @@
 #include <pce/vce.h>
 #include <pce_fast/pce.h>
 #include <pce_fast/vdc.h>
+#include "CoreComparison.hh"
 
 extern const Mednafen::MDFNGI EmulatedPCE_Fast;
 extern const Mednafen::MDFNGI EmulatedPCE;
@@ -40,6 +41,7 @@ extern vce_t vce;
 void SetSoundRate(double rate);
 double GetSoundRate();
 void PCECD_Drive_SetDisc(bool tray_open, CDInterface* cdif, bool no_emu_side_effects = false) MDFN_COLD;
+std::span<const uint8> GetBaseRAM();
 }
 
 namespace MDFN_IEN_PCE
@@ -50,6 +52,7 @@ extern VCE *vce;
 
 bool SetSoundRate(double rate);
 double GetSoundRate();
+std::span<const uint8> GetBaseRAM();
 }
 
 namespace EmuEx
@@ -65,7 +68,7 @@ enum
 	CFGKEY_NO_SPRITE_LIMIT = 281, CFGKEY_CD_SPEED = 282,
 	CFGKEY_CDDA_VOLUME = 283, CFGKEY_ADPCM_VOLUME = 284,
 	CFGKEY_ADPCM_FILTER = 285, CFGKEY_EMU_CORE = 286,
-	CFGKEY_NO_MD5_FILENAMES = 287,
+	CFGKEY_NO_MD5_FILENAMES = 287, CFGKEY_COMPARE_CORES = 288,
 };
 
 void set6ButtonPadEnabled(EmuApp &, bool);
@@ -91,12 +94,17 @@ WISE_ENUM_CLASS((EmuCore, uint8_t),
 
 inline std::string_view asModuleString(EmuCore c) { return c == EmuCore::Accurate ? "pce" : "pce_fast"; }
 
+// Returns the core the compatibility table lists for the content MD5, or Auto if it isn't listed
+EmuCore knownCompatibleCore(std::string_view md5);
+
 class PceSystem final: public EmuSystem
 {
 public:
 	Mednafen::MDFNGI mdfnGameInfo{EmulatedPCE_Fast};
 	std::array<uint16, 5> inputBuff; // 5 gamepad buffers
 	static constexpr int maxFrameBuffWidth = 1365, maxFrameBuffHeight = 270;
+	static constexpr size_t maxAudioFrames = 48000 / minFrameRate;
+	static constexpr size_t maxLineWidths = 264;
 	alignas(8) uint32_t pixBuff[maxFrameBuffWidth * maxFrameBuffHeight];
 	IG::MutablePixmapView mSurfacePix;
 	bool configuredFor263Lines{};
@@ -113,8 +121,11 @@ public:
 	bool correctLineAspect{};
 	bool adpcmFilter{};
 	bool noMD5InFilenames{};
+	bool compareCores{};
 	EmuCore defaultCore{};
 	EmuCore core{};
+	EmuCore autoCore{EmuCore::Fast};
+	std::unique_ptr<CoreComparison> coreComparison;
 
 	PceSystem(ApplicationContext ctx):
 		EmuSystem{ctx}
@@ -128,9 +139,11 @@ public:
 	uint8_t volume(VolumeType type) { return  volumeVar(type); }
 	void setAdpcmFilter(bool);
 	bool isUsingAccurateCore() const { return mdfnGameInfo.fb_width == 1365; }
-	EmuCore resolvedCore(EmuCore c) const { return c == EmuCore::Auto ? defaultCore : c; }
+	EmuCore resolvedCore(EmuCore c) const { return c == EmuCore::Auto ? resolvedDefaultCore() : c; }
 	EmuCore resolvedCore() const { return resolvedCore(core); }
-	EmuCore resolvedDefaultCore() const { return defaultCore == EmuCore::Auto ? EmuCore::Fast : defaultCore; }
+	EmuCore resolvedDefaultCore() const { return defaultCore == EmuCore::Auto ? autoCore : defaultCore; }
+	// CD access timing only matches between the cores at 1x
+	uint8_t activeCdSpeed() const { return coreComparison ? 1 : cdSpeed; }
 
 	// required API functions
 	void loadContent(IO &, EmuSystemCreateParams, OnLoadProgressDelegate);
@@ -160,10 +173,12 @@ public:
 	void onSessionOptionsLoaded(EmuApp &);
 	bool resetSessionOptions(EmuApp &);
 	double videoAspectRatioScale() const;
+	bool allowsInSessionStates() const { return !coreComparison; }
 
 private:
 	void updateCdSettings();
 	void updatePixmap(IG::PixelFormat);
+	void endCoreComparison();
 
 	bool isUsing263Lines() const
 	{
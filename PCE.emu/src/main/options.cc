@@ -74,6 +74,7 @@ bool PceSystem::readConfig(ConfigType type, MapIO &io, unsigned key)
 			case CFGKEY_ADPCM_FILTER: return readOptionValue(io, adpcmFilter);
 			case CFGKEY_EMU_CORE: return readOptionValue(io, defaultCore, [](auto val){return val <= lastEnum<EmuCore>;});
 			case CFGKEY_NO_MD5_FILENAMES: return readOptionValue(io, noMD5InFilenames);
+			case CFGKEY_COMPARE_CORES: return readOptionValue(io, compareCores);
 		}
 	}
 	else if(type == ConfigType::SESSION)
@@ -110,6 +111,7 @@ void PceSystem::writeConfig(ConfigType type, FileIO &io)
 			writeOptionValue(io, CFGKEY_ADPCM_FILTER, adpcmFilter);
 		writeOptionValueIfNotDefault(io, CFGKEY_EMU_CORE, defaultCore, EmuCore::Auto);
 		writeOptionValueIfNotDefault(io, CFGKEY_NO_MD5_FILENAMES, noMD5InFilenames, false);
+		writeOptionValueIfNotDefault(io, CFGKEY_COMPARE_CORES, compareCores, false);
 	}
 	else if(type == ConfigType::SESSION)
 	{
@@ -127,16 +129,22 @@ void PceSystem::setVisibleLines(VisibleLines lines)
 	visibleLines = lines;
 	if(!hasContent())
 		return;
-	if(isUsingAccurateCore())
+	auto setCoreLines = [&](bool accurate)
 	{
-		MDFN_IEN_PCE::vce->slstart = lines.first;
-		MDFN_IEN_PCE::vce->slend = lines.last;
-	}
-	else
-	{
-		MDFN_IEN_PCE_FAST::vce.slstart = lines.first;
-		MDFN_IEN_PCE_FAST::vce.slend = lines.last;
-	}
+		if(accurate)
+		{
+			MDFN_IEN_PCE::vce->slstart = lines.first;
+			MDFN_IEN_PCE::vce->slend = lines.last;
+		}
+		else
+		{
+			MDFN_IEN_PCE_FAST::vce.slstart = lines.first;
+			MDFN_IEN_PCE_FAST::vce.slend = lines.last;
+		}
+	};
+	setCoreLines(isUsingAccurateCore());
+	if(coreComparison)
+		setCoreLines(coreComparison->isAccurateCore());
 }
 
 void PceSystem::setNoSpriteLimit(bool on)
@@ -144,37 +152,49 @@ void PceSystem::setNoSpriteLimit(bool on)
 	noSpriteLimit = on;
 	if(!hasContent())
 		return;
-	if(isUsingAccurateCore())
-		MDFN_IEN_PCE::vce->SetVDCUnlimitedSprites(on);
-	else
-		MDFN_IEN_PCE_FAST::VDC_SetSettings(on, true);
+	auto setCoreSpriteLimit = [&](bool accurate)
+	{
+		if(accurate)
+			MDFN_IEN_PCE::vce->SetVDCUnlimitedSprites(on);
+		else
+			MDFN_IEN_PCE_FAST::VDC_SetSettings(on, true);
+	};
+	setCoreSpriteLimit(isUsingAccurateCore());
+	if(coreComparison)
+		setCoreSpriteLimit(coreComparison->isAccurateCore());
 }
 
 void PceSystem::updateCdSettings()
 {
 	if(!hasContent())
 		return;
-	if(isUsingAccurateCore())
+	auto setCoreCdSettings = [&](bool accurate)
 	{
-		MDFN_IEN_PCE::PCECD_Settings cdSettings
+		if(accurate)
 		{
-			.CDDA_Volume = cddaVolume / 100.f,
-			.ADPCM_Volume = adpcmVolume / 100.f,
-			.ADPCM_ExtraPrecision = adpcmFilter
-		};
-		MDFN_IEN_PCE::PCECD_SetSettings(&cdSettings);
-	}
-	else
-	{
-		MDFN_IEN_PCE_FAST::PCECD_Settings cdSettings
+			MDFN_IEN_PCE::PCECD_Settings cdSettings
 		{
-			.CDDA_Volume = cddaVolume / 100.f,
-			.ADPCM_Volume = adpcmVolume / 100.f,
-			.CD_Speed = cdSpeed,
-			.ADPCM_LPF = adpcmFilter
-		};
-		MDFN_IEN_PCE_FAST::PCECD_SetSettings(&cdSettings);
-	}
+				.CDDA_Volume = cddaVolume / 100.f,
+				.ADPCM_Volume = adpcmVolume / 100.f,
+				.ADPCM_ExtraPrecision = adpcmFilter
+			};
+			MDFN_IEN_PCE::PCECD_SetSettings(&cdSettings);
+		}
+		else
+		{
+			MDFN_IEN_PCE_FAST::PCECD_Settings cdSettings
+			{
+				.CDDA_Volume = cddaVolume / 100.f,
+				.ADPCM_Volume = adpcmVolume / 100.f,
+				.CD_Speed = activeCdSpeed(),
+				.ADPCM_LPF = adpcmFilter
+			};
+			MDFN_IEN_PCE_FAST::PCECD_SetSettings(&cdSettings);
+		}
+	};
+	setCoreCdSettings(isUsingAccurateCore());
+	if(coreComparison)
+		setCoreCdSettings(coreComparison->isAccurateCore());
 }
 
 void PceSystem::setCdSpeed(uint8_t speed)
@@ -209,7 +229,7 @@ uint64 MDFN_GetSettingUI(const char *name_)
 	if("pce_fast.ocmultiplier" == name)
 		return 1;
 	if("pce_fast.cdspeed" == name)
-		return sys.cdSpeed;
+		return sys.activeCdSpeed();
 	if(name.ends_with(".cdpsgvolume"))
 		return 100;
 	if(name.ends_with(".cddavolume"))
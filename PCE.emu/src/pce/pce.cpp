@@ -32,6 +32,7 @@
 #include <mednafen/FileStream.h>
 #include <mednafen/sound/OwlResampler.h>
 #include <imagine/util/string.h>
+#include <span>
 
 #include <zlib.h>
 
@@ -1182,6 +1183,11 @@ double GetSoundRate()
 	return HRRes->getOutputRate();
 }
 
+std::span<const uint8> GetBaseRAM()
+{
+	return {BaseRAM, IsSGX ? 32768u : 8192u};
+}
+
 //MDFN_printf(_("Palette is missing the full set of 512 greyscale entries.  Strip-colorburst entries will be calculated.\n"));
 static const CustomPalette_Spec CPInfo[] =
 {
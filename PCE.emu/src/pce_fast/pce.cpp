@@ -27,6 +27,7 @@
 #include <mednafen/mempatcher.h>
 #include <mednafen/cdrom/CDInterface.h>
 #include <imagine/util/string.h>
+#include <span>
 
 namespace MDFN_IEN_PCE_FAST
 {
@@ -514,6 +515,11 @@ double GetSoundRate()
 	return sbuf[0].sample_rate();
 }
 
+std::span<const uint8> GetBaseRAM()
+{
+	return {BaseRAM, IsSGX ? 32768u : 8192u};
+}
+
 static MDFN_COLD void CloseGame(void)
 {
  Cleanup();
@@ -30,6 +30,9 @@ ss/stvio.cpp \
 ss/vdp1_line.cpp \
 ss/vdp1_sprite.cpp \
 ss/vdp2_render.cpp \
+ss/vdp2_render_replica1.cpp \
+ss/vdp2_render_replica2.cpp \
+ss/vdp2_render_replica3.cpp \
 ss/cart.cpp \
 ss/db.cpp \
 ss/scu_dsp_jmp.cpp \
@@ -37,6 +40,10 @@ ss/scu_dsp_mvi.cpp \
 ss/sound.cpp \
 ss/vdp1.cpp \
 ss/vdp1_poly.cpp \
+ss/vdp1_render.cpp \
+ss/vdp1_render_line.cpp \
+ss/vdp1_render_poly.cpp \
+ss/vdp1_render_sprite.cpp \
 ss/vdp2.cpp \
 ss/cart/ar4mp.cpp \
 ss/cart/backup.cpp \
@@ -62,6 +69,9 @@ ifneq ($(compiler_sanitizeMode),)
 # disable sanitizers for these files due to long compile times and runtime performance loss
 %/ss/scu_dsp_gen.o : CFLAGS_CODEGEN += -fno-sanitize=address,undefined
 %/ss/vdp2_render.o : CFLAGS_CODEGEN += -fno-sanitize=address,undefined
+%/ss/vdp2_render_replica1.o : CFLAGS_CODEGEN += -fno-sanitize=address,undefined
+%/ss/vdp2_render_replica2.o : CFLAGS_CODEGEN += -fno-sanitize=address,undefined
+%/ss/vdp2_render_replica3.o : CFLAGS_CODEGEN += -fno-sanitize=address,undefined
 %/ss/ss.o : CFLAGS_CODEGEN += -fno-sanitize=address,undefined
 %/mednafen/hw_cpu/m68k/m68k.o : CFLAGS_CODEGEN += -fno-sanitize=address,undefined
 endif
@@ -532,6 +532,7 @@ public:
 
 class CustomSystemOptionView : public SystemOptionView, public MainAppHelper
 {
+	using MainAppHelper::app;
 	using MainAppHelper::system;
 
 	BoolMenuItem autoSetRTC
@@ -567,6 +568,30 @@ class CustomSystemOptionView : public SystemOptionView, public MainAppHelper
 		}
 	};
 
+	TextMenuItem vdp2RenderThreadsItems[5]
+	{
+		{"Auto", attachParams(), {.id = 0}},
+		{"1",    attachParams(), {.id = 1}},
+		{"2",    attachParams(), {.id = 2}},
+		{"3",    attachParams(), {.id = 3}},
+		{"4",    attachParams(), {.id = 4}},
+	};
+
+	MultiChoiceMenuItem vdp2RenderThreads
+	{
+		"VDP2 Render Threads", attachParams(),
+		MenuId{system().vdp2RenderThreads},
+		vdp2RenderThreadsItems,
+		{
+			.defaultItemOnSelect = [this](TextMenuItem &item)
+			{
+				system().vdp2RenderThreads = item.id;
+				if(system().hasContent())
+					app().postMessage("Option takes effect next time the system loads");
+			}
+		}
+	};
+
 	BoolMenuItem saveFilenameType = saveFilenameTypeMenuItem(*this, system());
 
 public:
@@ -575,6 +600,7 @@ public:
 		loadStockItems();
 		item.emplace_back(&biosLanguage);
 		item.emplace_back(&autoSetRTC);
+		item.emplace_back(&vdp2RenderThreads);
 		item.emplace_back(&saveFilenameType);
 	}
 };
@@ -54,6 +54,7 @@ bool EmuSystem::hasResetModes = true;
 bool EmuSystem::hasRectangularPixels = true;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::stateSizeChangesAtRuntime = true;
+bool EmuSystem::canRunAhead = false;
 bool EmuApp::needsGlobalInstance = true;
 
 constexpr EmuSystem::BackupMemoryDirtyFlags sramDirtyBit = bit(0);
@@ -273,9 +274,13 @@ void SaturnSystem::loadContent(IO &io, EmuSystemCreateParams, OnLoadProgressDele
 			filenames.emplace_back(cdImgFile.name());
 		}
 		ArchiveVFS archVFS{std::move(cdImgFile)};
+		auto cacheDir = archVFS.extractToDiskCache();
 		for(auto &fn : filenames)
 		{
-			CDInterfaces.emplace_back(CDInterface::Open(&archVFS, std::move(fn), true, 0));
+			if(cacheDir.size())
+				CDInterfaces.emplace_back(CDInterface::Open(&NVFS, pathString(cacheDir, FS::basename(fn)).data(), false, 0));
+			else
+				CDInterfaces.emplace_back(CDInterface::Open(&archVFS, std::move(fn), true, 0));
 		}
 	}
 	else
@@ -425,7 +430,7 @@ double SaturnSystem::videoAspectRatioScale() const
 
 size_t SaturnSystem::stateSize() { return currStateSize; }
 void SaturnSystem::readState(EmuApp &app, std::span<uint8_t> buff) { readStateMDFN(app, buff); }
-size_t SaturnSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags) { return writeStateMDFN(buff, flags); }
+size_t SaturnSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags) { return writeStateMDFN(*this, buff, flags); }
 
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
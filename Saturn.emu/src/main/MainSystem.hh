@@ -21,6 +21,7 @@
 #include <ss/ss.h>
 #include <ss/smpc.h>
 #include <ss/cart.h>
+#include <ss/vdp2_render.h>
 
 extern const Mednafen::MDFNGI EmulatedSS;
 
@@ -32,7 +33,8 @@ class CDInterface;
 namespace MDFN_IEN_SS
 {
 extern Mednafen::CDInterface* Cur_CDIF;
-extern IG::ThreadId RThreadId;
+extern IG::ThreadId RThreadId[VDP2REND_MaxThreads];
+extern IG::ThreadId VDP1RThreadId;
 extern const int ActiveCartType;
 extern uint8 AreaCode;
 }
@@ -85,7 +87,7 @@ enum
 	CFGKEY_DEFAULT_NTSC_VIDEO_LINES = 287, CFGKEY_DEFAULT_PAL_VIDEO_LINES = 288,
 	CFGKEY_DEFAULT_SHOW_H_OVERSCAN = 289, CFGKEY_SHOW_H_OVERSCAN = 290,
 	CFGKEY_DEINTERLACE_MODE = 291, CFGKEY_WIDESCREEN_MODE = 292,
-	CFGKEY_NO_MD5_FILENAMES = 293
+	CFGKEY_NO_MD5_FILENAMES = 293, CFGKEY_VDP2_RENDER_THREADS = 294
 };
 
 struct VideoLineRange
@@ -125,6 +127,7 @@ public:
 	uint8_t lastInterlaceMode{};
 	int8_t region{};
 	int8_t biosLanguage{MDFN_IEN_SS::SMPC_RTC_LANG_ENGLISH};
+	uint8_t vdp2RenderThreads{}; // 0 for auto
 	InputConfig inputConfig{};
 	DeinterlaceMode deinterlaceMode{DeinterlaceMode::Bob};
 	bool defaultShowHOverscan{};
@@ -194,7 +197,15 @@ public:
 	bool onPointerInputStart(const Input::MotionEvent &e, Input::DragTrackerState, WRect gameRect);
 	bool onPointerInputEnd(const Input::MotionEvent &, Input::DragTrackerState, WRect);
 	Rotation contentRotation() const;
-	void addThreadGroupIds(std::vector<ThreadId> &ids) const { ids.emplace_back(MDFN_IEN_SS::RThreadId); }
+	void addThreadGroupIds(std::vector<ThreadId> &ids) const
+	{
+		for(auto id : MDFN_IEN_SS::RThreadId)
+		{
+			if(id)
+				ids.emplace_back(id);
+		}
+		ids.emplace_back(MDFN_IEN_SS::VDP1RThreadId);
+	}
 };
 
 using MainSystem = SaturnSystem;
@@ -80,6 +80,7 @@ bool SaturnSystem::readConfig(ConfigType type, MapIO &io, unsigned key)
 			case CFGKEY_DEFAULT_PAL_VIDEO_LINES: return readOptionValue(io, defaultPalLines, linesAreValid<288>);
 			case CFGKEY_DEFAULT_SHOW_H_OVERSCAN: return readOptionValue(io, defaultShowHOverscan);
 			case CFGKEY_NO_MD5_FILENAMES: return readOptionValue(io, noMD5InFilenames);
+			case CFGKEY_VDP2_RENDER_THREADS: return readOptionValue(io, vdp2RenderThreads, [](auto v){ return v <= MDFN_IEN_SS::VDP2REND_MaxThreads; });
 		}
 	}
 	else if(type == ConfigType::SESSION)
@@ -113,6 +114,7 @@ void SaturnSystem::writeConfig(ConfigType type, FileIO &io)
 		writeOptionValueIfNotDefault(io, CFGKEY_DEFAULT_PAL_VIDEO_LINES, defaultPalLines, safePalLines);
 		writeOptionValueIfNotDefault(io, CFGKEY_DEFAULT_SHOW_H_OVERSCAN, defaultShowHOverscan, false);
 		writeOptionValueIfNotDefault(io, CFGKEY_NO_MD5_FILENAMES, noMD5InFilenames, false);
+		writeOptionValueIfNotDefault(io, CFGKEY_VDP2_RENDER_THREADS, vdp2RenderThreads, 0);
 	}
 	else if(type == ConfigType::SESSION)
 	{
@@ -147,8 +149,12 @@ uint64 MDFN_GetSettingUI(const char *name_)
 		return 4;
 	if("ss.smpc.autortc.lang" == name)
 		return sys.biosLanguage;
-	if("ss.affinity.vdp2" == name)
+	if("ss.affinity.vdp1" == name || "ss.affinity.vdp2" == name)
 		return 0;
+	if("ss.threads.vdp2" == name)
+		return sys.vdp2RenderThreads ? sys.vdp2RenderThreads :
+			// leave cores for the emulation, VDP1, and presentation threads
+			std::clamp(sys.appContext().cpuCount() - 3, 1, int(MDFN_IEN_SS::VDP2REND_MaxThreads));
 	if(name.ends_with("gun_chairs"))
 		return 0xFFFFFFFF;
 	if(name == "ss.dbg_cem")
@@ -1365,7 +1365,9 @@ static void MDFN_COLD InitCommon(unsigned cpucache_emumode, unsigned horrible_ha
  const char* biospath_sname;
  int sls = MDFN_GetSettingI(PAL ? "ss.slstartp" : "ss.slstart");
  int sle = MDFN_GetSettingI(PAL ? "ss.slendp" : "ss.slend");
+ const uint64 vdp1_affinity = MDFN_GetSettingUI("ss.affinity.vdp1");
  const uint64 vdp2_affinity = MDFN_GetSettingUI("ss.affinity.vdp2");
+ const unsigned vdp2_threads = MDFN_GetSettingUI("ss.threads.vdp2");
 
  if(PAL)
  {
@@ -1471,8 +1473,8 @@ static void MDFN_COLD InitCommon(unsigned cpucache_emumode, unsigned horrible_ha
  if(cart_type == CART_STV)
   STVIO_Init(sgi);
 
- VDP1::Init();
- VDP2::Init(PAL, vdp2_affinity);
+ VDP1::Init(vdp1_affinity);
+ VDP2::Init(PAL, vdp2_affinity, vdp2_threads);
  CDB_Init();
  SOUND_Init(cart_type == CART_STV);
 
@@ -2454,7 +2456,9 @@ static const MDFNSetting SSSettings[] =
  { "ss.slstartp", MDFNSF_NOFLAGS, gettext_noop("First displayed scanline in PAL mode."), NULL, MDFNST_INT, "0", "-16", "271" },
  { "ss.slendp", MDFNSF_NOFLAGS, gettext_noop("Last displayed scanline in PAL mode."), NULL, MDFNST_INT, "255", "-16", "271" },
 
+ { "ss.affinity.vdp1", MDFNSF_NOFLAGS, gettext_noop("VDP1 rendering thread CPU affinity mask."), gettext_noop("Set to 0 to disable changing affinity."), MDFNST_UINT, "0", "0x0000000000000000", "0xFFFFFFFFFFFFFFFF" },
  { "ss.affinity.vdp2", MDFNSF_NOFLAGS, gettext_noop("VDP2 rendering thread CPU affinity mask."), gettext_noop("Set to 0 to disable changing affinity."), MDFNST_UINT, "0", "0x0000000000000000", "0xFFFFFFFFFFFFFFFF" },
+ { "ss.threads.vdp2", MDFNSF_NOFLAGS, gettext_noop("Number of VDP2 rendering threads."), gettext_noop("Consecutive lines are drawn by different threads.  Each thread uses the VDP2 rendering thread CPU affinity mask."), MDFNST_UINT, "1", "1", "4" },
 
 #ifdef MDFN_ENABLE_DEV_BUILD
  { "ss.dbg_mask", MDFNSF_SUPPRESS_DOC, gettext_noop("Debug printf mask."), NULL, MDFNST_MULTI_ENUM, "none", NULL, NULL, NULL, NULL, DBGMask_List },
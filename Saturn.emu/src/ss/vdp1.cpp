@@ -45,6 +45,7 @@
 #include "vdp1.h"
 #include "vdp2.h"
 #include "vdp1_common.h"
+#include "vdp1_render.h"
 
 enum : int { VDP1_UpdateTimingGran = 263 };
 enum : int { VDP1_IdleTimingGran = 1019 };
@@ -56,21 +57,10 @@ namespace VDP1
 
 uint8 spr_w_shift_tab[8];
 uint8 gouraud_lut[0x40];
-line_data LineData;
-line_inner_data LineInnerData;
-prim_data PrimData;
 
-int32 SysClipX, SysClipY;
-int32 UserClipX0, UserClipY0, UserClipX1, UserClipY1;
-
-int32 LocalX, LocalY;
-
-uint8 TVMR;
-uint8 FBCR;
 static uint8 PTMR;
 static uint8 EDSR;
 
-uint16* FBDrawWhichPtr;
 static bool FBDrawWhich;
 
 static bool DrawingActive;
@@ -82,7 +72,6 @@ static sscpu_timestamp_t lastts;
 static int32 CycleCounter;
 static int32 CommandPhase;
 static uint16 CommandData[0x10];
-uint32 DTACounter;
 
 static bool vb_status, hb_status;
 static bool vbcdpending;
@@ -116,7 +105,6 @@ static uint32 EraseYCounter;
 static uint32 InstantDrawSanityLimit; // ss_horrible_hacks
 #endif
 
-uint16 VRAM[0x40000];
 uint16 FB[2][0x20000];
 //
 //
@@ -208,10 +196,12 @@ static INLINE void VRAMUsageWrite(uint32 A) { }
 static INLINE void VRAMUsageDrawRead(uint32 A) { }
 static INLINE void VRAMUsageEnd(void) { }
 #endif
+
+#include "vdp1_draw.inc"
 //
 //
 //
-void Init(void)
+void Init(const uint64 affinity)
 {
  vbcdpending = false;
 
@@ -238,15 +228,19 @@ void Init(void)
  LastRWTS = 0;
 
  VRAMUsageInit();
+
+ VDP1REND_Init(affinity);
 }
 
 void Kill(void)
 {
-
+ VDP1REND_Kill();
 }
 
 void Reset(bool powering_up)
 {
+ VDP1REND_Sync();
+
  if(powering_up)
  {
   for(unsigned i = 0; i < 0x40000; i++)
@@ -319,335 +313,8 @@ void Reset(bool powering_up)
 
  memset(&EraseParams, 0, sizeof(EraseParams));
  EraseYCounter = ~0U;
-}
-
-static int32 CMD_SetUserClip(const uint16* cmd_data)
-{
- UserClipX0 = cmd_data[0x6] & 0x1FFF;
- UserClipY0 = cmd_data[0x7] & 0x1FFF;
-
- UserClipX1 = cmd_data[0xA] & 0x1FFF;
- UserClipY1 = cmd_data[0xB] & 0x1FFF;
-
- return 0;
-}
-
-int32 CMD_SetSystemClip(const uint16* cmd_data)
-{
- SysClipX = cmd_data[0xA] & 0x1FFF;
- SysClipY = cmd_data[0xB] & 0x1FFF;
-
- return 0;
-}
-
-int32 CMD_SetLocalCoord(const uint16* cmd_data)
-{
- LocalX = sign_x_to_s32(11, cmd_data[0x6] & 0x7FF);
- LocalY = sign_x_to_s32(11, cmd_data[0x7] & 0x7FF);
-
- return 0;
-}
-
-template<unsigned ECDSPDMode>
-static uint32 MDFN_FASTCALL TexFetch(uint32 x)
-{
- const uint32 base = LineData.tex_base;
- const bool ECD = ECDSPDMode & 0x10;
- const bool SPD = ECDSPDMode & 0x08;
- const unsigned ColorMode = ECDSPDMode & 0x07;
-
- uint32 rtd;
- uint32 ret_or = 0;
-
- switch(ColorMode)
- {
-  case 0:	// 16 colors, color bank
-	rtd = (VRAM[(base + (x >> 2)) & 0x3FFFF] >> (((x & 0x3) ^ 0x3) << 2)) & 0xF;
-	VRAMUsageDrawRead((base + (x >> 2)) & 0x3FFFF);
-
-	if(!ECD && rtd == 0xF)
-	{
-	 LineData.ec_count--;	
-	 return -1;
-	}
-	ret_or = LineData.cb_or;
-	
-	if(!SPD) ret_or |= (int32)(rtd - 1) >> 31;
-
-	return rtd | ret_or;
-
-  case 1:	// 16 colors, LUT
-	rtd = (VRAM[(base + (x >> 2)) & 0x3FFFF] >> (((x & 0x3) ^ 0x3) << 2)) & 0xF;
-	VRAMUsageDrawRead((base + (x >> 2)) & 0x3FFFF);
-
-	if(!ECD && rtd == 0xF)
-	{
-	 LineData.ec_count--;
-	 return -1;
-	}
-
-	if(!SPD) ret_or |= (int32)(rtd - 1) >> 31;
-
-	return LineData.CLUT[rtd] | ret_or;
-
-  case 2:	// 64 colors, color bank
-	rtd = (VRAM[(base + (x >> 1)) & 0x3FFFF] >> (((x & 0x1) ^ 0x1) << 3)) & 0xFF;
-	VRAMUsageDrawRead((base + (x >> 1)) & 0x3FFFF);
-
-	if(!ECD && rtd == 0xFF)
-	{
-	 LineData.ec_count--;
-	 return -1;
-	}
-
-	ret_or = LineData.cb_or;
-
-	if(!SPD) ret_or |= (int32)(rtd - 1) >> 31;
-
-	return (rtd & 0x3F) | ret_or;
-
-  case 3:	// 128 colors, color bank
-	rtd = (VRAM[(base + (x >> 1)) & 0x3FFFF] >> (((x & 0x1) ^ 0x1) << 3)) & 0xFF;
-	VRAMUsageDrawRead((base + (x >> 1)) & 0x3FFFF);
-
-	if(!ECD && rtd == 0xFF)
-	{
-	 LineData.ec_count--;
-	 return -1;
-	}
-
-	ret_or = LineData.cb_or;
-
-	if(!SPD) ret_or |= (int32)(rtd - 1) >> 31;
-
-	return (rtd & 0x7F) | ret_or;
-
-  case 4:	// 256 colors, color bank
-	rtd = (VRAM[(base + (x >> 1)) & 0x3FFFF] >> (((x & 0x1) ^ 0x1) << 3)) & 0xFF;
-	VRAMUsageDrawRead((base + (x >> 1)) & 0x3FFFF);
-
-	if(!ECD && rtd == 0xFF)
-	{
-	 LineData.ec_count--;
-	 return -1;
-	}
-
-	ret_or = LineData.cb_or;
-
-	if(!SPD) ret_or |= (int32)(rtd - 1) >> 31;
-
-	return rtd | ret_or;
-
-  case 5:	// 32K colors, RGB
-  case 6:
-  case 7:
-	if(ColorMode >= 6)
-	 rtd = VRAM[0];
-	else
-	 rtd = VRAM[(base + x) & 0x3FFFF];
-	VRAMUsageDrawRead((ColorMode >= 6) ? 0 : ((base + x) & 0x3FFFF));
-
-	if(!ECD && (rtd & 0xC000) == 0x4000)
-	{
-	 LineData.ec_count--;
-	 return -1;
-	}
-
-	if(!SPD) ret_or |= (int32)(rtd - 0x4000) >> 31;
-
-	return rtd | ret_or;
- }
-}
-
-
-MDFN_HIDE extern uint32 (MDFN_FASTCALL *const TexFetchTab[0x20])(uint32 x) =
-{
- #define TF(a) (TexFetch<a>)
 
- TF(0x00), TF(0x01), TF(0x02), TF(0x03),
- TF(0x04), TF(0x05), TF(0x06), TF(0x07),
-
- TF(0x08), TF(0x09), TF(0x0A), TF(0x0B),
- TF(0x0C), TF(0x0D), TF(0x0E), TF(0x0F),
-
- TF(0x10), TF(0x11), TF(0x12), TF(0x13),
- TF(0x14), TF(0x15), TF(0x16), TF(0x17),
-
- TF(0x18), TF(0x19), TF(0x1A), TF(0x1B),
- TF(0x1C), TF(0x1D), TF(0x1E), TF(0x1F),
-
- #undef TF
-};
-
-bool SetupDrawLine(int32* const cycle_counter, const bool AA, const bool Textured, const uint16 mode)
-{
- const bool HSS = (mode & 0x1000);
- const bool PCD = (mode & 0x800);
- const bool UserClipEn = (mode & 0x400);
- const bool UserClipMode = (mode & 0x200);
- //const bool ECD = (mode & 0x80);
- //const bool SPD = (mode & 0x40);
- const bool GouraudEn = (mode & 0x8004) == 0x4;
- line_vertex p0 = LineData.p[0];
- line_vertex p1 = LineData.p[1];
- line_inner_data& lid = LineInnerData;
- bool clipped = false;
-
- p0.x &= 0x1FFF;
- p0.y &= 0x1FFF;
- p1.x &= 0x1FFF;
- p1.y &= 0x1FFF;
-
- //printf("(0x%04x,0x%04x) -> (0x%04x,0x%04x)\n", p0.x, p0.y, p1.x, p1.y);
-
- if(!PCD)
- {
-  bool swapped = false;
-
-  *cycle_counter += 4;
-
-  if(UserClipEn && !UserClipMode)
-  {
-   // Ignore system clipping WRT pre-clip for UserClipEn == 1 && UserClipMode == 0
-   clipped |= (((UserClipX1 - p0.x) & (UserClipX1 - p1.x)) | ((p0.x - UserClipX0) & (p1.x - UserClipX0))) & 0x1000;
-   clipped |= (((UserClipY1 - p0.y) & (UserClipY1 - p1.y)) | ((p0.y - UserClipY0) & (p1.y - UserClipY0))) & 0x1000;
-
-   swapped = (p0.y == p1.y) & ((p0.x < UserClipX0) | (p0.x > UserClipX1));
-  }
-  else
-  {
-   clipped |= (((SysClipX - p0.x) & (SysClipX - p1.x)) | (p0.x & p1.x)) & 0x1000;
-   clipped |= (((SysClipY - p0.y) & (SysClipY - p1.y)) | (p0.y & p1.y)) & 0x1000;
-
-   swapped = (p0.y == p1.y) & (p0.x > SysClipX);
-  }
-  //
-  // VDP1 reduces the line into a point to clip it, and it can be seen in the framebuffer under
-  // certain conditions relating to coordinate precision.
-  //
-  if(clipped)
-   p1 = p0;
-  else if(swapped)
-   std::swap(p0, p1);
- }
-
- *cycle_counter += 8;
-
- //
- //
- const int32 dx = sign_x_to_s32(13, p1.x - p0.x);
- const int32 dy = sign_x_to_s32(13, p1.y - p0.y);
- const int32 abs_dx = abs(dx); // & 0xFFF;
- const int32 abs_dy = abs(dy); // & 0xFFF;
- const int32 max_adx_ady = std::max<int32>(abs_dx, abs_dy);
- const int32 x_inc = (dx >= 0) ? 1 : -1;
- const int32 y_inc = (dy >= 0) ? 1 : -1;
- const int32 lid_x_inc = (x_inc & 0x7FF) <<  0;
- const int32 lid_y_inc = (y_inc & 0x7FF) << 16;
-
- lid.xy = (p0.x & 0x7FF) + ((p0.y & 0x7FF) << 16);
- lid.term_xy = (p1.x & 0x7FF) + ((p1.y & 0x7FF) << 16);
- lid.drawn_ac = true;	// Drawn all-clipped
- lid.color = LineData.color;
-
- //if(max_adx_ady >= 2048)
- // printf("%d,%d ->  %d, %d\n", p0.x, p0.y, p1.x, p1.y);
-
- if(GouraudEn)
-  lid.g.Setup(max_adx_ady + 1, p0.g, p1.g);
-
- if(Textured)
- {
-  LineData.ec_count = 2;	// Call before tffn()
-
-  if(MDFN_UNLIKELY(max_adx_ady < abs(p1.t - p0.t) && HSS))
-  {
-   LineData.ec_count = 0x7FFFFFFF;
-   lid.t.Setup(max_adx_ady + 1, p0.t >> 1, p1.t >> 1, 2, (bool)(FBCR & FBCR_EOS));
-  }
-  else
-   lid.t.Setup(max_adx_ady + 1, p0.t, p1.t);
-
-  lid.texel = LineData.tffn(lid.t.Current());
- }
-
- {
-  int32 aa_x_inc;
-  int32 aa_y_inc;
-
-  if(abs_dy > abs_dx)
-  {
-   if(y_inc < 0)
-   {
-    aa_x_inc =  (x_inc >> 31);
-    aa_y_inc = -(x_inc >> 31);
-   }
-   else
-   {
-    aa_x_inc = -(~x_inc >> 31);
-    aa_y_inc =  (~x_inc >> 31);
-   }
-  }
-  else
-  {
-   if(x_inc < 0)
-   {
-    aa_x_inc = -(~y_inc >> 31);
-    aa_y_inc = -(~y_inc >> 31);
-   }
-   else
-   {
-    aa_x_inc =  (y_inc >> 31);
-    aa_y_inc =  (y_inc >> 31);
-   }
-  }
-  lid.aa_xy_inc = (aa_x_inc & 0x7FF) + ((aa_y_inc & 0x7FF) << 16);
- }
-
- // x, y, x_inc, y_inc, aa_x_inc, aa_y_inc, term_x, term_y, error, error_inc, error_adj, t, g, color
- if(abs_dy > abs_dx)
- {
-  lid.error_inc =  (2 * abs_dx);
-  lid.error_adj = -(2 * abs_dy);
-  lid.error = (abs_dy - (2 * abs_dy)) - 1;
-  lid.error_cmp = 0;
-
-  if(dy < 0 && !AA)
-   lid.error_cmp--;
-
-  lid.error -= lid.error_inc;
-  lid.xy = (lid.xy + (0x8000000 - lid_y_inc)) & 0x07FF07FF;
-  lid.xy_inc[0] = lid_y_inc;
-  lid.xy_inc[1] = lid_x_inc;
- }
- else
- {
-  lid.error_inc =  (2 * abs_dy);
-  lid.error_adj = -(2 * abs_dx);
-  lid.error = (abs_dx - (2 * abs_dx)) - 1;
-  lid.error_cmp = 0;
-
-  if(dx < 0 && !AA)
-   lid.error_cmp--;
-
-  lid.error -= lid.error_inc;
-  lid.xy = (lid.xy + (0x800 - lid_x_inc)) & 0x07FF07FF;
-  lid.xy_inc[0] = lid_x_inc;
-  lid.xy_inc[1] = lid_y_inc;
- }
- if(AA)
- {
-  lid.error++;
-  lid.error_cmp++;
- }
-
- //
- lid.error_inc <<= 32 - 13;
- lid.error_adj <<= 32 - 13;
- lid.error <<= 32 - 13;
- lid.error_cmp = (uint32)lid.error_cmp << (32 - 13);
-
- return clipped;
+ VDP1REND_SetState(CommandData, FBDrawWhich);
 }
 
 void EdgeStepper::Setup(const bool gourauden, const line_vertex& p0, const line_vertex& p1, const int32 dmax)
@@ -730,6 +397,7 @@ static INLINE void DoDrawing(void)
 
    // Fetch command data
    memcpy(CommandData, &VRAM[CurCommandAddr], sizeof(CommandData));
+   VDP1REND_FetchCommand(CurCommandAddr);
 
    VDP1_EAT_CLOCKS(16);
 
@@ -769,6 +437,7 @@ static INLINE void DoDrawing(void)
       RESUME_Polygon, RESUME_Line, RESUME_Line, RESUME_Line,
      };
 
+     VDP1REND_StartCommand(DTACounter);
      VDP1_EAT_CLOCKS(command_table[CommandData[0] & 0xF](CommandData));
      if(!(CommandData[0] & 0x8))
      {
@@ -779,8 +448,12 @@ static INLINE void DoDrawing(void)
        cycles = resume_table[CommandData[0] & 0x7](CommandData);
 
        if(!cycles)
+       {
+        VDP1REND_EndCommand();
         break;
+       }
 
+       VDP1REND_ResumeCommand();
        VDP1_EAT_CLOCKS(cycles);
       }
      }
@@ -972,7 +645,10 @@ void SetHBVB(const sscpu_timestamp_t event_timestamp, const bool new_hb_status,
    {
 #if 1
     if((ss_horrible_hacks & HORRIBLEHACK_VDP1VRAM5000FIX) && DrawingActive && VRAM[0] == 0x5000 && VRAM[1] == 0x0000)
+    {
      VRAM[0] = 0x8000;
+     VDP1REND_Write16(0, 0x8000);
+    }
 #endif
 
     if(DrawingActive)
@@ -982,8 +658,10 @@ void SetHBVB(const sscpu_timestamp_t event_timestamp, const bool new_hb_status,
      VRAMUsageEnd();
     }
 
+    VDP1REND_Sync();
     FBDrawWhich = !FBDrawWhich;
     FBDrawWhichPtr = FB[FBDrawWhich];
+    VDP1REND_SetMode(TVMR, FBCR, FBDrawWhich);
 
     SS_DBGTI(SS_DBG_VDP1, "[VDP1] Displayed framebuffer changed to %d.", !FBDrawWhich);
 
@@ -1140,11 +818,13 @@ static INLINE void WriteReg(const unsigned which, const uint16 value)
 
   case 0x0:	// TVMR
 	TVMR = value & 0xF;
+	VDP1REND_SetMode(TVMR, FBCR, FBDrawWhich);
 	break;
 
   case 0x1:	// FBCR
 	FBCR = value & 0x1F;
 	FBManualPending |= value & 0x2;
+	VDP1REND_SetMode(TVMR, FBCR, FBDrawWhich);
 	break;
 
   case 0x2:	// PTMR
@@ -1247,6 +927,7 @@ MDFN_FASTCALL void Write8_DB(uint32 A, uint16 DB)
   VRAMUsageWrite(A >> 1);
   SS_DBGTI(SS_DBG_VDP1_VRAMW, "[VDP1] Write to VRAM: 0x%02x->VRAM[0x%05x]", (DB >> (((A & 1) ^ 1) << 3)) & 0xFF, A);
   ne16_wbo_be<uint8>(VRAM, A, DB >> (((A & 1) ^ 1) << 3) );
+  VDP1REND_Write16(A >> 1, VRAM[A >> 1]);
   return;
  }
 
@@ -1254,6 +935,7 @@ MDFN_FASTCALL void Write8_DB(uint32 A, uint16 DB)
  {
   uint32 FBA = A;
 
+  VDP1REND_Sync();
   SS_DBGTI(SS_DBG_VDP1_FBW, "[VDP1] Write to FB: 0x%02x->FB[%d][0x%05x] CycleCounter=%d", (DB >> (((A & 1) ^ 1) << 3)) & 0xFF, FBDrawWhich, A & 0x3FFFF, CycleCounter);
 
   if((TVMR & (TVMR_8BPP | TVMR_ROTATE)) == (TVMR_8BPP | TVMR_ROTATE))
@@ -1276,6 +958,7 @@ MDFN_FASTCALL void Write16_DB(uint32 A, uint16 DB)
   VRAMUsageWrite(A >> 1);
   SS_DBGTI(SS_DBG_VDP1_VRAMW, "[VDP1] Write to VRAM: 0x%04x->VRAM[0x%05x]", DB, A);
   VRAM[A >> 1] = DB;
+  VDP1REND_Write16(A >> 1, DB);
   return;
  }
 
@@ -1283,6 +966,7 @@ MDFN_FASTCALL void Write16_DB(uint32 A, uint16 DB)
  {
   uint32 FBA = A;
 
+  VDP1REND_Sync();
   SS_DBGTI(SS_DBG_VDP1_FBW, "[VDP1] Write to FB: 0x%04x->FB[%d][0x%05x] CycleCounter=%d", DB, FBDrawWhich, A & 0x3FFFF, CycleCounter);
 
   if((TVMR & (TVMR_8BPP | TVMR_ROTATE)) == (TVMR_8BPP | TVMR_ROTATE))
@@ -1306,6 +990,7 @@ MDFN_FASTCALL uint16 Read16_DB(uint32 A)
  {
   uint32 FBA = A;
 
+  VDP1REND_Sync();
   if((TVMR & (TVMR_8BPP | TVMR_ROTATE)) == (TVMR_8BPP | TVMR_ROTATE))
    FBA = (FBA & 0x1FF) | ((FBA << 1) & 0x3FC00) | ((FBA >> 8) & 0x200);
 
@@ -1319,6 +1004,10 @@ void StateAction(StateMem* sm, const unsigned load, const bool data_only)
 {
  bool tmp_abs_dy_gt_abs_dx = false;
 
+ VDP1REND_Sync();
+ if(!load)
+  VDP1REND_GetState();
+
  SFORMAT Prim_StateRegs[] =
  {
   SFVAR(PrimData.e->d_error, 0x2, sizeof(*PrimData.e), PrimData.e),
@@ -1501,6 +1190,8 @@ void StateAction(StateMem* sm, const unsigned load, const bool data_only)
 
   if(tmp_abs_dy_gt_abs_dx)
    std::swap(LineInnerData.xy_inc[0], LineInnerData.xy_inc[1]);
+
+  VDP1REND_SetState(CommandData, FBDrawWhich);
  }
 }
 
@@ -1578,6 +1269,8 @@ uint32 GetRegister(const unsigned id, char* const special, const uint32 special_
 
 void SetRegister(const unsigned id, const uint32 value)
 {
+ VDP1REND_Sync();
+
  // TODO
  switch(id)
  {
@@ -1635,6 +1328,9 @@ void SetRegister(const unsigned id, const uint32 value)
 	break;
 */
  }
+
+ VDP1REND_GetState();
+ VDP1REND_SetState(CommandData, FBDrawWhich);
 }
 
 }
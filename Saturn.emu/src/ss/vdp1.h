@@ -30,7 +30,7 @@ namespace MDFN_IEN_SS
 namespace VDP1
 {
 
-void Init(void) MDFN_COLD;
+void Init(const uint64 affinity) MDFN_COLD;
 void Kill(void) MDFN_COLD;
 void StateAction(StateMem* sm, const unsigned load, const bool data_only) MDFN_COLD;
 
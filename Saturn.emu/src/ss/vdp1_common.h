@@ -31,40 +31,18 @@ namespace VDP1
 enum : int { VDP1_SuspendResumeThreshold = 1000 };
 static_assert(VDP1_SuspendResumeThreshold >= 1, "out of acceptable range");
 
-int32 CMD_NormalSprite(const uint16*);
-int32 CMD_ScaledSprite(const uint16*);
-int32 CMD_DistortedSprite(const uint16*);
-int32 RESUME_Sprite(const uint16*);
-
-int32 CMD_Polygon(const uint16*);
-int32 RESUME_Polygon(const uint16*);
-
-int32 CMD_Polyline(const uint16*);
-int32 CMD_Line(const uint16*);
-int32 RESUME_Line(const uint16*);
-
-MDFN_HIDE extern uint16 VRAM[0x40000];
 MDFN_HIDE extern uint16 FB[2][0x20000];
-MDFN_HIDE extern uint16* FBDrawWhichPtr;
-
-MDFN_HIDE extern int32 SysClipX, SysClipY;
-MDFN_HIDE extern int32 UserClipX0, UserClipY0, UserClipX1, UserClipY1;
-MDFN_HIDE extern int32 LocalX, LocalY;
-
-MDFN_HIDE extern uint32 (MDFN_FASTCALL *const TexFetchTab[0x20])(uint32 x);
 
 constexpr unsigned TVMR_8BPP   = 0x1;
 constexpr unsigned TVMR_ROTATE = 0x2;
 constexpr unsigned TVMR_HDTV   = 0x4;
 constexpr unsigned TVMR_VBE    = 0x8;
-MDFN_HIDE extern uint8 TVMR;
 
 enum { FBCR_FCT	   = 0x01 };	// Frame buffer change trigger
 enum { FBCR_FCM	   = 0x02 };	// Frame buffer change mode
 enum { FBCR_DIL	   = 0x04 };	// Double interlace draw line(0=even, 1=odd) (does it affect drawing to FB RAM or reading from FB RAM to VDP2?)
 enum { FBCR_DIE	   = 0x08 };	// Double interlace enable
 enum { FBCR_EOS	   = 0x10 };	// Even/Odd coordinate select(0=even, 1=odd, used with HSS)
-MDFN_HIDE extern uint8 FBCR;
 
 MDFN_HIDE extern uint8 spr_w_shift_tab[8];
 MDFN_HIDE extern uint8 gouraud_lut[0x40];
@@ -204,9 +182,161 @@ struct VileTex
  int32 error_adj;
 };
 
+struct line_vertex
+{
+ int32 x, y;
+ uint16 g;
+ int32 t;
+};
+
+struct EdgeStepper
+{
+ void Setup(const bool gourauden, const line_vertex& p0, const line_vertex& p1, const int32 dmax);
+
+ template<bool gourauden>
+ INLINE void GetVertex(line_vertex* p)
+ {
+  p->x = x;
+  p->y = y;
+
+  if(gourauden)
+   p->g = g.Current();
+ }
+
+ template<bool gourauden>
+ INLINE void Step(void)
+ {
+  d_error += d_error_inc;
+  if((int32)d_error >= d_error_cmp)
+  {
+   d_error += d_error_adj;
+
+   x_error += x_error_inc;
+   {
+    const uint32 x_mask = -((int32)x_error >= x_error_cmp);
+    x += x_inc & x_mask;
+    x_error += x_error_adj & x_mask;
+   }
+
+   y_error += y_error_inc;
+   {
+    const uint32 y_mask = -((int32)y_error >= y_error_cmp);
+    y += y_inc & y_mask;
+    y_error += y_error_adj & y_mask;
+   }
+
+   if(gourauden)
+    g.Step();
+  }
+ }
+
+ uint32 d_error, d_error_inc, d_error_adj;
+ int32 d_error_cmp;
+
+ uint32 x, x_inc;
+ uint32 x_error, x_error_inc, x_error_adj;
+ int32 x_error_cmp;
+
+ uint32 y, y_inc;
+ uint32 y_error, y_error_inc, y_error_adj;
+ int32 y_error_cmp;
+
+ GourauderTheTerrible g;
+};
+
+struct line_inner_data
+{
+ uint32 xy;
+ uint32 error;
+ bool drawn_ac;
+
+ uint32 texel; // must be 32-bit
+ VileTex t;
+ GourauderTheTerrible g;
+ //
+ //
+ //
+ int32 xy_inc[2];
+ uint32 aa_xy_inc;
+ uint32 term_xy;
+
+ int32 error_cmp;
+ uint32 error_inc;
+ uint32 error_adj;
+
+ uint16 color;
+};
+
+struct line_data
+{
+ line_vertex p[2];
+ //
+ uint16 color;
+ int32 ec_count;
+ uint32 (MDFN_FASTCALL *tffn)(uint32);
+ uint16 CLUT[0x10];
+ uint32 cb_or;
+ uint32 tex_base;
+};
+
+struct prim_data
+{
+ EdgeStepper e[2];
+ VileTex big_t;
+ uint32 tex_base;
+ int32 iter;
+ bool need_line_resume;
+};
+
 //
+// The drawing code here and in vdp1_draw.inc, vdp1_line.cpp, vdp1_poly.cpp, and vdp1_sprite.cpp is built twice.  The
+// emulation thread's copy in VDP1 only tracks draw timing, while the copy in VDP1::Render(built with MDFN_SS_VDP1_RENDER
+// defined) has its own VRAM and drawing state, and is run by the render thread in vdp1_render.cpp to write the framebuffer.
 //
-//
+#ifdef MDFN_SS_VDP1_RENDER
+ #define VDP1_DRAW_NAMESPACE_BEGIN namespace Render {
+ #define VDP1_DRAW_NAMESPACE_END }
+ #define VDP1_DRAW_TIMING_ONLY false
+#else
+ #define VDP1_DRAW_NAMESPACE_BEGIN
+ #define VDP1_DRAW_NAMESPACE_END
+ #define VDP1_DRAW_TIMING_ONLY true
+#endif
+
+VDP1_DRAW_NAMESPACE_BEGIN
+
+int32 CMD_NormalSprite(const uint16*);
+int32 CMD_ScaledSprite(const uint16*);
+int32 CMD_DistortedSprite(const uint16*);
+int32 RESUME_Sprite(const uint16*);
+
+int32 CMD_Polygon(const uint16*);
+int32 RESUME_Polygon(const uint16*);
+
+int32 CMD_Polyline(const uint16*);
+int32 CMD_Line(const uint16*);
+int32 RESUME_Line(const uint16*);
+
+MDFN_HIDE extern uint16 VRAM[0x40000];
+MDFN_HIDE extern uint16* FBDrawWhichPtr;
+
+MDFN_HIDE extern int32 SysClipX, SysClipY;
+MDFN_HIDE extern int32 UserClipX0, UserClipY0, UserClipX1, UserClipY1;
+MDFN_HIDE extern int32 LocalX, LocalY;
+
+MDFN_HIDE extern uint32 (MDFN_FASTCALL *const TexFetchTab[0x20])(uint32 x);
+
+MDFN_HIDE extern uint8 TVMR;
+MDFN_HIDE extern uint8 FBCR;
+
+MDFN_HIDE extern line_data LineData;
+MDFN_HIDE extern line_inner_data LineInnerData;
+MDFN_HIDE extern prim_data PrimData;
+
+int32 CMD_SetSystemClip(const uint16*);
+int32 CMD_SetLocalCoord(const uint16*);
+int32 CMD_SetUserClip(const uint16*);
+
 template<bool die, unsigned bpp8, bool MSBOn, bool UserClipEn, bool UserClipMode, bool MeshEn, bool GouraudEn, bool HalfFGEn, bool HalfBGEn>
 static INLINE int32 PlotPixel(int32 x, int32 y, uint16 pix, bool transparent, GourauderTheTerrible* g)
 {
@@ -215,6 +345,10 @@ static INLINE int32 PlotPixel(int32 x, int32 y, uint16 pix, bool transparent, Go
  int32 ret = 0;
  uint16* fbyptr;
 
+ // Same cycle count as below, the render thread writes the pixel.
+ if(VDP1_DRAW_TIMING_ONLY)
+  return (MSBOn || HalfBGEn) ? 6 : 1;
+
  if(die)
  {
   fbyptr = &FBDrawWhichPtr[((y >> 1) & 0xFF) << 9];
@@ -318,118 +452,6 @@ static INLINE int32 PlotPixel(int32 x, int32 y, uint16 pix, bool transparent, Go
 }
 //
 //
-struct line_vertex
-{
- int32 x, y;
- uint16 g;
- int32 t;
-};
-
-struct EdgeStepper
-{
- void Setup(const bool gourauden, const line_vertex& p0, const line_vertex& p1, const int32 dmax);
-
- template<bool gourauden>
- INLINE void GetVertex(line_vertex* p)
- {
-  p->x = x;
-  p->y = y;
-
-  if(gourauden)
-   p->g = g.Current();
- }
-
- template<bool gourauden>
- INLINE void Step(void)
- {
-  d_error += d_error_inc;
-  if((int32)d_error >= d_error_cmp)
-  {
-   d_error += d_error_adj;
-
-   x_error += x_error_inc;
-   {
-    const uint32 x_mask = -((int32)x_error >= x_error_cmp);
-    x += x_inc & x_mask;
-    x_error += x_error_adj & x_mask;
-   }
-
-   y_error += y_error_inc;
-   {
-    const uint32 y_mask = -((int32)y_error >= y_error_cmp);
-    y += y_inc & y_mask;
-    y_error += y_error_adj & y_mask;
-   }
-
-   if(gourauden)
-    g.Step();
-  }
- }
-
- uint32 d_error, d_error_inc, d_error_adj;
- int32 d_error_cmp;
-
- uint32 x, x_inc;
- uint32 x_error, x_error_inc, x_error_adj;
- int32 x_error_cmp;
-
- uint32 y, y_inc;
- uint32 y_error, y_error_inc, y_error_adj;
- int32 y_error_cmp;
-
- GourauderTheTerrible g;
-};
-
-struct line_inner_data
-{
- uint32 xy;
- uint32 error;
- bool drawn_ac;
-
- uint32 texel; // must be 32-bit
- VileTex t;
- GourauderTheTerrible g;
- //
- //
- //
- int32 xy_inc[2];
- uint32 aa_xy_inc;
- uint32 term_xy;
-
- int32 error_cmp;
- uint32 error_inc;
- uint32 error_adj;
-
- uint16 color;
-};
-
-struct line_data
-{
- line_vertex p[2];
- //
- uint16 color;
- int32 ec_count;
- uint32 (MDFN_FASTCALL *tffn)(uint32);
- uint16 CLUT[0x10];
- uint32 cb_or;
- uint32 tex_base;
-};
-
-MDFN_HIDE extern line_data LineData;
-
-MDFN_HIDE extern line_inner_data LineInnerData;
-
-struct prim_data
-{
- EdgeStepper e[2];
- VileTex big_t;
- uint32 tex_base;
- int32 iter;
- bool need_line_resume;
-};
-
-MDFN_HIDE extern prim_data PrimData;
-
 // Not sure the exact nature of this overhead, probably the combined effects of FBRAM and VRAM refresh, and something else.
 // 8bpp mode timing is best-caseish, performance is different between horizontal and vertical lines.
 //
@@ -500,7 +522,9 @@ static int32 DrawLine(bool* need_line_resume)
 
     /*ret += (bool)t.IncPending();*/
 
-    lid.texel = LineData.tffn(tx);
+    // Texels only affect timing via end codes
+    if(!VDP1_DRAW_TIMING_ONLY || !ECD)
+     lid.texel = LineData.tffn(tx);
 
     if(!ECD && MDFN_UNLIKELY(LineData.ec_count <= 0))
      return ret;
@@ -540,7 +564,7 @@ static int32 DrawLine(bool* need_line_resume)
   //
   //
   //
-  if(GouraudEn)
+  if(GouraudEn && !VDP1_DRAW_TIMING_ONLY)
    lid.g.Step();
 
   if(MDFN_UNLIKELY(ret >= VDP1_SuspendResumeThreshold) && lid.xy != lid.term_xy)
@@ -566,6 +590,7 @@ static int32 DrawLine(bool* need_line_resume)
  return ret;
 }
 
+VDP1_DRAW_NAMESPACE_END
 //
 //
 }
@@ -27,6 +27,7 @@ namespace MDFN_IEN_SS
 
 namespace VDP1
 {
+VDP1_DRAW_NAMESPACE_BEGIN
 
 static int32 (*LineFuncTab[2][3][0x20][8 + 1])(bool* need_line_resume) =
 {
@@ -133,6 +134,7 @@ int32 CMD_Line(const uint16* cmd_data)
  return ret;
 }
 
+VDP1_DRAW_NAMESPACE_END
 }
 
 }
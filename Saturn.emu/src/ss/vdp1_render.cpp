@@ -0,0 +1,272 @@
+/******************************************************************************/
+/* Mednafen Sega Saturn Emulation Module                                      */
+/******************************************************************************/
+/* vdp1_render.cpp - VDP1 Render Thread
+**  Copyright (C) 2015-2021 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// The emulation thread runs the VDP1 command list with timing-only drawing code, and queues each command fetch,
+// command start, and resume slice, along with VRAM writes and TVMR/FBCR/framebuffer changes, in the same order
+// they happen in emulated time.  The render thread replays them with the full drawing code against its own VRAM
+// copy, so it sees the same command data, textures, and gouraud tables, and draws the same pixels in the same
+// slices the emulation thread timed.  The emulation thread only waits for the render thread before reading or
+// writing the draw framebuffer, swapping framebuffers, resetting, and saving or loading states.
+//
+
+#define MDFN_SS_VDP1_RENDER
+
+#include "ss.h"
+#include <mednafen/MThreading.h>
+#include "vdp1_common.h"
+#include "vdp1_render.h"
+#include <imagine/thread/Thread.hh>
+#include <imagine/util/container/RingBuffer.hh>
+
+namespace MDFN_IEN_SS
+{
+
+namespace VDP1
+{
+
+// Emulation thread copy of the drawing state, see vdp1_draw.inc
+MDFN_HIDE extern uint16 VRAM[0x40000];
+MDFN_HIDE extern int32 SysClipX, SysClipY;
+MDFN_HIDE extern int32 UserClipX0, UserClipY0, UserClipX1, UserClipY1;
+MDFN_HIDE extern int32 LocalX, LocalY;
+MDFN_HIDE extern uint8 TVMR;
+MDFN_HIDE extern uint8 FBCR;
+MDFN_HIDE extern uint32 DTACounter;
+MDFN_HIDE extern line_data LineData;
+MDFN_HIDE extern line_inner_data LineInnerData;
+MDFN_HIDE extern prim_data PrimData;
+
+namespace Render
+{
+
+static INLINE void VRAMUsageDrawRead(uint32 A) { }
+
+#include "vdp1_draw.inc"
+
+static uint16 CommandData[0x10];
+
+static int32 (*const command_table[0xC])(const uint16* cmd_data) =
+{
+ /* 0x0 */         /* 0x1 */           /* 0x2 */            /* 0x3 */
+ CMD_NormalSprite, CMD_ScaledSprite,   CMD_DistortedSprite, CMD_DistortedSprite,
+
+ /* 0x4 */         /* 0x5 (polyline) *//* 0x6 */            /* 0x7 (polyline) */
+ CMD_Polygon,      CMD_Line,	    CMD_Line,            CMD_Line,
+
+ /* 0x8*/          /* 0x9 */           /* 0xA */            /* 0xB */
+ CMD_SetUserClip,  CMD_SetSystemClip,  CMD_SetLocalCoord,   CMD_SetUserClip
+};
+
+static int32 (*const resume_table[0x8])(const uint16* cmd_data) =
+{
+ /* 0x0 */         /* 0x1 */         /* 0x2 */            /* 0x3 */
+ RESUME_Sprite, RESUME_Sprite, RESUME_Sprite, RESUME_Sprite,
+
+ /* 0x4 */    /* 0x5 */     /* 0x6 */ /* 0x7 */
+ RESUME_Polygon, RESUME_Line, RESUME_Line, RESUME_Line,
+};
+
+}
+
+}
+
+using namespace VDP1;
+
+static MThreading::Thread* RThread = NULL;
+IG::ThreadId VDP1RThreadId{};
+
+enum
+{
+ COMMAND_WRITE16 = 0,
+
+ COMMAND_SET_MODE,
+
+ COMMAND_FETCH,
+ COMMAND_START,
+ COMMAND_RESUME,
+ COMMAND_END,
+
+ COMMAND_EXIT
+};
+
+struct WQ_Entry
+{
+ uint16 Command;
+ uint16 Arg16;
+ uint32 Arg32;
+};
+
+static IG::RingBuffer<WQ_Entry, {.fixedSize = 0x4000}> WQ;
+
+static INLINE void WWQ(uint16 command, uint32 arg32 = 0, uint16 arg16 = 0)
+{
+ WQ.push({command, arg16, arg32}, {.blocking = true, .flushSize = 64});
+}
+
+static int RThreadEntry(void* data)
+{
+ VDP1RThreadId = IG::thisThreadId();
+
+ for(;;)
+ {
+  // Entries are only consumed after they're processed, so VDP1REND_Sync() waits for the drawing to finish.
+  auto span = WQ.beginRead(1, {.blocking = true});
+
+  if(!span.size())
+   continue;
+
+  const WQ_Entry wqe = span[0];
+
+  if(wqe.Command == COMMAND_EXIT)
+  {
+   WQ.endRead(span);
+   break;
+  }
+
+  switch(wqe.Command)
+  {
+   case COMMAND_WRITE16:
+	Render::VRAM[wqe.Arg32] = wqe.Arg16;
+	break;
+
+   case COMMAND_SET_MODE:
+	Render::TVMR = wqe.Arg16 & 0xFF;
+	Render::FBCR = wqe.Arg16 >> 8;
+	Render::FBDrawWhichPtr = FB[wqe.Arg32];
+	break;
+
+   case COMMAND_FETCH:
+	memcpy(Render::CommandData, &Render::VRAM[wqe.Arg32], sizeof(Render::CommandData));
+	break;
+
+   case COMMAND_START:
+	Render::DTACounter = wqe.Arg32;
+	Render::command_table[Render::CommandData[0] & 0xF](Render::CommandData);
+	break;
+
+   case COMMAND_RESUME:
+	Render::resume_table[Render::CommandData[0] & 0x7](Render::CommandData);
+	break;
+
+   case COMMAND_END:
+	// Normally already finished, but make sure nothing is left undrawn.
+	while(Render::resume_table[Render::CommandData[0] & 0x7](Render::CommandData));
+	break;
+  }
+
+  WQ.endRead(span);
+  WQ.notifyRead();
+ }
+ WQ.notifyRead();
+ return 0;
+}
+
+void VDP1REND_Init(const uint64 affinity)
+{
+ WQ.clear();
+ RThread = MThreading::Thread_Create(RThreadEntry, NULL, "MDFN VDP1 Render");
+ if(affinity)
+  MThreading::Thread_SetAffinity(RThread, affinity);
+}
+
+void VDP1REND_Kill(void)
+{
+ if(RThread != NULL)
+ {
+  WWQ(COMMAND_EXIT);
+  WQ.notifyWrite();
+  MThreading::Thread_Wait(RThread, NULL);
+  RThread = NULL;
+  VDP1RThreadId = {};
+ }
+}
+
+void VDP1REND_Sync(void)
+{
+ WQ.waitForSize(0);
+}
+
+void VDP1REND_SetState(const uint16* cmd_data, const bool fb_draw_which)
+{
+ memcpy(Render::VRAM, VDP1::VRAM, sizeof(Render::VRAM));
+ memcpy(Render::CommandData, cmd_data, sizeof(Render::CommandData));
+
+ Render::SysClipX = VDP1::SysClipX;
+ Render::SysClipY = VDP1::SysClipY;
+ Render::UserClipX0 = VDP1::UserClipX0;
+ Render::UserClipY0 = VDP1::UserClipY0;
+ Render::UserClipX1 = VDP1::UserClipX1;
+ Render::UserClipY1 = VDP1::UserClipY1;
+ Render::LocalX = VDP1::LocalX;
+ Render::LocalY = VDP1::LocalY;
+
+ Render::TVMR = VDP1::TVMR;
+ Render::FBCR = VDP1::FBCR;
+ Render::FBDrawWhichPtr = FB[fb_draw_which];
+ Render::DTACounter = VDP1::DTACounter;
+
+ Render::LineData = VDP1::LineData;
+ Render::LineInnerData = VDP1::LineInnerData;
+ Render::PrimData = VDP1::PrimData;
+ // Sprite resumes set this, but keep it from pointing at the emulation thread's texture fetch functions.
+ Render::LineData.tffn = Render::TexFetchTab[(cmd_data[0x2] >> 3) & 0x1F];
+}
+
+void VDP1REND_GetState(void)
+{
+ VDP1::LineInnerData.texel = Render::LineInnerData.texel;
+ VDP1::LineInnerData.g = Render::LineInnerData.g;
+}
+
+void VDP1REND_SetMode(const uint8 tvmr, const uint8 fbcr, const bool fb_draw_which)
+{
+ WWQ(COMMAND_SET_MODE, fb_draw_which, tvmr | (fbcr << 8));
+}
+
+void VDP1REND_Write16(uint32 A, uint16 DB)
+{
+ WWQ(COMMAND_WRITE16, A, DB);
+}
+
+void VDP1REND_FetchCommand(uint32 cmd_addr)
+{
+ WWQ(COMMAND_FETCH, cmd_addr);
+}
+
+void VDP1REND_StartCommand(uint32 dta_counter)
+{
+ WWQ(COMMAND_START, dta_counter);
+}
+
+void VDP1REND_ResumeCommand(void)
+{
+ WWQ(COMMAND_RESUME);
+ WQ.notifyWrite();
+}
+
+void VDP1REND_EndCommand(void)
+{
+ WWQ(COMMAND_END);
+ WQ.notifyWrite();
+}
+
+}
@@ -0,0 +1,52 @@
+/******************************************************************************/
+/* Mednafen Sega Saturn Emulation Module                                      */
+/******************************************************************************/
+/* vdp1_render.h:
+**  Copyright (C) 2015-2021 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_SS_VDP1_RENDER_H
+#define __MDFN_SS_VDP1_RENDER_H
+
+namespace MDFN_IEN_SS
+{
+
+void VDP1REND_Init(const uint64 affinity) MDFN_COLD;
+void VDP1REND_Kill(void) MDFN_COLD;
+
+// Wait for the render thread to finish all queued drawing; call before the emulation thread touches FB[FBDrawWhich].
+void VDP1REND_Sync(void);
+
+// After a reset or state load, copy the emulation thread's VRAM and drawing state to the render thread.
+// Only call after VDP1REND_Sync().
+void VDP1REND_SetState(const uint16* cmd_data, const bool fb_draw_which) MDFN_COLD;
+
+// Before a state save, copy the texel and gouraud values the timing-only drawing code doesn't track.
+// Only call after VDP1REND_Sync().
+void VDP1REND_GetState(void) MDFN_COLD;
+
+void VDP1REND_SetMode(const uint8 tvmr, const uint8 fbcr, const bool fb_draw_which);
+void VDP1REND_Write16(uint32 A, uint16 DB) MDFN_HOT;
+
+void VDP1REND_FetchCommand(uint32 cmd_addr);
+void VDP1REND_StartCommand(uint32 dta_counter);
+void VDP1REND_ResumeCommand(void);
+void VDP1REND_EndCommand(void);
+
+}
+
+#endif
@@ -24,6 +24,12 @@
 //  change outside of direct register writes
 // Ignore T4-T7 in hires and 31KHz monitor mode.
 
+//
+// With more than one render thread, this file is also compiled as vdp2_render_replica*.cpp.  Each copy keeps its own
+// registers, VRAM, CRAM, and per-line drawing state, follows the full write and draw line command stream, and only
+// does the expensive per-pixel work for the lines it owns; see the render thread section at the end.
+//
+
 #include "ss.h"
 #include <mednafen/mednafen.h>
 #include <mednafen/Time.h>
@@ -40,16 +46,28 @@ namespace MDFN_IEN_SS
 
 //uint8 vdp2rend_prepad_bss
 
-static EmulateSpecStruct* espec = NULL;
+#ifdef MDFN_SS_VDP2REND_REPLICA
+ #define VDP2REND_SHARED MDFN_HIDE extern
+#else
+ #define MDFN_SS_VDP2REND_REPLICA 0
+ #define VDP2REND_REPLICA_NAME VDP2REND_Replica0
+ #define VDP2REND_SHARED MDFN_HIDE
+#endif
+
+// Shared by all render threads
+VDP2REND_SHARED EmulateSpecStruct* espec;
+VDP2REND_SHARED bool CorrectAspect;
+VDP2REND_SHARED bool ShowHOverscan;
+VDP2REND_SHARED bool DoHBlend;
+VDP2REND_SHARED bool Clock28M;
+VDP2REND_SHARED VDP2Rend_LIB LIB[256];
+#if MDFN_SS_VDP2REND_REPLICA == 0
 static bool PAL;
-static bool CorrectAspect;
-static bool ShowHOverscan;
-static bool DoHBlend;
 static int LineVisFirst, LineVisLast;
 static uint32 NextOutLine;
-static bool Clock28M;
 static unsigned VisibleLines;
-static VDP2Rend_LIB LIB[256];
+#endif
+// Per render thread
 static uint16 VRAM[262144];
 static uint16 CRAM[2048];
 
@@ -2696,7 +2714,24 @@ static void ReorderRGB(uint32* target, const unsigned w, const unsigned Rshift,
  }
 }
 
-static NO_INLINE void DrawLine(const uint16 out_line, const uint16 vdp2_line, const bool field)
+//
+// FIXME: Timing
+//
+static INLINE void AdvanceLineCounters(void)
+{
+ for(unsigned n = 0; n < 2; n++)
+ {
+  YCoordAccum[n] += YCoordInc[n] << (InterlaceMode == IM_DOUBLE);
+  NBG23_YCounter[n & 1] += 1 << (InterlaceMode == IM_DOUBLE);
+ }
+
+ if(MosaicVCount >= ((MZCTL >> 12) & 0xF))
+  MosaicVCount = 0;
+ else
+  MosaicVCount++;
+}
+
+static NO_INLINE void DrawLine(const uint16 out_line, const uint16 vdp2_line, const bool field, const bool render)
 {
  if(espec->skip)
   return;
@@ -2708,23 +2743,6 @@ static NO_INLINE void DrawLine(const uint16 out_line, const uint16 vdp2_line, co
  uint32 back_rgb24;
  uint32 border_ncf;
 
- target = espec->surface->pixels + out_line * espec->surface->pitchinpix;
- espec->LineWidths[out_line] = tvdw;
-
- if(!ShowHOverscan)
- {
-  const int32 ntdw = tvdw * 1024 / 1056;
-  const int32 tadj = std::max<int32>(0, espec->DisplayRect.x - ((tvdw - ntdw) >> 1));
-
-  //if(out_line == 100)
-  // printf("tvdw=%d, ntdw=%d, tadj=%d --- tvdw+tadj=%d\n", tvdw, ntdw, tadj, tvdw + tadj);
-
-  assert((tvdw + tadj) <= 704);
-
-  target += tadj;
-  espec->LineWidths[out_line] = ntdw;
- }
-
  //
  // FIXME: Timing
  //
@@ -2775,19 +2793,7 @@ static NO_INLINE void DrawLine(const uint16 out_line, const uint16 vdp2_line, co
    CurLCTabAddr += 1 << (InterlaceMode == IM_DOUBLE);
  }
 
- back_rgb24 = rgb15_to_rgb24(CurBackColor);
-
- if(BorderMode)
-  border_ncf = espec->surface->MakeColor((uint8)(back_rgb24 >> 0), (uint8)(back_rgb24 >> 8), (uint8)(back_rgb24 >> 16));
- else
-  border_ncf = espec->surface->MakeColor(0, 0, 0);
-
- if(vdp2_line == 0xFFFF)
- {
-  for(int32 i = 0; i < tvdw; i++)
-   target[i] = border_ncf;
- }
- else
+ if(vdp2_line != 0xFFFF)
  {
   //
   // Line scroll
@@ -2908,6 +2914,70 @@ static NO_INLINE void DrawLine(const uint16 out_line, const uint16 vdp2_line, co
    std::sort(WinPieces.begin(), WinPieces.end());
   }
 
+  //
+  // Mosaic and vertical cell scroll
+  //
+  for(unsigned n = 0; n < 4; n++)
+  {
+   if(!MosaicVCount || !(MZCTL & (1U << n)))
+   {
+    if(n < 2)
+    {
+     MosEff_YCoordAccum[n] = YCoordAccum[n];	// Don't + (InterlaceMode == IM_DOUBLE && field)
+    }
+    else
+    {
+     MosEff_NBG23_YCounter[n & 1] = NBG23_YCounter[n & 1] + (InterlaceMode == IM_DOUBLE && field);
+    }
+   }
+  }
+
+  if(SCRCTL & 0x0101)
+   FetchVCScroll(w);	// Call after handling line scroll, and before DrawNBG() stuff
+ }
+
+ //
+ // Another render thread draws this line, so only keep the per-line state up to date.
+ //
+ if(!render)
+ {
+  if(vdp2_line != 0xFFFF)
+   AdvanceLineCounters();
+
+  return;
+ }
+
+ target = espec->surface->pixels + out_line * espec->surface->pitchinpix;
+ espec->LineWidths[out_line] = tvdw;
+
+ if(!ShowHOverscan)
+ {
+  const int32 ntdw = tvdw * 1024 / 1056;
+  const int32 tadj = std::max<int32>(0, espec->DisplayRect.x - ((tvdw - ntdw) >> 1));
+
+  //if(out_line == 100)
+  // printf("tvdw=%d, ntdw=%d, tadj=%d --- tvdw+tadj=%d\n", tvdw, ntdw, tadj, tvdw + tadj);
+
+  assert((tvdw + tadj) <= 704);
+
+  target += tadj;
+  espec->LineWidths[out_line] = ntdw;
+ }
+
+ back_rgb24 = rgb15_to_rgb24(CurBackColor);
+
+ if(BorderMode)
+  border_ncf = espec->surface->MakeColor((uint8)(back_rgb24 >> 0), (uint8)(back_rgb24 >> 8), (uint8)(back_rgb24 >> 16));
+ else
+  border_ncf = espec->surface->MakeColor(0, 0, 0);
+
+ if(vdp2_line == 0xFFFF)
+ {
+  for(int32 i = 0; i < tvdw; i++)
+   target[i] = border_ncf;
+ }
+ else
+ {
   //
   //
   //
@@ -3016,26 +3086,6 @@ static NO_INLINE void DrawLine(const uint16 out_line, const uint16 vdp2_line, co
    MDFN_FastArraySet(LB.lc, CurLCColor & 0x7F, w);
    MDFN_FastArraySet(LB.rbg0, 0, w);
   }
-  //
-  //
-  //
-  for(unsigned n = 0; n < 4; n++)
-  {
-   if(!MosaicVCount || !(MZCTL & (1U << n)))
-   {
-    if(n < 2)
-    {
-     MosEff_YCoordAccum[n] = YCoordAccum[n];	// Don't + (InterlaceMode == IM_DOUBLE && field)
-    }
-    else
-    {
-     MosEff_NBG23_YCounter[n & 1] = NBG23_YCounter[n & 1] + (InterlaceMode == IM_DOUBLE && field);
-    }
-   }
-  }
-
-  if(SCRCTL & 0x0101)
-   FetchVCScroll(w);	// Call after handling line scroll, and before DrawNBG() stuff
 
   if((BGON & 0x30) != 0x30)
   {
@@ -3157,18 +3207,7 @@ static NO_INLINE void DrawLine(const uint16 out_line, const uint16 vdp2_line, co
   //
   //
   //
-  // FIXME: Timing
-  //
-  for(unsigned n = 0; n < 2; n++)
-  {
-   YCoordAccum[n] += YCoordInc[n] << (InterlaceMode == IM_DOUBLE);
-   NBG23_YCounter[n & 1] += 1 << (InterlaceMode == IM_DOUBLE);
-  }
-
-  if(MosaicVCount >= ((MZCTL >> 12) & 0xF))
-   MosaicVCount = 0;
-  else
-   MosaicVCount++;
+  AdvanceLineCounters();
  }
 
  //
@@ -3186,9 +3225,6 @@ static NO_INLINE void DrawLine(const uint16 out_line, const uint16 vdp2_line, co
 //
 //
 //
-static MThreading::Thread* RThread = NULL;
-IG::ThreadId RThreadId{};
-
 enum
 {
  COMMAND_WRITE8 = 0,
@@ -3211,21 +3247,69 @@ struct WQ_Entry
  uint32 Arg32;
 };
 
-static IG::RingBuffer<WQ_Entry, {.fixedSize = 0x4000}> WQ;
+// Per-line drawing state carried from one line to the next, identical in every render thread.
+struct VDP2Rend_LineState
+{
+ uint8 MosaicVCount;
+ uint32 VCLast[2];
+ uint32 YCoordAccum[2];
+ uint32 MosEff_YCoordAccum[2];
+ uint32 CurXScrollIF[2];
+ uint32 CurYScrollIF[2];
+ uint16 CurXCoordInc[2];
+ uint32 CurLSA[2];
+ uint16 NBG23_YCounter[2];
+ uint16 MosEff_NBG23_YCounter[2];
+ uint32 CurBackTabAddr;
+ uint16 CurBackColor;
+ uint32 CurLCTabAddr;
+ uint16 CurLCColor;
+
+ struct
+ {
+  uint16 XStart, XEnd;
+  uint16 CurXStart, CurXEnd;
+  uint32 CurLineWinAddr;
+ } Window[2];
+};
 
-static INLINE void WWQ(uint16 command, uint32 arg32 = 0, uint16 arg16 = 0)
+struct VDP2Rend_Replica
 {
- WQ.push({command, arg16, arg32}, {.blocking = true, .flushSize = 64});
-}
+ int (*ThreadEntry)(void* data);
+ void (*LoadRegs)(const uint16* rr);
+ void (*GetLineState)(VDP2Rend_LineState* ls);
+ void (*SetState)(const uint16* cr, const uint16* vr, const VDP2Rend_LineState& ls);
+};
+
+// Every render thread's queue gets every command; the COMMAND_DRAW_LINE Arg16 bit 1 is only set for the line's owner.
+VDP2REND_SHARED IG::RingBuffer<WQ_Entry, {.fixedSize = 0x4000}> WQ[VDP2REND_MaxThreads];
+#if MDFN_SS_VDP2REND_REPLICA == 0
+IG::ThreadId RThreadId[VDP2REND_MaxThreads]{};
+#else
+extern IG::ThreadId RThreadId[VDP2REND_MaxThreads];
+#endif
 
 static int RThreadEntry(void* data)
 {
- RThreadId = IG::thisThreadId();
+ auto& Queue = WQ[MDFN_SS_VDP2REND_REPLICA];
+
+ RThreadId[MDFN_SS_VDP2REND_REPLICA] = IG::thisThreadId();
 
- auto nextCommand = []() { return WQ.pop({.blocking = true}); };
- for(WQ_Entry entry = nextCommand(); entry.Command != COMMAND_EXIT; entry = nextCommand())
+ for(;;)
  {
-  WQ_Entry* wqe = &entry;
+  // Entries are only consumed after they're processed, so waiting for an empty queue waits for the drawing to finish.
+  auto span = Queue.beginRead(1, {.blocking = true});
+
+  if(!span.size())
+   continue;
+
+  const WQ_Entry* wqe = &span[0];
+
+  if(wqe->Command == COMMAND_EXIT)
+  {
+   Queue.endRead(span);
+   break;
+  }
 
   switch(wqe->Command)
   {
@@ -3239,7 +3323,7 @@ static int RThreadEntry(void* data)
 
    case COMMAND_DRAW_LINE:
 	//for(unsigned i = 0; i < 2; i++)
-	DrawLine((uint16)wqe->Arg32, wqe->Arg32 >> 16, wqe->Arg16);
+	DrawLine((uint16)wqe->Arg32, wqe->Arg32 >> 16, wqe->Arg16 & 0x1, wqe->Arg16 & 0x2);
 	//
 	break;
 
@@ -3254,31 +3338,142 @@ static int RThreadEntry(void* data)
   //
   //
   //
-
-  WQ.notifyRead();
+  Queue.endRead(span);
+  Queue.notifyRead();
  }
- WQ.notifyRead();
+ Queue.notifyRead();
  return 0;
 }
 
+static void LoadRegs(const uint16* rr)
+{
+ for(unsigned i = 0; i < 0x100; i++)
+ {
+  RegsWrite(i << 1, rr[i]);
+ }
+}
+
+static void GetLineState(VDP2Rend_LineState* ls)
+{
+ ls->MosaicVCount = MosaicVCount;
+
+ for(unsigned n = 0; n < 2; n++)
+ {
+  ls->VCLast[n] = VCLast[n];
+  ls->YCoordAccum[n] = YCoordAccum[n];
+  ls->MosEff_YCoordAccum[n] = MosEff_YCoordAccum[n];
+  ls->CurXScrollIF[n] = CurXScrollIF[n];
+  ls->CurYScrollIF[n] = CurYScrollIF[n];
+  ls->CurXCoordInc[n] = CurXCoordInc[n];
+  ls->CurLSA[n] = CurLSA[n];
+  ls->NBG23_YCounter[n] = NBG23_YCounter[n];
+  ls->MosEff_NBG23_YCounter[n] = MosEff_NBG23_YCounter[n];
+ }
+
+ ls->CurBackTabAddr = CurBackTabAddr;
+ ls->CurBackColor = CurBackColor;
+ ls->CurLCTabAddr = CurLCTabAddr;
+ ls->CurLCColor = CurLCColor;
+
+ for(unsigned d = 0; d < 2; d++)
+ {
+  ls->Window[d].XStart = Window[d].XStart;
+  ls->Window[d].XEnd = Window[d].XEnd;
+  ls->Window[d].CurXStart = Window[d].CurXStart;
+  ls->Window[d].CurXEnd = Window[d].CurXEnd;
+  ls->Window[d].CurLineWinAddr = Window[d].CurLineWinAddr;
+ }
+}
+
+// Call after LoadRegs().
+static void SetState(const uint16* cr, const uint16* vr, const VDP2Rend_LineState& ls)
+{
+ MosaicVCount = ls.MosaicVCount;
+
+ for(unsigned n = 0; n < 2; n++)
+ {
+  VCLast[n] = ls.VCLast[n];
+  YCoordAccum[n] = ls.YCoordAccum[n];
+  MosEff_YCoordAccum[n] = ls.MosEff_YCoordAccum[n];
+  CurXScrollIF[n] = ls.CurXScrollIF[n];
+  CurYScrollIF[n] = ls.CurYScrollIF[n];
+  CurXCoordInc[n] = ls.CurXCoordInc[n];
+  CurLSA[n] = ls.CurLSA[n];
+  NBG23_YCounter[n] = ls.NBG23_YCounter[n];
+  MosEff_NBG23_YCounter[n] = ls.MosEff_NBG23_YCounter[n];
+ }
+
+ CurBackTabAddr = ls.CurBackTabAddr;
+ CurBackColor = ls.CurBackColor;
+ CurLCTabAddr = ls.CurLCTabAddr;
+ CurLCColor = ls.CurLCColor;
+
+ for(unsigned d = 0; d < 2; d++)
+ {
+  Window[d].XStart = ls.Window[d].XStart;
+  Window[d].XEnd = ls.Window[d].XEnd;
+  Window[d].CurXStart = ls.Window[d].CurXStart;
+  Window[d].CurXEnd = ls.Window[d].CurXEnd;
+  Window[d].CurLineWinAddr = ls.Window[d].CurLineWinAddr;
+ }
+
+ memcpy(VRAM, vr, sizeof(VRAM));
+ memcpy(CRAM, cr, sizeof(CRAM));
+
+ RecalcColorCache();
+}
+
+MDFN_HIDE VDP2Rend_Replica VDP2REND_REPLICA_NAME = { RThreadEntry, LoadRegs, GetLineState, SetState };
+
+#if MDFN_SS_VDP2REND_REPLICA == 0
+MDFN_HIDE extern VDP2Rend_Replica VDP2REND_Replica1, VDP2REND_Replica2, VDP2REND_Replica3;
+
+static VDP2Rend_Replica* const Replicas[VDP2REND_MaxThreads] = { &VDP2REND_Replica0, &VDP2REND_Replica1, &VDP2REND_Replica2, &VDP2REND_Replica3 };
+static MThreading::Thread* RThread[VDP2REND_MaxThreads] = { NULL };
+static unsigned NumThreads;
+
+static INLINE void WWQ(uint16 command, uint32 arg32 = 0, uint16 arg16 = 0)
+{
+ for(unsigned i = 0; i < NumThreads; i++)
+  WQ[i].push({command, arg16, arg32}, {.blocking = true, .flushSize = 64});
+}
+
+static INLINE void NotifyWQ(void)
+{
+ for(unsigned i = 0; i < NumThreads; i++)
+  WQ[i].notifyWrite();
+}
+
+static void SyncWQ(void)
+{
+ for(unsigned i = 0; i < NumThreads; i++)
+  WQ[i].waitForSize(0);
+}
+
 
 //
 //
 //
 //
 //
-void VDP2REND_Init(const bool IsPAL, const uint64 affinity)
+void VDP2REND_Init(const bool IsPAL, const uint64 affinity, const unsigned threads)
 {
  PAL = IsPAL;
  VisibleLines = PAL ? 288 : 240;
  //
- UserLayerEnableMask = ~0U;
  Clock28M = false;
  //
- WQ.clear();
- RThread = MThreading::Thread_Create(RThreadEntry, NULL, "MDFN VDP2 Render");
- if(affinity)
-  MThreading::Thread_SetAffinity(RThread, affinity);
+ NumThreads = std::min<unsigned>(std::max<unsigned>(1, threads), VDP2REND_MaxThreads);
+
+ for(unsigned i = 0; i < NumThreads; i++)
+ {
+  WQ[i].clear();
+  RThread[i] = MThreading::Thread_Create(Replicas[i]->ThreadEntry, NULL, "MDFN VDP2 Render");
+  if(affinity)
+   MThreading::Thread_SetAffinity(RThread[i], affinity);
+ }
+
+ WWQ(COMMAND_SET_LEM, ~0U);
 }
 
 // Needed for ss.correct_aspect == 0
@@ -3340,13 +3535,17 @@ void VDP2REND_SetGetVideoParams(MDFNGI* gi, const bool caspect, const int sls, c
 
 void VDP2REND_Kill(void)
 {
- if(RThread != NULL)
+ if(RThread[0] != NULL)
  {
   WWQ(COMMAND_EXIT);
-  WQ.notifyWrite();
-  MThreading::Thread_Wait(RThread, NULL);
-  RThread = NULL;
-  RThreadId = {};
+  NotifyWQ();
+
+  for(unsigned i = 0; i < NumThreads; i++)
+  {
+   MThreading::Thread_Wait(RThread[i], NULL);
+   RThread[i] = NULL;
+   RThreadId[i] = {};
+  }
  }
 }
 
@@ -3374,7 +3573,7 @@ void VDP2REND_StartFrame(EmulateSpecStruct* espec_arg, const bool clock28m, cons
 
 void VDP2REND_EndFrame(void)
 {
- WQ.waitForSize(0);
+ SyncWQ();
 
  if(NextOutLine < VisibleLines)
  {
@@ -3416,10 +3615,14 @@ void VDP2REND_DrawLine(const int vdp2_line, const uint32 crt_line, const bool fi
   if(espec->InterlaceOn)
    out_line = (out_line << 1) | espec->InterlaceField;
 
-  WWQ(COMMAND_DRAW_LINE, ((uint16)vdp2_line << 16) | out_line, field);
+  // Consecutive lines go to different render threads.
+  const unsigned owner = crt_line % NumThreads;
+
+  for(unsigned i = 0; i < NumThreads; i++)
+   WQ[i].push({COMMAND_DRAW_LINE, (uint16)(field | ((i == owner) << 1)), ((uint32)(uint16)vdp2_line << 16) | out_line}, {.blocking = true, .flushSize = 64});
   //
   //
-  WQ.notifyWrite();
+  NotifyWQ();
 
   NextOutLine = crt_line + 1;
  }
@@ -3453,7 +3656,9 @@ void VDP2REND_Write16_DB(uint32 A, uint16 DB)
 
 void VDP2REND_StateAction(StateMem* sm, const unsigned load, const bool data_only, uint16 (&rr)[0x100], uint16 (&cr)[2048], uint16 (&vr)[262144])
 {
- WQ.waitForSize(0);
+ VDP2Rend_LineState ls;
+
+ SyncWQ();
  //
  //
  //
@@ -3461,33 +3666,33 @@ void VDP2REND_StateAction(StateMem* sm, const unsigned load, const bool data_onl
  {
   SFVAR(Clock28M),	// DUBIOUS
 
-  SFVAR(MosaicVCount),
+  SFVARN(ls.MosaicVCount, "MosaicVCount"),
 
-  SFVAR(VCLast),
+  SFVARN(ls.VCLast, "VCLast"),
 
-  SFVAR(YCoordAccum),
-  SFVAR(MosEff_YCoordAccum),
+  SFVARN(ls.YCoordAccum, "YCoordAccum"),
+  SFVARN(ls.MosEff_YCoordAccum, "MosEff_YCoordAccum"),
 
-  SFVAR(CurXScrollIF),
-  SFVAR(CurYScrollIF),
-  SFVAR(CurXCoordInc),
-  SFVAR(CurLSA),
+  SFVARN(ls.CurXScrollIF, "CurXScrollIF"),
+  SFVARN(ls.CurYScrollIF, "CurYScrollIF"),
+  SFVARN(ls.CurXCoordInc, "CurXCoordInc"),
+  SFVARN(ls.CurLSA, "CurLSA"),
 
-  SFVAR(NBG23_YCounter),
-  SFVAR(MosEff_NBG23_YCounter),
+  SFVARN(ls.NBG23_YCounter, "NBG23_YCounter"),
+  SFVARN(ls.MosEff_NBG23_YCounter, "MosEff_NBG23_YCounter"),
 
-  SFVAR(CurBackTabAddr),
-  SFVAR(CurBackColor),
+  SFVARN(ls.CurBackTabAddr, "CurBackTabAddr"),
+  SFVARN(ls.CurBackColor, "CurBackColor"),
 
-  SFVAR(CurLCTabAddr),
-  SFVAR(CurLCColor),
+  SFVARN(ls.CurLCTabAddr, "CurLCTabAddr"),
+  SFVARN(ls.CurLCColor, "CurLCColor"),
 
   // XStart and XEnd can be modified by line window processing.
-  SFVAR(Window->XStart, 2, sizeof(*Window), Window),
-  SFVAR(Window->XEnd, 2, sizeof(*Window), Window),
-  SFVAR(Window->CurXStart, 2, sizeof(*Window), Window),
-  SFVAR(Window->CurXEnd, 2, sizeof(*Window), Window),
-  SFVAR(Window->CurLineWinAddr, 2, sizeof(*Window), Window),
+  SFVARN(ls.Window->XStart, 2, sizeof(*ls.Window), ls.Window, "Window->XStart"),
+  SFVARN(ls.Window->XEnd, 2, sizeof(*ls.Window), ls.Window, "Window->XEnd"),
+  SFVARN(ls.Window->CurXStart, 2, sizeof(*ls.Window), ls.Window, "Window->CurXStart"),
+  SFVARN(ls.Window->CurXEnd, 2, sizeof(*ls.Window), ls.Window, "Window->CurXEnd"),
+  SFVARN(ls.Window->CurLineWinAddr, 2, sizeof(*ls.Window), ls.Window, "Window->CurLineWinAddr"),
 
   SFEND
  };
@@ -3495,21 +3700,20 @@ void VDP2REND_StateAction(StateMem* sm, const unsigned load, const bool data_onl
  // Calls to RegsWrite() should go before MDFNSS_StateAction(), and before memcpy() to VRAM and CRAM.
  if(load)
  {
-  for(unsigned i = 0; i < 0x100; i++)
-  {
-   RegsWrite(i << 1, rr[i]);
-  }
+  for(unsigned i = 0; i < NumThreads; i++)
+   Replicas[i]->LoadRegs(rr);
  }
 
+ GetLineState(&ls);
+
  MDFNSS_StateAction(sm, load, data_only, StateRegs, "VDP2REND");
 
  if(load)
  {
-  memcpy(VRAM, vr, sizeof(VRAM));
-  memcpy(CRAM, cr, sizeof(CRAM));
-
-  RecalcColorCache();
+  for(unsigned i = 0; i < NumThreads; i++)
+   Replicas[i]->SetState(cr, vr, ls);
  }
 }
+#endif
 
 }
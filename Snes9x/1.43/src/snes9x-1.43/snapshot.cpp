@@ -1067,6 +1067,77 @@ static void FreezeBlock (STREAM stream, const char *name, uint8 *block, int size
     
 }
 
+static uint32 FreezeBlockSize (const char *name, int size)
+{
+    char buffer [512];
+    sprintf (buffer, "%s:%06d:", name, size);
+    return (strlen (buffer) + size);
+}
+
+static uint32 FreezeStructSize (const char *name, FreezeData *fields, int num_fields)
+{
+    int len = 0;
+    for (int i = 0; i < num_fields; i++)
+    {
+		if (fields [i].offset + FreezeSize (fields [i].size, 
+			fields [i].type) > len)
+			len = fields [i].offset + FreezeSize (fields [i].size, 
+			fields [i].type);
+    }
+    return (FreezeBlockSize (name, len));
+}
+
+// Returns the number of bytes S9xFreezeToStream() writes without serializing the state
+uint32 S9xFreezeSize ()
+{
+    char buffer [1024];
+    uint32 size = 0;
+
+    sprintf (buffer, "%s:%04d\n", SNAPSHOT_MAGIC, SNAPSHOT_VERSION);
+    size += strlen (buffer);
+    sprintf (buffer, "NAM:%06d:%s", (int)Memory.ROMFilename.size() + 1,
+		Memory.ROMFilename.c_str());
+    size += strlen (buffer) + 1;
+    size += FreezeStructSize ("CPU", SnapCPU, COUNT (SnapCPU));
+    size += FreezeStructSize ("REG", SnapRegisters, COUNT (SnapRegisters));
+    size += FreezeStructSize ("PPU", SnapPPU, COUNT (SnapPPU));
+    size += FreezeStructSize ("DMA", SnapDMA, COUNT (SnapDMA));
+    size += FreezeBlockSize ("VRA", 0x10000);
+    size += FreezeBlockSize ("RAM", 0x20000);
+    size += FreezeBlockSize ("SRA", 0x20000);
+    size += FreezeBlockSize ("FIL", 0x8000);
+    if (Settings.APUEnabled)
+    {
+		size += FreezeStructSize ("APU", SnapAPU, COUNT (SnapAPU));
+		size += FreezeStructSize ("ARE", SnapAPURegisters, COUNT (SnapAPURegisters));
+		size += FreezeBlockSize ("ARA", 0x10000);
+		size += FreezeStructSize ("SOU", SnapSoundData, COUNT (SnapSoundData));
+    }
+    if (Settings.SA1)
+    {
+		size += FreezeStructSize ("SA1", SnapSA1, COUNT (SnapSA1));
+		size += FreezeStructSize ("SAR", SnapSA1Registers, COUNT (SnapSA1Registers));
+    }
+    if (Settings.SPC7110)
+		size += FreezeStructSize ("SP7", SnapSPC7110, COUNT (SnapSPC7110));
+    if (Settings.SPC7110RTC)
+		size += FreezeStructSize ("RTC", SnapS7RTC, COUNT (SnapS7RTC));
+    if (S9xMovieActive ())
+    {
+		uint8* movie_freeze_buf;
+		uint32 movie_freeze_size;
+
+		S9xMovieFreeze(&movie_freeze_buf, &movie_freeze_size);
+		if(movie_freeze_buf)
+		{
+			size += FreezeStructSize ("MOV", SnapMovie, COUNT (SnapMovie));
+			size += FreezeBlockSize ("MID", movie_freeze_size);
+			delete [] movie_freeze_buf;
+		}
+    }
+    return (size);
+}
+
 static int UnfreezeStruct (STREAM stream, const char *name, void *base, FreezeData *fields,
 					int num_fields)
 {
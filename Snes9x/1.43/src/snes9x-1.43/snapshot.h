@@ -109,6 +109,7 @@ bool8 Snapshot (const char *filename);
 bool8 S9xLoadSnapshot (const char *filename);
 bool8 S9xSPCDump (const char *filename);
 void S9xFreezeToStream (STREAM);
+uint32 S9xFreezeSize (void);
 int S9xUnfreezeFromStream (STREAM);
 END_EXTERN_C
 
@@ -130,14 +130,122 @@ size_t Snes9xSystem::stateSize()
 	return saveStateSize;
 }
 
-#ifdef SNES9X_VERSION_1_4
-static uint32 S9xFreezeSize()
+#ifndef SNES9X_VERSION_1_4
+// Feeds S9xFreezeToStream() output directly to the state codec
+class StateCompressStream : public Stream
 {
-	DynArray<uint8_t> arr{0x100000};
-	auto stream = MapIO{arr}.toFileStream("wb");
-	S9xFreezeToStream(stream);
-	return ftell(stream);
-}
+public:
+	StateCompressStream(StateCompressor &comp): comp{comp} {}
+	int get_char() final { return EOF; }
+	char *gets(char *, size_t) final { return nullptr; }
+	size_t read(void *, size_t) final { return 0; }
+	size_t write(void *buf, size_t len) final { return comp.write({(const uint8_t*)buf, len}) ? len : 0; }
+	size_t pos() final { return comp.uncompressedSize(); }
+	size_t size() final { return comp.uncompressedSize(); }
+	int revert(uint8, int32) final { return -1; }
+	void closeStream() final {}
+
+private:
+	StateCompressor &comp;
+};
+
+// Feeds S9xUnfreezeFromStream() directly from the state codec. The unfreeze code only seeks
+// back a few bytes after peeking at block names, which the retained lookback bytes cover,
+// other backward seeks restart decompression and skip forward like unzStream.
+class StateUncompressStream : public Stream
+{
+public:
+	StateUncompressStream(StateUncompressor &uncomp): uncomp{uncomp} {}
+
+	int get_char() final
+	{
+		uint8_t c;
+		return read(&c, 1) ? c : EOF;
+	}
+
+	char *gets(char *buf, size_t len) final
+	{
+		if(!len)
+			return nullptr;
+		size_t i = 0;
+		for(; i < len - 1; i++)
+		{
+			auto c = get_char();
+			if(c == EOF)
+				break;
+			buf[i] = c;
+			if(c == '\n')
+			{
+				i++;
+				break;
+			}
+		}
+		if(!i)
+			return nullptr;
+		buf[i] = 0;
+		return buf;
+	}
+
+	size_t read(void *buf, size_t len) final
+	{
+		auto dest = (uint8_t*)buf;
+		size_t bytesRead = 0;
+		while(bytesRead < len)
+		{
+			if(bufPos == bufLen && !fillBuffer())
+				break;
+			auto copySize = std::min(len - bytesRead, bufLen - bufPos);
+			memcpy(dest + bytesRead, &buffer[bufPos], copySize);
+			bufPos += copySize;
+			bytesRead += copySize;
+		}
+		return bytesRead;
+	}
+
+	size_t write(void *, size_t) final { return 0; }
+	size_t pos() final { return bufStart + bufPos; }
+	size_t size() final { return uncomp.size(); }
+
+	int revert(uint8 origin, int32 offset) final
+	{
+		auto targetPos = pos_from_origin_offset(origin, offset);
+		if(targetPos < bufStart)
+		{
+			if(!uncomp.restart())
+				return -1;
+			bufStart = bufLen = bufPos = 0;
+		}
+		while(targetPos > bufStart + bufLen)
+		{
+			bufPos = bufLen;
+			if(!fillBuffer())
+				return -1;
+		}
+		bufPos = targetPos - bufStart;
+		return 0;
+	}
+
+	void closeStream() final {}
+
+private:
+	static constexpr size_t lookbackSize = 64;
+	StateUncompressor &uncomp;
+	size_t bufStart{}; // uncompressed offset of buffer[0]
+	size_t bufLen{};
+	size_t bufPos{};
+	std::array<uint8_t, 4096> buffer;
+
+	bool fillBuffer()
+	{
+		auto keep = std::min(bufLen, lookbackSize);
+		memmove(buffer.data(), &buffer[bufLen - keep], keep);
+		bufStart += bufLen - keep;
+		bufPos -= bufLen - keep;
+		auto bytesRead = uncomp.read(std::span{buffer}.subspan(keep));
+		bufLen = keep + bytesRead;
+		return bytesRead;
+	}
+};
 #endif
 
 static int unfreezeStateFrom(std::span<uint8_t> buff)
@@ -151,12 +259,24 @@ static int unfreezeStateFrom(std::span<uint8_t> buff)
 
 void Snes9xSystem::readState(EmuApp &, std::span<uint8_t> buff)
 {
+	#ifndef SNES9X_VERSION_1_4
+	if(auto codec = detectStateCodec(buff))
+	{
+		StateUncompressor uncomp{buff, *codec};
+		StateUncompressStream stream{uncomp};
+		if(!S9xUnfreezeFromStream(&stream))
+			throw std::runtime_error("Invalid state data");
+		IPPU.RenderThisFrame = TRUE;
+		return;
+	}
+	#else
 	DynArray<uint8_t> uncompArr;
-	if(hasGzipHeader(buff))
+	if(detectStateCodec(buff))
 	{
-		uncompArr = uncompressGzipState(buff);
+		uncompArr = uncompressState(buff);
 		buff = uncompArr;
 	}
+	#endif
 	if(!unfreezeStateFrom(buff))
 		throw std::runtime_error("Invalid state data");
 	IPPU.RenderThisFrame = TRUE;
@@ -180,12 +300,30 @@ size_t Snes9xSystem::writeState(std::span<uint8_t> buff, SaveStateFlags flags)
 	}
 	else
 	{
-		auto uncompArr = DynArray<uint8_t>(saveStateSize);
+		#ifndef SNES9X_VERSION_1_4
+		auto size = writeCompressedState(buff, {}, {});
+		if(!size)
+			throw std::runtime_error("Error compressing state");
+		return size;
+		#else
+		auto uncompArr = stateScratchBuffer(saveStateSize);
 		freezeStateTo(uncompArr);
 		return compressGzip(buff, uncompArr, Z_DEFAULT_COMPRESSION);
+		#endif
 	}
 }
 
+#ifndef SNES9X_VERSION_1_4
+size_t Snes9xSystem::writeCompressedState(std::span<uint8_t> outBuff, StateCodecConfig codec,
+	StateCompressor::OutputDelegate onOutput)
+{
+	StateCompressor comp{outBuff, saveStateSize, codec, onOutput};
+	StateCompressStream stream{comp};
+	S9xFreezeToStream(&stream);
+	return comp.finish();
+}
+#endif
+
 void Snes9xSystem::loadBackupMemory(EmuApp &app)
 {
 	if(!Memory.SRAMSize)
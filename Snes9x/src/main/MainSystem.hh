@@ -150,6 +150,9 @@ public:
 	bool onPointerInputUpdate(const Input::MotionEvent &, Input::DragTrackerState,
 		Input::DragTrackerState prevDragState, IG::WindowRect gameRect);
 	bool onPointerInputEnd(const Input::MotionEvent &, Input::DragTrackerState, IG::WindowRect gameRect);
+	#ifndef SNES9X_VERSION_1_4
+	size_t writeCompressedState(std::span<uint8_t> outBuff, StateCodecConfig, StateCompressor::OutputDelegate);
+	#endif
 
 protected:
 	void applyInputPortOption(int portVal, VController &vCtrl);
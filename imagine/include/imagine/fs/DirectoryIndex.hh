@@ -0,0 +1,83 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/fs/FSDefs.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/util/string/CStringView.hh>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace IG::FS
+{
+
+// Cache of directory listings keyed by directory path or URI, saved to a compact binary file so large
+// folders can be shown before storage is read again. Listings are unfiltered and sorted with directories
+// first, then by caseless name. A listing is current while the directory's last write time is unchanged,
+// which covers entries being added, removed, or renamed. Directories without a usable write time are
+// always re-read. All functions are thread-safe.
+
+class DirectoryIndex
+{
+public:
+	struct Entry
+	{
+		std::string name;
+		std::string path; // only set if it isn't uriString(directory, name)
+		file_type type{};
+
+		bool isDir() const { return type == file_type::directory; }
+	};
+
+	struct Listing
+	{
+		WallClockTimePoint lastWriteTime{};
+		std::vector<Entry> entries;
+
+		void addEntry(std::string_view dirPath, const directory_entry &);
+		void sort();
+		bool isCurrent(WallClockTimePoint t) const { return hasTime(lastWriteTime) && t == lastWriteTime; }
+	};
+
+	using ListingPtr = std::shared_ptr<const Listing>;
+
+	static constexpr size_t maxListings = 512;
+
+	ListingPtr find(std::string_view dirPath) const;
+	void update(std::string_view dirPath, Listing);
+	static PathString entryPath(std::string_view dirPath, const Entry &);
+	void load(CStringView filePath);
+	bool save(CStringView filePath);
+	bool isModified() const;
+
+private:
+	struct Node
+	{
+		ListingPtr listing;
+		uint32_t lastUse{};
+	};
+
+	mutable std::mutex mutex;
+	mutable std::map<std::string, Node, std::less<>> listings;
+	mutable uint32_t useCounter{};
+	bool modified{};
+};
+
+}
@@ -18,6 +18,7 @@
 #include <imagine/config/defs.hh>
 #include <imagine/gfx/GfxText.hh>
 #include <imagine/fs/FSDefs.hh>
+#include <imagine/fs/DirectoryIndex.hh>
 #include <imagine/gui/MenuItem.hh>
 #include <imagine/gui/View.hh>
 #include <imagine/gui/ViewStack.hh>
@@ -85,6 +86,7 @@ public:
 	void goUpDirectory(const Input::Event &);
 	void pushFileLocationsView(const Input::Event &);
 	void setShowHiddenFiles(bool);
+	void setDirectoryIndex(FS::DirectoryIndex *index) { dirIndex = index; }
 	bool onDocumentPicked(const DocumentPickerEvent&) override;
 
 protected:
@@ -93,13 +95,17 @@ protected:
 	OnChangePathDelegate onChangePath_;
 	OnSelectPathDelegate onSelectPath_;
 	std::vector<FileEntry> dir;
+	std::vector<FileEntry> refreshedDir;
 	std::vector<TableUIState> fileUIStates;
 	FS::RootedPath root;
 	Gfx::Text msgText;
 	CustomEvent dirListEvent{"FSPicker::dirListEvent", {}};
 	TableUIState newFileUIState{};
+	FS::DirectoryIndex *dirIndex{};
 	Mode mode_{};
 	bool showHiddenFiles_{};
+	bool showingCachedListing{};
+	bool hasRefreshedDir{};
 	WorkThread dirListThread{};
 
 	void changeDirByInput(CStringView path, FS::RootPathInfo, const Input::Event &,
@@ -108,7 +114,8 @@ protected:
 	Gfx::GlyphTextureSet &face();
 	TableView &fileTableView();
 	void startDirectoryListThread(CStringView path);
-	void listDirectory(CStringView path, ThreadStop &stop);
+	void listDirectory(CStringView path, const FS::DirectoryIndex::Listing *cachedListing, ThreadStop &stop);
+	void addEntries(std::vector<FileEntry> &, CStringView path, const FS::DirectoryIndex::Listing &);
 	void setEmptyPath(std::string_view message);
 };
 
@@ -41,6 +41,17 @@ uint32_t transformRGB565ToBGRX8888(uint16_t p);
 uint32_t transformRGB888ToRGBX8888(RGBTripleArray p);
 uint32_t transformRGB888ToBGRX8888(RGBTripleArray p);
 
+// Line kernels for the common per-frame conversions, vectorized when the target supports it
+void convertPixelsRGB565ToRGBX8888(uint32_t *dest, const uint16_t *src, size_t count);
+void convertPixelsRGB565ToBGRX8888(uint32_t *dest, const uint16_t *src, size_t count);
+void convertPixelsRGBX8888ToRGB565(uint16_t *dest, const uint32_t *src, size_t count);
+void convertPixelsBGRX8888ToRGB565(uint16_t *dest, const uint32_t *src, size_t count);
+void convertPixelsRGBA8888ToBGRA8888(uint32_t *dest, const uint32_t *src, size_t count);
+void lookupPixels(uint16_t *dest, const uint8_t *src, size_t count, const uint16_t *palette);
+void lookupPixels(uint32_t *dest, const uint8_t *src, size_t count, const uint32_t *palette);
+void lookupPixels(uint16_t *dest, const uint16_t *src, size_t count, const uint16_t *palette);
+void lookupPixels(uint32_t *dest, const uint16_t *src, size_t count, const uint32_t *palette);
+
 template <class Func>
 concept PixmapTransformFunc =
 		requires (Func &&f, unsigned data){ f(data); } ||
@@ -319,6 +330,21 @@ public:
 		writeTransformed2<Src, Dest>(func, pixmap);
 	}
 
+	// Writes the palette entry of each 8 or 16-bit source index, the palette entry size must match the destination format
+	template <class Dest>
+	void writeLookup(const Dest *palette, auto pixmap) requires(dataIsMutable)
+	{
+		assumeExpr(format().bytesPerPixel() == sizeof(Dest));
+		switch(pixmap.format().bytesPerPixel())
+		{
+			case 1: return writeLines<uint8_t, Dest>(pixmap,
+				[=](Dest *dest, const uint8_t *src, size_t count){ lookupPixels(dest, src, count, palette); });
+			case 2: return writeLines<uint16_t, Dest>(pixmap,
+				[=](Dest *dest, const uint16_t *src, size_t count){ lookupPixels(dest, src, count, palette); });
+		}
+		bug_unreachable("invalid lookup bytes per pixel:%d", pixmap.format().bytesPerPixel());
+	}
+
 protected:
 	PixData *data_{};
 	int pitchPx_{};
@@ -367,6 +393,28 @@ protected:
 		}
 	}
 
+	template <class Src, class Dest>
+	void writeLines(auto pixmap, auto &&lineFunc) requires(dataIsMutable)
+	{
+		auto srcData = (const Src*)pixmap.data();
+		auto destData = (Dest*)data_;
+		if(w() == pixmap.w() && !isPadded() && !pixmap.isPadded())
+		{
+			lineFunc(destData, srcData, pixmap.w() * pixmap.h());
+		}
+		else
+		{
+			auto srcPitchPixels = pixmap.pitchPx();
+			auto destPitchPixels = pitchPx();
+			for(auto h : iotaCount(pixmap.h()))
+			{
+				lineFunc(destData, srcData, pixmap.w());
+				srcData += srcPitchPixels;
+				destData += destPitchPixels;
+			}
+		}
+	}
+
 	static void invalidFormatConversion(auto dest, auto src)
 	{
 		bug_unreachable("unimplemented conversion:%s -> %s", src.format().name(), dest.format().name());
@@ -384,12 +432,12 @@ protected:
 
 	static void convertRGB565ToRGBX8888(auto dest, auto src)
 	{
-		dest.writeTransformed(transformRGB565ToRGBX8888, src);
+		dest.template writeLines<uint16_t, uint32_t>(src, convertPixelsRGB565ToRGBX8888);
 	}
 
 	static void convertRGB565ToBGRX8888(auto dest, auto src)
 	{
-		dest.writeTransformed(transformRGB565ToBGRX8888, src);
+		dest.template writeLines<uint16_t, uint32_t>(src, convertPixelsRGB565ToBGRX8888);
 	}
 
 	static void convertRGBX8888ToRGB888(auto dest, auto src)
@@ -414,17 +462,17 @@ protected:
 
 	static void convertRGBX8888ToRGB565(auto dest, auto src)
 	{
-		dest.writeTransformed(transformRGBX8888ToRGB565, src);
+		dest.template writeLines<uint32_t, uint16_t>(src, convertPixelsRGBX8888ToRGB565);
 	}
 
 	static void convertRGBA8888ToBGRA8888(auto dest, auto src)
 	{
-		dest.writeTransformed(transformRGBA8888ToBGRA8888, src);
+		dest.template writeLines<uint32_t, uint32_t>(src, convertPixelsRGBA8888ToBGRA8888);
 	}
 
 	static void convertBGRX8888ToRGB565(auto dest, auto src)
 	{
-		dest.template writeTransformed(transformBGRX8888ToRGB565, src);
+		dest.template writeLines<uint32_t, uint16_t>(src, convertPixelsBGRX8888ToRGB565);
 	}
 };
 
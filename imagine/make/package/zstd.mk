@@ -0,0 +1,10 @@
+ifndef inc_pkg_zstd
+inc_pkg_zstd := 1
+
+ifeq ($(ENV), linux)
+ pkgConfigDeps += libzstd
+else
+ pkgConfigStaticDeps += libzstd
+endif
+
+endif
\ No newline at end of file
@@ -20,6 +20,7 @@
 #include <imagine/util/format.hh>
 #include <imagine/logger/logger.h>
 #include <sys/stat.h>
+#include <cstdio>
 
 namespace IG
 {
@@ -135,6 +136,7 @@ FS::PathString ApplicationContext::libPath(const char *) const
 
 void ApplicationContext::exitWithMessage(int exitVal, const char *msg)
 {
+	std::fputs(std::format("Exited with error: {}\n", msg).c_str(), stderr);
 	auto cmd = std::format("zenity --warning --title='Exited with error' --text='{}'", msg);
 	auto cmdResult = system(cmd.data());
 	::exit(exitVal);
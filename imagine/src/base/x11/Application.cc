@@ -21,6 +21,7 @@
 #include "xlibutils.h"
 #include <imagine/util/ranges.hh>
 #include <xcb/xfixes.h>
+#include <stdexcept>
 
 constexpr char ASCII_LF = 0xA;
 constexpr char ASCII_CR = 0xD;
@@ -287,12 +288,12 @@ static void initXFixes(xcb_connection_t& conn)
 FDEventSource XApplication::makeXDisplayConnection(EventLoop loop)
 {
 	auto &conn = *xcb_connect(nullptr, nullptr);
-	xConn = &conn;
 	if(xcb_connection_has_error(&conn))
 	{
-		log.error("couldn't open X connection");
-		return {};
+		xcb_disconnect(&conn);
+		throw std::runtime_error("Couldn't open X display, check DISPLAY is set to a running X server");
 	}
+	xConn = &conn;
 	auto &screen = *xcb_setup_roots_iterator(xcb_get_setup(&conn)).data;
 	xScr = &screen;
 	log.info("created X connection:{} screen:{}", (void*)&conn, (void*)&screen);
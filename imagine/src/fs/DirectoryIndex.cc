@@ -0,0 +1,249 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/fs/DirectoryIndex.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/ranges.hh>
+#include <imagine/util/string.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace IG::FS
+{
+
+constexpr SystemLogger log{"DirIndex"};
+
+// File format, with all integers as LEB128 varints:
+// "IGDI", format version byte, listing count, then for each listing the directory path (size + bytes),
+// last write time in nanoseconds, entry count, and each entry's type byte, name, and path (size + bytes)
+constexpr std::string_view indexMagic{"IGDI"};
+constexpr uint8_t indexVersion = 1;
+
+// A directory written to in the last moments before it was read may get another entry within the
+// resolution of its write time, so such listings aren't treated as current
+constexpr auto minWriteTimeAge = Seconds{2};
+
+static void writeVarint(std::vector<uint8_t> &out, uint64_t val)
+{
+	while(val >= 0x80)
+	{
+		out.push_back(uint8_t(val) | 0x80);
+		val >>= 7;
+	}
+	out.push_back(uint8_t(val));
+}
+
+static void writeString(std::vector<uint8_t> &out, std::string_view str)
+{
+	writeVarint(out, str.size());
+	out.insert(out.end(), str.begin(), str.end());
+}
+
+class IndexReader
+{
+public:
+	IndexReader(std::span<const uint8_t> data): data{data} {}
+
+	uint8_t readByte()
+	{
+		if(pos == data.size())
+			throw std::runtime_error("truncated index");
+		return data[pos++];
+	}
+
+	uint64_t readVarint()
+	{
+		uint64_t val{};
+		for(unsigned shift = 0; shift < 64; shift += 7)
+		{
+			auto byte = readByte();
+			val |= uint64_t(byte & 0x7F) << shift;
+			if(!(byte & 0x80))
+				return val;
+		}
+		throw std::runtime_error("invalid varint");
+	}
+
+	std::string_view readString()
+	{
+		auto size = readVarint();
+		if(size > data.size() - pos)
+			throw std::runtime_error("truncated index");
+		std::string_view str{(const char*)&data[pos], size};
+		pos += size;
+		return str;
+	}
+
+	bool atEnd() const { return pos == data.size(); }
+
+private:
+	std::span<const uint8_t> data;
+	size_t pos{};
+};
+
+void DirectoryIndex::Listing::addEntry(std::string_view dirPath, const directory_entry &entry)
+{
+	auto &e = entries.emplace_back(std::string{entry.name()}, std::string{}, entry.type());
+	if(std::string_view{entry.path()} != std::string_view{uriString(dirPath, e.name)})
+		e.path = entry.path();
+}
+
+void DirectoryIndex::Listing::sort()
+{
+	std::ranges::sort(entries,
+		[](const Entry &e1, const Entry &e2)
+		{
+			if(e1.isDir() != e2.isDir())
+				return e1.isDir();
+			return caselessLexCompare(e1.name, e2.name);
+		});
+}
+
+DirectoryIndex::ListingPtr DirectoryIndex::find(std::string_view dirPath) const
+{
+	std::scoped_lock lock{mutex};
+	auto it = listings.find(dirPath);
+	if(it == listings.end())
+		return {};
+	it->second.lastUse = ++useCounter;
+	return it->second.listing;
+}
+
+void DirectoryIndex::update(std::string_view dirPath, Listing listing)
+{
+	if(WallClock::now() - listing.lastWriteTime < minWriteTimeAge)
+		listing.lastWriteTime = {};
+	auto listingPtr = std::make_shared<const Listing>(std::move(listing));
+	std::scoped_lock lock{mutex};
+	auto it = listings.find(dirPath);
+	if(it == listings.end())
+	{
+		if(listings.size() == maxListings)
+		{
+			auto oldestIt = std::ranges::min_element(listings, {}, [](auto &n){ return n.second.lastUse; });
+			log.info("removing least recently used listing:{}", oldestIt->first);
+			listings.erase(oldestIt);
+		}
+		it = listings.emplace(std::string{dirPath}, Node{}).first;
+	}
+	it->second = {std::move(listingPtr), ++useCounter};
+	modified = true;
+}
+
+PathString DirectoryIndex::entryPath(std::string_view dirPath, const Entry &e)
+{
+	if(e.path.size())
+		return PathString{e.path};
+	return uriString(dirPath, e.name);
+}
+
+void DirectoryIndex::load(CStringView filePath)
+{
+	auto buff = FileUtils::bufferFromPath(filePath, {.test = true});
+	if(!buff)
+		return;
+	std::span<const uint8_t> data{buff.data(), buff.size()};
+	if(data.size() < indexMagic.size() + 1 || !std::equal(indexMagic.begin(), indexMagic.end(), data.begin()) ||
+		data[indexMagic.size()] != indexVersion)
+	{
+		log.warn("ignoring index:{} with unknown format", filePath);
+		return;
+	}
+	std::map<std::string, Node, std::less<>> loadedListings;
+	try
+	{
+		IndexReader in{data.subspan(indexMagic.size() + 1)};
+		auto count = in.readVarint();
+		for(uint32_t i = 0; i < count; i++)
+		{
+			std::string dirPath{in.readString()};
+			Listing listing{.lastWriteTime = WallClockTimePoint{std::chrono::duration_cast<WallClock::duration>(
+				std::chrono::nanoseconds{int64_t(in.readVarint())})}};
+			auto entries = in.readVarint();
+			for([[maybe_unused]] auto j : iotaCount(entries))
+			{
+				auto type = file_type(in.readByte());
+				auto &e = listing.entries.emplace_back(std::string{in.readString()}, std::string{in.readString()}, type);
+				if(e.name.empty())
+					throw std::runtime_error("empty entry name");
+			}
+			loadedListings.insert_or_assign(std::move(dirPath),
+				Node{std::make_shared<const Listing>(std::move(listing)), uint32_t(count - i)});
+		}
+		if(!in.atEnd())
+			throw std::runtime_error("trailing data");
+	}
+	catch(std::exception &err)
+	{
+		log.error("error reading index:{}:{}", filePath, err.what());
+		return;
+	}
+	log.info("loaded {} listings from:{}", loadedListings.size(), filePath);
+	std::scoped_lock lock{mutex};
+	listings = std::move(loadedListings);
+	useCounter = listings.size();
+	modified = false;
+}
+
+bool DirectoryIndex::save(CStringView filePath)
+{
+	std::vector<uint8_t> data;
+	{
+		std::scoped_lock lock{mutex};
+		if(!modified)
+			return true;
+		// most recently used listings first so they're kept if the limit is lowered
+		std::vector<decltype(listings)::const_pointer> nodes;
+		nodes.reserve(listings.size());
+		for(auto &n : listings)
+			nodes.emplace_back(&n);
+		std::ranges::sort(nodes, std::ranges::greater{}, [](auto n){ return n->second.lastUse; });
+		data.insert(data.end(), indexMagic.begin(), indexMagic.end());
+		data.push_back(indexVersion);
+		writeVarint(data, nodes.size());
+		for(auto n : nodes)
+		{
+			auto &listing = *n->second.listing;
+			writeString(data, n->first);
+			writeVarint(data, std::chrono::duration_cast<std::chrono::nanoseconds>(listing.lastWriteTime.time_since_epoch()).count());
+			writeVarint(data, listing.entries.size());
+			for(auto &e : listing.entries)
+			{
+				data.push_back(uint8_t(e.type));
+				writeString(data, e.name);
+				writeString(data, e.path);
+			}
+		}
+		modified = false;
+	}
+	log.info("saving index of size:{} to:{}", data.size(), filePath);
+	if(FileUtils::writeToPath(filePath, data) != ssize_t(data.size()))
+	{
+		log.error("error writing index:{}", filePath);
+		return false;
+	}
+	return true;
+}
+
+bool DirectoryIndex::isModified() const
+{
+	std::scoped_lock lock{mutex};
+	return modified;
+}
+
+}
@@ -1,6 +1,7 @@
 ifndef inc_fs
 inc_fs := 1
 
-SRC += fs/FS.cc
+SRC += fs/DirectoryIndex.cc \
+fs/FS.cc
 
 endif
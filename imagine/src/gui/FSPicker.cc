@@ -18,6 +18,7 @@
 #include <imagine/gui/TextEntry.hh>
 #include <imagine/gui/NavView.hh>
 #include <imagine/fs/FS.hh>
+#include <imagine/fs/DirectoryIndex.hh>
 #include <imagine/base/ApplicationContext.hh>
 #include <imagine/gfx/RendererCommands.hh>
 #include <imagine/gfx/BasicEffect.hh>
@@ -192,6 +193,10 @@ void FSPicker::draw(Gfx::RendererCommands &__restrict__ cmds, ViewDrawParams) co
 			msgText.draw(cmds, controller.top().viewRect().pos(C2DO), C2DO, ColorName::WHITE);
 		}
 	}
+	else if(showingCachedListing && dir.size())
+	{
+		controller.top().draw(cmds);
+	}
 	controller.navView()->draw(cmds);
 }
 
@@ -209,6 +214,8 @@ void FSPicker::setEmptyPath(std::string_view message)
 	newFileUIState = {};
 	fileUIStates.clear();
 	dir.clear();
+	refreshedDir.clear();
+	showingCachedListing = hasRefreshedDir = false;
 	msgText.resetString(message);
 	if(mode_ == Mode::FILE_IN_DIR)
 	{
@@ -468,17 +475,38 @@ void FSPicker::startDirectoryListThread(CStringView path)
 	}
 	dir.clear();
 	fileTableView().resetItemSource();
+	FS::DirectoryIndex::ListingPtr cachedListing;
+	if(dirIndex)
+		cachedListing = dirIndex->find(path);
+	showingCachedListing = bool(cachedListing);
+	if(cachedListing)
+	{
+		log.info("showing cached listing while refreshing:{}", path);
+		addEntries(dir, path, *cachedListing);
+		fileTableView().resetItemSource(dir);
+		if(viewRect().x)
+			place();
+		fileTableView().restoreUIState(std::exchange(newFileUIState, {}));
+	}
 	dirListEvent.setCallback([this]()
 	{
+		if(!hasRefreshedDir)
+			return;
+		auto uiState = showingCachedListing ? fileTableView().saveUIState() : std::exchange(newFileUIState, {});
+		showingCachedListing = false;
+		hasRefreshedDir = false;
+		dir.swap(refreshedDir);
+		refreshedDir.clear();
 		fileTableView().resetItemSource(dir);
 		place();
-		fileTableView().restoreUIState(std::exchange(newFileUIState, {}));
+		fileTableView().restoreUIState(uiState);
 		postDraw();
 	});
 	dirListEvent.cancel();
-	dirListThread.reset([this](WorkThread::Context ctx, const std::string &path)
+	hasRefreshedDir = false;
+	dirListThread.reset([this, cachedListing](WorkThread::Context ctx, const std::string &path)
 	{
-		listDirectory(path, ctx.stop);
+		listDirectory(path, cachedListing.get(), ctx.stop);
 		if(ctx.stop.isQuitting()) [[unlikely]]
 			return;
 		ctx.finishedWork();
@@ -486,12 +514,20 @@ void FSPicker::startDirectoryListThread(CStringView path)
 	}, std::string{path});
 }
 
-void FSPicker::listDirectory(CStringView path, ThreadStop &stop)
+void FSPicker::listDirectory(CStringView path, const FS::DirectoryIndex::Listing *cachedListing, ThreadStop &stop)
 {
+	refreshedDir.clear();
 	try
 	{
-		appContext().forEachInDirectoryUri(path,
-			[this, &stop](auto &entry)
+		auto ctx = appContext();
+		FS::DirectoryIndex::Listing listing{.lastWriteTime = ctx.fileUriLastWriteTime(path)};
+		if(cachedListing && cachedListing->isCurrent(listing.lastWriteTime))
+		{
+			log.info("cached listing is current");
+			return;
+		}
+		ctx.forEachInDirectoryUri(path,
+			[&](auto &entry)
 			{
 				//log.info("entry:{}", entry.path());
 				if(stop) [[unlikely]]
@@ -499,70 +535,15 @@ void FSPicker::listDirectory(CStringView path, ThreadStop &stop)
 					log.info("interrupted listing directory");
 					return false;
 				}
-				bool isDir = entry.type() == FS::file_type::directory;
-				if(mode_ == Mode::FILE_IN_DIR) // filter directories
-				{
-					if(isDir)
-						return true;
-				}
-				if(!showHiddenFiles_ && entry.name().starts_with('.'))
-				{
-					return true;
-				}
-				if(filter && !filter(entry))
-				{
-					return true;
-				}
-				auto &item = dir.emplace_back(attachParams(), std::string{entry.path()}, entry.name());
-				if(isDir)
-					item.text.flags.user |= FileEntry::isDirFlag;
-				if(mode_ == Mode::DIR && !isDir)
-					item.text.setActive(false);
+				listing.addEntry(path, entry);
 				return true;
 			});
-		std::sort(dir.begin(), dir.end(),
-			[](const FileEntry &e1, const FileEntry &e2)
-			{
-				if(e1.isDir() && !e2.isDir())
-					return true;
-				else if(!e1.isDir() && e2.isDir())
-					return false;
-				else
-					return caselessLexCompare(e1.path, e2.path);
-			});
-		if(dir.size())
-		{
-			for(auto &d : dir)
-			{
-				if(!d.text.active())
-					continue;
-				if(d.isDir())
-				{
-					d.text.onSelect =
-						[this, &dirPath = d.path](const Input::Event &e)
-						{
-							assert(!isSingleDirectoryMode());
-							auto path = std::move(dirPath);
-							log.info("entering dir:{}", path);
-							changeDirByInput(path, root.info, e);
-						};
-				}
-				else
-				{
-					d.text.onSelect =
-						[this, &dirPath = d.path](const Input::Event &e)
-						{
-							onSelectPath_.callCopy(*this, dirPath, appContext().fileUriDisplayName(dirPath), e);
-						};
-				}
-			}
-			msgText.resetString();
-		}
-		else // no entries, show a message instead
-		{
-			msgText.resetString("Empty Directory");
-			msgText.compile();
-		}
+		if(stop)
+			return;
+		listing.sort();
+		addEntries(refreshedDir, path, listing);
+		if(dirIndex)
+			dirIndex->update(path, std::move(listing));
 	}
 	catch(std::system_error &err)
 	{
@@ -572,6 +553,67 @@ void FSPicker::listDirectory(CStringView path, ThreadStop &stop)
 		msgText.resetString(std::format("Can't open directory:\n{}{}", ec.message(), extraMsg));
 		msgText.compile();
 	}
+	hasRefreshedDir = true;
+}
+
+void FSPicker::addEntries(std::vector<FileEntry> &entries, CStringView path, const FS::DirectoryIndex::Listing &listing)
+{
+	for(const auto &e : listing.entries)
+	{
+		bool isDir = e.isDir();
+		if(mode_ == Mode::FILE_IN_DIR) // filter directories
+		{
+			if(isDir)
+				continue;
+		}
+		if(!showHiddenFiles_ && e.name.starts_with('.'))
+		{
+			continue;
+		}
+		auto entryPath = FS::DirectoryIndex::entryPath(path, e);
+		if(filter && !filter(FS::directory_entry{entryPath, e.name, e.type}))
+		{
+			continue;
+		}
+		auto &item = entries.emplace_back(attachParams(), std::string{entryPath}, e.name);
+		if(isDir)
+			item.text.flags.user |= FileEntry::isDirFlag;
+		if(mode_ == Mode::DIR && !isDir)
+			item.text.setActive(false);
+	}
+	if(entries.size())
+	{
+		for(auto &d : entries)
+		{
+			if(!d.text.active())
+				continue;
+			if(d.isDir())
+			{
+				d.text.onSelect =
+					[this, &dirPath = d.path](const Input::Event &e)
+					{
+						assert(!isSingleDirectoryMode());
+						auto path = std::move(dirPath);
+						log.info("entering dir:{}", path);
+						changeDirByInput(path, root.info, e);
+					};
+			}
+			else
+			{
+				d.text.onSelect =
+					[this, &dirPath = d.path](const Input::Event &e)
+					{
+						onSelectPath_.callCopy(*this, dirPath, appContext().fileUriDisplayName(dirPath), e);
+					};
+			}
+		}
+		msgText.resetString();
+	}
+	else // no entries, show a message instead
+	{
+		msgText.resetString("Empty Directory");
+		msgText.compile();
+	}
 }
 
 }
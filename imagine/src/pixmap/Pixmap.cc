@@ -13,8 +13,18 @@
 	You should have received a copy of the GNU General Public License
 	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
 
+#include <imagine/pixmap/Pixmap.hh>
 #include <array>
 #include <cstdint>
+#include <utility>
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+#if defined __x86_64__ || defined __i386__
+#include <immintrin.h>
+#endif
 
 namespace IG
 {
@@ -109,4 +119,227 @@ static uint32_t transformRGB888ToRGBX8888Impl(RGBTripleArray p)
 uint32_t transformRGB888ToRGBX8888(RGBTripleArray p) { return transformRGB888ToRGBX8888Impl(p); }
 uint32_t transformRGB888ToBGRX8888(RGBTripleArray p) { return transformRGB888ToRGBX8888Impl<true>(p); }
 
+#if defined __SSE2__ || defined __ARM_NEON
+
+// 8 x 16-bit lane helpers shared by the SSE2 & NEON kernels
+#if defined __SSE2__
+using u16x8 = __m128i;
+static u16x8 load8(const uint16_t *p) { return _mm_loadu_si128((const __m128i*)p); }
+static void store8(uint16_t *p, u16x8 v) { _mm_storeu_si128((__m128i*)p, v); }
+template<int n> static u16x8 shr(u16x8 v) { return _mm_srli_epi16(v, n); }
+template<int n> static u16x8 shl(u16x8 v) { return _mm_slli_epi16(v, n); }
+static u16x8 andMask(u16x8 v, uint16_t m) { return _mm_and_si128(v, _mm_set1_epi16(m)); }
+static u16x8 orV(u16x8 a, u16x8 b) { return _mm_or_si128(a, b); }
+static u16x8 addV(u16x8 a, u16x8 b) { return _mm_add_epi16(a, b); }
+static u16x8 addConst(u16x8 v, uint16_t a) { return _mm_add_epi16(v, _mm_set1_epi16(a)); }
+static u16x8 mulAdd(u16x8 v, uint16_t m, uint16_t a) { return _mm_add_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(m)), _mm_set1_epi16(a)); }
+static u16x8 mulHigh(u16x8 v, uint16_t m) { return _mm_mulhi_epu16(v, _mm_set1_epi16(m)); }
+
+// store the low & high 16 bits of 8 x 32-bit pixels
+static void storeInterleaved(uint32_t *p, u16x8 lo, u16x8 hi)
+{
+	_mm_storeu_si128((__m128i*)p, _mm_unpacklo_epi16(lo, hi));
+	_mm_storeu_si128((__m128i*)(p + 4), _mm_unpackhi_epi16(lo, hi));
+}
+
+// load 8 x 32-bit pixels split into their low & high 16 bits,
+// values are sign-extended before packing so the saturation leaves them unchanged
+static void loadDeinterleaved(const uint32_t *p, u16x8 &lo, u16x8 &hi)
+{
+	auto a = _mm_loadu_si128((const __m128i*)p);
+	auto b = _mm_loadu_si128((const __m128i*)(p + 4));
+	lo = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+	hi = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+}
+#else
+using u16x8 = uint16x8_t;
+static u16x8 load8(const uint16_t *p) { return vld1q_u16(p); }
+static void store8(uint16_t *p, u16x8 v) { vst1q_u16(p, v); }
+template<int n> static u16x8 shr(u16x8 v) { return vshrq_n_u16(v, n); }
+template<int n> static u16x8 shl(u16x8 v) { return vshlq_n_u16(v, n); }
+static u16x8 andMask(u16x8 v, uint16_t m) { return vandq_u16(v, vdupq_n_u16(m)); }
+static u16x8 orV(u16x8 a, u16x8 b) { return vorrq_u16(a, b); }
+static u16x8 addV(u16x8 a, u16x8 b) { return vaddq_u16(a, b); }
+static u16x8 addConst(u16x8 v, uint16_t a) { return vaddq_u16(v, vdupq_n_u16(a)); }
+static u16x8 mulAdd(u16x8 v, uint16_t m, uint16_t a) { return vmlaq_n_u16(vdupq_n_u16(a), v, m); }
+
+static u16x8 mulHigh(u16x8 v, uint16_t m)
+{
+	return vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(v), m), 16),
+		vshrn_n_u32(vmull_n_u16(vget_high_u16(v), m), 16));
+}
+
+static void storeInterleaved(uint32_t *p, u16x8 lo, u16x8 hi) { vst2q_u16((uint16_t*)p, uint16x8x2_t{lo, hi}); }
+
+static void loadDeinterleaved(const uint32_t *p, u16x8 &lo, u16x8 &hi)
+{
+	auto v = vld2q_u16((const uint16_t*)p);
+	lo = v.val[0];
+	hi = v.val[1];
+}
+#endif
+
+// Exact equivalents of the scalar rounding divisions, valid for the input ranges used below:
+// (c * 255 + 15) / 31 for 5-bit, (c * 255 + 31) / 63 for 6-bit, and x / 255 for x < 65280 (255 * 256)
+static u16x8 expand5To8(u16x8 c) { return shr<2>(mulHigh(mulAdd(c, 255, 15), 8457)); }
+static u16x8 expand6To8(u16x8 c) { return shr<4>(mulHigh(mulAdd(c, 255, 31), 16645)); }
+static u16x8 div255(u16x8 x) { return shr<8>(addV(addConst(x, 1), shr<8>(x))); }
+
+#endif
+
+template <bool BGR_SWAP>
+static void convertPixelsRGB565ToRGBX8888Impl(uint32_t *__restrict__ dest, const uint16_t *__restrict__ src, size_t count)
+{
+	#if defined __SSE2__ || defined __ARM_NEON
+	for(; count >= 8; count -= 8, src += 8, dest += 8)
+	{
+		auto p = load8(src);
+		auto r = expand5To8(shr<11>(p));
+		auto g = expand6To8(andMask(shr<5>(p), 0x3F));
+		auto b = expand5To8(andMask(p, 0x1F));
+		if constexpr(BGR_SWAP) { std::swap(r, b); }
+		storeInterleaved(dest, orV(r, shl<8>(g)), b);
+	}
+	#endif
+	for(; count; count--)
+	{
+		*dest++ = transformRGB565ToRGBX8888Impl<BGR_SWAP>(*src++);
+	}
+}
+
+void convertPixelsRGB565ToRGBX8888(uint32_t *dest, const uint16_t *src, size_t count) { convertPixelsRGB565ToRGBX8888Impl<false>(dest, src, count); }
+void convertPixelsRGB565ToBGRX8888(uint32_t *dest, const uint16_t *src, size_t count) { convertPixelsRGB565ToRGBX8888Impl<true>(dest, src, count); }
+
+template <bool BGR_SWAP>
+static void convertPixelsRGBX8888ToRGB565Impl(uint16_t *__restrict__ dest, const uint32_t *__restrict__ src, size_t count)
+{
+	#if defined __SSE2__ || defined __ARM_NEON
+	for(; count >= 8; count -= 8, src += 8, dest += 8)
+	{
+		u16x8 lo, hi;
+		loadDeinterleaved(src, lo, hi);
+		auto r = andMask(lo, 0xFF);
+		auto g = shr<8>(lo);
+		auto b = andMask(hi, 0xFF);
+		if constexpr(BGR_SWAP) { std::swap(r, b); }
+		auto r5 = div255(mulAdd(r, 31, 127));
+		auto g6 = div255(mulAdd(g, 63, 127));
+		auto b5 = div255(mulAdd(b, 31, 127));
+		store8(dest, orV(orV(shl<11>(r5), shl<5>(g6)), b5));
+	}
+	#endif
+	for(; count; count--)
+	{
+		*dest++ = transformRGBX8888ToRGB565Impl<BGR_SWAP>(*src++);
+	}
+}
+
+void convertPixelsRGBX8888ToRGB565(uint16_t *dest, const uint32_t *src, size_t count) { convertPixelsRGBX8888ToRGB565Impl<false>(dest, src, count); }
+void convertPixelsBGRX8888ToRGB565(uint16_t *dest, const uint32_t *src, size_t count) { convertPixelsRGBX8888ToRGB565Impl<true>(dest, src, count); }
+
+#if defined __x86_64__ || defined __i386__
+static bool hasAVX2()
+{
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+	return hasAVX2;
+}
+
+[[gnu::target("avx2")]]
+static size_t convertPixelsRGBA8888ToBGRA8888AVX2(uint32_t *__restrict__ dest, const uint32_t *__restrict__ src, size_t count)
+{
+	const auto shuffle = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	size_t converted{};
+	for(; count - converted >= 8; converted += 8)
+	{
+		auto v = _mm256_loadu_si256((const __m256i*)(src + converted));
+		_mm256_storeu_si256((__m256i*)(dest + converted), _mm256_shuffle_epi8(v, shuffle));
+	}
+	return converted;
+}
+
+template <class Src, class Dest>
+[[gnu::target("avx2")]]
+static size_t lookupPixelsAVX2(Dest *__restrict__ dest, const Src *__restrict__ src, size_t count, const Dest *__restrict__ palette)
+{
+	static_assert(sizeof(Dest) == 4, "gathers read 32-bit elements");
+	size_t converted{};
+	for(; count - converted >= 8; converted += 8)
+	{
+		__m256i idx;
+		if constexpr(sizeof(Src) == 1)
+			idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + converted)));
+		else
+			idx = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + converted)));
+		_mm256_storeu_si256((__m256i*)(dest + converted), _mm256_i32gather_epi32((const int*)palette, idx, 4));
+	}
+	return converted;
+}
+#endif
+
+void convertPixelsRGBA8888ToBGRA8888(uint32_t *__restrict__ dest, const uint32_t *__restrict__ src, size_t count)
+{
+	#if defined __x86_64__ || defined __i386__
+	if(hasAVX2())
+	{
+		auto converted = convertPixelsRGBA8888ToBGRA8888AVX2(dest, src, count);
+		dest += converted; src += converted; count -= converted;
+	}
+	#endif
+	#if defined __SSE2__
+	const auto rbMask = _mm_set1_epi32(0x00FF00FF);
+	for(; count >= 4; count -= 4, src += 4, dest += 4)
+	{
+		auto v = _mm_loadu_si128((const __m128i*)src);
+		auto rb = _mm_and_si128(v, rbMask);
+		auto ga = _mm_andnot_si128(rbMask, v);
+		_mm_storeu_si128((__m128i*)dest, _mm_or_si128(ga, _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16))));
+	}
+	#elif defined __ARM_NEON
+	const auto rbMask = vdupq_n_u32(0x00FF00FF);
+	for(; count >= 4; count -= 4, src += 4, dest += 4)
+	{
+		auto v = vld1q_u32(src);
+		auto rb = vreinterpretq_u16_u32(vandq_u32(v, rbMask));
+		auto ga = vbicq_u32(v, rbMask);
+		vst1q_u32(dest, vorrq_u32(ga, vreinterpretq_u32_u16(vrev32q_u16(rb))));
+	}
+	#endif
+	for(; count; count--)
+	{
+		*dest++ = transformRGBA8888ToBGRA8888(*src++);
+	}
+}
+
+// SSE2 & NEON have no gather instruction so lookups without AVX2 stay scalar, unrolled to keep multiple loads in flight
+template <class Src, class Dest>
+static void lookupPixelsImpl(Dest *__restrict__ dest, const Src *__restrict__ src, size_t count, const Dest *__restrict__ palette)
+{
+	#if defined __x86_64__ || defined __i386__
+	if constexpr(sizeof(Dest) == 4)
+	{
+		if(hasAVX2())
+		{
+			auto converted = lookupPixelsAVX2(dest, src, count, palette);
+			dest += converted; src += converted; count -= converted;
+		}
+	}
+	#endif
+	for(; count >= 4; count -= 4, src += 4, dest += 4)
+	{
+		auto p0 = palette[src[0]], p1 = palette[src[1]], p2 = palette[src[2]], p3 = palette[src[3]];
+		dest[0] = p0; dest[1] = p1; dest[2] = p2; dest[3] = p3;
+	}
+	for(; count; count--)
+	{
+		*dest++ = palette[*src++];
+	}
+}
+
+void lookupPixels(uint16_t *dest, const uint8_t *src, size_t count, const uint16_t *palette) { lookupPixelsImpl(dest, src, count, palette); }
+void lookupPixels(uint32_t *dest, const uint8_t *src, size_t count, const uint32_t *palette) { lookupPixelsImpl(dest, src, count, palette); }
+void lookupPixels(uint16_t *dest, const uint16_t *src, size_t count, const uint16_t *palette) { lookupPixelsImpl(dest, src, count, palette); }
+void lookupPixels(uint32_t *dest, const uint16_t *src, size_t count, const uint32_t *palette) { lookupPixelsImpl(dest, src, count, palette); }
+
 }